@@ -0,0 +1,48 @@
+#version 450
+
+// Position-only stream for the depth pre-pass, instance attributes keep the locations used by shader.vert
+layout (location = 0) in vec3 inPosition;
+layout (location = 3) in vec4 inInstance0; // Transform row 0 or translation
+layout (location = 4) in vec4 inInstance1; // Transform row 1 or rotation quaternion
+layout (location = 5) in vec4 inInstance2; // Transform row 2 or scale
+
+layout (set = 0, binding = 0) uniform UniformBufferObject {
+	mat4 view;
+	mat4 projection;
+} ubo;
+
+layout (push_constant) uniform VertexDequantization {
+	vec4 positionOffset;
+	vec4 positionScale;
+	vec4 texCoordTransform;
+} dequantization;
+
+// Must match shader.vert bit for bit, the main pass tests depth with EQUAL
+invariant gl_Position;
+
+// Must match shader.vert, InstanceEncoding and InstancePacker, 0 = affine rows, 1 = translation, rotation and scale
+layout (constant_id = 0) const uint INSTANCE_ENCODING = 1;
+
+mat4 decodeModelMatrix()
+{
+	if (INSTANCE_ENCODING == 0) {
+		return transpose(mat4(inInstance0, inInstance1, inInstance2, vec4(0.0, 0.0, 0.0, 1.0)));
+	}
+	vec4 q = normalize(inInstance1);
+	vec3 q2 = q.xyz * 2.0;
+	float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+	float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+	float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+	vec3 scale = inInstance2.xyz;
+	return mat4(vec4(vec3(1.0 - (yy + zz), xy + wz, xz - wy) * scale.x, 0.0),
+	            vec4(vec3(xy - wz, 1.0 - (xx + zz), yz + wx) * scale.y, 0.0),
+	            vec4(vec3(xz + wy, yz - wx, 1.0 - (xx + yy)) * scale.z, 0.0),
+	            vec4(inInstance0.xyz, 1.0));
+}
+
+void main()
+{
+	mat4 model = decodeModelMatrix();
+	vec3 position = dequantization.positionOffset.xyz + inPosition * dequantization.positionScale.xyz;
+	gl_Position = ubo.projection * ubo.view * model * vec4(position, 1.0);
+}
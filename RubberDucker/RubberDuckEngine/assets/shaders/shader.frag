@@ -1,14 +1,17 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
-layout(set = 1, binding = 0) uniform sampler2D texSampler;
+// Bindless texture array, sized at descriptor set allocation
+layout(set = 1, binding = 0) uniform sampler2D textures[];
 
-layout(location = 0) in vec3 fragColor;
+layout(location = 0) in vec3 fragNormal;
 layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
 void main()
 {
-//	outColor = vec4(fragColor, 1.0);
-	outColor = texture(texSampler, fragTexCoord);
+//	outColor = vec4(normalize(fragNormal) * 0.5 + 0.5, 1.0);
+	outColor = texture(textures[nonuniformEXT(fragTextureIndex)], fragTexCoord);
 }
\ No newline at end of file
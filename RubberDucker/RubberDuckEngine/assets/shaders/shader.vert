@@ -1,25 +1,69 @@
 #version 450
 
+// Per-mesh vertex formats, quantized streams are converted to float by the vertex fetch and mapped back with the
+// push constants. Missing attributes read zeroes, which decode to a +Z normal and uv 0
 layout (location = 0) in vec3 inPosition;
-layout (location = 1) in vec3 inColor;
+layout (location = 1) in vec2 inNormal; // Octahedral
 layout (location = 2) in vec2 inTexCoord;
-layout (location = 3) in mat4 inModelMatrix;
-//		location = 4
-//		location = 5
-//		location = 6
+layout (location = 3) in vec4 inInstance0; // Transform row 0 or translation
+layout (location = 4) in vec4 inInstance1; // Transform row 1 or rotation quaternion
+layout (location = 5) in vec4 inInstance2; // Transform row 2 or scale
+layout (location = 6) in uint inTextureIndex;
 
 layout (set = 0, binding = 0) uniform UniformBufferObject {
 	mat4 view;
 	mat4 projection;
 } ubo;
 
-layout (location = 0) out vec3 fragColor;
+layout (push_constant) uniform VertexDequantization {
+	vec4 positionOffset;
+	vec4 positionScale;
+	vec4 texCoordTransform; // xy = offset, zw = scale
+} dequantization;
+
+layout (location = 0) out vec3 fragNormal;
 layout (location = 1) out vec2 fragTexCoord;
+layout (location = 2) flat out uint fragTextureIndex;
+
+// Must match depth.vert bit for bit, the main pass tests depth with EQUAL after a depth pre-pass
+invariant gl_Position;
+
+// Must match encodeOctahedral in vertex_packer.cpp
+vec3 decodeOctahedral(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0);
+	normal.x += normal.x >= 0.0 ? -fold : fold;
+	normal.y += normal.y >= 0.0 ? -fold : fold;
+	return normalize(normal);
+}
+
+// Must match depth.vert, InstanceEncoding and InstancePacker, 0 = affine rows, 1 = translation, rotation and scale
+layout (constant_id = 0) const uint INSTANCE_ENCODING = 1;
+
+mat4 decodeModelMatrix()
+{
+	if (INSTANCE_ENCODING == 0) {
+		return transpose(mat4(inInstance0, inInstance1, inInstance2, vec4(0.0, 0.0, 0.0, 1.0)));
+	}
+	vec4 q = normalize(inInstance1);
+	vec3 q2 = q.xyz * 2.0;
+	float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+	float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+	float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+	vec3 scale = inInstance2.xyz;
+	return mat4(vec4(vec3(1.0 - (yy + zz), xy + wz, xz - wy) * scale.x, 0.0),
+	            vec4(vec3(xy - wz, 1.0 - (xx + zz), yz + wx) * scale.y, 0.0),
+	            vec4(vec3(xz + wy, yz - wx, 1.0 - (xx + yy)) * scale.z, 0.0),
+	            vec4(inInstance0.xyz, 1.0));
+}
 
 void main()
 {
-	mat4 model = inModelMatrix;
-	gl_Position = ubo.projection * ubo.view * model * vec4(inPosition, 1.0);
-	fragColor = inPosition;
-	fragTexCoord = inTexCoord;
+	mat4 model = decodeModelMatrix();
+	vec3 position = dequantization.positionOffset.xyz + inPosition * dequantization.positionScale.xyz;
+	gl_Position = ubo.projection * ubo.view * model * vec4(position, 1.0);
+	fragNormal = mat3(model) * decodeOctahedral(inNormal);
+	fragTexCoord = dequantization.texCoordTransform.xy + inTexCoord * dequantization.texCoordTransform.zw;
+	fragTextureIndex = inTextureIndex;
 }
\ No newline at end of file
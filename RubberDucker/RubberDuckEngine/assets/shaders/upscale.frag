@@ -0,0 +1,17 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Bindless texture array, sized at descriptor set allocation
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) flat in vec2 fragTexCoordMax;
+layout(location = 2) flat in uint fragTextureIndex;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	// Only the top left of the scene color image was rendered this frame, bilinear taps must not reach past it
+	outColor = texture(textures[fragTextureIndex], min(fragTexCoord, fragTexCoordMax));
+}
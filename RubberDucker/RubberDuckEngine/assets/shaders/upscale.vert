@@ -0,0 +1,23 @@
+#version 450
+
+// Fullscreen triangle without vertex input, for the upscale pass
+layout (push_constant) uniform Upscale {
+	vec2 texCoordScale;
+	vec2 texCoordMax;
+	uint textureIndex;
+} upscale;
+
+layout (location = 0) out vec2 fragTexCoord;
+layout (location = 1) flat out vec2 fragTexCoordMax;
+layout (location = 2) flat out uint fragTextureIndex;
+
+void main()
+{
+	// (0, 0), (2, 0) and (0, 2), covering the whole viewport
+	const vec2 position = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+
+	fragTexCoord = position * upscale.texCoordScale;
+	fragTexCoordMax = upscale.texCoordMax;
+	fragTextureIndex = upscale.textureIndex;
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -3,8 +3,13 @@
 #include "assetmanager/asset_manager.hpp"
 
 #include "core/main.hpp"
-#include "vulkan/data_types/texture_data.hpp"
 #include "vulkan/data_types/vertex.hpp"
+#include "vulkan/index_packer.hpp"
+#include "vulkan/ktx2.hpp"
+#include "vulkan/mesh_optimizer.hpp"
+#include "vulkan/meshlet_builder.hpp"
+#include "vulkan/mip_generator.hpp"
+#include "vulkan/vertex_packer.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stbi/stb_image.h>
@@ -13,7 +18,8 @@
 #include <tinyobjloader/tiny_obj_loader.h>
 
 namespace RDE {
-const glm::vec3 k_defaultModelColor = {0.0f, 1.0f, 0.0f};
+
+constexpr float k_overdrawCacheThreshold = 1.05f; // ACMR growth accepted for drawing outward facing clusters first
 
 void AssetManager::loadModel(const char* modelPath)
 {
@@ -32,6 +38,10 @@ void AssetManager::loadModel(const char* modelPath)
     Vulkan::Mesh mesh{};
     std::unordered_map<Vulkan::Vertex, uint32_t> uniqueVertexIndices{};
 
+    // Streams are only kept if every vertex has them
+    bool hasNormals = !attrib.normals.empty();
+    const bool hasTexCoords = !attrib.texcoords.empty();
+
     for (const auto& shape : shapes) {
         for (const auto& index : shape.mesh.indices) {
             Vulkan::Vertex vertex{};
@@ -47,7 +57,14 @@ void AssetManager::loadModel(const char* modelPath)
                 const auto modelV = attrib.texcoords[2 * index.texcoord_index + 1];
                 vertex.texCoord = {modelU, 1.0f - modelV};
             }
-            vertex.color = k_defaultModelColor;
+            if (index.normal_index >= 0 && !attrib.normals.empty()) {
+                const auto normalX = attrib.normals[3 * index.normal_index + 0];
+                const auto normalY = attrib.normals[3 * index.normal_index + 1];
+                const auto normalZ = attrib.normals[3 * index.normal_index + 2];
+                vertex.normal = {normalX, normalY, normalZ};
+            } else {
+                hasNormals = false;
+            }
 
             if (uniqueVertexIndices.count(vertex) == 0) {
                 uniqueVertexIndices[vertex] = static_cast<uint32_t>(mesh.vertices.size());
@@ -56,6 +73,50 @@ void AssetManager::loadModel(const char* modelPath)
             mesh.indices.push_back(uniqueVertexIndices[vertex]);
         }
     }
+
+    // Triangles are reordered for the post-transform cache and then for less overdraw, vertices by first use
+    const auto cacheBefore = Vulkan::MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    std::vector<uint32_t> clusters;
+    Vulkan::MeshOptimizer::optimizeVertexCache(mesh.indices, mesh.vertices.size(), &clusters);
+    Vulkan::MeshOptimizer::optimizeOverdraw(mesh.indices, mesh.vertices, clusters, k_overdrawCacheThreshold);
+    Vulkan::MeshOptimizer::optimizeVertexFetch(mesh.vertices, mesh.indices);
+
+    // Bounding sphere around the AABB center, used for frustum culling
+    if (!mesh.vertices.empty()) {
+        glm::vec3 minPos = mesh.vertices.front().pos;
+        glm::vec3 maxPos = mesh.vertices.front().pos;
+
+        for (const auto& vertex : mesh.vertices) {
+            minPos = glm::min(minPos, vertex.pos);
+            maxPos = glm::max(maxPos, vertex.pos);
+        }
+        const glm::vec3 center = (minPos + maxPos) * 0.5f;
+
+        float radius = 0.0f;
+        for (const auto& vertex : mesh.vertices) {
+            radius = glm::max(radius, glm::length(vertex.pos - center));
+        }
+        mesh.boundingSphere = glm::vec4(center, radius);
+    }
+
+    static const auto positionEncoding =
+        Vulkan::VertexPacker::parsePositionEncoding(g_engine->launchOptions().vertexPositions);
+    mesh.vertexFormat = Vulkan::VertexPacker::chooseFormat(mesh.vertices, hasNormals, hasTexCoords, positionEncoding);
+
+    auto indexLayout = Vulkan::IndexPacker::chooseLayout(mesh.indices, mesh.vertices.size());
+    mesh.indexType = indexLayout.indexType;
+    mesh.submeshes = std::move(indexLayout.submeshes);
+    mesh.meshlets = Vulkan::MeshletBuilder::build(mesh.vertices, mesh.indices, mesh.submeshes);
+    Vulkan::MeshOptimizer::optimizeMeshletVertexCache(mesh.indices, mesh.meshlets, mesh.vertices.size());
+
+    const auto cacheAfter = Vulkan::MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    RDELOG_INFO("{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                modelPath,
+                cacheBefore.acmr,
+                cacheAfter.acmr,
+                cacheBefore.atvr,
+                cacheAfter.atvr);
+
     uint32_t guid = static_cast<uint32_t>(m_assetIds.size());
     m_assetIds[modelPath] = guid;
     m_assetPaths[guid] = modelPath;
@@ -95,22 +156,52 @@ void AssetManager::loadModels(const char* folderPath)
 
 void AssetManager::loadTexture(const char* texturePath)
 {
-    Vulkan::TextureData textureData;
+    const std::filesystem::path path(texturePath);
+    const bool isKtx2 = path.extension() == ".ktx2";
+
+    // A precompressed KTX2 file next to the source image takes precedence. The source image is the fallback when the
+    // device can't sample its format and the CPU can't decode it either
+    auto texture = loadKtx2Texture(isKtx2 ? path : std::filesystem::path(path).replace_extension(".ktx2"));
 
-    stbi_uc* pixels =
-        stbi_load(texturePath, &textureData.texWidth, &textureData.texHeight, &textureData.texChannels, STBI_rgb_alpha);
-    RDE_ASSERT_0(pixels, "Failed to load {}!", texturePath);
+    if (!texture && isKtx2) {
+        RDELOG_ERROR("Failed to load {} and there is no source image to fall back to!", texturePath);
+        return;
+    }
+    if (!texture) {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+
+        stbi_uc* pixels = stbi_load(texturePath, &width, &height, &channels, STBI_rgb_alpha);
+        RDE_ASSERT_0(pixels, "Failed to load {}!", texturePath);
+
+        auto& renderer = g_engine->renderer();
+        auto mipChain = Vulkan::MipGenerator::generate(pixels,
+                                                       static_cast<uint32_t>(width),
+                                                       static_cast<uint32_t>(height),
+                                                       VK_FORMAT_R8G8B8A8_SRGB,
+                                                       renderer.mipmapsEnabled(),
+                                                       Vulkan::MipGenerator::Filter::Kaiser,
+                                                       &g_engine->threadPool());
+        stbi_image_free(pixels);
+
+        // Baked chains are picked up in place of the source image on the next run
+        if (g_engine->launchOptions().bakeTextures) {
+            const auto bakedPath = std::filesystem::path(path).replace_extension(".ktx2").string();
+            if (mipChain.save(bakedPath.c_str())) {
+                RDELOG_INFO("Baked {} levels of {} into {}", mipChain.levels.size(), texturePath, bakedPath);
+            }
+        }
 
-    textureData.data = pixels;
+        // RGBA8 sRGB can always be sampled
+        texture = renderer.createTextureResources(std::move(mipChain));
+        RDE_ASSERT_0(texture, "Failed to create texture for {}!", texturePath);
+    }
 
     uint32_t guid = static_cast<uint32_t>(m_assetIds.size());
     m_assetIds[texturePath] = guid;
     m_assetPaths[guid] = texturePath;
-
-    // Create vulkan texture and store
-    m_textures[guid] = g_engine->renderer().createTextureResources(textureData);
-
-    stbi_image_free(textureData.data);
+    m_textures[guid] = *texture;
 
     RDELOG_INFO("Loaded texture {0} with ID {1}", m_assetPaths[m_assetIds[texturePath]], m_assetIds[texturePath]);
 }
@@ -129,7 +220,14 @@ void AssetManager::loadTextures(const char* folderPath)
         std::string filename = fsPath.filename().string();
         std::string filepath = folderPath + filename;
 
-        if (fsPath.extension() != ".png" && fsPath.extension() != ".jpg") {
+        if (fsPath.extension() == ".ktx2") {
+            // Loaded in place of its source image, if there is one
+            auto sourcePath = fsPath;
+            if (std::filesystem::exists(sourcePath.replace_extension(".png")) ||
+                std::filesystem::exists(sourcePath.replace_extension(".jpg"))) {
+                continue;
+            }
+        } else if (fsPath.extension() != ".png" && fsPath.extension() != ".jpg") {
             RDELOG_WARN("Texture {} is of {} extension, skipping", filename, fsPath.extension());
             continue;
         }
@@ -146,6 +244,25 @@ void AssetManager::loadTextures(const char* folderPath)
     RDELOG_INFO(list.str().c_str());
 }
 
+[[nodiscard]] std::optional<Vulkan::Texture> AssetManager::loadKtx2Texture(const std::filesystem::path& path)
+{
+    if (!std::filesystem::exists(path)) {
+        return std::nullopt;
+    }
+    auto ktxTexture = Vulkan::Ktx2Texture::load(path.string().c_str());
+    if (!ktxTexture) {
+        return std::nullopt;
+    }
+
+    const VkFormat format = ktxTexture->format;
+    auto texture = g_engine->renderer().createTextureResources(std::move(*ktxTexture));
+    if (!texture) {
+        RDELOG_WARN(
+            "{} is in {}, which this device can't sample", path.string(), Vulkan::Ktx2Texture::formatName(format));
+    }
+    return texture;
+}
+
 [[nodiscard]] std::string AssetManager::getFileName(const char* filePath) const
 {
     const std::filesystem::path path(filePath);
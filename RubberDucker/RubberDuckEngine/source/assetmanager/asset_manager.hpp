@@ -73,6 +73,9 @@ public:
     }
 
 private:
+    // Null if the file is missing, invalid or in a format this device can't use
+    [[nodiscard]] std::optional<Vulkan::Texture> loadKtx2Texture(const std::filesystem::path& path);
+
     // GUIDs and Filenames
     std::unordered_map<uint32_t, std::string> m_assetPaths;
     std::unordered_map<std::string, uint32_t> m_assetIds;
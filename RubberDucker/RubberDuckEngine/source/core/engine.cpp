@@ -16,13 +16,15 @@ Engine::Engine()
     , m_assetManager(std::make_unique<AssetManager>())
     , m_monoHandler(std::make_unique<MonoHandler>())
     , m_sceneManager(std::make_unique<SceneManager>())
+    , m_threadPool(std::make_unique<ThreadPool>())
 {}
 
-void Engine::run()
+[[nodiscard]] int Engine::run(int argc, char** argv)
 {
-    init();
+    init(argc, argv);
     mainLoop();
     cleanup();
+    return m_exitCode;
 }
 
 void Engine::shutdown()
@@ -40,9 +42,13 @@ Scene& Engine::currentScene()
     return m_sceneManager->currentScene();
 }
 
-void Engine::init()
+void Engine::init(int argc, char** argv)
 {
     Logger::init();
+    m_launchOptions = LaunchOptions::parse(argc, argv);
+
+    // Leave one core for the main thread, which records alongside the workers
+    m_threadPool->init(std::max(2u, std::thread::hardware_concurrency()) - 1);
 
     m_window->init();
     m_renderer->init();
@@ -50,24 +56,77 @@ void Engine::init()
     m_ecs->init();
     m_sceneManager->init();
     m_monoHandler->init();
+
+    if (m_launchOptions.benchmarkEntityCount) {
+        currentScene().initBenchmark(std::max(*m_launchOptions.benchmarkEntityCount, 1u));
+        m_renderer->setMaxInstancesPerDraw(1);
+    }
 }
 
 void Engine::mainLoop()
 {
-    static auto* handle = m_window->handle();
+    const auto& options = m_launchOptions;
+    uint32_t frameIndex = 0;
+    float totalFrameTime = 0.0f;
+    float maxFrameTime = 0.0f;
+
+    if (!options.captureFrames.empty()) {
+        std::filesystem::create_directories(options.captureDirectory);
+    }
 
-    while (!m_shutdown && !glfwWindowShouldClose(handle)) {
-        m_deltaTime = Clock::deltaTime([this]() {
-            glfwPollEvents();
+    while (!m_shutdown && !m_window->shouldClose()) {
+        if (options.frameCount && frameIndex >= options.frameCount) {
+            break;
+        }
+        if (options.isCaptureFrame(frameIndex)) {
+            m_renderer->requestCapture(options.capturePath(frameIndex));
+        }
+
+        const float frameTime = Clock::deltaTime([this]() {
+            // Otherwise input is sampled before waiting for the GPU and is a little older by the time it is used
+            if (m_renderer->lowLatency()) {
+                m_renderer->waitForFrameSlot();
+            }
+            m_window->pollEvents();
 
             m_ecs->update(m_sceneManager->currentScene().registry(), m_deltaTime);
 
             m_editor->update();
             m_renderer->drawFrame();
         });
+        m_deltaTime = options.fixedDeltaTime.value_or(frameTime);
+
+        // The first frame includes one-off work such as compiling pipelines
+        if (frameIndex > 0) {
+            totalFrameTime += frameTime;
+            maxFrameTime = std::max(maxFrameTime, frameTime);
+        }
+        ++frameIndex;
     }
 
     m_renderer->waitForOperations();
+
+    if (frameIndex > 1) {
+        RDELOG_INFO("{} frames, CPU frame time {:.3f} ms average, {:.3f} ms max (first frame excluded)",
+                    frameIndex,
+                    totalFrameTime * 1000.0f / static_cast<float>(frameIndex - 1),
+                    maxFrameTime * 1000.0f);
+    }
+
+    if (options.validateCulling) {
+        const auto& renderer = *m_renderer;
+        if (renderer.cullMismatchCount() > 0) {
+            RDELOG_ERROR("GPU culling validation failed, {} of {} batches differ from the CPU reference",
+                         renderer.cullMismatchCount(),
+                         renderer.validatedCullBatchCount());
+            m_exitCode = EXIT_FAILURE;
+        } else if (renderer.validatedCullBatchCount() == 0) {
+            RDELOG_WARN("GPU culling validation compared no batches, GPU culling is off or unsupported");
+        } else {
+            RDELOG_INFO("GPU culling validation passed, {} batches matched the CPU reference",
+                        renderer.validatedCullBatchCount());
+        }
+    }
 }
 
 void Engine::cleanup()
@@ -75,5 +134,6 @@ void Engine::cleanup()
     m_window->cleanup();
     m_renderer->cleanup();
     m_monoHandler->cleanup();
+    m_threadPool->shutdown();
 }
 } // namespace RDE
@@ -1,11 +1,13 @@
 #pragma once
 #include "assetmanager/asset_manager.hpp"
 #include "camera/camera_handler.hpp"
+#include "core/launch_options.hpp"
 #include "ecs/ecs.hpp"
 #include "editor/editor.hpp"
 #include "input/input_handler.hpp"
 #include "mono/mono_handler.hpp"
 #include "scene/scene_manager.hpp"
+#include "utilities/thread_pool.hpp"
 #include "vulkan/renderer.hpp"
 #include "window/window.hpp"
 
@@ -15,12 +17,14 @@ class Engine
 {
 public:
     Engine();
-    void run();
+    [[nodiscard]] int run(int argc = 0, char** argv = nullptr); // Returns the process exit code
     void shutdown();
 
     float dt() const; // Return deltaTime in seconds
     Scene& currentScene();
 
+    inline const auto& launchOptions() const { return m_launchOptions; }
+
     inline auto& renderer() { return *m_renderer; }
 
     inline auto& window() { return *m_window; }
@@ -37,8 +41,10 @@ public:
 
     inline auto& monoHandler() { return *m_monoHandler; }
 
+    inline auto& threadPool() { return *m_threadPool; }
+
 private:
-    void init();
+    void init(int argc, char** argv);
     void mainLoop();
     void cleanup();
 
@@ -52,8 +58,11 @@ private:
     std::unique_ptr<AssetManager> m_assetManager;
     std::unique_ptr<MonoHandler> m_monoHandler;
     std::unique_ptr<SceneManager> m_sceneManager;
+    std::unique_ptr<ThreadPool> m_threadPool;
 
+    LaunchOptions m_launchOptions{};
     float m_deltaTime = 0;
     bool m_shutdown = false;
+    int m_exitCode = EXIT_SUCCESS;
 };
 } // namespace RDE
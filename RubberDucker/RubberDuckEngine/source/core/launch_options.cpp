@@ -0,0 +1,116 @@
+#include "precompiled/pch.hpp"
+
+#include "launch_options.hpp"
+
+namespace RDE {
+
+// Headless runs have no window to close
+constexpr uint32_t k_defaultHeadlessFrameCount = 100;
+
+[[nodiscard]] LaunchOptions LaunchOptions::parse(int argc, char** argv)
+{
+    LaunchOptions options{};
+    bool frameCountSet = false;
+
+    // Every option except the flags takes exactly one value
+    const auto nextValue = [&](int& i) -> const char* {
+        if (i + 1 >= argc) {
+            RDELOG_WARN("Missing value for {}", argv[i]);
+            return nullptr;
+        }
+        return argv[++i];
+    };
+    const auto nextNumber = [&](int& i) -> std::optional<uint32_t> {
+        const char* value = nextValue(i);
+        if (!value) {
+            return std::nullopt;
+        }
+        return static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+
+        if (argument == "--headless") {
+            options.headless = true;
+        } else if (argument == "--software") {
+            options.preferSoftwareDevice = true;
+        } else if (argument == "--low-latency") {
+            options.lowLatency = true;
+        } else if (argument == "--bake-textures") {
+            options.bakeTextures = true;
+        } else if (argument == "--validate-culling") {
+            options.validateCulling = true;
+        } else if (argument == "--width") {
+            options.width = nextNumber(i);
+        } else if (argument == "--height") {
+            options.height = nextNumber(i);
+        } else if (argument == "--frames") {
+            options.frameCount = nextNumber(i).value_or(0);
+            frameCountSet = true;
+        } else if (argument == "--capture") {
+            if (const auto frame = nextNumber(i)) {
+                options.captureFrames.push_back(*frame);
+            }
+        } else if (argument == "--capture-dir") {
+            if (const char* value = nextValue(i)) {
+                options.captureDirectory = value;
+            }
+        } else if (argument == "--frames-in-flight") {
+            options.framesInFlight = nextNumber(i);
+        } else if (argument == "--staging-pool") {
+            options.stagingPoolSize = nextNumber(i).value_or(options.stagingPoolSize);
+        } else if (argument == "--texture-budget") {
+            options.textureBudget = nextNumber(i).value_or(options.textureBudget);
+        } else if (argument == "--vertex-positions") {
+            if (const char* value = nextValue(i)) {
+                options.vertexPositions = value;
+            }
+        } else if (argument == "--instance-encoding") {
+            if (const char* value = nextValue(i)) {
+                options.instanceEncoding = value;
+            }
+        } else if (argument == "--dynamic-resolution") {
+            if (const char* value = nextValue(i)) {
+                options.dynamicResolutionTarget = std::strtof(value, nullptr);
+            }
+        } else if (argument == "--min-render-scale") {
+            if (const char* value = nextValue(i)) {
+                options.minRenderScale = std::strtof(value, nullptr);
+            }
+        } else if (argument == "--max-render-scale") {
+            if (const char* value = nextValue(i)) {
+                options.maxRenderScale = std::strtof(value, nullptr);
+            }
+        } else if (argument == "--benchmark") {
+            options.benchmarkEntityCount = nextNumber(i);
+        } else if (argument == "--fixed-dt") {
+            if (const char* value = nextValue(i)) {
+                options.fixedDeltaTime = std::strtof(value, nullptr);
+            }
+        } else {
+            RDELOG_WARN("Unknown argument {}", argument);
+        }
+    }
+
+    if (options.headless && !frameCountSet) {
+        options.frameCount = k_defaultHeadlessFrameCount;
+    }
+    if (!options.captureFrames.empty() && !options.headless) {
+        RDELOG_WARN("Frames can only be captured in headless mode, ignoring --capture");
+        options.captureFrames.clear();
+    }
+    return options;
+}
+
+[[nodiscard]] bool LaunchOptions::isCaptureFrame(uint32_t frameIndex) const
+{
+    return std::find(captureFrames.begin(), captureFrames.end(), frameIndex) != captureFrames.end();
+}
+
+[[nodiscard]] std::string LaunchOptions::capturePath(uint32_t frameIndex) const
+{
+    return fmt::format("{}/frame_{:05}.ppm", captureDirectory, frameIndex);
+}
+
+} // namespace RDE
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace RDE {
+
+// Command line configuration, mostly for automated runs:
+//   --headless             Render into offscreen images, no window or surface
+//   --width <pixels>       Size of the window or the offscreen images
+//   --height <pixels>
+//   --frames <count>       Exit after this many frames, 0 runs until closed
+//   --capture <frame>      Write the given frame to the capture directory, repeatable (headless only)
+//   --capture-dir <path>   Defaults to "captures"
+//   --benchmark <count>    Load the benchmark scene with this many entities
+//   --fixed-dt <seconds>   Advance the simulation by a fixed step, so captures are reproducible
+//   --software             Prefer a CPU implementation such as lavapipe over GPUs
+//   --frames-in-flight <n> Between 1 and 4, fewer lowers latency and more raises throughput
+//   --low-latency          Delay each frame so it is submitted just as the GPU needs it
+//   --staging-pool <MB>    Cap on pooled upload memory, larger uploads fall back to dedicated buffers
+//   --bake-textures        Write the mip chains generated for source images next to them as KTX2 files
+//   --texture-budget <MB>  Memory for streamed texture levels, 0 keeps every texture fully resident
+//   --vertex-positions <e> float, half or unorm16 (default), the 16-bit ones also pack normals and uvs into 16 bits
+//   --instance-encoding <e> affine (52 bytes per instance) or quaternion (32 bytes, default)
+//   --dynamic-resolution <ms> Scale the scene resolution to hold this GPU frame time
+//   --min-render-scale <s> Bounds of the scene resolution relative to the window, 0.5 and 1 by default
+//   --max-render-scale <s>
+//   --validate-culling     Compare GPU culling against the CPU reference, mismatches fail the run
+struct LaunchOptions
+{
+    bool headless = false;
+    std::optional<uint32_t> width;
+    std::optional<uint32_t> height;
+    uint32_t frameCount = 0;
+    std::vector<uint32_t> captureFrames;
+    std::string captureDirectory = "captures";
+    std::optional<uint32_t> benchmarkEntityCount;
+    std::optional<float> fixedDeltaTime;
+    bool preferSoftwareDevice = false;
+    std::optional<uint32_t> framesInFlight;
+    bool lowLatency = false;
+    uint32_t stagingPoolSize = 128; // In megabytes
+    bool bakeTextures = false;
+    uint32_t textureBudget = 512; // In megabytes
+    std::string vertexPositions = "unorm16";
+    std::string instanceEncoding = "quaternion";
+    std::optional<float> dynamicResolutionTarget; // In milliseconds
+    float minRenderScale = 0.5f;
+    float maxRenderScale = 1.0f;
+    bool validateCulling = false;
+
+    [[nodiscard]] static LaunchOptions parse(int argc, char** argv);
+
+    [[nodiscard]] bool isCaptureFrame(uint32_t frameIndex) const;
+    [[nodiscard]] std::string capturePath(uint32_t frameIndex) const;
+};
+
+} // namespace RDE
@@ -4,7 +4,7 @@
 
 std::unique_ptr<RDE::Engine> g_engine;
 
-int main()
+int main(int argc, char** argv)
 {
     // Enable run-time memory check for debug builds
 #if defined(RDE_DEBUG)
@@ -13,7 +13,5 @@ int main()
 
     g_engine = std::make_unique<RDE::Engine>();
 
-    g_engine->run();
-
-    return EXIT_SUCCESS;
+    return g_engine->run(argc, argv);
 }
@@ -13,6 +13,7 @@ struct MeshComponent
     // TODO: Use GUID to represent and preload assets
     uint32_t modelGuid{k_undefinedGuid};
     uint32_t textureGuid{k_undefinedGuid};
+    uint32_t materialIndex{0};
 };
 
 } // namespace RDE
@@ -32,5 +32,6 @@ RTTR_REGISTRATION
     rttr::registration::class_<RDE::MeshComponent>("MeshComponent")
         .constructor<>()
         .property("modelGuid", &RDE::MeshComponent::modelGuid)
-        .property("textureGuid", &RDE::MeshComponent::textureGuid);
+        .property("textureGuid", &RDE::MeshComponent::textureGuid)
+        .property("materialIndex", &RDE::MeshComponent::materialIndex);
 }
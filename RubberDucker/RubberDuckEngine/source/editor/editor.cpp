@@ -6,7 +6,9 @@
 #include "core/engine.hpp"
 #include "core/main.hpp"
 #include "ecs/components/component_list.hpp"
+#include "vulkan/index_packer.hpp"
 #include "vulkan/renderer.hpp"
+#include "vulkan/vertex_packer.hpp"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -15,7 +17,11 @@
 #include <spdlog/fmt/ostr.h>
 
 namespace RDE {
-void Editor::init() {}
+void Editor::init()
+{
+    // ImGui needs a window to draw into
+    m_renderingEnabled = !g_engine->window().isHeadless();
+}
 
 void Editor::update()
 {
@@ -239,6 +245,22 @@ void Editor::showInspector()
                 }
                 ImGui::EndCombo();
             }
+            const auto& materials = g_engine->renderer().materials();
+            const auto materialIndex = std::min<size_t>(model->materialIndex, materials.size() - 1);
+
+            if (ImGui::BeginCombo("Material", materials[materialIndex].name.c_str())) {
+                for (uint32_t i = 0; i < materials.size(); ++i) {
+                    bool selected = i == materialIndex;
+
+                    if (ImGui::Selectable(materials[i].name.c_str(), selected)) {
+                        model->materialIndex = i;
+                    }
+                    if (selected) {
+                        ImGui::SetItemDefaultFocus();
+                    }
+                }
+                ImGui::EndCombo();
+            }
             ImGui::PopItemWidth();
             ImGui::TreePop();
         }
@@ -266,11 +288,246 @@ void Editor::showDebugInfo()
     static auto& renderer = g_engine->renderer();
     ImGui::TextUnformatted(fmt::format("Number of draw calls: {}", renderer.drawCallCount()).c_str());
 
+    static constexpr std::array<const char*, 3> cullingModeNames = {"Disabled", "CPU", "GPU"};
+    int cullingMode = static_cast<int>(renderer.cullingMode());
+    if (ImGui::Combo("Culling", &cullingMode, cullingModeNames.data(), static_cast<int>(cullingModeNames.size()))) {
+        renderer.setCullingMode(static_cast<Vulkan::CullingMode>(cullingMode));
+    }
+    bool validateGpuCulling = renderer.validateGpuCulling();
+    if (ImGui::Checkbox("Validate GPU culling", &validateGpuCulling)) {
+        renderer.setValidateGpuCulling(validateGpuCulling);
+    }
+    if (renderer.validateGpuCulling()) {
+        ImGui::TextUnformatted(fmt::format("Culling mismatches: {} / {} batches",
+                                           renderer.cullMismatchCount(),
+                                           renderer.validatedCullBatchCount())
+                                   .c_str());
+    }
+    ImGui::TextUnformatted(fmt::format("Visible instances: {} / {}",
+                                       renderer.visibleInstanceCount(),
+                                       renderer.submittedInstanceCount())
+                               .c_str());
+    bool clusterCulling = renderer.clusterCulling();
+    if (ImGui::Checkbox("Cluster culling", &clusterCulling)) {
+        renderer.setClusterCulling(clusterCulling);
+    }
+    const auto& clusterCullingStatistics = renderer.clusterCullingStatistics();
+    ImGui::TextUnformatted(fmt::format("Visible meshlets: {} / {}, triangles: {} / {}",
+                                       clusterCullingStatistics.visibleMeshletCount,
+                                       clusterCullingStatistics.meshletCount,
+                                       clusterCullingStatistics.visibleTriangleCount,
+                                       clusterCullingStatistics.triangleCount)
+                               .c_str());
+
+    static constexpr std::array<const char*, 2> instanceEncodingNames = {"Affine 3x4", "Quaternion + scale"};
+    int instanceEncoding = static_cast<int>(renderer.instanceEncoding());
+    if (ImGui::Combo("Instance encoding",
+                     &instanceEncoding,
+                     instanceEncodingNames.data(),
+                     static_cast<int>(instanceEncodingNames.size()))) {
+        renderer.setInstanceEncoding(static_cast<Vulkan::InstanceEncoding>(instanceEncoding));
+    }
+    ImGui::TextUnformatted(fmt::format("Instance data: {:.1f} KB",
+                                       renderer.submittedInstanceCount() *
+                                           Vulkan::instanceStride(renderer.instanceEncoding()) / 1024.0f)
+                               .c_str());
+
+    ImGui::Separator();
+
+    int recordingThreadCount = static_cast<int>(renderer.recordingThreadCount());
+    if (ImGui::SliderInt(
+            "Recording threads", &recordingThreadCount, 1, static_cast<int>(renderer.maxRecordingThreadCount()))) {
+        renderer.setRecordingThreadCount(static_cast<uint32_t>(recordingThreadCount));
+    }
+    int maxInstancesPerDraw = static_cast<int>(renderer.maxInstancesPerDraw());
+    if (ImGui::InputInt("Max instances per draw", &maxInstancesPerDraw)) {
+        renderer.setMaxInstancesPerDraw(static_cast<uint32_t>(std::max(maxInstancesPerDraw, 0)));
+    }
+    bool reuseSceneCommands = renderer.reuseSceneCommands();
+    if (ImGui::Checkbox("Reuse scene commands", &reuseSceneCommands)) {
+        renderer.setReuseSceneCommands(reuseSceneCommands);
+    }
+    ImGui::Text("Command recording: %.3f ms (scene %s)",
+                renderer.recordingTime(),
+                renderer.sceneCommandsReused() ? "reused" : "recorded");
+
+    int framesInFlight = static_cast<int>(renderer.framesInFlight());
+    if (ImGui::SliderInt("Frames in flight", &framesInFlight, 1, static_cast<int>(renderer.maxFramesInFlight()))) {
+        renderer.setFramesInFlight(static_cast<uint32_t>(framesInFlight));
+    }
+    bool lowLatency = renderer.lowLatency();
+    if (ImGui::Checkbox("Low latency", &lowLatency)) {
+        renderer.setLowLatency(lowLatency);
+    }
+    const auto& framePacing = renderer.framePacingStatistics();
+    ImGui::TextUnformatted(fmt::format("Waits: fence {:.3f} ms, acquire {:.3f} ms, latency sleep {:.3f} ms",
+                                       framePacing.fenceWait,
+                                       framePacing.acquireWait,
+                                       framePacing.latencySleep)
+                               .c_str());
+    ImGui::Text("CPU frame time: %.3f ms", framePacing.cpuFrameTime);
+    ImGui::Text("Last swapchain recreation: %.3f ms", framePacing.swapchainRecreateTime);
+    ImGui::TextUnformatted(
+        fmt::format("Objects waiting for frames in flight: {}", renderer.pendingDestructionCount()).c_str());
+    ImGui::TextUnformatted(fmt::format("Pipelines: {} ({} compiling)",
+                                       renderer.pipelineCount(),
+                                       renderer.pendingPipelineCount())
+                               .c_str());
+
+    bool sortDrawItems = renderer.sortDrawItems();
+    if (ImGui::Checkbox("Sort draws", &sortDrawItems)) {
+        renderer.setSortDrawItems(sortDrawItems);
+    }
+    const auto& bindStatistics = renderer.bindStatistics();
+    ImGui::TextUnformatted(fmt::format("Pipeline binds: {} ({} avoided)",
+                                       bindStatistics.pipelineBinds,
+                                       bindStatistics.pipelineBindsAvoided)
+                               .c_str());
+    ImGui::TextUnformatted(
+        fmt::format("Buffer binds: {} ({} avoided)", bindStatistics.bufferBinds, bindStatistics.bufferBindsAvoided)
+            .c_str());
+
+    const auto& stagingPool = renderer.stagingPool();
+    ImGui::TextUnformatted(fmt::format("Staging: {} blocks ({} MB), {} uploads ({} dedicated)",
+                                       stagingPool.blockCount(),
+                                       stagingPool.poolSize() / (1024 * 1024),
+                                       stagingPool.allocationCount(),
+                                       stagingPool.dedicatedAllocationCount())
+                               .c_str());
+    const auto& uniformRing = renderer.uniformRing();
+    ImGui::TextUnformatted(fmt::format("Uniforms: {} blocks, {} of {} bytes per frame",
+                                       uniformRing.allocationCount(),
+                                       uniformRing.usedSize(),
+                                       uniformRing.regionSize())
+                               .c_str());
+
+    if (renderer.textureStreaming()) {
+        const auto& textureStreamer = renderer.textureStreamer();
+        int textureBudget = static_cast<int>(textureStreamer.budget() / (1024 * 1024));
+        if (ImGui::InputInt("Texture budget (MB)", &textureBudget)) {
+            renderer.setTextureBudget(VkDeviceSize{static_cast<uint32_t>(std::max(textureBudget, 0))} * 1024 * 1024);
+        }
+        const auto& streaming = textureStreamer.statistics();
+        ImGui::TextUnformatted(
+            fmt::format("Streamed textures: {} ({} waiting for levels)", streaming.textureCount, streaming.pendingCount)
+                .c_str());
+        ImGui::TextUnformatted(fmt::format("Texture memory: {} of {} MB, {} KB uploaded",
+                                           streaming.residentSize / (1024 * 1024),
+                                           streaming.budget / (1024 * 1024),
+                                           streaming.uploadSize / 1024)
+                                   .c_str());
+    }
+
+    const auto& renderGraph = renderer.renderGraph();
+    ImGui::TextUnformatted(fmt::format("Render passes: {} ({} culled)",
+                                       renderGraph.passCount(),
+                                       renderGraph.culledPassCount())
+                               .c_str());
+    ImGui::TextUnformatted(fmt::format("Transient images: {} KB in {} KB",
+                                       renderGraph.transientImageSize() / 1024,
+                                       renderGraph.transientMemorySize() / 1024)
+                               .c_str());
+
+    bool depthPrePass = renderer.depthPrePass();
+    if (ImGui::Checkbox("Depth pre-pass", &depthPrePass)) {
+        renderer.setDepthPrePass(depthPrePass);
+    }
+    ImGui::TextUnformatted(fmt::format("Scene GPU time: {:.3f} ms without pre-pass, {:.3f} ms with",
+                                       renderer.sceneGpuTime(false),
+                                       renderer.sceneGpuTime(true))
+                               .c_str());
+
+    ImGui::Separator();
+
+    bool dynamicResolution = renderer.dynamicResolution();
+    if (ImGui::Checkbox("Dynamic resolution", &dynamicResolution)) {
+        renderer.setDynamicResolution(dynamicResolution);
+    }
+    const auto& resolutionController = renderer.resolutionController();
+    auto resolutionSettings = resolutionController.settings();
+    bool resolutionSettingsChanged =
+        ImGui::SliderFloat("Target GPU time (ms)", &resolutionSettings.targetGpuTime, 4.0f, 50.0f, "%.2f");
+    resolutionSettingsChanged |= ImGui::SliderFloat("Min render scale", &resolutionSettings.minScale, 0.25f, 1.0f);
+
+    // The max scale sizes the scene color image, so it is applied once released instead of rebuilding every frame
+    static float maxScale = resolutionSettings.maxScale;
+    ImGui::SliderFloat("Max render scale", &maxScale, 0.25f, 1.0f);
+    if (ImGui::IsItemDeactivatedAfterEdit()) {
+        resolutionSettings.maxScale = maxScale;
+        resolutionSettingsChanged = true;
+    } else if (!ImGui::IsItemActive()) {
+        maxScale = resolutionSettings.maxScale;
+    }
+    if (resolutionSettingsChanged) {
+        renderer.setResolutionSettings(resolutionSettings);
+    }
+
+    const auto renderExtent = renderer.renderExtent();
+    ImGui::TextUnformatted(fmt::format("Render scale: {:.2f} ({}x{}), {}",
+                                       resolutionController.scale(),
+                                       renderExtent.width,
+                                       renderExtent.height,
+                                       Vulkan::ResolutionController::stateName(resolutionController.state()))
+                               .c_str());
+    ImGui::TextUnformatted(fmt::format("GPU frame time: {:.3f} ms smoothed, {:.2f} ms target",
+                                       resolutionController.smoothedGpuTime(),
+                                       resolutionSettings.targetGpuTime)
+                               .c_str());
+
+
+    const auto& gpuProfiler = renderer.gpuProfiler();
+    if (gpuProfiler.isSupported()) {
+        bool profileDrawItems = renderer.profileDrawItems();
+        if (ImGui::Checkbox("Time each draw", &profileDrawItems)) {
+            renderer.setProfileDrawItems(profileDrawItems);
+        }
+        for (const auto& [name, time] : gpuProfiler.results()) {
+            ImGui::BulletText("%s: %.3f ms", name.c_str(), time);
+        }
+    } else {
+        ImGui::TextUnformatted("GPU timestamps are not supported");
+    }
+
+    // One draw per entity so recording cost scales with the entity count
+    ImGui::InputInt("Benchmark entities", &m_benchmarkEntityCount);
+    if (ImGui::Button("Load benchmark scene")) {
+        m_selectedEntity = entt::null;
+        g_engine->currentScene().initBenchmark(static_cast<uint32_t>(std::max(m_benchmarkEntityCount, 1)));
+        renderer.setMaxInstancesPerDraw(1);
+    }
+
+    // Savings against the interleaved 32 byte vertex with its separate depth pass positions, and 32-bit indices
+    if (ImGui::TreeNode("Mesh memory")) {
+        static auto& assetManager = g_engine->assetManager();
+        assetManager.eachMesh([](uint32_t meshId, Vulkan::Mesh& mesh) {
+            const auto statistics = Vulkan::VertexPacker::statistics(mesh.vertexFormat, mesh.vertices.size());
+            ImGui::BulletText("%s", assetManager.getAssetName(meshId).c_str());
+            ImGui::Indent();
+            ImGui::TextUnformatted(fmt::format("{} KB instead of {} KB, fetching {} / {} bytes instead of {} / {}",
+                                               statistics.size / 1024,
+                                               statistics.unpackedSize / 1024,
+                                               statistics.depthFetchSize,
+                                               statistics.sceneFetchSize,
+                                               Vulkan::k_unpackedPositionStride,
+                                               Vulkan::k_unpackedVertexStride)
+                                       .c_str());
+            const auto indexSize = Vulkan::IndexPacker::indexSize(mesh.indexType);
+            ImGui::TextUnformatted(fmt::format("{}-bit indices in {} submeshes, {} KB instead of {} KB",
+                                               indexSize * 8,
+                                               mesh.submeshes.size(),
+                                               mesh.indices.size() * indexSize / 1024,
+                                               mesh.indices.size() * sizeof(uint32_t) / 1024)
+                                       .c_str());
+            ImGui::Unindent();
+        });
+        ImGui::TreePop();
+    }
+
     ImGui::Separator();
 
     const auto& instances = renderer.instancesString();
-    for (const auto& [mesh, texture, instanceCount] : instances) {
-        ImGui::TextWrapped("Drawing %s using %s with %d instances", mesh.c_str(), texture.c_str(), instanceCount);
+    for (const auto& [mesh, instanceCount] : instances) {
+        ImGui::TextWrapped("Drawing %s with %d instances", mesh.c_str(), instanceCount);
     }
     ImGui::End();
 }
@@ -26,6 +26,7 @@ private:
     glm::vec3 m_eulerAngles{};
     float m_dtTimer = 0.0f;
     float m_dtToDisplay = 1.0f;
+    int m_benchmarkEntityCount = 5000;
     entt::entity m_selectedEntity = entt::null;
     bool m_renderingEnabled = true;
 };
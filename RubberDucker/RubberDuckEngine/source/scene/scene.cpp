@@ -117,6 +117,42 @@ void Scene::init()
     spaceshipModel.textureGuid = capsuleTextureId;
 }
 
+void Scene::initBenchmark(uint32_t entityCount)
+{
+    static auto& assetManager = g_engine->assetManager();
+    constexpr float space = 4.0f;
+    constexpr float scaling = 0.5f;
+
+    m_registry->clear();
+
+    const auto modelNames = assetManager.getModelNames();
+    const auto textureNames = assetManager.getTextureNames();
+    if (modelNames.empty() || textureNames.empty()) {
+        RDELOG_WARN("No assets loaded for the benchmark scene!");
+        return;
+    }
+
+    // Fill a cube of entities in front of the camera
+    const auto n = static_cast<uint32_t>(std::ceil(std::cbrtf(static_cast<float>(entityCount))));
+    const float offset = (n - 1) * space * 0.5f;
+
+    for (uint32_t i = 0; i < entityCount; ++i) {
+        const uint32_t x = i % n;
+        const uint32_t y = (i / n) % n;
+        const uint32_t z = i / (n * n);
+
+        auto entity = m_registry->create();
+        auto& transform = m_registry->emplace<TransformComponent>(entity);
+        auto& model = m_registry->emplace<MeshComponent>(entity);
+
+        transform.scale *= scaling;
+        transform.translate = {x * space - offset, y * space - offset, -(z * space + space)};
+        model.modelGuid = assetManager.getModelId(modelNames[i % modelNames.size()].c_str());
+        model.textureGuid = assetManager.getTextureId(textureNames[i % textureNames.size()].c_str());
+    }
+    RDELOG_INFO("Created benchmark scene with {} entities", entityCount);
+}
+
 void Scene::cleanup()
 {
     m_registry->clear();
@@ -16,6 +16,7 @@ public:
     ~Scene() = default;
 
     void init();
+    void initBenchmark(uint32_t entityCount); // Replaces every entity with a grid of mixed meshes and textures
     void cleanup();
 
     Camera& camera();
@@ -19,12 +19,12 @@ float Clock::s_currentFps = 0.0f;
 
 std::vector<float> Clock::s_perSecondDoTimes{};
 
-Clock::Clock(const char* scopeName) : m_scopeName(scopeName) { start(s_timer); }
+Clock::Clock(const char* scopeName) : m_scopeName(scopeName) { start(m_timer); }
 
 Clock::~Clock()
 {
     RDELOG_PROFILE("{0} finished in {1} ms", m_scopeName,
-                    fmt::format("{:.{}f}", stop(s_timer), k_decimalPlaces));
+                    fmt::format("{:.{}f}", stop(m_timer), k_decimalPlaces));
 }
 
 [[nodiscard]] float Clock::stop(const Timer& timer)
@@ -129,6 +129,7 @@ private:
     static std::vector<float> s_perSecondDoTimes;
 
     std::string m_scopeName;
+    Timer m_timer; // Per scope, so nested and concurrent scopes don't overwrite each other
 };
 } // namespace RDE
 
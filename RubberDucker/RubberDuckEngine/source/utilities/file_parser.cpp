@@ -10,6 +10,7 @@ FileParser::FileBufferType RDE::FileParser::read(const char* filename)
 
     if (!file.is_open()) {
         RDELOG_CRITICAL(fmt::format("Failed to open {}!", filename));
+        return {};
     }
 
     // Get file size from read position
@@ -30,5 +31,29 @@ FileParser::FileBufferType RDE::FileParser::read(std::string_view filename)
     return read(filename.data());
 }
 
-void RDE::FileParser::write(const char* filename) {}
+bool RDE::FileParser::write(const char* filename, const FileBufferType& buffer)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        RDELOG_ERROR(fmt::format("Failed to open {} for writing!", filename));
+        return false;
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+    return file.good();
+}
+
+bool RDE::FileParser::writePpm(const char* filename,
+                               uint32_t width,
+                               uint32_t height,
+                               const std::vector<uint8_t>& rgb)
+{
+    const auto header = fmt::format("P6\n{} {}\n255\n", width, height);
+
+    FileBufferType buffer(header.begin(), header.end());
+    buffer.insert(buffer.end(), rgb.begin(), rgb.end());
+
+    return write(filename, buffer);
+}
 } // namespace RDE
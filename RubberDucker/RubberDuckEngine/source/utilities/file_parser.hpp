@@ -10,6 +10,9 @@ class FileParser
 
     static FileBufferType read(const char* filename);
     static FileBufferType read(std::string_view filename);
-    static void write(const char* filename);
+    static bool write(const char* filename, const FileBufferType& buffer);
+
+    // Binary PPM, 8 bits per channel with no padding between rows
+    static bool writePpm(const char* filename, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgb);
 };
 } // namespace RDE
@@ -0,0 +1,96 @@
+#include "precompiled/pch.hpp"
+
+#include "utilities/radix_sort.hpp"
+
+#include "utilities/thread_pool.hpp"
+
+namespace RDE {
+namespace RadixSort {
+
+constexpr uint32_t k_digitBits = 8;
+constexpr uint32_t k_bucketCount = 1 << k_digitBits;
+constexpr uint32_t k_passCount = 64 / k_digitBits;
+constexpr size_t k_minItemsPerChunk = 4096; // Below this, waking workers costs more than it saves
+
+using Histogram = std::array<size_t, k_bucketCount>;
+
+void sort(std::vector<Item>& items, std::vector<Item>& scratch, ThreadPool* threadPool)
+{
+    const size_t itemCount = items.size();
+    if (itemCount < 2) {
+        return;
+    }
+    scratch.resize(itemCount);
+
+    const size_t maxChunkCount = threadPool ? threadPool->threadCount() + 1 : 1;
+    const size_t chunkCount = std::clamp(itemCount / k_minItemsPerChunk, size_t{1}, maxChunkCount);
+    const size_t chunkSize = (itemCount + chunkCount - 1) / chunkCount;
+
+    // Runs the callable for every chunk, chunk 0 on the calling thread
+    const auto forEachChunk = [&](const auto& callable) {
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(chunkCount - 1);
+
+        for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+            tasks.emplace_back(threadPool->submit([&callable, chunk]() { callable(chunk); }));
+        }
+        callable(0);
+
+        for (auto& task : tasks) {
+            task.wait();
+        }
+    };
+
+    std::vector<Histogram> histograms(chunkCount);
+    Item* source = items.data();
+    Item* destination = scratch.data();
+
+    for (uint32_t pass = 0; pass < k_passCount; ++pass) {
+        const uint32_t shift = pass * k_digitBits;
+
+        forEachChunk([&](size_t chunk) {
+            auto& histogram = histograms[chunk];
+            histogram.fill(0);
+
+            const size_t end = std::min(itemCount, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                ++histogram[(source[i].key >> shift) & (k_bucketCount - 1)];
+            }
+        });
+
+        // Turn the counts into scatter offsets, ordered by digit and then by chunk to keep the sort stable
+        size_t offset = 0;
+        bool singleDigit = false;
+
+        for (uint32_t digit = 0; digit < k_bucketCount; ++digit) {
+            size_t digitCount = 0;
+            for (auto& histogram : histograms) {
+                const size_t count = histogram[digit];
+                histogram[digit] = offset + digitCount;
+                digitCount += count;
+            }
+            singleDigit |= digitCount == itemCount;
+            offset += digitCount;
+        }
+        if (singleDigit) {
+            continue;
+        }
+
+        forEachChunk([&](size_t chunk) {
+            auto& offsets = histograms[chunk];
+
+            const size_t end = std::min(itemCount, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                destination[offsets[(source[i].key >> shift) & (k_bucketCount - 1)]++] = source[i];
+            }
+        });
+        std::swap(source, destination);
+    }
+
+    if (source != items.data()) {
+        items.swap(scratch);
+    }
+}
+
+} // namespace RadixSort
+} // namespace RDE
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace RDE {
+class ThreadPool;
+
+namespace RadixSort {
+
+struct Item
+{
+    uint64_t key;
+    uint32_t value;
+};
+
+// Stable LSD radix sort on the 64-bit keys, 8 bits per pass. Passes in which every key has the same digit are
+// skipped, so keys that only use a few bits stay cheap. Large inputs split histograms and scatters over the pool
+void sort(std::vector<Item>& items, std::vector<Item>& scratch, ThreadPool* threadPool = nullptr);
+
+} // namespace RadixSort
+} // namespace RDE
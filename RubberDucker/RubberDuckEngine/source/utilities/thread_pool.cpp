@@ -0,0 +1,58 @@
+#include "precompiled/pch.hpp"
+
+#include "utilities/thread_pool.hpp"
+
+namespace RDE {
+
+void ThreadPool::init(uint32_t threadCount)
+{
+    RDE_ASSERT_0(m_workers.empty(), "Thread pool already initialized!");
+
+    threadCount = std::max(threadCount, 1u);
+    m_stopping = false;
+    m_workers.reserve(threadCount);
+
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+    RDELOG_INFO("Started thread pool with {} worker threads", threadCount);
+}
+
+void ThreadPool::shutdown()
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+[[nodiscard]] uint32_t ThreadPool::threadCount() const
+{
+    return static_cast<uint32_t>(m_workers.size());
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+            // Drain remaining tasks before stopping so no future is left unfulfilled
+            if (m_stopping && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
+} // namespace RDE
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace RDE {
+
+class ThreadPool
+{
+public:
+    void init(uint32_t threadCount);
+    void shutdown();
+
+    [[nodiscard]] uint32_t threadCount() const;
+
+    template<typename TCallable>
+    [[nodiscard]] std::future<std::invoke_result_t<TCallable>> submit(TCallable&& callable)
+    {
+        static_assert(std::is_invocable_v<TCallable>, "Task is not invocable!");
+
+        using ResultType = std::invoke_result_t<TCallable>;
+
+        // std::function needs a copyable target, packaged_task is move-only
+        auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<TCallable>(callable));
+        auto future = task->get_future();
+        {
+            std::scoped_lock lock(m_mutex);
+            m_tasks.emplace([task]() { (*task)(); });
+        }
+        m_condition.notify_one();
+
+        return future;
+    }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+};
+} // namespace RDE
@@ -38,6 +38,11 @@ constexpr bool always_false_v = false;
     return a >= b ? a * a + a + b : a + b * b;
 }
 
+[[nodiscard]] inline uint64_t hashCombine(uint64_t seed, uint64_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
 std::vector<entt::type_info> getComponentTypeInfos(entt::registry& registry, entt::entity entity);
 
 std::unordered_map<entt::entity, std::vector<entt::type_info>> getAllEntityComponentTypeInfos(entt::registry& registry);
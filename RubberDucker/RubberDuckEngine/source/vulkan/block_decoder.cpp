@@ -0,0 +1,357 @@
+#include "precompiled/pch.hpp"
+
+#include "block_decoder.hpp"
+
+#include "utilities/clock.hpp"
+
+#include <array>
+
+namespace RDE {
+namespace Vulkan {
+namespace BlockDecoder {
+
+namespace {
+using Texel = std::array<uint8_t, 4>;
+using Block = std::array<Texel, 16>; // Row-major 4x4
+
+// Modifiers by pixel index, where index bits 00, 01, 10, 11 select +a, +b, -a and -b
+constexpr int k_etcModifiers[8][4] = {{2, 8, -2, -8},
+                                      {5, 17, -5, -17},
+                                      {9, 29, -9, -29},
+                                      {13, 42, -13, -42},
+                                      {18, 60, -18, -60},
+                                      {24, 80, -24, -80},
+                                      {33, 106, -33, -106},
+                                      {47, 183, -47, -183}};
+
+// T and H mode paint color distances
+constexpr int k_etcDistances[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+constexpr int k_eacModifiers[16][8] = {{-3, -6, -9, -15, 2, 5, 8, 14},
+                                       {-3, -7, -10, -13, 2, 6, 9, 12},
+                                       {-2, -5, -8, -13, 1, 4, 7, 12},
+                                       {-2, -4, -6, -13, 1, 3, 5, 12},
+                                       {-3, -6, -8, -12, 2, 5, 7, 11},
+                                       {-3, -7, -9, -11, 2, 6, 8, 10},
+                                       {-4, -7, -8, -11, 3, 6, 7, 10},
+                                       {-3, -5, -8, -11, 2, 4, 7, 10},
+                                       {-2, -6, -8, -10, 1, 5, 7, 9},
+                                       {-2, -5, -8, -10, 1, 4, 7, 9},
+                                       {-2, -4, -8, -10, 1, 3, 7, 9},
+                                       {-2, -5, -7, -10, 1, 4, 6, 9},
+                                       {-3, -4, -7, -10, 2, 3, 6, 9},
+                                       {-1, -2, -3, -10, 0, 1, 2, 9},
+                                       {-4, -6, -8, -9, 3, 5, 7, 8},
+                                       {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+[[nodiscard]] uint8_t clampByte(int value)
+{
+    return static_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+[[nodiscard]] int extend(int value, int bits)
+{
+    return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+[[nodiscard]] Texel expand565(uint16_t color)
+{
+    return {static_cast<uint8_t>(extend((color >> 11) & 31, 5)),
+            static_cast<uint8_t>(extend((color >> 5) & 63, 6)),
+            static_cast<uint8_t>(extend(color & 31, 5)),
+            255};
+}
+
+void decodeBc1(const uint8_t* data, Block& block, bool alpha)
+{
+    const uint16_t color0 = static_cast<uint16_t>(data[0] | data[1] << 8);
+    const uint16_t color1 = static_cast<uint16_t>(data[2] | data[3] << 8);
+    const uint32_t indices = data[4] | data[5] << 8 | data[6] << 16 | static_cast<uint32_t>(data[7]) << 24;
+
+    std::array<Texel, 4> palette{expand565(color0), expand565(color1)};
+    for (int channel = 0; channel < 3; ++channel) {
+        const int c0 = palette[0][channel];
+        const int c1 = palette[1][channel];
+        if (color0 > color1) {
+            palette[2][channel] = static_cast<uint8_t>((2 * c0 + c1) / 3);
+            palette[3][channel] = static_cast<uint8_t>((c0 + 2 * c1) / 3);
+        } else {
+            palette[2][channel] = static_cast<uint8_t>((c0 + c1) / 2);
+            palette[3][channel] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = color0 > color1 || !alpha ? 255 : 0;
+
+    for (int i = 0; i < 16; ++i) {
+        block[i] = palette[(indices >> (2 * i)) & 3];
+    }
+}
+
+void decodeBc4(const uint8_t* data, Block& block, int channel)
+{
+    const int value0 = data[0];
+    const int value1 = data[1];
+
+    std::array<int, 8> palette{value0, value1};
+    if (value0 > value1) {
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = ((7 - i) * value0 + i * value1) / 7;
+        }
+    } else {
+        for (int i = 1; i < 5; ++i) {
+            palette[i + 1] = ((5 - i) * value0 + i * value1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i) {
+        indices |= static_cast<uint64_t>(data[2 + i]) << (8 * i);
+    }
+    for (int i = 0; i < 16; ++i) {
+        block[i][channel] = static_cast<uint8_t>(palette[(indices >> (3 * i)) & 7]);
+    }
+}
+
+[[nodiscard]] uint64_t readBigEndian(const uint8_t* data)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = value << 8 | data[i];
+    }
+    return value;
+}
+
+void decodeEtc2Rgb(const uint8_t* data, Block& block)
+{
+    const uint64_t bits = readBigEndian(data);
+    const auto field = [bits](int highBit, int count) {
+        return static_cast<int>((bits >> (highBit - count + 1)) & ((1ull << count) - 1));
+    };
+
+    // Pixel indices are stored column-major, most significant bits in the upper half
+    const auto pixelIndex = [bits](int x, int y) {
+        const int i = x * 4 + y;
+        return static_cast<int>(((bits >> (16 + i)) & 1) << 1 | ((bits >> i) & 1));
+    };
+    const auto setTexel = [&block](int x, int y, int r, int g, int b) {
+        block[y * 4 + x] = {clampByte(r), clampByte(g), clampByte(b), 255};
+    };
+    const auto decodePaintColors = [&](const std::array<std::array<int, 3>, 4>& paint) {
+        for (int y = 0; y < 4; ++y) {
+            for (int x = 0; x < 4; ++x) {
+                const auto& color = paint[pixelIndex(x, y)];
+                setTexel(x, y, color[0], color[1], color[2]);
+            }
+        }
+    };
+
+    std::array<std::array<int, 3>, 2> base{};
+
+    if (field(33, 1) == 0) {
+        // Individual mode, two 4-bit colors
+        base[0] = {extend(field(63, 4), 4), extend(field(55, 4), 4), extend(field(47, 4), 4)};
+        base[1] = {extend(field(59, 4), 4), extend(field(51, 4), 4), extend(field(43, 4), 4)};
+    } else {
+        // Differential mode. Overflowing the second color selects one of the ETC2 modes instead
+        const int r = field(63, 5);
+        const int g = field(55, 5);
+        const int b = field(47, 5);
+        const auto signExtend = [](int value) { return value >= 4 ? value - 8 : value; };
+        const int r2 = r + signExtend(field(58, 3));
+        const int g2 = g + signExtend(field(50, 3));
+        const int b2 = b + signExtend(field(42, 3));
+
+        if (r2 < 0 || r2 > 31) {
+            // T mode
+            const std::array<int, 3> color1 = {extend(field(60, 2) << 2 | field(57, 2), 4),
+                                               extend(field(55, 4), 4),
+                                               extend(field(51, 4), 4)};
+            const std::array<int, 3> color2 = {
+                extend(field(47, 4), 4), extend(field(43, 4), 4), extend(field(39, 4), 4)};
+            const int distance = k_etcDistances[field(35, 2) << 1 | field(32, 1)];
+
+            decodePaintColors({color1,
+                               std::array<int, 3>{color2[0] + distance, color2[1] + distance, color2[2] + distance},
+                               color2,
+                               std::array<int, 3>{color2[0] - distance, color2[1] - distance, color2[2] - distance}});
+            return;
+        }
+        if (g2 < 0 || g2 > 31) {
+            // H mode, the order of the two colors holds the lowest distance bit
+            const int r1 = field(62, 4);
+            const int g1 = field(58, 3) << 1 | field(52, 1);
+            const int b1 = field(51, 1) << 3 | field(49, 3);
+            const int rh2 = field(46, 4);
+            const int gh2 = field(42, 4);
+            const int bh2 = field(38, 4);
+            const int order = (r1 << 8 | g1 << 4 | b1) >= (rh2 << 8 | gh2 << 4 | bh2) ? 1 : 0;
+            const int distance = k_etcDistances[field(34, 1) << 2 | field(32, 1) << 1 | order];
+
+            const std::array<int, 3> color1 = {extend(r1, 4), extend(g1, 4), extend(b1, 4)};
+            const std::array<int, 3> color2 = {extend(rh2, 4), extend(gh2, 4), extend(bh2, 4)};
+            decodePaintColors({std::array<int, 3>{color1[0] + distance, color1[1] + distance, color1[2] + distance},
+                               std::array<int, 3>{color1[0] - distance, color1[1] - distance, color1[2] - distance},
+                               std::array<int, 3>{color2[0] + distance, color2[1] + distance, color2[2] + distance},
+                               std::array<int, 3>{color2[0] - distance, color2[1] - distance, color2[2] - distance}});
+            return;
+        }
+        if (b2 < 0 || b2 > 31) {
+            // Planar mode, a gradient through the origin, horizontal and vertical colors
+            const std::array<int, 3> origin = {extend(field(62, 6), 6),
+                                               extend(field(56, 1) << 6 | field(54, 6), 7),
+                                               extend(field(48, 1) << 5 | field(44, 2) << 3 | field(41, 3), 6)};
+            const std::array<int, 3> horizontal = {
+                extend(field(38, 5) << 1 | field(32, 1), 6), extend(field(31, 7), 7), extend(field(24, 6), 6)};
+            const std::array<int, 3> vertical = {
+                extend(field(18, 6), 6), extend(field(12, 7), 7), extend(field(5, 6), 6)};
+
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 4; ++x) {
+                    std::array<int, 3> color{};
+                    for (int channel = 0; channel < 3; ++channel) {
+                        color[channel] = (x * (horizontal[channel] - origin[channel]) +
+                                          y * (vertical[channel] - origin[channel]) + 4 * origin[channel] + 2) >>
+                                         2;
+                    }
+                    setTexel(x, y, color[0], color[1], color[2]);
+                }
+            }
+            return;
+        }
+
+        base[0] = {extend(r, 5), extend(g, 5), extend(b, 5)};
+        base[1] = {extend(r2, 5), extend(g2, 5), extend(b2, 5)};
+    }
+
+    const bool flip = field(32, 1) != 0;
+    const int tables[2] = {field(39, 3), field(36, 3)};
+
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            const int subblock = flip ? (y >= 2 ? 1 : 0) : (x >= 2 ? 1 : 0);
+            const int modifier = k_etcModifiers[tables[subblock]][pixelIndex(x, y)];
+            const auto& color = base[subblock];
+            setTexel(x, y, color[0] + modifier, color[1] + modifier, color[2] + modifier);
+        }
+    }
+}
+
+void decodeEacAlpha(const uint8_t* data, Block& block)
+{
+    const uint64_t bits = readBigEndian(data);
+    const int baseValue = static_cast<int>(bits >> 56);
+    const int multiplier = static_cast<int>((bits >> 52) & 15);
+    const auto& modifiers = k_eacModifiers[(bits >> 48) & 15];
+
+    // 3-bit indices, column-major from the most significant end
+    for (int x = 0; x < 4; ++x) {
+        for (int y = 0; y < 4; ++y) {
+            const int i = x * 4 + y;
+            const int index = static_cast<int>((bits >> (45 - 3 * i)) & 7);
+            block[y * 4 + x][3] = clampByte(baseValue + modifiers[index] * multiplier);
+        }
+    }
+}
+
+void decodeBlock(VkFormat format, const uint8_t* data, Block& block)
+{
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        decodeBc1(data, block, false);
+        break;
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        decodeBc1(data, block, true);
+        break;
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        block.fill({0, 0, 0, 255});
+        decodeBc4(data, block, 0);
+        decodeBc4(data + 8, block, 1);
+        break;
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        decodeEtc2Rgb(data, block);
+        break;
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        decodeEtc2Rgb(data + 8, block);
+        decodeEacAlpha(data, block);
+        break;
+    default:
+        RDE_ASSERT_0(false, "Can't decode format {}!", static_cast<uint32_t>(format));
+    }
+}
+} // namespace
+
+[[nodiscard]] bool canDecode(VkFormat format)
+{
+    return Ktx2Texture::isBlockCompressed(format) && format != VK_FORMAT_BC7_UNORM_BLOCK &&
+           format != VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+[[nodiscard]] VkFormat decodedFormat(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return VK_FORMAT_R8G8B8A8_SRGB;
+    default:
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+[[nodiscard]] Ktx2Texture decode(const Ktx2Texture& texture)
+{
+    RDE_PROFILE_SCOPE
+
+    Ktx2Texture decoded{};
+    decoded.format = decodedFormat(texture.format);
+    decoded.width = texture.width;
+    decoded.height = texture.height;
+
+    size_t dataSize = 0;
+    for (const auto& level : texture.levels) {
+        auto& decodedLevel = decoded.levels.emplace_back(level);
+        decodedLevel.offset = dataSize;
+        decodedLevel.size = Ktx2Texture::levelSize(decoded.format, level.width, level.height);
+        dataSize += decodedLevel.size;
+    }
+    decoded.data.resize(dataSize);
+
+    const uint32_t blockSize = Ktx2Texture::blockSize(texture.format);
+    Block block{};
+
+    for (size_t levelIndex = 0; levelIndex < texture.levels.size(); ++levelIndex) {
+        const auto& level = texture.levels[levelIndex];
+        const uint8_t* source = texture.data.data() + level.offset;
+        uint8_t* destination = decoded.data.data() + decoded.levels[levelIndex].offset;
+
+        for (uint32_t blockY = 0; blockY < level.height; blockY += 4) {
+            for (uint32_t blockX = 0; blockX < level.width; blockX += 4) {
+                decodeBlock(texture.format, source, block);
+                source += blockSize;
+
+                // Blocks overhanging the edge of small levels are cropped
+                for (uint32_t y = 0; y < 4 && blockY + y < level.height; ++y) {
+                    for (uint32_t x = 0; x < 4 && blockX + x < level.width; ++x) {
+                        const size_t texel = (static_cast<size_t>(blockY + y) * level.width + blockX + x) * 4;
+                        std::memcpy(destination + texel, block[y * 4 + x].data(), 4);
+                    }
+                }
+            }
+        }
+    }
+    return decoded;
+}
+
+} // namespace BlockDecoder
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ktx2.hpp"
+
+namespace RDE {
+namespace Vulkan {
+namespace BlockDecoder {
+
+// CPU fallback for devices that can't sample a block-compressed format. BC1, BC5 and ETC2 (RGB and RGBA) are
+// decoded, BC7 is not and needs an uncompressed source image next to the KTX2 file instead
+[[nodiscard]] bool canDecode(VkFormat format);
+
+// RGBA8 in the same color space as the compressed format
+[[nodiscard]] VkFormat decodedFormat(VkFormat format);
+
+// Decodes every level
+[[nodiscard]] Ktx2Texture decode(const Ktx2Texture& texture);
+
+} // namespace BlockDecoder
+} // namespace Vulkan
+} // namespace RDE
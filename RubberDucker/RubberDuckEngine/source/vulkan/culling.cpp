@@ -0,0 +1,90 @@
+#include "precompiled/pch.hpp"
+
+#include "culling.hpp"
+
+namespace RDE {
+namespace Vulkan {
+namespace Culling {
+
+[[nodiscard]] glm::vec4 transformBoundingSphere(const glm::vec4& boundingSphere, const glm::mat4& transform)
+{
+    const glm::vec3 center = glm::vec3(transform * glm::vec4(glm::vec3(boundingSphere), 1.0f));
+    const float scale = glm::max(glm::max(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1]))),
+                                 glm::length(glm::vec3(transform[2])));
+
+    return glm::vec4(center, boundingSphere.w * scale);
+}
+
+[[nodiscard]] bool isInstanceVisible(const Frustum& frustum,
+                                     const glm::vec4& boundingSphere,
+                                     const glm::mat4& transform)
+{
+    const glm::vec4 worldSphere = transformBoundingSphere(boundingSphere, transform);
+    return frustum.intersectsSphere(glm::vec3(worldSphere), worldSphere.w);
+}
+
+void cullInstances(const Frustum& frustum, const std::vector<MeshInstance>& instances,
+                   const std::vector<uint32_t>& instanceBatches, const std::vector<CullBatch>& batches,
+                   std::vector<uint32_t>& visibleIndices, std::vector<uint32_t>& visibleCounts)
+{
+    RDE_ASSERT_2(instances.size() == instanceBatches.size(), "Every instance needs a batch index!");
+
+    visibleIndices.assign(instances.size(), 0);
+    visibleCounts.assign(batches.size(), 0);
+
+    for (uint32_t instanceIndex = 0; instanceIndex < static_cast<uint32_t>(instances.size()); ++instanceIndex) {
+        const uint32_t batchIndex = instanceBatches[instanceIndex];
+        const CullBatch& batch = batches[batchIndex];
+
+        if (!isInstanceVisible(frustum, batch.boundingSphere, instances[instanceIndex].modelTransform)) {
+            continue;
+        }
+
+        const uint32_t slot = visibleCounts[batchIndex]++;
+        visibleIndices[batch.firstInstance + slot] = instanceIndex;
+    }
+}
+
+[[nodiscard]] bool isMeshletVisible(const Frustum& frustum,
+                                    const glm::vec3& cameraPosition,
+                                    const Meshlet& meshlet,
+                                    const glm::mat4& transform)
+{
+    const glm::vec4 worldSphere = transformBoundingSphere(meshlet.boundingSphere, transform);
+    const glm::vec3 center(worldSphere);
+    if (!frustum.intersectsSphere(center, worldSphere.w)) {
+        return false;
+    }
+    if (meshlet.coneCutoff >= 1.0f) {
+        return true;
+    }
+
+    const glm::mat3 rotationScale(transform);
+    const float scaleX = glm::length(rotationScale[0]);
+    const float scaleY = glm::length(rotationScale[1]);
+    const float scaleZ = glm::length(rotationScale[2]);
+    constexpr float uniformTolerance = 1e-3f;
+    if (glm::determinant(rotationScale) <= 0.0f || glm::abs(scaleX - scaleY) > uniformTolerance * scaleX ||
+        glm::abs(scaleX - scaleZ) > uniformTolerance * scaleX) {
+        return true;
+    }
+
+    // Every triangle faces away when the whole sphere lies behind the cone's back side, seen from the camera
+    const glm::vec3 axis = rotationScale * meshlet.coneAxis / scaleX;
+    const glm::vec3 toCenter = center - cameraPosition;
+    return glm::dot(toCenter, axis) < meshlet.coneCutoff * glm::length(toCenter) + worldSphere.w;
+}
+
+void cullMeshlets(const Frustum& frustum, const glm::vec3& cameraPosition, const std::vector<Meshlet>& meshlets,
+                  const glm::mat4& transform, std::vector<uint32_t>& visibleMeshlets)
+{
+    for (uint32_t meshletIndex = 0; meshletIndex < static_cast<uint32_t>(meshlets.size()); ++meshletIndex) {
+        if (isMeshletVisible(frustum, cameraPosition, meshlets[meshletIndex], transform)) {
+            visibleMeshlets.push_back(meshletIndex);
+        }
+    }
+}
+
+} // namespace Culling
+} // namespace Vulkan
+} // namespace RDE
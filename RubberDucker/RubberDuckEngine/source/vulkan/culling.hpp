@@ -0,0 +1,43 @@
+#pragma once
+
+#include "data_types/culling_data.hpp"
+#include "data_types/frustum.hpp"
+#include "data_types/mesh_instance.hpp"
+#include "data_types/meshlet.hpp"
+
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+namespace Culling {
+
+// Transforms a model space bounding sphere (xyz = center, w = radius) into world space.
+// The radius is scaled by the largest axis scale so non-uniform scaling stays conservative
+[[nodiscard]] glm::vec4 transformBoundingSphere(const glm::vec4& boundingSphere, const glm::mat4& transform);
+
+[[nodiscard]] bool isInstanceVisible(const Frustum& frustum,
+                                     const glm::vec4& boundingSphere,
+                                     const glm::mat4& transform);
+
+// CPU reference of cull.comp. Produces the same per-batch visible instance counts and the same
+// compacted visible index ranges (starting at each batch's firstInstance), so GPU results can be
+// validated on software rasterizers such as lavapipe, or without a GPU at all.
+// The order of indices within a batch is only guaranteed here, the GPU appends them atomically.
+void cullInstances(const Frustum& frustum, const std::vector<MeshInstance>& instances,
+                   const std::vector<uint32_t>& instanceBatches, const std::vector<CullBatch>& batches,
+                   std::vector<uint32_t>& visibleIndices, std::vector<uint32_t>& visibleCounts);
+
+// Frustum test of the meshlet's bounding sphere, then a test of its normal cone against the camera position. The cone
+// test is skipped under non-uniform scale or mirroring, which don't preserve the facing it relies on
+[[nodiscard]] bool isMeshletVisible(const Frustum& frustum,
+                                    const glm::vec3& cameraPosition,
+                                    const Meshlet& meshlet,
+                                    const glm::mat4& transform);
+
+// Appends the indices of the meshlets of one instance that pass isMeshletVisible
+void cullMeshlets(const Frustum& frustum, const glm::vec3& cameraPosition, const std::vector<Meshlet>& meshlets,
+                  const glm::mat4& transform, std::vector<uint32_t>& visibleMeshlets);
+
+} // namespace Culling
+} // namespace Vulkan
+} // namespace RDE
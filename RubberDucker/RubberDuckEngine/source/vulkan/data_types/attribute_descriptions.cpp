@@ -2,62 +2,70 @@
 
 #include "attribute_descriptions.hpp"
 #include "binding_ids.hpp"
-#include "vertex.hpp"
 
 namespace RDE
 {
 namespace Vulkan
 {
 
-RDE::Vulkan::AttributeDescriptions::AttributeDescriptions()
+RDE::Vulkan::AttributeDescriptions::AttributeDescriptions(const VertexFormat& vertexFormat,
+                                                          InstanceEncoding instanceEncoding)
 {
     // Vertex
     VkVertexInputAttributeDescription posAttrDesc{};
-    posAttrDesc.binding = VertexBufferBindingID;
+    posAttrDesc.binding = PositionBufferBindingID;
     posAttrDesc.location = location++;
-    posAttrDesc.format = VK_FORMAT_R32G32B32_SFLOAT;
-    posAttrDesc.offset = offsetof(Vertex, pos);
+    posAttrDesc.format = vertexFormat.positionFormat();
+    posAttrDesc.offset = 0;
 
-    VkVertexInputAttributeDescription colorAttrDesc{};
-    colorAttrDesc.binding = VertexBufferBindingID;
-    colorAttrDesc.location = location++;
-    colorAttrDesc.format = VK_FORMAT_R32G32B32_SFLOAT;
-    colorAttrDesc.offset = offsetof(Vertex, color);
+    const bool hasNormal = vertexFormat.normal != NormalEncoding::None;
+    VkVertexInputAttributeDescription normalAttrDesc{};
+    normalAttrDesc.binding = hasNormal ? AttributeBufferBindingID : DefaultAttributeBindingID;
+    normalAttrDesc.location = location++;
+    normalAttrDesc.format = hasNormal ? vertexFormat.normalFormat() : VK_FORMAT_R32G32_SFLOAT;
+    normalAttrDesc.offset = 0;
 
+    const bool hasTexCoord = vertexFormat.texCoord != TexCoordEncoding::None;
     VkVertexInputAttributeDescription texCoordAttrDesc{};
-    texCoordAttrDesc.binding = VertexBufferBindingID;
+    texCoordAttrDesc.binding = hasTexCoord ? AttributeBufferBindingID : DefaultAttributeBindingID;
     texCoordAttrDesc.location = location++;
-    texCoordAttrDesc.format = VK_FORMAT_R32G32_SFLOAT;
-    texCoordAttrDesc.offset = offsetof(Vertex, texCoord);
-
-    vertex = {posAttrDesc, colorAttrDesc, texCoordAttrDesc};
-
-    // Instance
-    VkVertexInputAttributeDescription col0AttrDesc{};
-    col0AttrDesc.binding = InstanceBufferBindingID;
-    col0AttrDesc.location = location++;
-    col0AttrDesc.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    col0AttrDesc.offset = 0 * sizeof(glm::vec4);
-
-    VkVertexInputAttributeDescription col1AttrDesc{};
-    col1AttrDesc.binding = InstanceBufferBindingID;
-    col1AttrDesc.location = location++;
-    col1AttrDesc.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    col1AttrDesc.offset = 1 * sizeof(glm::vec4);
-
-    VkVertexInputAttributeDescription col2AttrDesc{};
-    col2AttrDesc.binding = InstanceBufferBindingID;
-    col2AttrDesc.location = location++;
-    col2AttrDesc.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    col2AttrDesc.offset = 2 * sizeof(glm::vec4);
-
-    VkVertexInputAttributeDescription col3AttrDesc{};
-    col3AttrDesc.binding = InstanceBufferBindingID;
-    col3AttrDesc.location = location++;
-    col3AttrDesc.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    col3AttrDesc.offset = 3 * sizeof(glm::vec4);
-
-    instance = {col0AttrDesc, col1AttrDesc, col2AttrDesc, col3AttrDesc};
+    texCoordAttrDesc.format = hasTexCoord ? vertexFormat.texCoordFormat() : VK_FORMAT_R32G32_SFLOAT;
+    texCoordAttrDesc.offset = hasTexCoord ? vertexFormat.texCoordOffset() : 0;
+
+    vertex = {posAttrDesc, normalAttrDesc, texCoordAttrDesc};
+
+    // Instance, either three rows of the affine transform or translation, rotation and scale
+    const bool affine = instanceEncoding == InstanceEncoding::Affine;
+
+    VkVertexInputAttributeDescription transform0AttrDesc{};
+    transform0AttrDesc.binding = InstanceBufferBindingID;
+    transform0AttrDesc.location = location++;
+    transform0AttrDesc.format = affine ? VK_FORMAT_R32G32B32A32_SFLOAT : VK_FORMAT_R32G32B32_SFLOAT;
+    transform0AttrDesc.offset =
+        affine ? offsetof(AffineInstance, rows) : offsetof(QuaternionScaleInstance, translation);
+
+    VkVertexInputAttributeDescription transform1AttrDesc{};
+    transform1AttrDesc.binding = InstanceBufferBindingID;
+    transform1AttrDesc.location = location++;
+    transform1AttrDesc.format = affine ? VK_FORMAT_R32G32B32A32_SFLOAT : VK_FORMAT_R16G16B16A16_SNORM;
+    transform1AttrDesc.offset =
+        affine ? offsetof(AffineInstance, rows) + sizeof(glm::vec4) : offsetof(QuaternionScaleInstance, rotation);
+
+    VkVertexInputAttributeDescription transform2AttrDesc{};
+    transform2AttrDesc.binding = InstanceBufferBindingID;
+    transform2AttrDesc.location = location++;
+    transform2AttrDesc.format = affine ? VK_FORMAT_R32G32B32A32_SFLOAT : VK_FORMAT_R16G16B16A16_SFLOAT;
+    transform2AttrDesc.offset =
+        affine ? offsetof(AffineInstance, rows) + 2 * sizeof(glm::vec4) : offsetof(QuaternionScaleInstance, scale);
+
+    VkVertexInputAttributeDescription textureIndexAttrDesc{};
+    textureIndexAttrDesc.binding = InstanceBufferBindingID;
+    textureIndexAttrDesc.location = location++;
+    textureIndexAttrDesc.format = VK_FORMAT_R32_UINT;
+    textureIndexAttrDesc.offset =
+        affine ? offsetof(AffineInstance, textureIndex) : offsetof(QuaternionScaleInstance, textureIndex);
+
+    instance = {transform0AttrDesc, transform1AttrDesc, transform2AttrDesc, textureIndexAttrDesc};
 }
 } // namespace Vulkan
 } // namespace RDE
@@ -1,4 +1,7 @@
 #pragma once
+#include "instance_encoding.hpp"
+#include "vertex_format.hpp"
+
 #include <vulkan/vulkan.hpp>
 
 namespace RDE
@@ -9,7 +12,9 @@ namespace Vulkan
 class AttributeDescriptions
 {
   public:
-    AttributeDescriptions();
+    // Position, normal and texture coordinates, the last two from the default attribute binding when the format
+    // doesn't have them. Then the three transform attributes and the texture index of the instance encoding
+    AttributeDescriptions(const VertexFormat& vertexFormat, InstanceEncoding instanceEncoding);
     inline std::array<VkVertexInputAttributeDescription, 3> getVertexAttributeDescriptions() const
     {
         return vertex;
@@ -2,22 +2,30 @@
 
 #include "binding_descriptions.hpp"
 #include "binding_ids.hpp"
-#include "mesh_instance.hpp"
-#include "vertex.hpp"
 
 namespace RDE
 {
 namespace Vulkan
 {
 
-BindingDescriptions::BindingDescriptions() : vertex{}, instance{}
+BindingDescriptions::BindingDescriptions(const VertexFormat& vertexFormat, InstanceEncoding instanceEncoding)
+    : position{}, attribute{}, defaultAttribute{}, instance{}
 {
-    vertex.binding = VertexBufferBindingID;
-    vertex.stride = sizeof(Vertex);
-    vertex.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    position.binding = PositionBufferBindingID;
+    position.stride = vertexFormat.positionStride();
+    position.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    attribute.binding = AttributeBufferBindingID;
+    attribute.stride = vertexFormat.attributeStride();
+    attribute.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    // Every vertex reads the same zeroes
+    defaultAttribute.binding = DefaultAttributeBindingID;
+    defaultAttribute.stride = 0;
+    defaultAttribute.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
     instance.binding = InstanceBufferBindingID;
-    instance.stride = sizeof(MeshInstance);
+    instance.stride = instanceStride(instanceEncoding);
     instance.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 }
 } // namespace Vulkan
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "instance_encoding.hpp"
+#include "vertex_format.hpp"
+
 #include <vulkan/vulkan.hpp>
 
 namespace RDE
@@ -10,10 +13,18 @@ namespace Vulkan
 class BindingDescriptions
 {
   public:
-    BindingDescriptions();
-    inline VkVertexInputBindingDescription getVertexBindingDescription() const
+    BindingDescriptions(const VertexFormat& vertexFormat, InstanceEncoding instanceEncoding);
+    inline VkVertexInputBindingDescription getPositionBindingDescription() const
+    {
+        return position;
+    }
+    inline VkVertexInputBindingDescription getAttributeBindingDescription() const
+    {
+        return attribute;
+    }
+    inline VkVertexInputBindingDescription getDefaultAttributeBindingDescription() const
     {
-        return vertex;
+        return defaultAttribute;
     }
     inline VkVertexInputBindingDescription getInstanceBindingDescription() const
     {
@@ -21,7 +32,9 @@ class BindingDescriptions
     }
 
   private:
-    VkVertexInputBindingDescription vertex;
+    VkVertexInputBindingDescription position;
+    VkVertexInputBindingDescription attribute;
+    VkVertexInputBindingDescription defaultAttribute;
     VkVertexInputBindingDescription instance;
 };
 } // namespace Vulkan
@@ -7,8 +7,10 @@ namespace Vulkan
 {
 
 enum BindingIDs : uint32_t {
-    VertexBufferBindingID = 0,
+    PositionBufferBindingID = 0,
     InstanceBufferBindingID = 1,
+    AttributeBufferBindingID = 2,
+    DefaultAttributeBindingID = 3, // Zeroed, stride 0, for attributes a mesh doesn't have
 
     bufferBindingCount
 };
@@ -0,0 +1,74 @@
+#include "precompiled/pch.hpp"
+
+#include "compute_pipeline.hpp"
+#include "pipeline.hpp"
+#include "utilities/clock.hpp"
+#include "utilities/file_parser.hpp"
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+void ComputePipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const char* shaderPath,
+                             VkDescriptorSetLayout descriptorSetLayout, uint32_t pushConstantSize,
+                             VkPipelineCache pipelineCache)
+{
+    RDE_PROFILE_SCOPE
+
+    // Shader stage
+    auto computeShaderCode = FileParser::read(shaderPath);
+    VkShaderModule computeShaderModule = Pipeline::createShaderModule(device, allocator, computeShaderCode);
+
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo{};
+    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeShaderStageInfo.module = computeShaderModule;
+    computeShaderStageInfo.pName = "main"; // Entry point
+
+    // Push constants
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = pushConstantSize;
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // Pipeline layout
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantSize > 0 ? &pushConstantRange : nullptr;
+
+    auto result = vkCreatePipelineLayout(device, &pipelineLayoutInfo, allocator, &m_pipelineLayout);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create compute pipeline layout!");
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = computeShaderStageInfo;
+    pipelineInfo.layout = m_pipelineLayout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    result = vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, allocator, &m_computePipeline);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create compute pipeline!");
+
+    vkDestroyShaderModule(device, computeShaderModule, allocator);
+}
+
+void ComputePipeline::destroy(VkDevice device, VkAllocationCallbacks* allocator)
+{
+    vkDestroyPipeline(device, m_computePipeline, allocator);
+    vkDestroyPipelineLayout(device, m_pipelineLayout, allocator);
+
+    m_computePipeline = VK_NULL_HANDLE;
+    m_pipelineLayout = VK_NULL_HANDLE;
+}
+
+void ComputePipeline::bind(VkCommandBuffer commandBuffer)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+}
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,32 @@
+#pragma once
+#include <vulkan/vulkan.hpp>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+class ComputePipeline
+{
+  public:
+    void create(VkDevice device, VkAllocationCallbacks* allocator, const char* shaderPath,
+                VkDescriptorSetLayout descriptorSetLayout, uint32_t pushConstantSize, VkPipelineCache pipelineCache);
+    void destroy(VkDevice device, VkAllocationCallbacks* allocator);
+    void bind(VkCommandBuffer commandBuffer);
+
+    [[nodiscard]] __forceinline VkPipeline pipeline() const
+    {
+        return m_computePipeline;
+    }
+    [[nodiscard]] __forceinline VkPipelineLayout layout() const
+    {
+        return m_pipelineLayout;
+    }
+
+  private:
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_computePipeline = VK_NULL_HANDLE;
+};
+
+} // namespace Vulkan
+} // namespace RDE
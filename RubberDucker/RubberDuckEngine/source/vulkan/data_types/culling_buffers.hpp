@@ -0,0 +1,41 @@
+#pragma once
+#include "vma_buffer.hpp"
+
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// Per frame-in-flight buffers used by the GPU culling pass
+struct CullingBuffers {
+    // Host-visible inputs written every frame
+    VmaBuffer instances{};
+    VmaBuffer instanceBatches{};
+    VmaBuffer batches{};
+    VmaBuffer commandTemplates{};
+
+    // Device-local outputs written by cull.comp
+    VmaBuffer visibleInstances{};
+    VmaBuffer visibleIndices{};
+    VmaBuffer commands{};
+    VmaBuffer drawCounts{};
+
+    // Host-visible copy of the commands, read once this frame's fence has signalled
+    VmaBuffer readback{};
+
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    uint32_t instanceStride = 0; // Of the encoding the instance buffers were sized for
+    uint32_t instanceCapacity = 0;
+    uint32_t batchCapacity = 0;
+    uint32_t commandCapacity = 0;
+
+    // What was submitted the last time this frame was recorded, the first command of every batch
+    std::vector<uint32_t> submittedFirstCommands;
+    std::vector<uint32_t> expectedInstanceCounts;
+};
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,32 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <array>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// Mirrors the std430 layouts in cull.comp, keep both in sync. Instances are read as words in their InstanceEncoding
+
+struct CullBatch {
+    glm::vec4 boundingSphere; // Model space, xyz = center, w = radius
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+    uint32_t firstCommand; // One indirect command per submesh of the batch's mesh
+    uint32_t commandCount;
+};
+
+struct CullPushConstants {
+    std::array<glm::vec4, 6> frustumPlanes;
+    uint32_t instanceCount;
+    uint32_t batchCount;
+    uint32_t instanceEncoding;
+    uint32_t instanceStride; // In 32-bit words
+};
+
+static_assert(sizeof(CullBatch) == 32, "CullBatch does not match std430 layout!");
+static_assert(sizeof(CullPushConstants) <= 128, "Cull push constants exceed guaranteed push constant size!");
+} // namespace Vulkan
+} // namespace RDE
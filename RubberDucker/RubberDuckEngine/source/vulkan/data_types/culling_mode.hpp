@@ -0,0 +1,18 @@
+#pragma once
+#include <type_traits>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+enum class CullingMode : uint32_t {
+    Disabled = 0,
+    Cpu,
+    Gpu,
+
+    CullingModeCount
+};
+
+} // namespace Vulkan
+} // namespace RDE
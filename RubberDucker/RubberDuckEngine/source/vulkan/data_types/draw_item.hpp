@@ -0,0 +1,76 @@
+#pragma once
+#include "mesh.hpp"
+#include "vertex_format.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+namespace RDE
+{
+namespace Vulkan
+{
+struct CullingBuffers;
+
+// Everything needed to record one draw, gathered on the main thread so recording threads never touch the asset
+// manager or the ECS
+struct DrawItem {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipeline depthPipeline = VK_NULL_HANDLE; // Null for draws that don't write depth, skipped by the depth pre-pass
+    VkBuffer positionBuffer = VK_NULL_HANDLE;
+    VkBuffer attributeBuffer = VK_NULL_HANDLE; // Null when the mesh has no attribute stream or for depth-only draws
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    VkBuffer instanceBuffer = VK_NULL_HANDLE;
+    VkDeviceSize instanceOffset = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    const Submesh* submeshes = nullptr; // Owned by the mesh, drawn one after the other
+    uint32_t submeshCount = 0;
+    uint32_t meshId = 0; // Only for debugging and profiling
+    VertexDequantization vertexDequantization{};
+
+    // Direct draws only, indirect draws read their instance count from the culling buffers. Direct draws index into
+    // the instance buffer with firstInstance, so consecutive draws of a mesh keep the same instance buffer binding
+    uint32_t firstInstance = 0;
+    uint32_t instanceCount = 0;
+
+    // Indirect draws only
+    uint32_t batchIndex = 0;
+    uint32_t firstCommand = 0;
+
+    // Cluster culled draws only, drawn from the frame's cluster commands instead of firstInstance and instanceCount
+    uint32_t firstClusterCommand = 0;
+    uint32_t clusterCommandCount = 0;
+
+    [[nodiscard]] bool operator==(const DrawItem& rhs) const = default;
+};
+
+// Binds issued and skipped while recording, summed over all recording threads
+struct BindStatistics {
+    uint32_t pipelineBinds = 0;
+    uint32_t pipelineBindsAvoided = 0;
+    uint32_t bufferBinds = 0;
+    uint32_t bufferBindsAvoided = 0;
+
+    BindStatistics& operator+=(const BindStatistics& rhs)
+    {
+        pipelineBinds += rhs.pipelineBinds;
+        pipelineBindsAvoided += rhs.pipelineBindsAvoided;
+        bufferBinds += rhs.bufferBinds;
+        bufferBindsAvoided += rhs.bufferBindsAvoided;
+        return *this;
+    }
+};
+
+// What the scene pass secondary command buffers of a frame in flight were last recorded with. They are executed
+// again as long as the next frame gathers the same draws
+struct SceneCommands {
+    std::vector<DrawItem> drawItems;
+    const CullingBuffers* cullingBuffers = nullptr;
+    VkExtent2D renderExtent{};
+    uint32_t viewUniformOffset = 0;
+    uint32_t chunkCount = 0;
+    BindStatistics bindStatistics{};
+    bool valid = false;
+};
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,52 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// 64-bit draw sort key, most significant first:
+// | translucent (1) | pipeline (11) | material (12) | mesh (16) | depth (24) |
+// Draws group by pipeline, then material and mesh so binds can be skipped, and go front-to-back within a group.
+// Translucent draws come last and go back-to-front
+constexpr uint32_t k_sortDepthBits = 24;
+constexpr uint32_t k_sortMeshBits = 16;
+constexpr uint32_t k_sortMaterialBits = 12;
+constexpr uint32_t k_sortPipelineBits = 11;
+
+[[nodiscard]] inline uint64_t makeDrawSortKey(bool translucent, uint32_t pipelineSlot, uint32_t materialIndex,
+                                              uint32_t meshId, float depth, float farClip)
+{
+    constexpr uint64_t depthMask = (1ull << k_sortDepthBits) - 1;
+    constexpr uint64_t meshMask = (1ull << k_sortMeshBits) - 1;
+    constexpr uint64_t materialMask = (1ull << k_sortMaterialBits) - 1;
+    constexpr uint64_t pipelineMask = (1ull << k_sortPipelineBits) - 1;
+
+    // Quantize linearly over the view range, anything behind the camera sorts first
+    const float normalizedDepth = std::clamp(depth / farClip, 0.0f, 1.0f);
+    uint64_t quantizedDepth = static_cast<uint64_t>(normalizedDepth * static_cast<float>(depthMask));
+
+    if (translucent) {
+        quantizedDepth = depthMask - quantizedDepth;
+    }
+
+    uint64_t key = static_cast<uint64_t>(translucent);
+    key = (key << k_sortPipelineBits) | (pipelineSlot & pipelineMask);
+    key = (key << k_sortMaterialBits) | (materialIndex & materialMask);
+    key = (key << k_sortMeshBits) | (meshId & meshMask);
+    key = (key << k_sortDepthBits) | quantizedDepth;
+
+    return key;
+}
+
+// Distance along the view direction to the instance origin
+[[nodiscard]] inline float calculateViewDepth(const glm::vec3& eye, const glm::vec3& front, const glm::mat4& transform)
+{
+    return glm::dot(glm::vec3(transform[3]) - eye, front);
+}
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// Where the CPU spent the last frame waiting, in milliseconds. Long fence waits mean the CPU is ahead of the GPU,
+// long acquire waits mean presentation (e.g. vsync) is the limit
+struct FramePacingStatistics {
+    float fenceWait = 0.0f;             // Frame slot and swapchain image fences
+    float acquireWait = 0.0f;           // vkAcquireNextImageKHR
+    float latencySleep = 0.0f;          // Low latency mode only
+    float cpuFrameTime = 0.0f;          // From the frame slot becoming free to submission, smoothed
+    float swapchainRecreateTime = 0.0f; // Of the latest resize, kept until the next one
+};
+
+} // namespace Vulkan
+} // namespace RDE
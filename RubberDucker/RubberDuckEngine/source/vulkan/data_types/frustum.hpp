@@ -0,0 +1,47 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <array>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+struct Frustum {
+    // Left, right, bottom, top, near, far. xyz = inward facing normal, w = distance
+    std::array<glm::vec4, 6> planes{};
+
+    // Gribb-Hartmann plane extraction for a [0, 1] depth range projection
+    [[nodiscard]] static Frustum fromViewProjection(const glm::mat4& viewProjection)
+    {
+        const auto row = [&viewProjection](int i) {
+            return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        };
+
+        Frustum frustum;
+        frustum.planes[0] = row(3) + row(0);
+        frustum.planes[1] = row(3) - row(0);
+        frustum.planes[2] = row(3) + row(1);
+        frustum.planes[3] = row(3) - row(1);
+        frustum.planes[4] = row(2);
+        frustum.planes[5] = row(3) - row(2);
+
+        for (auto& plane : frustum.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    [[nodiscard]] inline bool intersectsSphere(const glm::vec3& center, float radius) const
+    {
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+} // namespace Vulkan
+} // namespace RDE
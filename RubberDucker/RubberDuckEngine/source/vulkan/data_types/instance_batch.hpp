@@ -0,0 +1,29 @@
+#pragma once
+#include "mesh_instance.hpp"
+
+#include <vector>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// Instances of one mesh drawn with one material
+struct InstanceBatch {
+    std::vector<MeshInstance> instances;
+
+    // Range of the visible instances within the mesh's instance buffer, filled when the buffer is copied
+    uint32_t firstInstance = 0;
+    uint32_t instanceCount = 0;
+
+    // Meshes with enough meshlets are culled per meshlet on the CPU. Their batches draw the runs of visible meshlets
+    // of every visible instance, a range of the frame's cluster commands
+    bool clusterCulled = false;
+    uint32_t firstClusterCommand = 0;
+    uint32_t clusterCommandCount = 0;
+
+    // View depth of each visible instance in the same order, used to sort draws
+    std::vector<float> depths;
+};
+} // namespace Vulkan
+} // namespace RDE
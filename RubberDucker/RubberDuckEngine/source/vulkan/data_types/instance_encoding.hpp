@@ -0,0 +1,43 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// How MeshInstance transforms are packed into instance buffers. The last row of a model matrix is always (0, 0, 0, 1),
+// so neither encoding stores it. Both use vertex locations 3 to 5 for the transform and 6 for the texture index, the
+// shaders pick the decoding through a specialization constant
+enum class InstanceEncoding : uint8_t {
+    Affine = 0,      // Rows of the 3x4 transform at full precision
+    QuaternionScale, // Translation, 16-bit rotation quaternion and half precision scale, no shear
+
+    InstanceEncodingCount
+};
+
+struct AffineInstance {
+    std::array<glm::vec4, 3> rows; // xyz = rotation and scale, w = translation
+    uint32_t textureIndex;
+};
+
+struct QuaternionScaleInstance {
+    glm::vec3 translation;
+    uint32_t textureIndex;
+    std::array<int16_t, 4> rotation; // Snorm xyzw, the sign of the whole quaternion is arbitrary
+    std::array<uint16_t, 4> scale;   // Half floats, w is unused. Mirrored transforms have a negative x scale
+};
+
+static_assert(sizeof(AffineInstance) == 52, "AffineInstance must not be padded!");
+static_assert(sizeof(QuaternionScaleInstance) == 32, "QuaternionScaleInstance must not be padded!");
+
+[[nodiscard]] inline uint32_t instanceStride(InstanceEncoding encoding)
+{
+    return encoding == InstanceEncoding::Affine ? sizeof(AffineInstance) : sizeof(QuaternionScaleInstance);
+}
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,18 @@
+#pragma once
+#include "pipeline_state.hpp"
+
+#include <string>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// Render pass and MSAA count are filled in by the renderer when the pipeline is requested
+struct Material {
+    std::string name;
+    PipelineState pipelineState{};
+};
+
+} // namespace Vulkan
+} // namespace RDE
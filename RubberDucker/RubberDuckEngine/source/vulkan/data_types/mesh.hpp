@@ -1,8 +1,11 @@
 #pragma once
 #include "instance_buffer.hpp"
+#include "meshlet.hpp"
 #include "vertex.hpp"
+#include "vertex_format.hpp"
 #include "vma_buffer.hpp"
 
+#include <glm/glm.hpp>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
@@ -13,18 +16,37 @@ namespace Vulkan
 
 struct Vertex;
 
+// Range of the index buffer drawn with its own vertex offset, so 16-bit indices can address more than 65536 vertices
+struct Submesh {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0;
+};
+
 struct Mesh {
     // Vertices and indices
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
 
+    // Indices are kept absolute and 32-bit here, the index buffer is packed to indexType relative to each submesh
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    std::vector<Submesh> submeshes;
+    std::vector<Meshlet> meshlets; // In index buffer order
+
+    // Chosen on load, the dequantization is filled in when the vertices are packed
+    VertexFormat vertexFormat{};
+    VertexDequantization vertexDequantization{};
+
+    // Model space, xyz = center, w = radius
+    glm::vec4 boundingSphere{};
+
     // Vertex and Index buffers
-    VmaBuffer vertexBuffer{};
+    VmaBuffer positionBuffer{};  // Read by every pass
+    VmaBuffer attributeBuffer{}; // Normals and texture coordinates, null if the format has neither
     VmaBuffer indexBuffer{};
-    std::unordered_map<uint32_t, InstanceBuffer> instanceBuffers{};
+    InstanceBuffer instanceBuffer{};
 
     using VerticesValueType = decltype(vertices)::value_type;
-    using IndicesValueType = decltype(indices)::value_type;
 };
 } // namespace Vulkan
 } // namespace RDE
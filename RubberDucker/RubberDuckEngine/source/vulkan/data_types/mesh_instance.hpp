@@ -7,8 +7,10 @@ namespace RDE
 namespace Vulkan
 {
 
+// Culled and sorted on the CPU as is, instance buffers get it packed with the renderer's InstanceEncoding
 struct MeshInstance {
     glm::mat4 modelTransform;
+    uint32_t textureIndex; // Index into the bindless texture array
 };
 } // namespace Vulkan
 } // namespace RDE
@@ -0,0 +1,33 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+constexpr uint32_t k_maxMeshletVertices = 64;
+constexpr uint32_t k_maxMeshletTriangles = 124;
+
+// Cluster of nearby triangles culled as a whole. Each one is a contiguous range of its submesh's indices, so the
+// visible ones are drawn straight from the mesh's index buffer
+struct Meshlet {
+    glm::vec4 boundingSphere{}; // Model space, xyz = center, w = radius
+    glm::vec3 coneAxis{};       // Average facing direction of the triangles
+    float coneCutoff = 1.0f;    // Sine of the normal cone's half angle, 1 when the cone is too wide to cull
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0; // Of the submesh the meshlet belongs to
+};
+
+// Work done by cluster culling this frame, over every visible instance of a cluster culled mesh
+struct ClusterCullingStatistics {
+    uint32_t meshletCount = 0;
+    uint32_t visibleMeshletCount = 0;
+    uint32_t triangleCount = 0;
+    uint32_t visibleTriangleCount = 0;
+};
+} // namespace Vulkan
+} // namespace RDE
@@ -10,18 +10,23 @@ namespace RDE
 namespace Vulkan
 {
 
-void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const Swapchain& swapchain, VkSampleCountFlagBits msaaSamples,
-                      VkDescriptorSetLayout uboDescriptorSetLayout, VkDescriptorSetLayout samplerDescriptorSetLayout,
-                      VkRenderPass renderPass)
+void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const PipelineState& state,
+                      VkPipelineLayout pipelineLayout, VkPipelineCache pipelineCache)
 {
     RDE_PROFILE_SCOPE
 
-    // Shader stage
-    auto vertexShaderCode = FileParser::read("assets/shaders/vert.spv");
-    auto fragmentShaderCode = FileParser::read("assets/shaders/frag.spv");
+    // Depth-only pipelines have no fragment shader and no color attachments
+    const bool depthOnly = state.fragmentShaderPath.empty();
 
+    // Shader stage
+    auto vertexShaderCode = FileParser::read(state.vertexShaderPath);
     VkShaderModule vertShaderModule = createShaderModule(device, allocator, vertexShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(device, allocator, fragmentShaderCode);
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+
+    if (!depthOnly) {
+        auto fragmentShaderCode = FileParser::read(state.fragmentShaderPath);
+        fragShaderModule = createShaderModule(device, allocator, fragmentShaderCode);
+    }
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -29,30 +34,64 @@ void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const S
     vertShaderStageInfo.module = vertShaderModule;
     vertShaderStageInfo.pName = "main"; // Entry point
 
+    // Selects how shaders decode the instance transform, constant_id 0 in every vertex shader
+    const auto instanceEncoding = static_cast<uint32_t>(state.instanceEncoding);
+    VkSpecializationMapEntry specializationEntry{};
+    specializationEntry.constantID = 0;
+    specializationEntry.offset = 0;
+    specializationEntry.size = sizeof(instanceEncoding);
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = 1;
+    specializationInfo.pMapEntries = &specializationEntry;
+    specializationInfo.dataSize = sizeof(instanceEncoding);
+    specializationInfo.pData = &instanceEncoding;
+    vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
     VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
     fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     fragShaderStageInfo.module = fragShaderModule;
     fragShaderStageInfo.pName = "main"; // Entry point
 
-    std::vector<VkPipelineShaderStageCreateInfo> shaderStages = {vertShaderStageInfo, fragShaderStageInfo};
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages = {vertShaderStageInfo};
+    if (!depthOnly) {
+        shaderStages.push_back(fragShaderStageInfo);
+    }
 
     // Descriptions
-    const BindingDescriptions bindingDescriptions{};
-    const AttributeDescriptions attributeDescriptions{};
+    const BindingDescriptions bindingDescriptions(state.vertexFormat, state.instanceEncoding);
+    const AttributeDescriptions attributeDescriptions(state.vertexFormat, state.instanceEncoding);
 
     // Vertex input state
-    std::vector<VkVertexInputBindingDescription> vertexInputBindingDescriptions = {bindingDescriptions.getVertexBindingDescription(),
+    std::vector<VkVertexInputBindingDescription> vertexInputBindingDescriptions = {bindingDescriptions.getPositionBindingDescription(),
                                                                                    bindingDescriptions.getInstanceBindingDescription()};
 
     std::array<VkVertexInputAttributeDescription, 3> vertexAttrDesc = attributeDescriptions.getVertexAttributeDescriptions();
     std::array<VkVertexInputAttributeDescription, 4> instanceAttrDesc = attributeDescriptions.getInstanceAttributeDescriptions();
 
-    // pos, index, uv
-    // transformation matrix columns 0, 1, 2, 3
-    std::vector<VkVertexInputAttributeDescription> vertexInputAttributeDescriptions =         // NOLINT
-        {vertexAttrDesc[0],   vertexAttrDesc[1],   vertexAttrDesc[2],                         // NOLINT
-         instanceAttrDesc[0], instanceAttrDesc[1], instanceAttrDesc[2], instanceAttrDesc[3]}; // NOLINT
+    // pos, instance transform 0, 1, 2
+    std::vector<VkVertexInputAttributeDescription> vertexInputAttributeDescriptions = {
+        vertexAttrDesc[0], instanceAttrDesc[0], instanceAttrDesc[1], instanceAttrDesc[2]};
+
+    // Normal, uv and texture index on top, from the attribute stream or the default binding where the format has none
+    if (state.vertexLayout == VertexLayout::MeshInstanced) {
+        vertexInputAttributeDescriptions.insert(vertexInputAttributeDescriptions.end(),
+                                                {vertexAttrDesc[1], vertexAttrDesc[2], instanceAttrDesc[3]});
+
+        const auto& vertexFormat = state.vertexFormat;
+        if (vertexFormat.attributeStride() > 0) {
+            vertexInputBindingDescriptions.push_back(bindingDescriptions.getAttributeBindingDescription());
+        }
+        if (vertexFormat.normal == NormalEncoding::None || vertexFormat.texCoord == TexCoordEncoding::None) {
+            vertexInputBindingDescriptions.push_back(bindingDescriptions.getDefaultAttributeBindingDescription());
+        }
+    }
+
+    if (state.vertexLayout == VertexLayout::Fullscreen) {
+        vertexInputBindingDescriptions.clear();
+        vertexInputAttributeDescriptions.clear();
+    }
 
     VkPipelineVertexInputStateCreateInfo inputInfo{};
     inputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -72,34 +111,22 @@ void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const S
     inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
 
-    // Viewport state
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(swapchain.extent.width);
-    viewport.height = static_cast<float>(swapchain.extent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = swapchain.extent;
-
+    // Viewport state, viewport and scissor are set when recording
     VkPipelineViewportStateCreateInfo viewportStateInfo{};
     viewportStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportStateInfo.viewportCount = 1;
-    viewportStateInfo.pViewports = &viewport;
+    viewportStateInfo.pViewports = nullptr;
     viewportStateInfo.scissorCount = 1;
-    viewportStateInfo.pScissors = &scissor;
+    viewportStateInfo.pScissors = nullptr;
 
     // Rasterization state
     VkPipelineRasterizationStateCreateInfo rasterizerInfo{};
     rasterizerInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizerInfo.depthClampEnable = VK_FALSE;        // Clamp fragments within depth range
     rasterizerInfo.rasterizerDiscardEnable = VK_FALSE; // Discard geometry pass through rasterizer
-    rasterizerInfo.polygonMode = VK_POLYGON_MODE_FILL; // Fill polygon area with fragments
+    rasterizerInfo.polygonMode = state.polygonMode;
     rasterizerInfo.lineWidth = 1.0f;
-    rasterizerInfo.cullMode = VK_CULL_MODE_BACK_BIT; // Back-face culling
+    rasterizerInfo.cullMode = state.cullMode;
     rasterizerInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
     rasterizerInfo.depthBiasEnable = VK_FALSE;
     rasterizerInfo.depthBiasConstantFactor = 0.0f;
@@ -110,7 +137,7 @@ void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const S
     VkPipelineMultisampleStateCreateInfo multisampleInfo{};
     multisampleInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampleInfo.sampleShadingEnable = VK_TRUE;
-    multisampleInfo.rasterizationSamples = msaaSamples;
+    multisampleInfo.rasterizationSamples = state.msaaSamples;
     multisampleInfo.minSampleShading = 1.0f;
     multisampleInfo.pSampleMask = nullptr;
     multisampleInfo.alphaToCoverageEnable = VK_FALSE;
@@ -119,9 +146,9 @@ void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const S
     // Depth and stencil testing state
     VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
     depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencilInfo.depthTestEnable = VK_TRUE;
-    depthStencilInfo.depthWriteEnable = VK_TRUE;
-    depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencilInfo.depthTestEnable = state.depthTestEnable;
+    depthStencilInfo.depthWriteEnable = state.depthWriteEnable;
+    depthStencilInfo.depthCompareOp = state.depthCompareOp;
     depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
     depthStencilInfo.stencilTestEnable = VK_FALSE;
 
@@ -131,10 +158,11 @@ void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const S
     colorBlendAttachmentInfo.colorWriteMask =
         VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 
-    // Alpha blending
-    colorBlendAttachmentInfo.blendEnable = VK_TRUE;
+    colorBlendAttachmentInfo.blendEnable = state.blendMode != BlendMode::Opaque;
     colorBlendAttachmentInfo.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    colorBlendAttachmentInfo.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachmentInfo.dstColorBlendFactor = state.blendMode == BlendMode::Additive
+                                                       ? VK_BLEND_FACTOR_ONE
+                                                       : VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     colorBlendAttachmentInfo.colorBlendOp = VK_BLEND_OP_ADD;
     colorBlendAttachmentInfo.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
     colorBlendAttachmentInfo.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
@@ -145,35 +173,19 @@ void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const S
     colorBlendingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     colorBlendingInfo.logicOpEnable = VK_FALSE; // Setting this to true will void all attachments and use
                                                 // bitwise operations
-    colorBlendingInfo.attachmentCount = 1;
+    colorBlendingInfo.attachmentCount = depthOnly ? 0 : 1;
     colorBlendingInfo.pAttachments = &colorBlendAttachmentInfo;
 
     // Dynamic state
-    std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_LINE_WIDTH};
+    std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
     VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
     dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicStateInfo.pDynamicStates = dynamicStates.data();
 
-    // Push Constants
-    // VkPushConstantRange pushConstantRange;
-    // pushConstantRange.offset = 0;
-    // pushConstantRange.size = sizeof(PushConstantObject);
-    // pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-    // Pipeline layout
-    std::vector<VkDescriptorSetLayout> descriptorSetLayouts{uboDescriptorSetLayout, samplerDescriptorSetLayout};
-
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
-    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data(); // UBO and texture sampler descriptor set layouts
-    // pipelineLayoutInfo.pushConstantRangeCount = 1;
-    // pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-
-    auto result = vkCreatePipelineLayout(device, &pipelineLayoutInfo, allocator, &m_pipelineLayout);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create pipeline layout!");
+    // Pipeline layout is shared by every pipeline state
+    m_pipelineLayout = pipelineLayout;
 
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -188,27 +200,30 @@ void Pipeline::create(VkDevice device, VkAllocationCallbacks* allocator, const S
     pipelineInfo.pMultisampleState = &multisampleInfo;
     pipelineInfo.pDepthStencilState = &depthStencilInfo;
     pipelineInfo.pColorBlendState = &colorBlendingInfo;
-    pipelineInfo.pDynamicState = nullptr;
+    pipelineInfo.pDynamicState = &dynamicStateInfo;
     // Pipeline layout
     pipelineInfo.layout = m_pipelineLayout;
     // Render pass
-    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.renderPass = state.renderPass;
     pipelineInfo.subpass = 0; // Index
     // Pipeline derivatives
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
 
-    result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, allocator, &m_graphicsPipeline);
+    // Compiled shaders are looked up in, and added to, the cache shared by every pipeline
+    auto result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, allocator, &m_graphicsPipeline);
     RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create graphics pipeline!");
 
     vkDestroyShaderModule(device, vertShaderModule, allocator);
-    vkDestroyShaderModule(device, fragShaderModule, allocator);
+    if (fragShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, fragShaderModule, allocator);
+    }
 }
 
 void Pipeline::destroy(VkDevice device, VkAllocationCallbacks* allocator)
 {
     vkDestroyPipeline(device, m_graphicsPipeline, allocator);
-    vkDestroyPipelineLayout(device, m_pipelineLayout, allocator);
+    m_graphicsPipeline = VK_NULL_HANDLE;
 }
 
 void Pipeline::bind(VkCommandBuffer commandBuffer)
@@ -217,7 +232,7 @@ void Pipeline::bind(VkCommandBuffer commandBuffer)
 }
 
 [[nodiscard]] VkShaderModule Pipeline::createShaderModule(VkDevice device, VkAllocationCallbacks* allocator,
-                                                          FileParser::FileBufferType shaderCode) const
+                                                          FileParser::FileBufferType shaderCode)
 {
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
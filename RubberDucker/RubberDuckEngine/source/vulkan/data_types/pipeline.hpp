@@ -1,5 +1,5 @@
 #pragma once
-#include "swapchain.hpp"
+#include "pipeline_state.hpp"
 #include "utilities/file_parser.hpp"
 
 #include <vulkan/vulkan.hpp>
@@ -12,8 +12,9 @@ namespace Vulkan
 class Pipeline
 {
   public:
-    void create(VkDevice device, VkAllocationCallbacks* allocator, const Swapchain& swapchain, VkSampleCountFlagBits msaaSamples,
-                VkDescriptorSetLayout uboDescriptorSetLayout, VkDescriptorSetLayout samplerDescriptorSetLayout, VkRenderPass renderPass);
+    // The pipeline layout is not owned and has to outlive the pipeline
+    void create(VkDevice device, VkAllocationCallbacks* allocator, const PipelineState& state,
+                VkPipelineLayout pipelineLayout, VkPipelineCache pipelineCache);
     void destroy(VkDevice device, VkAllocationCallbacks* allocator);
     void bind(VkCommandBuffer commandBuffer);
 
@@ -26,9 +27,10 @@ class Pipeline
         return m_pipelineLayout;
     }
 
+    [[nodiscard]] static VkShaderModule createShaderModule(VkDevice device, VkAllocationCallbacks* allocator,
+                                                           FileParser::FileBufferType shaderCode);
+
   private:
-    [[nodiscard]] VkShaderModule createShaderModule(VkDevice device, VkAllocationCallbacks* allocator,
-                                                    FileParser::FileBufferType shaderCode) const;
 
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
     VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
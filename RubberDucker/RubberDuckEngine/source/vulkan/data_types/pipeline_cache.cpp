@@ -0,0 +1,98 @@
+#include "precompiled/pch.hpp"
+
+#include "pipeline_cache.hpp"
+#include "utilities/clock.hpp"
+#include "utilities/file_parser.hpp"
+
+#include <filesystem>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+void PipelineCache::create(VkDevice device, VkAllocationCallbacks* allocator,
+                           const VkPhysicalDeviceProperties& properties, const char* filePath)
+{
+    RDE_PROFILE_SCOPE
+
+    m_filePath = filePath;
+    m_loadedSize = 0;
+
+    FileParser::FileBufferType cacheData;
+    if (std::filesystem::exists(m_filePath)) {
+        cacheData = FileParser::read(filePath);
+
+        if (!isHeaderValid(cacheData, properties)) {
+            RDELOG_WARN("Pipeline cache {} was created for another device or driver, discarding it", filePath);
+            cacheData.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo pipelineCacheInfo{};
+    pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheInfo.initialDataSize = cacheData.size();
+    pipelineCacheInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+
+    auto result = vkCreatePipelineCache(device, &pipelineCacheInfo, allocator, &m_pipelineCache);
+
+    // Drivers may still reject data that passed the header check, fall back to an empty cache
+    if (result != VK_SUCCESS && !cacheData.empty()) {
+        RDELOG_WARN("Failed to create pipeline cache from {}, starting empty", filePath);
+        cacheData.clear();
+        pipelineCacheInfo.initialDataSize = 0;
+        pipelineCacheInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(device, &pipelineCacheInfo, allocator, &m_pipelineCache);
+    }
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create pipeline cache!");
+
+    m_loadedSize = cacheData.size();
+    RDELOG_INFO("Loaded pipeline cache with {} bytes from {}", m_loadedSize, filePath);
+}
+
+void PipelineCache::save(VkDevice device) const
+{
+    RDE_PROFILE_SCOPE
+
+    size_t dataSize = 0;
+    auto result = vkGetPipelineCacheData(device, m_pipelineCache, &dataSize, nullptr);
+    if (result != VK_SUCCESS || !dataSize) {
+        return;
+    }
+
+    FileParser::FileBufferType cacheData(dataSize);
+    result = vkGetPipelineCacheData(device, m_pipelineCache, &dataSize, cacheData.data());
+    if (result != VK_SUCCESS) {
+        RDELOG_WARN("Failed to retrieve pipeline cache data!");
+        return;
+    }
+    cacheData.resize(dataSize);
+
+    if (FileParser::write(m_filePath.c_str(), cacheData)) {
+        RDELOG_INFO("Saved pipeline cache with {} bytes to {}", dataSize, m_filePath);
+    }
+}
+
+void PipelineCache::destroy(VkDevice device, VkAllocationCallbacks* allocator)
+{
+    vkDestroyPipelineCache(device, m_pipelineCache, allocator);
+    m_pipelineCache = VK_NULL_HANDLE;
+}
+
+[[nodiscard]] bool PipelineCache::isHeaderValid(const std::vector<char>& cacheData,
+                                                const VkPhysicalDeviceProperties& properties)
+{
+    VkPipelineCacheHeaderVersionOne header{};
+    if (cacheData.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, cacheData.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) && header.headerSize <= cacheData.size() &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+} // namespace Vulkan
+} // namespace RDE
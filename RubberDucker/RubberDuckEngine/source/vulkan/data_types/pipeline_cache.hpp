@@ -0,0 +1,38 @@
+#pragma once
+#include <vulkan/vulkan.hpp>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// VkPipelineCache persisted to disk between runs. The file is only used when its header matches the current device,
+// so a driver update or a different GPU starts from an empty cache instead of feeding the driver foreign data
+class PipelineCache
+{
+  public:
+    void create(VkDevice device, VkAllocationCallbacks* allocator, const VkPhysicalDeviceProperties& properties,
+                const char* filePath);
+    void save(VkDevice device) const;
+    void destroy(VkDevice device, VkAllocationCallbacks* allocator);
+
+    [[nodiscard]] __forceinline VkPipelineCache handle() const
+    {
+        return m_pipelineCache;
+    }
+    [[nodiscard]] __forceinline size_t loadedSize() const
+    {
+        return m_loadedSize;
+    }
+
+  private:
+    [[nodiscard]] static bool isHeaderValid(const std::vector<char>& cacheData,
+                                            const VkPhysicalDeviceProperties& properties);
+
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+    std::string m_filePath;
+    size_t m_loadedSize = 0;
+};
+
+} // namespace Vulkan
+} // namespace RDE
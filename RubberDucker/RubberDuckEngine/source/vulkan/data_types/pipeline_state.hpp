@@ -0,0 +1,59 @@
+#pragma once
+#include "instance_encoding.hpp"
+#include "vertex_format.hpp"
+
+#include <string>
+#include <vulkan/vulkan.hpp>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+enum class VertexLayout : uint32_t {
+    MeshInstanced = 0, // Vertex streams followed by the instance, see BindingDescriptions and AttributeDescriptions
+    PositionInstanced, // Position stream followed by the instance transform, for depth-only passes
+    Fullscreen,        // No vertex input, the vertex shader derives a fullscreen triangle from gl_VertexIndex
+};
+
+enum class BlendMode : uint32_t {
+    Opaque = 0,
+    Alpha,
+    Additive,
+};
+
+// Everything that is baked into a graphics pipeline. Two equal states always produce the same pipeline, which is what
+// PipelineStateCache hashes and compares. Viewport and scissor are dynamic so swapchain resizes don't affect it
+struct PipelineState {
+    std::string vertexShaderPath = "assets/shaders/vert.spv";
+    std::string fragmentShaderPath = "assets/shaders/frag.spv"; // Empty for depth-only pipelines
+    VertexLayout vertexLayout = VertexLayout::MeshInstanced;
+    VertexFormat vertexFormat{}; // Of the meshes drawn with it
+    InstanceEncoding instanceEncoding = InstanceEncoding::QuaternionScale;
+
+    BlendMode blendMode = BlendMode::Alpha;
+    VkBool32 depthTestEnable = VK_TRUE;
+    VkBool32 depthWriteEnable = VK_TRUE;
+    VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+
+    VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // Only used to create the pipeline, which stays valid with any compatible render pass. Equal states are drawn in
+    // the same pass of the graph, whose render pass only changes compatibility with the swapchain format
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+
+    [[nodiscard]] bool operator==(const PipelineState& rhs) const
+    {
+        return vertexShaderPath == rhs.vertexShaderPath && fragmentShaderPath == rhs.fragmentShaderPath &&
+               vertexLayout == rhs.vertexLayout && vertexFormat == rhs.vertexFormat &&
+               instanceEncoding == rhs.instanceEncoding && blendMode == rhs.blendMode &&
+               depthTestEnable == rhs.depthTestEnable && depthWriteEnable == rhs.depthWriteEnable &&
+               depthCompareOp == rhs.depthCompareOp && cullMode == rhs.cullMode && polygonMode == rhs.polygonMode &&
+               msaaSamples == rhs.msaaSamples;
+    }
+};
+
+} // namespace Vulkan
+} // namespace RDE
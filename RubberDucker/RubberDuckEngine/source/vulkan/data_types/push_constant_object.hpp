@@ -1,13 +1,25 @@
 #pragma once
-#include <glm/mat4x4.hpp>
+#include "vertex_format.hpp"
 
 namespace RDE
 {
 namespace Vulkan
 {
 
+// Graphics push constants, in the vertex stage of the layout shared by every pipeline state
 struct PushConstantObject {
-    glm::mat4 modelMtx;
+    VertexDequantization vertexDequantization;
 };
+
+static_assert(sizeof(PushConstantObject) <= 128, "Push constants exceed guaranteed push constant size!");
+
+// Pushed by the upscale pass in place of PushConstantObject, must match upscale.vert
+struct UpscalePushConstants {
+    glm::vec2 texCoordScale; // Rendered area over the size of the scene color image
+    glm::vec2 texCoordMax;   // Half a texel inside the rendered area
+    uint32_t textureIndex;   // Of the scene color image in the bindless array
+};
+
+static_assert(sizeof(UpscalePushConstants) <= sizeof(PushConstantObject), "Upscale push constants exceed the range!");
 } // namespace Vulkan
 } // namespace RDE
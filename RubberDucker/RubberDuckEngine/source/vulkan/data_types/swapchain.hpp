@@ -27,11 +27,10 @@ struct Swapchain {
     // Swap chain data
     std::vector<VkImage> images;
     std::vector<VkImageView> imageViews;
-    std::vector<VkFramebuffer> framebuffers;
 
     inline size_t size() const
     {
-        return framebuffers.size();
+        return images.size();
     }
 };
 } // namespace Vulkan
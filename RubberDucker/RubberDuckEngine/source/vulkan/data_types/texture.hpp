@@ -3,10 +3,13 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <memory>
+
 namespace RDE
 {
 namespace Vulkan
 {
+struct Ktx2Texture;
 
 struct Texture {
     uint32_t mipLevels;
@@ -15,8 +18,12 @@ struct Texture {
     VkImageView imageView = VK_NULL_HANDLE;
     VkSampler sampler = VK_NULL_HANDLE;
 
-    // Swapchain duplicates of the same descriptor sets
-    std::vector<VkDescriptorSet> descriptorSets;
+    // Slot in the bindless texture descriptor array
+    uint32_t bindlessIndex = 0;
+
+    // Streamed textures keep every level on the CPU, the image only holds those from residentMip down
+    std::shared_ptr<const Ktx2Texture> source;
+    uint32_t residentMip = 0;
 };
 } // namespace Vulkan
 } // namespace RDE
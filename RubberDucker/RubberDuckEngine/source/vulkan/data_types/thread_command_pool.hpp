@@ -0,0 +1,15 @@
+#pragma once
+#include <vulkan/vulkan.hpp>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// Command pools are externally synchronized, so every recording thread gets its own pool for each frame in flight
+struct ThreadCommandPool {
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+};
+} // namespace Vulkan
+} // namespace RDE
@@ -8,14 +8,15 @@ namespace RDE
 namespace Vulkan
 {
 
+// Full precision vertex as loaded, packed into the mesh's VertexFormat on upload
 struct Vertex {
     glm::vec3 pos;
-    glm::vec3 color;
+    glm::vec3 normal;
     glm::vec2 texCoord;
 
     bool operator==(const Vertex& other) const
     {
-        return pos == other.pos && color == other.color && texCoord == other.texCoord;
+        return pos == other.pos && normal == other.normal && texCoord == other.texCoord;
     }
 };
 } // namespace Vulkan
@@ -27,7 +28,7 @@ namespace std
 template <> struct hash<RDE::Vulkan::Vertex> {
     size_t operator()(RDE::Vulkan::Vertex const& vertex) const
     {
-        return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+        return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.normal) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
     }
 };
 } // namespace std
@@ -0,0 +1,115 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+namespace RDE
+{
+namespace Vulkan
+{
+
+// 16-bit positions are relative to the mesh bounds, see VertexDequantization
+enum class PositionEncoding : uint8_t {
+    Float32 = 0,
+    Half16,  // Centered on the bounds and scaled by their half extent
+    Unorm16, // From the bounds minimum and scaled by their extent
+};
+
+// Normals are octahedral encoded, two components that the vertex shader unfolds back onto the sphere
+enum class NormalEncoding : uint8_t {
+    None = 0,
+    Octahedral32,
+    Octahedral16,
+};
+
+enum class TexCoordEncoding : uint8_t {
+    None = 0,
+    Float32,
+    Unorm16, // Relative to the texture coordinate bounds of the mesh
+};
+
+// Vertex layout chosen per mesh. Positions have their own stream so the depth pre-pass fetches nothing else, normals
+// and texture coordinates are interleaved in a second stream that is left out when the mesh has neither. Attributes
+// a mesh doesn't have are read from a zeroed buffer with a stride of 0 instead, so every format works with the same
+// shaders
+struct VertexFormat {
+    PositionEncoding position = PositionEncoding::Float32;
+    NormalEncoding normal = NormalEncoding::None;
+    TexCoordEncoding texCoord = TexCoordEncoding::None;
+
+    [[nodiscard]] inline VkFormat positionFormat() const
+    {
+        switch (position) {
+        case PositionEncoding::Half16:
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case PositionEncoding::Unorm16:
+            return VK_FORMAT_R16G16B16A16_UNORM;
+        default:
+            return VK_FORMAT_R32G32B32_SFLOAT;
+        }
+    }
+
+    [[nodiscard]] inline VkFormat normalFormat() const
+    {
+        return normal == NormalEncoding::Octahedral16 ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R32G32_SFLOAT;
+    }
+
+    [[nodiscard]] inline VkFormat texCoordFormat() const
+    {
+        return texCoord == TexCoordEncoding::Unorm16 ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R32G32_SFLOAT;
+    }
+
+    // 16-bit positions are padded to four components, three component 16-bit formats are rarely supported
+    [[nodiscard]] inline uint32_t positionStride() const
+    {
+        return position == PositionEncoding::Float32 ? 12 : 8;
+    }
+
+    [[nodiscard]] inline uint32_t normalSize() const
+    {
+        return normal == NormalEncoding::None ? 0 : normal == NormalEncoding::Octahedral16 ? 4 : 8;
+    }
+
+    [[nodiscard]] inline uint32_t texCoordSize() const
+    {
+        return texCoord == TexCoordEncoding::None ? 0 : texCoord == TexCoordEncoding::Unorm16 ? 4 : 8;
+    }
+
+    // Normal first, then texture coordinates
+    [[nodiscard]] inline uint32_t attributeStride() const
+    {
+        return normalSize() + texCoordSize();
+    }
+
+    [[nodiscard]] inline uint32_t texCoordOffset() const
+    {
+        return normalSize();
+    }
+
+    [[nodiscard]] inline uint32_t key() const
+    {
+        return static_cast<uint32_t>(position) | static_cast<uint32_t>(normal) << 8 |
+               static_cast<uint32_t>(texCoord) << 16;
+    }
+
+    [[nodiscard]] bool operator==(const VertexFormat& rhs) const = default;
+};
+
+// Maps quantized positions and texture coordinates back to model space and UV space, pushed once per mesh. Identity
+// for float streams. Mirrors the push constant block in shader.vert and depth.vert
+struct VertexDequantization {
+    glm::vec4 positionOffset{0.0f};
+    glm::vec4 positionScale{1.0f};
+    glm::vec4 texCoordTransform{0.0f, 0.0f, 1.0f, 1.0f}; // xy = offset, zw = scale
+
+    [[nodiscard]] bool operator==(const VertexDequantization& rhs) const = default;
+};
+
+// The zeroed stream missing attributes are read from, large enough for every attribute at offset 0
+constexpr uint32_t k_defaultAttributeSize = 8;
+
+// Interleaved vec3 position, vec3 color and vec2 texture coordinates, plus a copy of the positions for depth-only
+// passes. Kept to report what the per-mesh formats save
+constexpr uint32_t k_unpackedVertexStride = 32;
+constexpr uint32_t k_unpackedPositionStride = 12;
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,37 @@
+#include "precompiled/pch.hpp"
+
+#include "deletion_queue.hpp"
+
+namespace RDE {
+namespace Vulkan {
+
+void DeletionQueue::retire(uint64_t frameNumber, Deleter deleter)
+{
+    RDE_ASSERT_2(m_entries.empty() || m_entries.back().frameNumber <= frameNumber,
+                 "Objects must be retired in frame order!");
+    m_entries.push_back({frameNumber, std::move(deleter)});
+}
+
+void DeletionQueue::collect(uint64_t completedFrameNumber)
+{
+    while (!m_entries.empty() && m_entries.front().frameNumber <= completedFrameNumber) {
+        m_entries.front().deleter();
+        m_entries.pop_front();
+    }
+}
+
+void DeletionQueue::flush()
+{
+    for (auto& entry : m_entries) {
+        entry.deleter();
+    }
+    m_entries.clear();
+}
+
+[[nodiscard]] size_t DeletionQueue::pendingCount() const
+{
+    return m_entries.size();
+}
+
+} // namespace Vulkan
+} // namespace RDE
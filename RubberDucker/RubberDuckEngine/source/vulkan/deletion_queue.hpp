@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace RDE {
+namespace Vulkan {
+
+// Destroys GPU objects once no frame in flight can use them anymore. Objects are retired with the number of the last
+// frame that may use them, which is the one being recorded, and destroyed once that frame's fence has been waited on.
+// Frames are submitted in order to a single queue, so a finished frame means every earlier frame has finished too.
+class DeletionQueue
+{
+public:
+    using Deleter = std::function<void()>;
+
+    void retire(uint64_t frameNumber, Deleter deleter);
+
+    // Destroys everything retired up to and including the given frame
+    void collect(uint64_t completedFrameNumber);
+
+    // Destroys everything, the device must be idle
+    void flush();
+
+    [[nodiscard]] size_t pendingCount() const;
+
+private:
+    struct Entry
+    {
+        uint64_t frameNumber = 0;
+        Deleter deleter;
+    };
+
+    std::deque<Entry> m_entries; // Oldest first
+};
+
+} // namespace Vulkan
+} // namespace RDE
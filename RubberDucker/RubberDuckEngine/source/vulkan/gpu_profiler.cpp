@@ -0,0 +1,179 @@
+#include "precompiled/pch.hpp"
+
+#include "gpu_profiler.hpp"
+
+namespace RDE {
+namespace Vulkan {
+
+void GpuProfiler::init(VkDevice device,
+                       VkAllocationCallbacks* allocator,
+                       VkPhysicalDevice physicalDevice,
+                       uint32_t graphicsQueueFamily,
+                       uint32_t frameCount,
+                       uint32_t maxScopeCount)
+{
+    m_device = device;
+    m_allocator = allocator;
+    m_maxScopeCount = maxScopeCount;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    // Either limit is enough to time graphics work, the first one covers every queue
+    const bool supported = properties.limits.timestampComputeAndGraphics == VK_TRUE ||
+                           queueFamilies[graphicsQueueFamily].timestampValidBits > 0;
+    if (!supported) {
+        RDELOG_WARN("Timestamp queries are not supported, GPU timings are disabled");
+        return;
+    }
+    m_timestampPeriod = properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2 * maxScopeCount;
+
+    m_frames.resize(frameCount);
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        auto& frame = m_frames[i];
+        frame.scopeCount = std::make_unique<std::atomic<uint32_t>>(0);
+        frame.names.resize(maxScopeCount);
+
+        auto result = vkCreateQueryPool(m_device, &queryPoolInfo, m_allocator, &frame.queryPool);
+        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create timestamp query pool for frame {}!", i);
+    }
+}
+
+void GpuProfiler::destroy()
+{
+    for (auto& frame : m_frames) {
+        vkDestroyQueryPool(m_device, frame.queryPool, m_allocator);
+    }
+    m_frames.clear();
+    m_currentFrame = nullptr;
+    m_results.clear();
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if (!isSupported()) {
+        return;
+    }
+    auto& frame = m_frames[frameIndex];
+    if (frame.pending) {
+        readback(frame);
+    }
+
+    vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, 2 * m_maxScopeCount);
+    frame.scopeCount->store(0);
+    frame.pending = true;
+    m_currentFrame = &frame;
+}
+
+[[nodiscard]] GpuProfiler::ScopeHandle GpuProfiler::beginScope(VkCommandBuffer commandBuffer, std::string name)
+{
+    if (!m_currentFrame) {
+        return k_invalidScope;
+    }
+    const ScopeHandle scope = m_currentFrame->scopeCount->fetch_add(1);
+    if (scope >= m_maxScopeCount) {
+        return k_invalidScope;
+    }
+    m_currentFrame->names[scope] = std::move(name);
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_currentFrame->queryPool, 2 * scope);
+    return scope;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, ScopeHandle scope)
+{
+    if (scope == k_invalidScope) {
+        return;
+    }
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_currentFrame->queryPool, 2 * scope + 1);
+}
+
+void GpuProfiler::clearResults()
+{
+    for (auto& frame : m_frames) {
+        frame.pending = false;
+    }
+    m_results.clear();
+}
+
+[[nodiscard]] bool GpuProfiler::isSupported() const
+{
+    return !m_frames.empty();
+}
+
+[[nodiscard]] const std::vector<GpuProfiler::ScopeTime>& GpuProfiler::results() const
+{
+    return m_results;
+}
+
+[[nodiscard]] float GpuProfiler::scopeTime(std::string_view name) const
+{
+    float time = 0.0f;
+    for (const auto& result : m_results) {
+        if (result.name == name) {
+            time += result.time;
+        }
+    }
+    return time;
+}
+
+void GpuProfiler::readback(Frame& frame)
+{
+    frame.pending = false;
+
+    const uint32_t scopeCount = std::min(frame.scopeCount->load(), m_maxScopeCount);
+    if (scopeCount == 0) {
+        return;
+    }
+
+    // Value and availability per query
+    std::vector<uint64_t> queries(4 * static_cast<size_t>(scopeCount));
+    vkGetQueryPoolResults(m_device,
+                          frame.queryPool,
+                          0,
+                          2 * scopeCount,
+                          queries.size() * sizeof(uint64_t),
+                          queries.data(),
+                          2 * sizeof(uint64_t),
+                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    // Keep the previous results rather than showing a partial frame
+    for (uint32_t scope = 0; scope < scopeCount; ++scope) {
+        if (queries[4 * scope + 1] == 0 || queries[4 * scope + 3] == 0) {
+            return;
+        }
+    }
+
+    m_results.resize(scopeCount);
+    for (uint32_t scope = 0; scope < scopeCount; ++scope) {
+        const uint64_t begin = queries[4 * scope];
+        const uint64_t end = queries[4 * scope + 2];
+
+        m_results[scope].name = frame.names[scope];
+        m_results[scope].time = static_cast<float>(end - begin) * m_timestampPeriod / 1000000.0f;
+    }
+}
+
+GpuProfileScope::GpuProfileScope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, std::string name)
+    : m_profiler(profiler)
+    , m_commandBuffer(commandBuffer)
+    , m_scope(profiler.beginScope(commandBuffer, std::move(name)))
+{}
+
+GpuProfileScope::~GpuProfileScope()
+{
+    m_profiler.endScope(m_commandBuffer, m_scope);
+}
+
+} // namespace Vulkan
+} // namespace RDE
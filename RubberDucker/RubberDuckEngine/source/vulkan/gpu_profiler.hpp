@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+
+// Timestamp queries around named scopes, with one query pool per frame in flight. A frame's results are read back
+// without waiting when its slot comes around again, i.e. once its fence has been waited on. Scopes may be opened
+// from several recording threads at once, inside or outside render passes.
+class GpuProfiler
+{
+public:
+    using ScopeHandle = uint32_t;
+    static constexpr ScopeHandle k_invalidScope = UINT32_MAX;
+
+    struct ScopeTime
+    {
+        std::string name;
+        float time = 0.0f; // In milliseconds
+    };
+
+    // Does nothing if the device has no timestamp support on its graphics queue
+    void init(VkDevice device,
+              VkAllocationCallbacks* allocator,
+              VkPhysicalDevice physicalDevice,
+              uint32_t graphicsQueueFamily,
+              uint32_t frameCount,
+              uint32_t maxScopeCount);
+    void destroy();
+
+    // Reads back what this frame slot recorded last time, then resets its queries. Call outside of render passes
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+    // Returns k_invalidScope once the frame runs out of queries, endScope() ignores it
+    [[nodiscard]] ScopeHandle beginScope(VkCommandBuffer commandBuffer, std::string name);
+    void endScope(VkCommandBuffer commandBuffer, ScopeHandle scope);
+
+    // Drops results and pending queries, e.g. when scopes are renamed
+    void clearResults();
+
+    [[nodiscard]] bool isSupported() const;
+    [[nodiscard]] const std::vector<ScopeTime>& results() const; // Latest complete frame, in scope order
+    [[nodiscard]] float scopeTime(std::string_view name) const;  // Sum over every scope with that name
+
+private:
+    struct Frame
+    {
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        std::unique_ptr<std::atomic<uint32_t>> scopeCount;
+        std::vector<std::string> names;
+        bool pending = false;
+    };
+
+    void readback(Frame& frame);
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkAllocationCallbacks* m_allocator = nullptr;
+    float m_timestampPeriod = 0.0f; // Nanoseconds per tick
+    uint32_t m_maxScopeCount = 0;
+
+    std::vector<Frame> m_frames;
+    Frame* m_currentFrame = nullptr;
+    std::vector<ScopeTime> m_results;
+};
+
+// Opens a scope for the lifetime of the object
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, std::string name);
+    ~GpuProfileScope();
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler& m_profiler;
+    VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+    GpuProfiler::ScopeHandle m_scope = GpuProfiler::k_invalidScope;
+};
+
+} // namespace Vulkan
+} // namespace RDE
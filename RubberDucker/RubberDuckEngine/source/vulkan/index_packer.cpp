@@ -0,0 +1,91 @@
+#include "precompiled/pch.hpp"
+
+#include "index_packer.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace RDE {
+namespace Vulkan {
+namespace IndexPacker {
+
+namespace {
+constexpr uint32_t k_maxUint16VertexRange = std::numeric_limits<uint16_t>::max(); // Between lowest and highest index
+constexpr size_t k_maxSubmeshCount = 8; // Each submesh is another draw, past this 32-bit indices are cheaper
+} // namespace
+
+[[nodiscard]] Layout chooseLayout(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    const auto indexCount = static_cast<uint32_t>(indices.size());
+
+    Layout layout{};
+    if (vertexCount <= size_t{k_maxUint16VertexRange} + 1) {
+        layout.indexType = VK_INDEX_TYPE_UINT16;
+        layout.submeshes.push_back({0, indexCount, 0});
+        return layout;
+    }
+
+    // Greedily grow each submesh by whole triangles until its vertex range no longer fits
+    std::vector<Submesh> submeshes;
+    uint32_t firstIndex = 0;
+    uint32_t minVertex = std::numeric_limits<uint32_t>::max();
+    uint32_t maxVertex = 0;
+
+    for (uint32_t index = 0; index + 2 < indexCount; index += 3) {
+        const uint32_t triangleMin = std::min({indices[index], indices[index + 1], indices[index + 2]});
+        const uint32_t triangleMax = std::max({indices[index], indices[index + 1], indices[index + 2]});
+        const bool tooFar = triangleMax - triangleMin > k_maxUint16VertexRange;
+        const bool startsSubmesh =
+            std::max(maxVertex, triangleMax) - std::min(minVertex, triangleMin) > k_maxUint16VertexRange;
+
+        if (tooFar || (startsSubmesh && submeshes.size() + 1 >= k_maxSubmeshCount)) {
+            layout.submeshes.push_back({0, indexCount, 0});
+            return layout;
+        }
+
+        if (startsSubmesh) {
+            submeshes.push_back({firstIndex, index - firstIndex, static_cast<int32_t>(minVertex)});
+            firstIndex = index;
+            minVertex = triangleMin;
+            maxVertex = triangleMax;
+        } else {
+            minVertex = std::min(minVertex, triangleMin);
+            maxVertex = std::max(maxVertex, triangleMax);
+        }
+    }
+    submeshes.push_back({firstIndex, indexCount - firstIndex, static_cast<int32_t>(indexCount ? minVertex : 0)});
+
+    layout.indexType = VK_INDEX_TYPE_UINT16;
+    layout.submeshes = std::move(submeshes);
+    return layout;
+}
+
+[[nodiscard]] std::vector<uint8_t> pack(const std::vector<uint32_t>& indices, const Layout& layout)
+{
+    if (layout.indexType == VK_INDEX_TYPE_UINT32) {
+        std::vector<uint8_t> packed(indices.size() * sizeof(uint32_t));
+        std::memcpy(packed.data(), indices.data(), packed.size());
+        return packed;
+    }
+
+    std::vector<uint16_t> rebased(indices.size());
+    for (const auto& submesh : layout.submeshes) {
+        const auto vertexOffset = static_cast<uint32_t>(submesh.vertexOffset);
+        for (uint32_t index = submesh.firstIndex; index < submesh.firstIndex + submesh.indexCount; ++index) {
+            rebased[index] = static_cast<uint16_t>(indices[index] - vertexOffset);
+        }
+    }
+
+    std::vector<uint8_t> packed(rebased.size() * sizeof(uint16_t));
+    std::memcpy(packed.data(), rebased.data(), packed.size());
+    return packed;
+}
+
+[[nodiscard]] uint32_t indexSize(VkIndexType indexType)
+{
+    return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+} // namespace IndexPacker
+} // namespace Vulkan
+} // namespace RDE
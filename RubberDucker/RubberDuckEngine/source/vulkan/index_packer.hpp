@@ -0,0 +1,29 @@
+#pragma once
+
+#include "data_types/mesh.hpp"
+
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+namespace IndexPacker {
+
+struct Layout
+{
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    std::vector<Submesh> submeshes;
+};
+
+// 16-bit indices when the mesh has at most 65536 vertices, or when splitting its triangles in order into a few
+// submeshes keeps each one within a 65536 vertex window. Loaders emit vertices in first use order, so consecutive
+// triangles reference nearby vertices and the windows rarely overlap much
+[[nodiscard]] Layout chooseLayout(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+// Indices relative to their submesh's vertex offset, in the layout's index type
+[[nodiscard]] std::vector<uint8_t> pack(const std::vector<uint32_t>& indices, const Layout& layout);
+
+[[nodiscard]] uint32_t indexSize(VkIndexType indexType);
+
+} // namespace IndexPacker
+} // namespace Vulkan
+} // namespace RDE
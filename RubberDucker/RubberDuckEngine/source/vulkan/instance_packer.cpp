@@ -0,0 +1,80 @@
+#include "precompiled/pch.hpp"
+
+#include "instance_packer.hpp"
+
+#include "utilities/clock.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+namespace RDE {
+namespace Vulkan {
+namespace InstancePacker {
+
+namespace {
+[[nodiscard]] AffineInstance packAffine(const MeshInstance& instance)
+{
+    const glm::mat4 rows = glm::transpose(instance.modelTransform);
+    return {{rows[0], rows[1], rows[2]}, instance.textureIndex};
+}
+
+[[nodiscard]] QuaternionScaleInstance packQuaternionScale(const MeshInstance& instance)
+{
+    const auto& transform = instance.modelTransform;
+    glm::mat3 rotation(transform);
+
+    // A mirrored transform can't be a rotation, the mirroring goes into the x scale
+    glm::vec3 scale(glm::length(rotation[0]), glm::length(rotation[1]), glm::length(rotation[2]));
+    if (glm::determinant(rotation) < 0.0f) {
+        scale.x = -scale.x;
+    }
+    const glm::mat3 identity(1.0f);
+    for (glm::length_t axis = 0; axis < 3; ++axis) {
+        rotation[axis] = scale[axis] != 0.0f ? rotation[axis] / scale[axis] : identity[axis];
+    }
+    const glm::quat quaternion = glm::normalize(glm::quat_cast(rotation));
+
+    QuaternionScaleInstance packed{};
+    packed.translation = glm::vec3(transform[3]);
+    packed.textureIndex = instance.textureIndex;
+    packed.rotation = {static_cast<int16_t>(glm::packSnorm1x16(quaternion.x)),
+                       static_cast<int16_t>(glm::packSnorm1x16(quaternion.y)),
+                       static_cast<int16_t>(glm::packSnorm1x16(quaternion.z)),
+                       static_cast<int16_t>(glm::packSnorm1x16(quaternion.w))};
+    packed.scale = {glm::packHalf1x16(scale.x), glm::packHalf1x16(scale.y), glm::packHalf1x16(scale.z), 0};
+    return packed;
+}
+} // namespace
+
+[[nodiscard]] InstanceEncoding parseEncoding(std::string_view name)
+{
+    if (name == "affine") {
+        return InstanceEncoding::Affine;
+    }
+    if (name != "quaternion") {
+        RDELOG_WARN("Unknown instance encoding {}, using quaternion", name);
+    }
+    return InstanceEncoding::QuaternionScale;
+}
+
+void pack(InstanceEncoding encoding, const MeshInstance* instances, size_t instanceCount, void* destination)
+{
+    RDE_PROFILE_SCOPE
+
+    // Whole instances are assigned, so mapped memory is written front to back
+    if (encoding == InstanceEncoding::Affine) {
+        auto* packed = static_cast<AffineInstance*>(destination);
+        for (size_t i = 0; i < instanceCount; ++i) {
+            packed[i] = packAffine(instances[i]);
+        }
+        return;
+    }
+
+    auto* packed = static_cast<QuaternionScaleInstance*>(destination);
+    for (size_t i = 0; i < instanceCount; ++i) {
+        packed[i] = packQuaternionScale(instances[i]);
+    }
+}
+
+} // namespace InstancePacker
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "data_types/instance_encoding.hpp"
+#include "data_types/mesh_instance.hpp"
+
+#include <string_view>
+
+namespace RDE {
+namespace Vulkan {
+namespace InstancePacker {
+
+// "affine" or "quaternion"
+[[nodiscard]] InstanceEncoding parseEncoding(std::string_view name);
+
+// Writes instanceStride(encoding) bytes per instance to destination, which may be mapped write-combined memory. Model
+// transforms are expected to be translation, rotation and scale, quaternion encoding drops any shear
+void pack(InstanceEncoding encoding, const MeshInstance* instances, size_t instanceCount, void* destination);
+
+} // namespace InstancePacker
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,293 @@
+#include "precompiled/pch.hpp"
+
+#include "ktx2.hpp"
+
+#include <cstring>
+
+namespace RDE {
+namespace Vulkan {
+
+namespace {
+constexpr uint8_t k_identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+struct Header
+{
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+
+    // Index
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+static_assert(sizeof(Header) == 80, "KTX2 header must not be padded!");
+
+struct LevelIndex
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+// Data format descriptor values, from the Khronos Data Format Specification
+constexpr uint32_t k_dfdVersion = 2;
+constexpr uint32_t k_dfdBlockHeaderSize = 24;
+constexpr uint32_t k_dfdSampleSize = 16;
+constexpr uint32_t k_dfdColorModelRgbsda = 1;
+constexpr uint32_t k_dfdPrimariesBt709 = 1;
+constexpr uint32_t k_dfdTransferLinear = 1;
+constexpr uint32_t k_dfdTransferSrgb = 2;
+constexpr uint32_t k_dfdChannelAlpha = 15;
+constexpr uint32_t k_dfdQualifierLinear = 0x10;
+
+// Level data has to be aligned to the texel size and to 4 bytes, RGBA8 satisfies both with 4
+constexpr size_t k_levelAlignment = 4;
+} // namespace
+
+[[nodiscard]] std::optional<Ktx2Texture> Ktx2Texture::load(const char* path)
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        RDELOG_WARN("Failed to open {}!", path);
+        return std::nullopt;
+    }
+    const size_t fileSize = static_cast<size_t>(file.tellg());
+    std::vector<uint8_t> buffer(fileSize);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.data()), fileSize);
+
+    Header header{};
+    if (fileSize < sizeof(Header)) {
+        RDELOG_WARN("{} is too small to be a KTX2 file!", path);
+        return std::nullopt;
+    }
+    std::memcpy(&header, buffer.data(), sizeof(Header));
+
+    if (std::memcmp(header.identifier, k_identifier, sizeof(k_identifier)) != 0) {
+        RDELOG_WARN("{} is not a KTX2 file!", path);
+        return std::nullopt;
+    }
+
+    const auto format = static_cast<VkFormat>(header.vkFormat);
+    if (!isSupportedFormat(format)) {
+        RDELOG_WARN("{} uses unsupported format {}!", path, header.vkFormat);
+        return std::nullopt;
+    }
+    if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1) {
+        RDELOG_WARN("{} is not a single 2D image, arrays, cube maps and 3D textures are not supported!", path);
+        return std::nullopt;
+    }
+    if (header.supercompressionScheme != 0) {
+        RDELOG_WARN("{} is supercompressed, which is not supported!", path);
+        return std::nullopt;
+    }
+
+    // A level count of 0 asks the loader to generate mips, which block-compressed data can't be blitted for
+    const uint32_t levelCount = std::max(header.levelCount, 1u);
+    if (fileSize < sizeof(Header) + levelCount * sizeof(LevelIndex)) {
+        RDELOG_WARN("{} is truncated!", path);
+        return std::nullopt;
+    }
+
+    Ktx2Texture texture{};
+    texture.format = format;
+    texture.width = header.pixelWidth;
+    texture.height = std::max(header.pixelHeight, 1u);
+    texture.levels.resize(levelCount);
+
+    size_t dataSize = 0;
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        auto& textureLevel = texture.levels[level];
+        textureLevel.width = std::max(texture.width >> level, 1u);
+        textureLevel.height = std::max(texture.height >> level, 1u);
+        textureLevel.offset = dataSize;
+        textureLevel.size = levelSize(format, textureLevel.width, textureLevel.height);
+        dataSize += textureLevel.size;
+    }
+    texture.data.resize(dataSize);
+
+    // Levels are usually stored smallest first, the index always lists the largest first
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        LevelIndex levelIndex{};
+        std::memcpy(&levelIndex, buffer.data() + sizeof(Header) + level * sizeof(LevelIndex), sizeof(LevelIndex));
+
+        const auto& textureLevel = texture.levels[level];
+        if (levelIndex.byteLength != textureLevel.size || levelIndex.byteOffset + levelIndex.byteLength > fileSize) {
+            RDELOG_WARN("{} has an invalid level {}!", path, level);
+            return std::nullopt;
+        }
+        std::memcpy(
+            texture.data.data() + textureLevel.offset, buffer.data() + levelIndex.byteOffset, textureLevel.size);
+    }
+    return texture;
+}
+
+[[nodiscard]] bool Ktx2Texture::save(const char* path) const
+{
+    if (format != VK_FORMAT_R8G8B8A8_UNORM && format != VK_FORMAT_R8G8B8A8_SRGB) {
+        RDELOG_WARN("Can't write {} to {}, only RGBA8 is supported!", formatName(format), path);
+        return false;
+    }
+    const bool srgb = format == VK_FORMAT_R8G8B8A8_SRGB;
+    const auto levelCount = static_cast<uint32_t>(levels.size());
+
+    // Basic descriptor block with one 8-bit sample per channel
+    std::vector<uint32_t> dfd;
+    dfd.push_back(0); // Total size, filled in below
+    dfd.push_back(0); // Khronos vendor, basic descriptor type
+    dfd.push_back(k_dfdVersion | (k_dfdBlockHeaderSize + 4 * k_dfdSampleSize) << 16);
+    dfd.push_back(k_dfdColorModelRgbsda | k_dfdPrimariesBt709 << 8 |
+                  (srgb ? k_dfdTransferSrgb : k_dfdTransferLinear) << 16);
+    dfd.push_back(0); // 1x1x1x1 texel block
+    dfd.push_back(blockSize(format));
+    dfd.push_back(0);
+
+    for (uint32_t channel = 0; channel < 4; ++channel) {
+        // Alpha is never sRGB encoded
+        const uint32_t channelType =
+            channel == 3 ? k_dfdChannelAlpha | (srgb ? k_dfdQualifierLinear : 0) : channel;
+        dfd.push_back(channel * 8 | 7 << 16 | channelType << 24);
+        dfd.push_back(0); // Sample position
+        dfd.push_back(0); // Lower
+        dfd.push_back(255); // Upper
+    }
+    dfd[0] = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+    Header header{};
+    std::memcpy(header.identifier, k_identifier, sizeof(k_identifier));
+    header.vkFormat = static_cast<uint32_t>(format);
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.faceCount = 1;
+    header.levelCount = levelCount;
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(Header) + levelCount * sizeof(LevelIndex));
+    header.dfdByteLength = dfd[0];
+
+    // Smallest level first, as the specification recommends for streaming
+    std::vector<LevelIndex> levelIndices(levelCount);
+    size_t fileSize = header.dfdByteOffset + header.dfdByteLength;
+
+    for (uint32_t level = levelCount; level-- > 0;) {
+        fileSize = (fileSize + k_levelAlignment - 1) / k_levelAlignment * k_levelAlignment;
+        levelIndices[level].byteOffset = fileSize;
+        levelIndices[level].byteLength = levels[level].size;
+        levelIndices[level].uncompressedByteLength = levels[level].size;
+        fileSize += levels[level].size;
+    }
+
+    std::vector<uint8_t> buffer(fileSize);
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+    std::memcpy(buffer.data() + sizeof(Header), levelIndices.data(), levelCount * sizeof(LevelIndex));
+    std::memcpy(buffer.data() + header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        std::memcpy(
+            buffer.data() + levelIndices[level].byteOffset, data.data() + levels[level].offset, levels[level].size);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        RDELOG_WARN("Failed to open {} for writing!", path);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    return file.good();
+}
+
+[[nodiscard]] bool Ktx2Texture::isSupportedFormat(VkFormat format)
+{
+    return format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB || isBlockCompressed(format);
+}
+
+[[nodiscard]] bool Ktx2Texture::isBlockCompressed(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        return true;
+    default:
+        return false;
+    }
+}
+
+[[nodiscard]] uint32_t Ktx2Texture::blockSize(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        return 8;
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+[[nodiscard]] size_t Ktx2Texture::levelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    if (!isBlockCompressed(format)) {
+        return static_cast<size_t>(width) * height * blockSize(format);
+    }
+    const size_t blocksX = (width + 3) / 4;
+    const size_t blocksY = (height + 3) / 4;
+    return blocksX * blocksY * blockSize(format);
+}
+
+[[nodiscard]] const char* Ktx2Texture::formatName(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return "RGBA8";
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        return "BC1";
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        return "BC5";
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return "BC7";
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        return "ETC2 RGB";
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        return "ETC2 RGBA";
+    default:
+        return "unknown";
+    }
+}
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+
+// A 2D texture read from a KTX2 container. Only single layer, single face files without supercompression are
+// accepted, in RGBA8 or one of the block-compressed formats in isSupportedFormat(). Only RGBA8 can be written back
+struct Ktx2Texture
+{
+    struct Level
+    {
+        size_t offset = 0; // Into data
+        size_t size = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<Level> levels; // Largest first
+    std::vector<uint8_t> data;
+
+    [[nodiscard]] static std::optional<Ktx2Texture> load(const char* path);
+    [[nodiscard]] bool save(const char* path) const;
+
+    [[nodiscard]] static bool isSupportedFormat(VkFormat format);
+    [[nodiscard]] static bool isBlockCompressed(VkFormat format);
+    [[nodiscard]] static uint32_t blockSize(VkFormat format); // Bytes per 4x4 block, or per texel if uncompressed
+    [[nodiscard]] static size_t levelSize(VkFormat format, uint32_t width, uint32_t height);
+    [[nodiscard]] static const char* formatName(VkFormat format);
+};
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,308 @@
+#include "precompiled/pch.hpp"
+
+#include "mesh_optimizer.hpp"
+
+#include "utilities/clock.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace RDE {
+namespace Vulkan {
+namespace MeshOptimizer {
+
+namespace {
+constexpr uint32_t k_optimizationCacheSize = 16;
+constexpr uint32_t k_invalidVertex = std::numeric_limits<uint32_t>::max();
+
+// Triangles using each vertex, the ones of vertex v are triangles[offsets[v]] up to triangles[offsets[v + 1]]
+struct Adjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+};
+
+[[nodiscard]] Adjacency buildAdjacency(const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    Adjacency adjacency{};
+    adjacency.offsets.assign(vertexCount + 1, 0);
+    adjacency.triangles.resize(indexCount);
+
+    for (size_t i = 0; i < indexCount; ++i) {
+        ++adjacency.offsets[indices[i] + 1];
+    }
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        adjacency.offsets[vertex + 1] += adjacency.offsets[vertex];
+    }
+
+    std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (size_t i = 0; i < indexCount; ++i) {
+        adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+    return adjacency;
+}
+
+void tipsify(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>* clusters)
+{
+    const size_t triangleCount = indexCount / 3;
+    const auto adjacency = buildAdjacency(indices, triangleCount * 3, vertexCount);
+
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        liveTriangles[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+    }
+
+    // A vertex is cached while fewer than the cache size vertices were transformed after it
+    std::vector<uint32_t> cacheTimes(vertexCount, 0);
+    uint32_t time = k_optimizationCacheSize + 1;
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    uint32_t cursor = 0;
+    const auto skipDeadEnd = [&]() {
+        while (!deadEnd.empty()) {
+            const uint32_t vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                return vertex;
+            }
+        }
+        for (; cursor < vertexCount; ++cursor) {
+            if (liveTriangles[cursor] > 0) {
+                return cursor;
+            }
+        }
+        return k_invalidVertex;
+    };
+
+    if (clusters) {
+        clusters->clear();
+    }
+    uint32_t fanning = skipDeadEnd();
+    bool jumped = true;
+
+    while (fanning != k_invalidVertex) {
+        if (jumped && clusters) {
+            clusters->push_back(static_cast<uint32_t>(output.size() / 3));
+        }
+
+        candidates.clear();
+        for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; ++i) {
+            const uint32_t triangle = adjacency.triangles[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = true;
+
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                const uint32_t vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+
+                if (time - cacheTimes[vertex] > k_optimizationCacheSize) {
+                    cacheTimes[vertex] = time++;
+                }
+            }
+        }
+
+        // The candidate that entered the cache earliest, unless fanning around it would push it out midway
+        uint32_t next = k_invalidVertex;
+        int64_t bestPriority = -1;
+        for (const uint32_t vertex : candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= k_optimizationCacheSize) {
+                priority = time - cacheTimes[vertex];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+
+        jumped = next == k_invalidVertex;
+        fanning = jumped ? skipDeadEnd() : next;
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+} // namespace
+
+[[nodiscard]] VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    VertexCacheStatistics statistics{};
+    if (indices.empty()) {
+        return statistics;
+    }
+
+    std::vector<uint32_t> cacheTimes(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    uint32_t time = k_analysisCacheSize + 1;
+    uint32_t transformedCount = 0;
+    uint32_t usedCount = 0;
+
+    for (const uint32_t vertex : indices) {
+        if (time - cacheTimes[vertex] > k_analysisCacheSize) {
+            cacheTimes[vertex] = time++;
+            ++transformedCount;
+        }
+        if (!used[vertex]) {
+            used[vertex] = true;
+            ++usedCount;
+        }
+    }
+
+    statistics.acmr = static_cast<float>(transformedCount) / static_cast<float>(indices.size() / 3);
+    statistics.atvr = static_cast<float>(transformedCount) / static_cast<float>(usedCount);
+    return statistics;
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>* clusters)
+{
+    RDE_PROFILE_SCOPE
+
+    tipsify(indices.data(), indices.size(), vertexCount, clusters);
+}
+
+void optimizeOverdraw(std::vector<uint32_t>& indices,
+                      const std::vector<Vertex>& vertices,
+                      const std::vector<uint32_t>& clusters,
+                      float threshold)
+{
+    RDE_PROFILE_SCOPE
+
+    if (clusters.size() < 2) {
+        return;
+    }
+    const auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+    struct Cluster
+    {
+        uint32_t firstTriangle = 0;
+        uint32_t triangleCount = 0;
+        glm::vec3 centroid{};
+        glm::vec3 normal{}; // Area weighted
+        float sortKey = 0.0f;
+    };
+    std::vector<Cluster> sortedClusters(clusters.size());
+
+    // Area weighted, so densely tessellated parts don't pull the center towards them
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        auto& cluster = sortedClusters[i];
+        cluster.firstTriangle = clusters[i];
+        cluster.triangleCount = (i + 1 < clusters.size() ? clusters[i + 1] : triangleCount) - clusters[i];
+
+        float clusterArea = 0.0f;
+        for (uint32_t triangle = cluster.firstTriangle; triangle < cluster.firstTriangle + cluster.triangleCount;
+             ++triangle) {
+            const glm::vec3& a = vertices[indices[triangle * 3]].pos;
+            const glm::vec3& b = vertices[indices[triangle * 3 + 1]].pos;
+            const glm::vec3& c = vertices[indices[triangle * 3 + 2]].pos;
+
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float area = glm::length(normal);
+            cluster.normal += normal;
+            cluster.centroid += (a + b + c) * (area / 3.0f);
+            clusterArea += area;
+        }
+        meshCentroid += cluster.centroid;
+        meshArea += clusterArea;
+        if (clusterArea > 0.0f) {
+            cluster.centroid /= clusterArea;
+        }
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    for (auto& cluster : sortedClusters) {
+        const float normalLength = glm::length(cluster.normal);
+        if (normalLength > 0.0f) {
+            cluster.sortKey = glm::dot(cluster.centroid - meshCentroid, cluster.normal / normalLength);
+        }
+    }
+    std::stable_sort(sortedClusters.begin(), sortedClusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<uint32_t> reordered;
+    reordered.reserve(indices.size());
+    for (const auto& cluster : sortedClusters) {
+        reordered.insert(reordered.end(),
+                         indices.begin() + cluster.firstTriangle * 3,
+                         indices.begin() + (cluster.firstTriangle + cluster.triangleCount) * 3);
+    }
+
+    const float acmr = analyzeVertexCache(indices, vertices.size()).acmr;
+    if (analyzeVertexCache(reordered, vertices.size()).acmr <= acmr * threshold) {
+        indices.swap(reordered);
+    }
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+    RDE_PROFILE_SCOPE
+
+    std::vector<uint32_t> remap(vertices.size(), k_invalidVertex);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (auto& index : indices) {
+        if (remap[index] == k_invalidVertex) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+void optimizeMeshletVertexCache(std::vector<uint32_t>& indices,
+                                const std::vector<Meshlet>& meshlets,
+                                size_t vertexCount)
+{
+    RDE_PROFILE_SCOPE
+
+    // Meshlets only use a few vertices, they are optimized with local vertex ids to keep the adjacency small
+    std::vector<uint32_t> localVertices(vertexCount, k_invalidVertex);
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint32_t> localIndices;
+
+    for (const auto& meshlet : meshlets) {
+        meshletVertices.clear();
+        localIndices.clear();
+
+        for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; ++i) {
+            const uint32_t vertex = indices[i];
+            if (localVertices[vertex] == k_invalidVertex) {
+                localVertices[vertex] = static_cast<uint32_t>(meshletVertices.size());
+                meshletVertices.push_back(vertex);
+            }
+            localIndices.push_back(localVertices[vertex]);
+        }
+
+        tipsify(localIndices.data(), localIndices.size(), meshletVertices.size(), nullptr);
+
+        for (uint32_t i = 0; i < meshlet.indexCount; ++i) {
+            indices[meshlet.firstIndex + i] = meshletVertices[localIndices[i]];
+        }
+        for (const uint32_t vertex : meshletVertices) {
+            localVertices[vertex] = k_invalidVertex;
+        }
+    }
+}
+
+} // namespace MeshOptimizer
+} // namespace Vulkan
+} // namespace RDE
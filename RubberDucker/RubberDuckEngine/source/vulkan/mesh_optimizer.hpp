@@ -0,0 +1,44 @@
+#pragma once
+
+#include "data_types/meshlet.hpp"
+#include "data_types/vertex.hpp"
+
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+namespace MeshOptimizer {
+
+// Post-transform cache efficiency of an index buffer, simulated with a FIFO cache of k_analysisCacheSize entries
+struct VertexCacheStatistics
+{
+    float acmr = 0.0f; // Average cache miss ratio, vertices transformed per triangle. 0.5 at best, 3 at worst
+    float atvr = 0.0f; // Average transformed vertex ratio, vertices transformed per vertex used. 1 at best
+};
+
+constexpr uint32_t k_analysisCacheSize = 16;
+
+[[nodiscard]] VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+// Tipsify (Sander et al. 2007), fans around the most recently used vertex that is still cached. Fills clusters with the
+// first triangle of every run that had to jump somewhere non-local, which is where optimizeOverdraw may reorder
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>* clusters = nullptr);
+
+// Draws the clusters facing away from the mesh center first, they tend to occlude the rest. Kept only if the ACMR grows
+// by less than the threshold, e.g. 1.05 for 5%
+void optimizeOverdraw(std::vector<uint32_t>& indices,
+                      const std::vector<Vertex>& vertices,
+                      const std::vector<uint32_t>& clusters,
+                      float threshold);
+
+// Orders the vertices by first use, so consecutive vertex fetches hit the same cache lines. Drops unused vertices
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+// optimizeVertexCache within each meshlet, building the meshlets reorders the triangles of the whole mesh
+void optimizeMeshletVertexCache(std::vector<uint32_t>& indices,
+                                const std::vector<Meshlet>& meshlets,
+                                size_t vertexCount);
+
+} // namespace MeshOptimizer
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,215 @@
+#include "precompiled/pch.hpp"
+
+#include "meshlet_builder.hpp"
+
+#include "utilities/clock.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace RDE {
+namespace Vulkan {
+namespace MeshletBuilder {
+
+namespace {
+// Cones whose triangles face more than ~84 degrees apart can only be culled from so few directions it isn't worth it
+constexpr float k_minConeDot = 0.1f;
+
+void calculateBounds(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Meshlet& meshlet)
+{
+    glm::vec3 minPos(std::numeric_limits<float>::max());
+    glm::vec3 maxPos(std::numeric_limits<float>::lowest());
+    glm::vec3 normalSum(0.0f);
+
+    const uint32_t lastIndex = meshlet.firstIndex + meshlet.indexCount;
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.indexCount / 3);
+
+    for (uint32_t index = meshlet.firstIndex; index < lastIndex; index += 3) {
+        const glm::vec3& a = vertices[indices[index]].pos;
+        const glm::vec3& b = vertices[indices[index + 1]].pos;
+        const glm::vec3& c = vertices[indices[index + 2]].pos;
+
+        minPos = glm::min(minPos, glm::min(a, glm::min(b, c)));
+        maxPos = glm::max(maxPos, glm::max(a, glm::max(b, c)));
+
+        // Counter-clockwise triangles face the viewer, matching the pipelines' front face
+        const glm::vec3 normal = glm::cross(b - a, c - a);
+        const float length = glm::length(normal);
+        if (length > 0.0f) {
+            normals.push_back(normal / length);
+            normalSum += normals.back();
+        }
+    }
+
+    const glm::vec3 center = (minPos + maxPos) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t index = meshlet.firstIndex; index < lastIndex; ++index) {
+        radius = glm::max(radius, glm::distance(center, vertices[indices[index]].pos));
+    }
+    meshlet.boundingSphere = glm::vec4(center, radius);
+
+    const float axisLength = glm::length(normalSum);
+    if (axisLength == 0.0f) {
+        return;
+    }
+    meshlet.coneAxis = normalSum / axisLength;
+
+    float minDot = 1.0f;
+    for (const auto& normal : normals) {
+        minDot = glm::min(minDot, glm::dot(meshlet.coneAxis, normal));
+    }
+    if (minDot > k_minConeDot) {
+        meshlet.coneCutoff = glm::sqrt(1.0f - minDot * minDot);
+    }
+}
+} // namespace
+
+[[nodiscard]] std::vector<Meshlet> build(const std::vector<Vertex>& vertices,
+                                         std::vector<uint32_t>& indices,
+                                         const std::vector<Submesh>& submeshes)
+{
+    RDE_PROFILE_SCOPE
+
+    std::vector<Meshlet> meshlets;
+
+    // Meshlet each vertex was last added to, so counting unique vertices needs no search
+    std::vector<uint32_t> vertexMeshlets(vertices.size(), std::numeric_limits<uint32_t>::max());
+
+    std::vector<uint32_t> triangleOffsets;
+    std::vector<uint32_t> vertexTriangles;
+    std::vector<bool> emitted;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> reordered;
+
+    for (const auto& submesh : submeshes) {
+        const uint32_t triangleCount = submesh.indexCount / 3;
+        const uint32_t* submeshIndices = indices.data() + submesh.firstIndex;
+        const auto vertexIndex = [&](uint32_t triangle, uint32_t corner) {
+            return submeshIndices[triangle * 3 + corner] - static_cast<uint32_t>(submesh.vertexOffset);
+        };
+
+        // Triangles using each vertex of the submesh, vertices are relative to its vertex offset
+        uint32_t vertexRange = 0;
+        for (uint32_t triangle = 0; triangle < triangleCount; ++triangle) {
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                vertexRange = std::max(vertexRange, vertexIndex(triangle, corner) + 1);
+            }
+        }
+        triangleOffsets.assign(vertexRange + 1, 0);
+        for (uint32_t triangle = 0; triangle < triangleCount; ++triangle) {
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                ++triangleOffsets[vertexIndex(triangle, corner) + 1];
+            }
+        }
+        for (uint32_t vertex = 0; vertex < vertexRange; ++vertex) {
+            triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+        }
+        vertexTriangles.resize(triangleCount * 3);
+        std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        for (uint32_t triangle = 0; triangle < triangleCount; ++triangle) {
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                vertexTriangles[fill[vertexIndex(triangle, corner)]++] = triangle;
+            }
+        }
+
+        emitted.assign(triangleCount, false);
+        reordered.clear();
+        uint32_t seed = 0;
+
+        // Each meshlet starts at the first triangle not yet emitted and grows over shared vertices, preferring the
+        // triangles that add the fewest new ones. That keeps meshlets compact, so their normal cones stay narrow
+        while (true) {
+            while (seed < triangleCount && emitted[seed]) {
+                ++seed;
+            }
+            if (seed == triangleCount) {
+                break;
+            }
+
+            auto& meshlet = meshlets.emplace_back();
+            meshlet.firstIndex = submesh.firstIndex + static_cast<uint32_t>(reordered.size());
+            meshlet.vertexOffset = submesh.vertexOffset;
+            const auto meshletId = static_cast<uint32_t>(meshlets.size()) - 1;
+
+            const auto newVertexCount = [&](uint32_t triangle) {
+                uint32_t count = 0;
+                for (uint32_t corner = 0; corner < 3; ++corner) {
+                    count += vertexMeshlets[submeshIndices[triangle * 3 + corner]] != meshletId ? 1 : 0;
+                }
+                return count;
+            };
+
+            const auto centroid = [&](uint32_t triangle) {
+                return (vertices[submeshIndices[triangle * 3]].pos + vertices[submeshIndices[triangle * 3 + 1]].pos +
+                        vertices[submeshIndices[triangle * 3 + 2]].pos) /
+                       3.0f;
+            };
+
+            uint32_t vertexCount = 0;
+            uint32_t next = seed;
+            glm::vec3 centroidSum(0.0f);
+            candidates.clear();
+
+            while (next != std::numeric_limits<uint32_t>::max()) {
+                emitted[next] = true;
+                centroidSum += centroid(next);
+                for (uint32_t corner = 0; corner < 3; ++corner) {
+                    reordered.push_back(submeshIndices[next * 3 + corner]);
+
+                    const uint32_t vertex = submeshIndices[next * 3 + corner];
+                    if (vertexMeshlets[vertex] == meshletId) {
+                        continue;
+                    }
+                    vertexMeshlets[vertex] = meshletId;
+                    ++vertexCount;
+
+                    const uint32_t local = vertexIndex(next, corner);
+                    candidates.insert(candidates.end(),
+                                      vertexTriangles.begin() + triangleOffsets[local],
+                                      vertexTriangles.begin() + triangleOffsets[local + 1]);
+                }
+                meshlet.indexCount += 3;
+                if (meshlet.indexCount == k_maxMeshletTriangles * 3) {
+                    break;
+                }
+
+                // Ties go to the triangle closest to the meshlet's center. Emitted candidates are dropped on the way
+                const glm::vec3 center = centroidSum / static_cast<float>(meshlet.indexCount / 3);
+                next = std::numeric_limits<uint32_t>::max();
+                uint32_t bestNewVertexCount = 4;
+                float bestDistance = std::numeric_limits<float>::max();
+                uint32_t kept = 0;
+                for (const uint32_t candidate : candidates) {
+                    if (emitted[candidate]) {
+                        continue;
+                    }
+                    candidates[kept++] = candidate;
+
+                    const uint32_t count = newVertexCount(candidate);
+                    if (count > bestNewVertexCount || vertexCount + count > k_maxMeshletVertices) {
+                        continue;
+                    }
+                    const glm::vec3 offset = centroid(candidate) - center;
+                    const float distance = glm::dot(offset, offset);
+                    if (count < bestNewVertexCount || distance < bestDistance) {
+                        bestNewVertexCount = count;
+                        bestDistance = distance;
+                        next = candidate;
+                    }
+                }
+                candidates.resize(kept);
+            }
+        }
+        std::copy(reordered.begin(), reordered.end(), indices.begin() + submesh.firstIndex);
+    }
+
+    for (auto& meshlet : meshlets) {
+        calculateBounds(vertices, indices, meshlet);
+    }
+    return meshlets;
+}
+
+} // namespace MeshletBuilder
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "data_types/mesh.hpp"
+#include "data_types/meshlet.hpp"
+
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+namespace MeshletBuilder {
+
+// Splits each submesh into meshlets of at most k_maxMeshletVertices unique vertices and k_maxMeshletTriangles
+// triangles, grown over shared vertices. Triangles are reordered within their submesh so every meshlet is a contiguous
+// range of the indices, the submeshes themselves are unchanged
+[[nodiscard]] std::vector<Meshlet> build(const std::vector<Vertex>& vertices,
+                                         std::vector<uint32_t>& indices,
+                                         const std::vector<Submesh>& submeshes);
+
+} // namespace MeshletBuilder
+} // namespace Vulkan
+} // namespace RDE
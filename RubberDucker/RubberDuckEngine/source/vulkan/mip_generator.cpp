@@ -0,0 +1,374 @@
+#include "precompiled/pch.hpp"
+
+#include "mip_generator.hpp"
+
+#include "utilities/clock.hpp"
+#include "utilities/thread_pool.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RDE_MIP_GENERATOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace RDE {
+namespace Vulkan {
+namespace MipGenerator {
+
+namespace {
+constexpr uint32_t k_channelCount = 4;
+constexpr int32_t k_kaiserTapCount = 6;
+constexpr float k_kaiserAlpha = 4.0f;          // Window shape, higher trades sharpness for less ringing
+constexpr uint32_t k_srgbEncodeSize = 1 << 13; // Linear values are quantized to this many steps before encoding
+constexpr size_t k_minTexelsPerChunk = 16384;  // Below this, waking workers costs more than it saves
+
+// A level in linear floating point RGBA
+struct Image
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> texels;
+
+    void resize(uint32_t newWidth, uint32_t newHeight)
+    {
+        width = newWidth;
+        height = newHeight;
+        texels.resize(static_cast<size_t>(width) * height * k_channelCount);
+    }
+
+    [[nodiscard]] float* texel(uint32_t x, uint32_t y)
+    {
+        return texels.data() + (static_cast<size_t>(y) * width + x) * k_channelCount;
+    }
+
+    [[nodiscard]] const float* texel(uint32_t x, uint32_t y) const
+    {
+        return texels.data() + (static_cast<size_t>(y) * width + x) * k_channelCount;
+    }
+};
+
+// One texel, all four channels at once
+#ifdef RDE_MIP_GENERATOR_SSE2
+using Vec4 = __m128;
+
+inline Vec4 load(const float* texel) { return _mm_loadu_ps(texel); }
+inline void store(float* texel, Vec4 value) { _mm_storeu_ps(texel, value); }
+inline Vec4 splat(float value) { return _mm_set1_ps(value); }
+inline Vec4 add(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+inline Vec4 mul(Vec4 a, Vec4 b) { return _mm_mul_ps(a, b); }
+
+// Clamps to [0, 1], scales and rounds to the nearest integer
+inline void quantize(Vec4 value, Vec4 scale, int32_t* result)
+{
+    const Vec4 clamped = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result), _mm_cvtps_epi32(_mm_mul_ps(clamped, scale)));
+}
+#else
+using Vec4 = glm::vec4;
+
+inline Vec4 load(const float* texel) { return Vec4(texel[0], texel[1], texel[2], texel[3]); }
+inline void store(float* texel, Vec4 value) { std::memcpy(texel, &value, sizeof(Vec4)); }
+inline Vec4 splat(float value) { return Vec4(value); }
+inline Vec4 add(Vec4 a, Vec4 b) { return a + b; }
+inline Vec4 mul(Vec4 a, Vec4 b) { return a * b; }
+
+inline void quantize(Vec4 value, Vec4 scale, int32_t* result)
+{
+    const Vec4 scaled = glm::round(glm::clamp(value, 0.0f, 1.0f) * scale);
+    for (uint32_t channel = 0; channel < k_channelCount; ++channel) {
+        result[channel] = static_cast<int32_t>(scaled[channel]);
+    }
+}
+#endif
+
+[[nodiscard]] const std::array<float, 256>& srgbToLinearTable()
+{
+    static const auto table = [] {
+        std::array<float, 256> values{};
+        for (uint32_t i = 0; i < values.size(); ++i) {
+            const float srgb = static_cast<float>(i) / 255.0f;
+            values[i] = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+[[nodiscard]] const std::array<uint8_t, k_srgbEncodeSize>& linearToSrgbTable()
+{
+    static const auto table = [] {
+        std::array<uint8_t, k_srgbEncodeSize> values{};
+        for (uint32_t i = 0; i < values.size(); ++i) {
+            const float linear = static_cast<float>(i) / (k_srgbEncodeSize - 1);
+            const float srgb =
+                linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+            values[i] = static_cast<uint8_t>(std::lround(std::clamp(srgb, 0.0f, 1.0f) * 255.0f));
+        }
+        return values;
+    }();
+    return table;
+}
+
+// Zeroth order modified Bessel function of the first kind, for the Kaiser window
+[[nodiscard]] double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; term > sum * 1e-12; ++k) {
+        const double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+// Taps at source texels 2x - 2 to 2x + 3, centered between the two texels a box filter would average. The sinc is
+// stretched by the downsampling factor of 2 so it cuts off at the new Nyquist frequency
+[[nodiscard]] const std::array<float, k_kaiserTapCount>& kaiserWeights()
+{
+    static const auto weights = [] {
+        constexpr double pi = 3.14159265358979323846;
+        constexpr double radius = k_kaiserTapCount / 2.0;
+
+        std::array<double, k_kaiserTapCount> taps{};
+        double total = 0.0;
+        for (int32_t tap = 0; tap < k_kaiserTapCount; ++tap) {
+            const double distance = tap - (k_kaiserTapCount - 1) / 2.0;
+            const double x = distance / 2.0;
+            const double sinc = std::sin(pi * x) / (pi * x);
+            const double t = distance / radius;
+            const double window = besselI0(k_kaiserAlpha * std::sqrt(1.0 - t * t)) / besselI0(k_kaiserAlpha);
+            taps[tap] = sinc * window;
+            total += taps[tap];
+        }
+
+        std::array<float, k_kaiserTapCount> normalized{};
+        for (int32_t tap = 0; tap < k_kaiserTapCount; ++tap) {
+            normalized[tap] = static_cast<float>(taps[tap] / total);
+        }
+        return normalized;
+    }();
+    return weights;
+}
+
+// Samplers repeat, so the filter wraps around the edges as well
+[[nodiscard]] uint32_t wrap(int64_t coordinate, uint32_t size)
+{
+    const auto signedSize = static_cast<int64_t>(size);
+    return static_cast<uint32_t>((coordinate % signedSize + signedSize) % signedSize);
+}
+
+// Runs the callable over ranges of rows, the first range on the calling thread
+template<typename TCallable>
+void forEachRowChunk(uint32_t rowCount, uint32_t rowWidth, ThreadPool* threadPool, const TCallable& callable)
+{
+    const size_t texelCount = static_cast<size_t>(rowCount) * rowWidth;
+    const size_t maxChunkCount = std::min<size_t>(threadPool ? threadPool->threadCount() + 1 : 1, rowCount);
+    const size_t chunkCount = std::clamp(texelCount / k_minTexelsPerChunk, size_t{1}, maxChunkCount);
+    const auto rowsPerChunk = static_cast<uint32_t>((rowCount + chunkCount - 1) / chunkCount);
+
+    const auto runChunk = [&callable, rowCount, rowsPerChunk](size_t chunk) {
+        const auto begin = static_cast<uint32_t>(chunk * rowsPerChunk);
+        callable(begin, std::min(rowCount, begin + rowsPerChunk));
+    };
+
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(chunkCount - 1);
+
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+        tasks.emplace_back(threadPool->submit([&runChunk, chunk]() { runChunk(chunk); }));
+    }
+    runChunk(0);
+
+    for (auto& task : tasks) {
+        task.wait();
+    }
+}
+
+[[nodiscard]] Image decode(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb, ThreadPool* threadPool)
+{
+    const auto& toLinear = srgbToLinearTable();
+
+    Image image{};
+    image.resize(width, height);
+
+    forEachRowChunk(height, width, threadPool, [&](uint32_t beginRow, uint32_t endRow) {
+        const size_t begin = static_cast<size_t>(beginRow) * width * k_channelCount;
+        const size_t end = static_cast<size_t>(endRow) * width * k_channelCount;
+
+        for (size_t i = begin; i < end; i += k_channelCount) {
+            for (uint32_t channel = 0; channel < 3; ++channel) {
+                image.texels[i + channel] =
+                    srgb ? toLinear[pixels[i + channel]] : static_cast<float>(pixels[i + channel]) / 255.0f;
+            }
+            image.texels[i + 3] = static_cast<float>(pixels[i + 3]) / 255.0f;
+        }
+    });
+    return image;
+}
+
+void encode(const Image& image, uint8_t* pixels, bool srgb, ThreadPool* threadPool)
+{
+    const auto& toSrgb = linearToSrgbTable();
+    const float colorScale = srgb ? static_cast<float>(k_srgbEncodeSize - 1) : 255.0f;
+#ifdef RDE_MIP_GENERATOR_SSE2
+    const Vec4 scale = _mm_setr_ps(colorScale, colorScale, colorScale, 255.0f);
+#else
+    const Vec4 scale = Vec4(colorScale, colorScale, colorScale, 255.0f);
+#endif
+
+    forEachRowChunk(image.height, image.width, threadPool, [&](uint32_t beginRow, uint32_t endRow) {
+        const size_t begin = static_cast<size_t>(beginRow) * image.width * k_channelCount;
+        const size_t end = static_cast<size_t>(endRow) * image.width * k_channelCount;
+
+        alignas(16) int32_t quantized[k_channelCount];
+        for (size_t i = begin; i < end; i += k_channelCount) {
+            quantize(load(image.texels.data() + i), scale, quantized);
+            for (uint32_t channel = 0; channel < 3; ++channel) {
+                pixels[i + channel] = srgb ? toSrgb[quantized[channel]] : static_cast<uint8_t>(quantized[channel]);
+            }
+            pixels[i + 3] = static_cast<uint8_t>(quantized[3]);
+        }
+    });
+}
+
+// Odd sizes drop their last row or column, like the GPU's own box downsampling
+[[nodiscard]] Image downsampleBox(const Image& source, ThreadPool* threadPool)
+{
+    Image destination{};
+    destination.resize(std::max(source.width / 2, 1u), std::max(source.height / 2, 1u));
+
+    const Vec4 quarter = splat(0.25f);
+
+    forEachRowChunk(destination.height, destination.width, threadPool, [&](uint32_t beginRow, uint32_t endRow) {
+        for (uint32_t y = beginRow; y < endRow; ++y) {
+            const uint32_t y0 = std::min(y * 2, source.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+
+            for (uint32_t x = 0; x < destination.width; ++x) {
+                const uint32_t x0 = std::min(x * 2, source.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+
+                const Vec4 top = add(load(source.texel(x0, y0)), load(source.texel(x1, y0)));
+                const Vec4 bottom = add(load(source.texel(x0, y1)), load(source.texel(x1, y1)));
+                store(destination.texel(x, y), mul(add(top, bottom), quarter));
+            }
+        }
+    });
+    return destination;
+}
+
+// Separable, horizontally into the scratch image and then vertically. A dimension that is already 1 is copied
+[[nodiscard]] Image downsampleKaiser(const Image& source, Image& scratch, ThreadPool* threadPool)
+{
+    const auto& weights = kaiserWeights();
+    const uint32_t width = std::max(source.width / 2, 1u);
+    const uint32_t height = std::max(source.height / 2, 1u);
+
+    if (source.width == 1) {
+        scratch = source;
+    } else {
+        scratch.resize(width, source.height);
+
+        forEachRowChunk(source.height, width, threadPool, [&](uint32_t beginRow, uint32_t endRow) {
+            for (uint32_t y = beginRow; y < endRow; ++y) {
+                for (uint32_t x = 0; x < width; ++x) {
+                    const int64_t first = static_cast<int64_t>(x) * 2 - (k_kaiserTapCount / 2 - 1);
+
+                    Vec4 sum = splat(0.0f);
+                    for (int32_t tap = 0; tap < k_kaiserTapCount; ++tap) {
+                        const Vec4 texel = load(source.texel(wrap(first + tap, source.width), y));
+                        sum = add(sum, mul(texel, splat(weights[tap])));
+                    }
+                    store(scratch.texel(x, y), sum);
+                }
+            }
+        });
+    }
+
+    if (source.height == 1) {
+        return scratch;
+    }
+
+    Image destination{};
+    destination.resize(width, height);
+
+    forEachRowChunk(height, width, threadPool, [&](uint32_t beginRow, uint32_t endRow) {
+        for (uint32_t y = beginRow; y < endRow; ++y) {
+            const int64_t first = static_cast<int64_t>(y) * 2 - (k_kaiserTapCount / 2 - 1);
+
+            for (uint32_t x = 0; x < width; ++x) {
+                Vec4 sum = splat(0.0f);
+                for (int32_t tap = 0; tap < k_kaiserTapCount; ++tap) {
+                    const Vec4 texel = load(scratch.texel(x, wrap(first + tap, scratch.height)));
+                    sum = add(sum, mul(texel, splat(weights[tap])));
+                }
+                store(destination.texel(x, y), sum);
+            }
+        }
+    });
+    return destination;
+}
+} // namespace
+
+[[nodiscard]] Ktx2Texture generate(const uint8_t* pixels,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   VkFormat format,
+                                   bool mipmaps,
+                                   Filter filter,
+                                   ThreadPool* threadPool)
+{
+    RDE_PROFILE_SCOPE
+
+    RDE_ASSERT_0(format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_R8G8B8A8_UNORM,
+                 "Mips can only be generated for RGBA8, not {}!",
+                 static_cast<uint32_t>(format));
+    const bool srgb = format == VK_FORMAT_R8G8B8A8_SRGB;
+
+    Ktx2Texture texture{};
+    texture.format = format;
+    texture.width = width;
+    texture.height = height;
+    texture.levels.resize(mipmaps ? levelCount(width, height) : 1);
+
+    size_t dataSize = 0;
+    for (uint32_t level = 0; level < texture.levels.size(); ++level) {
+        auto& textureLevel = texture.levels[level];
+        textureLevel.width = std::max(width >> level, 1u);
+        textureLevel.height = std::max(height >> level, 1u);
+        textureLevel.offset = dataSize;
+        textureLevel.size = Ktx2Texture::levelSize(format, textureLevel.width, textureLevel.height);
+        dataSize += textureLevel.size;
+    }
+    texture.data.resize(dataSize);
+
+    // Level 0 is copied as is rather than round-tripped through floats
+    std::memcpy(texture.data.data(), pixels, texture.levels[0].size);
+
+    if (texture.levels.size() == 1) {
+        return texture;
+    }
+
+    // Every level is filtered from the previous one in full precision, only the output is quantized
+    Image image = decode(pixels, width, height, srgb, threadPool);
+    Image scratch{};
+
+    for (uint32_t level = 1; level < texture.levels.size(); ++level) {
+        image = filter == Filter::Box ? downsampleBox(image, threadPool) : downsampleKaiser(image, scratch, threadPool);
+        encode(image, texture.data.data() + texture.levels[level].offset, srgb, threadPool);
+    }
+    return texture;
+}
+
+[[nodiscard]] uint32_t levelCount(uint32_t width, uint32_t height)
+{
+    return static_cast<uint32_t>(std::floor(std::log2(std::max({width, height, 1u})))) + 1;
+}
+
+} // namespace MipGenerator
+} // namespace Vulkan
+} // namespace RDE
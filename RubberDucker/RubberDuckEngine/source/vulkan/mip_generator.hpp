@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ktx2.hpp"
+
+namespace RDE {
+class ThreadPool;
+
+namespace Vulkan {
+namespace MipGenerator {
+
+enum class Filter
+{
+    Box,    // 2x2 average, cheapest but soft and aliases on fine detail
+    Kaiser, // Kaiser-windowed sinc over 6 taps, sharper without much ringing
+};
+
+// Builds the mip chain of an RGBA8 image on the CPU, or only level 0 if mipmaps is false. For the sRGB format the
+// color channels are linearized before filtering and re-encoded after, alpha is always filtered as is. Rows are split
+// over the pool and filtered 4 channels at a time with SSE2 where available
+[[nodiscard]] Ktx2Texture generate(const uint8_t* pixels,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   VkFormat format,
+                                   bool mipmaps,
+                                   Filter filter = Filter::Kaiser,
+                                   ThreadPool* threadPool = nullptr);
+
+// Down to and including 1x1
+[[nodiscard]] uint32_t levelCount(uint32_t width, uint32_t height);
+
+} // namespace MipGenerator
+} // namespace Vulkan
+} // namespace RDE
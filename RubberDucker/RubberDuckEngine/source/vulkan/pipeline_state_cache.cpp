@@ -0,0 +1,150 @@
+#include "precompiled/pch.hpp"
+
+#include "pipeline_state_cache.hpp"
+
+#include "utilities/thread_pool.hpp"
+#include "utilities/utilities.hpp"
+
+namespace RDE {
+namespace Vulkan {
+
+void PipelineStateCache::init(VkDevice device,
+                              VkAllocationCallbacks* allocator,
+                              VkPipelineLayout pipelineLayout,
+                              VkPipelineCache pipelineCache,
+                              ThreadPool& threadPool)
+{
+    m_device = device;
+    m_allocator = allocator;
+    m_pipelineLayout = pipelineLayout;
+    m_pipelineCache = pipelineCache;
+    m_threadPool = &threadPool;
+}
+
+void PipelineStateCache::clear()
+{
+    for (auto& pipeline : release()) {
+        pipeline.destroy(m_device, m_allocator);
+    }
+}
+
+[[nodiscard]] std::vector<Pipeline> PipelineStateCache::release()
+{
+    waitForCompiles();
+
+    std::vector<Pipeline> pipelines;
+    pipelines.reserve(m_pipelines.size());
+    for (auto& [stateHash, entry] : m_pipelines) {
+        pipelines.push_back(entry->pipeline);
+    }
+    m_pipelines.clear();
+    return pipelines;
+}
+
+void PipelineStateCache::waitForCompiles()
+{
+    for (auto& [stateHash, entry] : m_pipelines) {
+        if (entry->compile.valid()) {
+            entry->compile.wait();
+        }
+    }
+}
+
+[[nodiscard]] const Pipeline& PipelineStateCache::get(const PipelineState& state)
+{
+    const auto stateHash = hash(state);
+    Entry* entry = find(state, stateHash);
+
+    if (!entry) {
+        entry = &emplace(state, stateHash);
+        compile(*entry);
+        entry->ready = true;
+    } else if (!entry->ready) {
+        // Already compiling in the background, block until it's done
+        entry->compile.wait();
+        entry->ready = poll(*entry);
+    }
+    return entry->pipeline;
+}
+
+[[nodiscard]] const Pipeline* PipelineStateCache::tryGet(const PipelineState& state)
+{
+    const auto stateHash = hash(state);
+    Entry* entry = find(state, stateHash);
+
+    if (!entry) {
+        entry = &emplace(state, stateHash);
+        entry->compile = m_threadPool->submit([this, entry]() { compile(*entry); });
+        return nullptr;
+    }
+    if (!entry->ready) {
+        entry->ready = poll(*entry);
+    }
+    return entry->ready ? &entry->pipeline : nullptr;
+}
+
+[[nodiscard]] uint32_t PipelineStateCache::pipelineCount() const
+{
+    return static_cast<uint32_t>(m_pipelines.size());
+}
+
+[[nodiscard]] uint32_t PipelineStateCache::pendingCount() const
+{
+    return static_cast<uint32_t>(std::count_if(
+        m_pipelines.begin(), m_pipelines.end(), [](const auto& pipeline) { return !pipeline.second->ready; }));
+}
+
+[[nodiscard]] uint64_t PipelineStateCache::hash(const PipelineState& state)
+{
+    uint64_t stateHash = std::hash<std::string>{}(state.vertexShaderPath);
+    stateHash = Utilities::hashCombine(stateHash, std::hash<std::string>{}(state.fragmentShaderPath));
+    stateHash = Utilities::hashCombine(stateHash, static_cast<uint64_t>(state.vertexLayout));
+    stateHash = Utilities::hashCombine(stateHash, state.vertexFormat.key());
+    stateHash = Utilities::hashCombine(stateHash, static_cast<uint64_t>(state.instanceEncoding));
+    stateHash = Utilities::hashCombine(stateHash, static_cast<uint64_t>(state.blendMode));
+    stateHash = Utilities::hashCombine(stateHash, state.depthTestEnable);
+    stateHash = Utilities::hashCombine(stateHash, state.depthWriteEnable);
+    stateHash = Utilities::hashCombine(stateHash, state.depthCompareOp);
+    stateHash = Utilities::hashCombine(stateHash, state.cullMode);
+    stateHash = Utilities::hashCombine(stateHash, state.polygonMode);
+    stateHash = Utilities::hashCombine(stateHash, state.msaaSamples);
+
+    return stateHash;
+}
+
+PipelineStateCache::Entry* PipelineStateCache::find(const PipelineState& state, uint64_t stateHash)
+{
+    // Compare full states in case two of them hash to the same value
+    const auto [begin, end] = m_pipelines.equal_range(stateHash);
+    for (auto it = begin; it != end; ++it) {
+        if (it->second->state == state) {
+            return it->second.get();
+        }
+    }
+    return nullptr;
+}
+
+PipelineStateCache::Entry& PipelineStateCache::emplace(const PipelineState& state, uint64_t stateHash)
+{
+    auto entry = std::make_unique<Entry>();
+    entry->state = state;
+
+    return *m_pipelines.emplace(stateHash, std::move(entry))->second;
+}
+
+void PipelineStateCache::compile(Entry& entry)
+{
+    entry.pipeline.create(m_device, m_allocator, entry.state, m_pipelineLayout, m_pipelineCache);
+}
+
+[[nodiscard]] bool PipelineStateCache::poll(Entry& entry)
+{
+    if (entry.compile.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+    entry.compile.get();
+    return true;
+}
+
+} // namespace Vulkan
+} // namespace RDE
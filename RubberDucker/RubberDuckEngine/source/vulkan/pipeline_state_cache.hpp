@@ -0,0 +1,73 @@
+#pragma once
+
+#include "data_types/pipeline.hpp"
+#include "data_types/pipeline_state.hpp"
+
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace RDE {
+class ThreadPool;
+
+namespace Vulkan {
+
+// Graphics pipelines keyed by a hash of their PipelineState, created lazily on first use.
+// Lookups and clearing are meant for the main thread only, compiles may run on the thread pool.
+class PipelineStateCache
+{
+public:
+    void init(VkDevice device,
+              VkAllocationCallbacks* allocator,
+              VkPipelineLayout pipelineLayout,
+              VkPipelineCache pipelineCache,
+              ThreadPool& threadPool);
+
+    // Waits for background compiles, then destroys every pipeline, e.g. when attachment formats change
+    void clear();
+
+    // Waits for background compiles, then hands every pipeline over to the caller, who destroys them once no frame
+    // in flight uses them anymore
+    [[nodiscard]] std::vector<Pipeline> release();
+
+    // Background compiles use the render pass of the state that started them, which has to outlive them
+    void waitForCompiles();
+
+    // Returns the pipeline for the state, compiling it on the calling thread if it doesn't exist yet
+    [[nodiscard]] const Pipeline& get(const PipelineState& state);
+
+    // Returns nullptr while the pipeline is compiling in the background. The first request starts the compile
+    [[nodiscard]] const Pipeline* tryGet(const PipelineState& state);
+
+    [[nodiscard]] uint32_t pipelineCount() const;
+    [[nodiscard]] uint32_t pendingCount() const;
+
+    [[nodiscard]] static uint64_t hash(const PipelineState& state);
+
+private:
+    struct Entry
+    {
+        PipelineState state{};
+        Pipeline pipeline{};
+        std::future<void> compile;
+        bool ready = false;
+    };
+
+    Entry* find(const PipelineState& state, uint64_t stateHash);
+    Entry& emplace(const PipelineState& state, uint64_t stateHash);
+    void compile(Entry& entry);
+    [[nodiscard]] static bool poll(Entry& entry);
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkAllocationCallbacks* m_allocator = nullptr;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+    ThreadPool* m_threadPool = nullptr;
+
+    // Entries are heap allocated so background compiles can write into them while the map grows
+    std::unordered_multimap<uint64_t, std::unique_ptr<Entry>> m_pipelines;
+};
+
+} // namespace Vulkan
+} // namespace RDE
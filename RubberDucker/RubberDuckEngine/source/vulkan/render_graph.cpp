@@ -0,0 +1,864 @@
+#include "precompiled/pch.hpp"
+
+#include "render_graph.hpp"
+
+#include "gpu_profiler.hpp"
+
+#include "utilities/clock.hpp"
+
+namespace RDE {
+namespace Vulkan {
+
+void RenderGraph::init(VkDevice device, VkAllocationCallbacks* allocator, VmaAllocator vmaAllocator)
+{
+    m_device = device;
+    m_allocator = allocator;
+    m_vmaAllocator = vmaAllocator;
+}
+
+void RenderGraph::destroy()
+{
+    for (auto& pass : m_passes) {
+        for (auto framebuffer : pass.framebuffers) {
+            vkDestroyFramebuffer(m_device, framebuffer, m_allocator);
+        }
+        if (pass.renderPass != VK_NULL_HANDLE) {
+            vkDestroyRenderPass(m_device, pass.renderPass, m_allocator);
+        }
+    }
+
+    for (auto& resource : m_resources) {
+        if (resource.imported) {
+            continue;
+        }
+        for (auto imageView : resource.imageViews) {
+            vkDestroyImageView(m_device, imageView, m_allocator);
+        }
+        for (auto image : resource.images) {
+            vkDestroyImage(m_device, image, m_allocator);
+        }
+    }
+
+    for (auto& memoryBlock : m_memoryBlocks) {
+        vmaFreeMemory(m_vmaAllocator, memoryBlock.allocation);
+    }
+
+    m_passes.clear();
+    m_resources.clear();
+    m_memoryBlocks.clear();
+    m_finalBarriers.clear();
+    m_transientImageSize = 0;
+}
+
+[[nodiscard]] RenderGraph::ResourceHandle RenderGraph::createImage(std::string name, const ImageDesc& desc)
+{
+    Resource resource{};
+    resource.name = std::move(name);
+    resource.image = true;
+    resource.desc = desc;
+    m_resources.emplace_back(std::move(resource));
+
+    return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+[[nodiscard]] RenderGraph::ResourceHandle RenderGraph::importImage(std::string name,
+                                                                  const ImageDesc& desc,
+                                                                  const std::vector<VkImage>& images,
+                                                                  const std::vector<VkImageView>& imageViews,
+                                                                  VkImageLayout finalLayout)
+{
+    RDE_ASSERT_0(!images.empty() && images.size() == imageViews.size(), "Imported image {} has no views!", name);
+
+    Resource resource{};
+    resource.name = std::move(name);
+    resource.image = true;
+    resource.imported = true;
+    resource.desc = desc;
+    resource.images = images;
+    resource.imageViews = imageViews;
+    resource.finalLayout = finalLayout;
+    m_resources.emplace_back(std::move(resource));
+
+    return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+[[nodiscard]] RenderGraph::ResourceHandle RenderGraph::createBuffer(std::string name)
+{
+    Resource resource{};
+    resource.name = std::move(name);
+    m_resources.emplace_back(std::move(resource));
+
+    return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+[[nodiscard]] RenderGraph::PassHandle RenderGraph::addGraphicsPass(std::string name,
+                                                                   ExecuteCallback execute,
+                                                                   bool secondaryCommandBuffers)
+{
+    Pass pass{};
+    pass.name = std::move(name);
+    pass.execute = std::move(execute);
+    pass.graphics = true;
+    pass.secondaryCommandBuffers = secondaryCommandBuffers;
+    m_passes.emplace_back(std::move(pass));
+
+    return static_cast<PassHandle>(m_passes.size() - 1);
+}
+
+[[nodiscard]] RenderGraph::PassHandle RenderGraph::addComputePass(std::string name, ExecuteCallback execute)
+{
+    Pass pass{};
+    pass.name = std::move(name);
+    pass.execute = std::move(execute);
+    m_passes.emplace_back(std::move(pass));
+
+    return static_cast<PassHandle>(m_passes.size() - 1);
+}
+
+void RenderGraph::writeColor(PassHandle pass, ResourceHandle image, AttachmentLoad load, VkClearColorValue clearValue)
+{
+    auto& access = addAccess(pass, image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, load == AttachmentLoad::Load, true);
+    access.discard = load != AttachmentLoad::Load;
+    m_resources[image].usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    Attachment attachment{};
+    attachment.resource = image;
+    attachment.load = load;
+    attachment.clearValue.color = clearValue;
+    m_passes[pass].colorAttachments.push_back(attachment);
+}
+
+void RenderGraph::writeDepth(PassHandle pass,
+                             ResourceHandle image,
+                             AttachmentLoad load,
+                             VkClearDepthStencilValue clearValue)
+{
+    auto& access =
+        addAccess(pass, image, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, load == AttachmentLoad::Load, true);
+    access.discard = load != AttachmentLoad::Load;
+    m_resources[image].usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+    Attachment attachment{};
+    attachment.resource = image;
+    attachment.load = load;
+    attachment.clearValue.depthStencil = clearValue;
+    m_passes[pass].depthAttachment = attachment;
+    m_passes[pass].depthReadOnly = false;
+}
+
+void RenderGraph::readDepth(PassHandle pass, ResourceHandle image)
+{
+    addAccess(pass, image, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, true, false);
+    m_resources[image].usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+    Attachment attachment{};
+    attachment.resource = image;
+    attachment.load = AttachmentLoad::Load;
+    m_passes[pass].depthAttachment = attachment;
+    m_passes[pass].depthReadOnly = true;
+}
+
+void RenderGraph::writeResolve(PassHandle pass, ResourceHandle image)
+{
+    RDE_ASSERT_0(!m_passes[pass].colorAttachments.empty(), "Pass {} resolves without a color attachment!", pass);
+
+    auto& access = addAccess(pass, image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, false, true);
+    access.discard = true;
+    m_resources[image].usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    m_passes[pass].resolveAttachment = image;
+}
+
+void RenderGraph::readTexture(PassHandle pass, ResourceHandle image, VkPipelineStageFlags stages)
+{
+    auto& access = addAccess(pass, image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true, false);
+    access.stages = stages;
+    m_resources[image].usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+}
+
+void RenderGraph::readBuffer(PassHandle pass, ResourceHandle buffer, VkPipelineStageFlags stages, VkAccessFlags access)
+{
+    auto& bufferAccess = addAccess(pass, buffer, VK_IMAGE_LAYOUT_UNDEFINED, true, false);
+    bufferAccess.stages = stages;
+    bufferAccess.access = access;
+}
+
+void RenderGraph::writeBuffer(PassHandle pass, ResourceHandle buffer, VkPipelineStageFlags stages, VkAccessFlags access)
+{
+    auto& bufferAccess = addAccess(pass, buffer, VK_IMAGE_LAYOUT_UNDEFINED, false, true);
+    bufferAccess.stages = stages;
+    bufferAccess.access = access;
+}
+
+void RenderGraph::compile()
+{
+    RDE_PROFILE_SCOPE
+
+    cullPasses();
+    computeLifetimes();
+    allocateTransientImages();
+    computeBarriers();
+
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex) {
+        auto& pass = m_passes[passIndex];
+        if (pass.culled || !pass.graphics) {
+            continue;
+        }
+        createRenderPass(passIndex);
+        createFramebuffers(pass);
+    }
+
+    RDELOG_INFO("Render graph compiled: {} passes ({} culled), {} KB of transient images aliased into {} KB",
+                passCount(),
+                culledPassCount(),
+                transientImageSize() / 1024,
+                transientMemorySize() / 1024);
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer, uint32_t imageIndex, GpuProfiler* profiler) const
+{
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex) {
+        const auto& pass = m_passes[passIndex];
+        if (pass.culled) {
+            continue;
+        }
+        recordBarriers(commandBuffer, pass.barriers, imageIndex);
+
+        const auto scope = profiler ? profiler->beginScope(commandBuffer, pass.name) : GpuProfiler::k_invalidScope;
+
+        PassContext context{};
+        context.commandBuffer = commandBuffer;
+        context.imageIndex = imageIndex;
+
+        if (pass.graphics) {
+            recordRenderPass(pass, passIndex, context);
+        } else {
+            pass.execute(context);
+        }
+
+        if (profiler) {
+            profiler->endScope(commandBuffer, scope);
+        }
+    }
+    recordBarriers(commandBuffer, m_finalBarriers, imageIndex);
+}
+
+[[nodiscard]] VkRenderPass RenderGraph::renderPass(PassHandle pass) const
+{
+    return m_passes[pass].renderPass;
+}
+
+[[nodiscard]] VkFramebuffer RenderGraph::framebuffer(PassHandle pass, uint32_t imageIndex) const
+{
+    const auto& framebuffers = m_passes[pass].framebuffers;
+    return framebuffers.empty() ? VK_NULL_HANDLE : framebuffers[imageIndex % framebuffers.size()];
+}
+
+[[nodiscard]] VkImageView RenderGraph::imageView(ResourceHandle image, uint32_t imageIndex) const
+{
+    return resolveImageView(image, imageIndex);
+}
+
+void RenderGraph::setRenderArea(PassHandle pass, VkExtent2D extent)
+{
+    auto& graphPass = m_passes[pass];
+    graphPass.renderArea = {std::min(std::max(extent.width, 1u), graphPass.extent.width),
+                            std::min(std::max(extent.height, 1u), graphPass.extent.height)};
+}
+
+[[nodiscard]] VkExtent2D RenderGraph::renderArea(PassHandle pass) const
+{
+    return m_passes[pass].renderArea;
+}
+
+[[nodiscard]] uint32_t RenderGraph::passCount() const
+{
+    return static_cast<uint32_t>(m_passes.size());
+}
+
+[[nodiscard]] uint32_t RenderGraph::culledPassCount() const
+{
+    return static_cast<uint32_t>(
+        std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& pass) { return pass.culled; }));
+}
+
+[[nodiscard]] const std::string& RenderGraph::passName(PassHandle pass) const
+{
+    return m_passes[pass].name;
+}
+
+[[nodiscard]] VkDeviceSize RenderGraph::transientImageSize() const
+{
+    return m_transientImageSize;
+}
+
+[[nodiscard]] VkDeviceSize RenderGraph::transientMemorySize() const
+{
+    VkDeviceSize size = 0;
+    for (const auto& memoryBlock : m_memoryBlocks) {
+        size += memoryBlock.requirements.size;
+    }
+    return size;
+}
+
+[[nodiscard]] RenderGraph::LayoutUsage RenderGraph::layoutUsage(VkImageLayout layout)
+{
+    switch (layout) {
+    case VK_IMAGE_LAYOUT_UNDEFINED:
+        return {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0};
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT};
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT};
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT};
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT};
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+        return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT};
+    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+        // Presentation is synchronized with semaphores
+        return {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0};
+    default:
+        return {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT};
+    }
+}
+
+[[nodiscard]] VkImageAspectFlags RenderGraph::formatAspect(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+RenderGraph::Access& RenderGraph::addAccess(
+    PassHandle pass, ResourceHandle resource, VkImageLayout layout, bool read, bool write)
+{
+    RDE_ASSERT_0(pass < m_passes.size() && resource < m_resources.size(), "Invalid render graph handle!");
+
+    const auto usage = layoutUsage(layout);
+
+    Access access{};
+    access.resource = resource;
+    access.layout = layout;
+    access.stages = usage.stages;
+    access.access = usage.access;
+    access.read = read;
+    access.write = write;
+
+    return m_passes[pass].accesses.emplace_back(access);
+}
+
+void RenderGraph::cullPasses()
+{
+    // Imported resources are the graph's outputs, anything not contributing to them is skipped
+    std::vector<bool> needed(m_resources.size());
+    for (uint32_t resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex) {
+        needed[resourceIndex] = m_resources[resourceIndex].imported;
+    }
+
+    for (auto& pass : m_passes) {
+        pass.culled = true;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (auto passIt = m_passes.rbegin(); passIt != m_passes.rend(); ++passIt) {
+            auto& pass = *passIt;
+            const bool contributes = std::any_of(pass.accesses.begin(), pass.accesses.end(), [&](const Access& access) {
+                return access.write && needed[access.resource];
+            });
+
+            if (!pass.culled || !contributes) {
+                continue;
+            }
+            pass.culled = false;
+            changed = true;
+
+            for (const auto& access : pass.accesses) {
+                if (access.read) {
+                    needed[access.resource] = true;
+                }
+            }
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex) {
+        if (m_passes[passIndex].culled) {
+            continue;
+        }
+        for (const auto& access : m_passes[passIndex].accesses) {
+            auto& resource = m_resources[access.resource];
+            if (!resource.firstPass) {
+                resource.firstPass = passIndex;
+            }
+            resource.lastPass = passIndex;
+        }
+    }
+}
+
+void RenderGraph::allocateTransientImages()
+{
+    std::vector<ResourceHandle> transientImages;
+    for (ResourceHandle resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex) {
+        const auto& resource = m_resources[resourceIndex];
+        if (resource.image && !resource.imported && resource.firstPass) {
+            transientImages.push_back(resourceIndex);
+        }
+    }
+
+    // Greedy interval assignment: an image reuses the first block whose previous images are dead by the time it is
+    // first used and whose memory types are compatible
+    std::stable_sort(transientImages.begin(), transientImages.end(), [this](ResourceHandle lhs, ResourceHandle rhs) {
+        return *m_resources[lhs].firstPass < *m_resources[rhs].firstPass;
+    });
+
+    for (auto resourceIndex : transientImages) {
+        auto& resource = m_resources[resourceIndex];
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {resource.desc.extent.width, resource.desc.extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = resource.desc.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = resource.usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.samples = resource.desc.samples;
+
+        VkImage image;
+        auto result = vkCreateImage(m_device, &imageInfo, m_allocator, &image);
+        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create render graph image {}!", resource.name);
+        resource.images = {image};
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(m_device, image, &requirements);
+        m_transientImageSize += requirements.size;
+
+        auto memoryBlockIt = std::find_if(m_memoryBlocks.begin(), m_memoryBlocks.end(), [&](const MemoryBlock& block) {
+            return block.lastPass < *resource.firstPass &&
+                   (block.requirements.memoryTypeBits & requirements.memoryTypeBits) != 0;
+        });
+
+        if (memoryBlockIt == m_memoryBlocks.end()) {
+            MemoryBlock memoryBlock{};
+            memoryBlock.requirements = requirements;
+            m_memoryBlocks.push_back(memoryBlock);
+            memoryBlockIt = m_memoryBlocks.end() - 1;
+        } else {
+            auto& blockRequirements = memoryBlockIt->requirements;
+            blockRequirements.size = std::max(blockRequirements.size, requirements.size);
+            blockRequirements.alignment = std::max(blockRequirements.alignment, requirements.alignment);
+            blockRequirements.memoryTypeBits &= requirements.memoryTypeBits;
+        }
+        memoryBlockIt->lastPass = resource.lastPass;
+        resource.memoryBlock = static_cast<uint32_t>(memoryBlockIt - m_memoryBlocks.begin());
+    }
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    for (auto& memoryBlock : m_memoryBlocks) {
+        auto result = vmaAllocateMemory(
+            m_vmaAllocator, &memoryBlock.requirements, &allocationInfo, &memoryBlock.allocation, nullptr);
+        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to allocate render graph memory!");
+    }
+
+    for (auto resourceIndex : transientImages) {
+        auto& resource = m_resources[resourceIndex];
+        const auto image = resource.images.front();
+
+        auto result = vmaBindImageMemory(m_vmaAllocator, m_memoryBlocks[*resource.memoryBlock].allocation, image);
+        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to bind render graph image {}!", resource.name);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = resource.desc.format;
+        viewInfo.subresourceRange.aspectMask = formatAspect(resource.desc.format);
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        VkImageView imageView;
+        result = vkCreateImageView(m_device, &viewInfo, m_allocator, &imageView);
+        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create render graph image view {}!", resource.name);
+        resource.imageViews = {imageView};
+    }
+}
+
+void RenderGraph::computeBarriers()
+{
+    struct ResourceState
+    {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        LayoutUsage lastWrite{};
+        VkPipelineStageFlags readStages = 0;
+        VkPipelineStageFlags visibleStages = 0; // Stages the last write has already been made visible to
+    };
+
+    // Aliased memory is reused every frame, so the first user of a block waits on the block's last user of the
+    // previous frame
+    for (const auto& pass : m_passes) {
+        if (pass.culled) {
+            continue;
+        }
+        for (const auto& access : pass.accesses) {
+            const auto& memoryBlock = m_resources[access.resource].memoryBlock;
+            if (memoryBlock) {
+                m_memoryBlocks[*memoryBlock].lastUsage = {access.stages, access.write ? access.access : 0};
+            }
+        }
+    }
+
+    std::vector<ResourceState> states(m_resources.size());
+    for (uint32_t resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex) {
+        const auto& memoryBlock = m_resources[resourceIndex].memoryBlock;
+        if (memoryBlock) {
+            states[resourceIndex].lastWrite = m_memoryBlocks[*memoryBlock].lastUsage;
+        }
+    }
+
+    // Image currently living in each block, a later alias waits on everything its predecessor did
+    std::vector<std::optional<ResourceHandle>> blockOwners(m_memoryBlocks.size());
+
+    for (auto& pass : m_passes) {
+        pass.barriers.clear();
+        if (pass.culled) {
+            continue;
+        }
+
+        for (const auto& access : pass.accesses) {
+            const auto& resource = m_resources[access.resource];
+            auto& state = states[access.resource];
+
+            if (resource.memoryBlock) {
+                auto& owner = blockOwners[*resource.memoryBlock];
+                if (owner != access.resource) {
+                    if (owner) {
+                        const auto& previous = states[*owner];
+                        state.lastWrite = {previous.lastWrite.stages | previous.readStages, previous.lastWrite.access};
+                    }
+                    owner = access.resource;
+                }
+            }
+
+            Barrier barrier{};
+            barrier.dstStages = access.stages;
+            barrier.dstAccess = access.access;
+
+            bool needsBarrier = false;
+            if (resource.image) {
+                barrier.image = access.resource;
+                barrier.oldLayout = access.discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+                barrier.newLayout = access.layout;
+                needsBarrier = state.layout != access.layout || access.discard;
+            }
+
+            // Read after write, write after write
+            if (state.lastWrite.stages && ((access.stages & ~state.visibleStages) || access.write)) {
+                barrier.srcStages |= state.lastWrite.stages;
+                barrier.srcAccess |= state.lastWrite.access;
+                needsBarrier = true;
+            }
+            // Write after read only needs an execution dependency
+            if (access.write && state.readStages) {
+                barrier.srcStages |= state.readStages;
+                needsBarrier = true;
+            }
+
+            if (needsBarrier) {
+                // Nothing to wait on, e.g. a swapchain image. Chains with the acquire semaphore wait at the same stage
+                if (!barrier.srcStages) {
+                    barrier.srcStages = access.stages;
+                }
+                pass.barriers.push_back(barrier);
+            }
+
+            state.layout = access.layout;
+            if (access.write) {
+                state.lastWrite = {access.stages, access.access};
+                state.readStages = 0;
+                state.visibleStages = 0;
+            } else {
+                state.readStages |= access.stages;
+                state.visibleStages |= access.stages;
+            }
+        }
+    }
+
+    m_finalBarriers.clear();
+    for (ResourceHandle resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex) {
+        const auto& resource = m_resources[resourceIndex];
+        const auto& state = states[resourceIndex];
+
+        if (!resource.imported || !resource.firstPass || state.layout == resource.finalLayout ||
+            resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+            continue;
+        }
+
+        const auto finalUsage = layoutUsage(resource.finalLayout);
+
+        Barrier barrier{};
+        barrier.image = resourceIndex;
+        barrier.oldLayout = state.layout;
+        barrier.newLayout = resource.finalLayout;
+        barrier.srcStages = state.lastWrite.stages | state.readStages;
+        if (!barrier.srcStages) {
+            barrier.srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        }
+        barrier.srcAccess = state.lastWrite.access;
+        barrier.dstStages = finalUsage.stages;
+        barrier.dstAccess = finalUsage.access;
+        m_finalBarriers.push_back(barrier);
+    }
+}
+
+[[nodiscard]] bool RenderGraph::isReadAfter(ResourceHandle resource, uint32_t passIndex) const
+{
+    for (uint32_t laterPass = passIndex + 1; laterPass < m_passes.size(); ++laterPass) {
+        if (m_passes[laterPass].culled) {
+            continue;
+        }
+        for (const auto& access : m_passes[laterPass].accesses) {
+            if (access.resource == resource && access.read) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void RenderGraph::createRenderPass(uint32_t passIndex)
+{
+    auto& pass = m_passes[passIndex];
+    RDE_ASSERT_0(!pass.colorAttachments.empty() || pass.depthAttachment,
+                 "Graphics pass {} has no attachments!",
+                 pass.name);
+
+    std::vector<VkAttachmentDescription> attachments;
+    pass.clearValues.clear();
+
+    const auto describeAttachment = [&](ResourceHandle resourceIndex, AttachmentLoad load, VkImageLayout layout) {
+        const auto& resource = m_resources[resourceIndex];
+
+        // Layouts never change inside the pass, the graph transitions them with explicit barriers
+        VkAttachmentDescription attachment{};
+        attachment.format = resource.desc.format;
+        attachment.samples = resource.desc.samples;
+        attachment.loadOp = load == AttachmentLoad::Clear  ? VK_ATTACHMENT_LOAD_OP_CLEAR
+                            : load == AttachmentLoad::Load ? VK_ATTACHMENT_LOAD_OP_LOAD
+                                                           : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.storeOp = resource.imported || isReadAfter(resourceIndex, passIndex)
+                                 ? VK_ATTACHMENT_STORE_OP_STORE
+                                 : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachment.initialLayout = layout;
+        attachment.finalLayout = layout;
+        attachments.push_back(attachment);
+
+        VkAttachmentReference reference{};
+        reference.attachment = static_cast<uint32_t>(attachments.size() - 1);
+        reference.layout = layout;
+        return reference;
+    };
+
+    std::vector<VkAttachmentReference> colorReferences;
+    for (const auto& colorAttachment : pass.colorAttachments) {
+        colorReferences.push_back(describeAttachment(
+            colorAttachment.resource, colorAttachment.load, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+        pass.clearValues.push_back(colorAttachment.clearValue);
+    }
+
+    VkAttachmentReference depthReference{};
+    if (pass.depthAttachment) {
+        depthReference = describeAttachment(pass.depthAttachment->resource,
+                                            pass.depthAttachment->load,
+                                            pass.depthReadOnly ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                                                               : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+        pass.clearValues.push_back(pass.depthAttachment->clearValue);
+    }
+
+    // Only the first color attachment is resolved, the others are left unused
+    std::vector<VkAttachmentReference> resolveReferences(colorReferences.size(),
+                                                         {VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED});
+    if (pass.resolveAttachment) {
+        resolveReferences[0] = describeAttachment(
+            *pass.resolveAttachment, AttachmentLoad::DontCare, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        pass.clearValues.push_back({});
+    }
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+    subpass.pColorAttachments = colorReferences.data();
+    subpass.pDepthStencilAttachment = pass.depthAttachment ? &depthReference : nullptr;
+    subpass.pResolveAttachments = pass.resolveAttachment ? resolveReferences.data() : nullptr;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    renderPassInfo.pAttachments = attachments.data();
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    auto result = vkCreateRenderPass(m_device, &renderPassInfo, m_allocator, &pass.renderPass);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create render pass {}!", pass.name);
+}
+
+void RenderGraph::createFramebuffers(Pass& pass)
+{
+    // Attachments in the same order as the render pass
+    std::vector<ResourceHandle> attachments;
+    for (const auto& colorAttachment : pass.colorAttachments) {
+        attachments.push_back(colorAttachment.resource);
+    }
+    if (pass.depthAttachment) {
+        attachments.push_back(pass.depthAttachment->resource);
+    }
+    if (pass.resolveAttachment) {
+        attachments.push_back(*pass.resolveAttachment);
+    }
+
+    size_t framebufferCount = 1;
+    for (auto resourceIndex : attachments) {
+        framebufferCount = std::max(framebufferCount, m_resources[resourceIndex].imageViews.size());
+    }
+    pass.extent = m_resources[attachments.front()].desc.extent;
+    pass.renderArea = pass.extent;
+    pass.framebuffers.resize(framebufferCount);
+
+    for (uint32_t imageIndex = 0; imageIndex < framebufferCount; ++imageIndex) {
+        std::vector<VkImageView> imageViews;
+        for (auto resourceIndex : attachments) {
+            imageViews.push_back(resolveImageView(resourceIndex, imageIndex));
+        }
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = pass.renderPass;
+        framebufferInfo.attachmentCount = static_cast<uint32_t>(imageViews.size());
+        framebufferInfo.pAttachments = imageViews.data();
+        framebufferInfo.width = pass.extent.width;
+        framebufferInfo.height = pass.extent.height;
+        framebufferInfo.layers = 1;
+
+        auto result = vkCreateFramebuffer(m_device, &framebufferInfo, m_allocator, &pass.framebuffers[imageIndex]);
+        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create framebuffer for {}!", pass.name);
+    }
+}
+
+void RenderGraph::recordRenderPass(const Pass& pass, uint32_t passIndex, PassContext& context) const
+{
+    context.renderPass = pass.renderPass;
+    context.framebuffer = framebuffer(passIndex, context.imageIndex);
+
+    VkRenderPassBeginInfo renderPassBeginInfo{};
+    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.renderPass = context.renderPass;
+    renderPassBeginInfo.framebuffer = context.framebuffer;
+    renderPassBeginInfo.renderArea.offset = {0, 0};
+    renderPassBeginInfo.renderArea.extent = pass.renderArea;
+    renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(pass.clearValues.size());
+    renderPassBeginInfo.pClearValues = pass.clearValues.data();
+
+    vkCmdBeginRenderPass(context.commandBuffer,
+                         &renderPassBeginInfo,
+                         pass.secondaryCommandBuffers ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                                      : VK_SUBPASS_CONTENTS_INLINE);
+    pass.execute(context);
+    vkCmdEndRenderPass(context.commandBuffer);
+}
+
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer,
+                                 const std::vector<Barrier>& barriers,
+                                 uint32_t imageIndex) const
+{
+    if (barriers.empty()) {
+        return;
+    }
+
+    std::vector<VkMemoryBarrier> memoryBarriers;
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+
+    for (const auto& barrier : barriers) {
+        srcStages |= barrier.srcStages;
+        dstStages |= barrier.dstStages;
+
+        if (!barrier.image) {
+            VkMemoryBarrier memoryBarrier{};
+            memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memoryBarrier.srcAccessMask = barrier.srcAccess;
+            memoryBarrier.dstAccessMask = barrier.dstAccess;
+            memoryBarriers.push_back(memoryBarrier);
+            continue;
+        }
+
+        VkImageMemoryBarrier imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = barrier.srcAccess;
+        imageBarrier.dstAccessMask = barrier.dstAccess;
+        imageBarrier.oldLayout = barrier.oldLayout;
+        imageBarrier.newLayout = barrier.newLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = resolveImage(*barrier.image, imageIndex);
+        imageBarrier.subresourceRange.aspectMask = formatAspect(m_resources[*barrier.image].desc.format);
+        imageBarrier.subresourceRange.levelCount = 1;
+        imageBarrier.subresourceRange.layerCount = 1;
+        imageBarriers.push_back(imageBarrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         srcStages,
+                         dstStages,
+                         0,
+                         static_cast<uint32_t>(memoryBarriers.size()),
+                         memoryBarriers.data(),
+                         0,
+                         nullptr,
+                         static_cast<uint32_t>(imageBarriers.size()),
+                         imageBarriers.data());
+}
+
+[[nodiscard]] VkImage RenderGraph::resolveImage(ResourceHandle resource, uint32_t imageIndex) const
+{
+    const auto& images = m_resources[resource].images;
+    return images[imageIndex % images.size()];
+}
+
+[[nodiscard]] VkImageView RenderGraph::resolveImageView(ResourceHandle resource, uint32_t imageIndex) const
+{
+    const auto& imageViews = m_resources[resource].imageViews;
+    return imageViews[imageIndex % imageViews.size()];
+}
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <vma/vk_mem_alloc.h>
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+class GpuProfiler;
+
+// Frame graph of render and compute passes. Passes declare the images and buffers they read and write, compile()
+// then culls passes nothing depends on, creates a VkRenderPass and framebuffers per graphics pass, aliases the memory
+// of transient images whose lifetimes don't overlap and precomputes every barrier and layout transition.
+// Declarations are rebuilt from scratch whenever the swapchain changes.
+class RenderGraph
+{
+public:
+    using ResourceHandle = uint32_t;
+    using PassHandle = uint32_t;
+
+    enum class AttachmentLoad
+    {
+        Clear,
+        Load,
+        DontCare
+    };
+
+    struct ImageDesc
+    {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent2D extent{};
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    };
+
+    struct PassContext
+    {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        uint32_t imageIndex = 0;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    };
+
+    struct LayoutUsage
+    {
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags access = 0;
+    };
+
+    using ExecuteCallback = std::function<void(const PassContext& context)>;
+
+    void init(VkDevice device, VkAllocationCallbacks* allocator, VmaAllocator vmaAllocator);
+
+    // Destroys everything compiled and forgets all declarations
+    void destroy();
+
+    // Resources
+    [[nodiscard]] ResourceHandle createImage(std::string name, const ImageDesc& desc);
+    [[nodiscard]] ResourceHandle importImage(std::string name,
+                                             const ImageDesc& desc,
+                                             const std::vector<VkImage>& images,
+                                             const std::vector<VkImageView>& imageViews,
+                                             VkImageLayout finalLayout);
+    [[nodiscard]] ResourceHandle createBuffer(std::string name); // Only tracked for synchronization
+
+    // Passes, executed in declaration order
+    [[nodiscard]] PassHandle addGraphicsPass(std::string name,
+                                             ExecuteCallback execute,
+                                             bool secondaryCommandBuffers = false);
+    [[nodiscard]] PassHandle addComputePass(std::string name, ExecuteCallback execute);
+
+    void writeColor(PassHandle pass, ResourceHandle image, AttachmentLoad load, VkClearColorValue clearValue = {});
+    void writeDepth(PassHandle pass,
+                    ResourceHandle image,
+                    AttachmentLoad load,
+                    VkClearDepthStencilValue clearValue = {1.0f, 0});
+    void readDepth(PassHandle pass, ResourceHandle image);
+    void writeResolve(PassHandle pass, ResourceHandle image); // Resolves the first color attachment
+    void readTexture(PassHandle pass, ResourceHandle image, VkPipelineStageFlags stages);
+    void readBuffer(PassHandle pass, ResourceHandle buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+    void writeBuffer(PassHandle pass, ResourceHandle buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+
+    void compile();
+
+    // Times every live pass under its name when a profiler is given
+    void execute(VkCommandBuffer commandBuffer, uint32_t imageIndex, GpuProfiler* profiler = nullptr) const;
+
+    [[nodiscard]] VkRenderPass renderPass(PassHandle pass) const;
+    [[nodiscard]] VkFramebuffer framebuffer(PassHandle pass, uint32_t imageIndex) const;
+    [[nodiscard]] VkImageView imageView(ResourceHandle image, uint32_t imageIndex) const;
+
+    // Limits rendering to the top left of the attachments from the next execute() on, for passes that draw at a lower
+    // resolution than their images. Reset to the full extent by compile()
+    void setRenderArea(PassHandle pass, VkExtent2D extent);
+    [[nodiscard]] VkExtent2D renderArea(PassHandle pass) const;
+
+    // Statistics
+    [[nodiscard]] uint32_t passCount() const;
+    [[nodiscard]] uint32_t culledPassCount() const;
+    [[nodiscard]] const std::string& passName(PassHandle pass) const;
+    [[nodiscard]] VkDeviceSize transientImageSize() const; // Sum of every transient image
+    [[nodiscard]] VkDeviceSize transientMemorySize() const; // Memory actually allocated after aliasing
+
+    [[nodiscard]] static LayoutUsage layoutUsage(VkImageLayout layout);
+    [[nodiscard]] static VkImageAspectFlags formatAspect(VkFormat format);
+
+private:
+    struct Access
+    {
+        ResourceHandle resource = 0;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags access = 0;
+        bool read = false;
+        bool write = false;
+        bool discard = false; // Previous contents are not needed
+    };
+
+    struct Attachment
+    {
+        ResourceHandle resource = 0;
+        AttachmentLoad load = AttachmentLoad::DontCare;
+        VkClearValue clearValue{};
+    };
+
+    struct Barrier
+    {
+        std::optional<ResourceHandle> image; // Memory barrier for buffers
+        VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags srcStages = 0;
+        VkAccessFlags srcAccess = 0;
+        VkPipelineStageFlags dstStages = 0;
+        VkAccessFlags dstAccess = 0;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteCallback execute;
+        bool graphics = false;
+        bool secondaryCommandBuffers = false;
+        bool culled = false;
+
+        std::vector<Access> accesses;
+        std::vector<Attachment> colorAttachments;
+        std::optional<Attachment> depthAttachment;
+        std::optional<ResourceHandle> resolveAttachment;
+        bool depthReadOnly = false;
+
+        // Compiled
+        std::vector<Barrier> barriers;
+        std::vector<VkClearValue> clearValues;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        std::vector<VkFramebuffer> framebuffers; // One per swapchain image if a swapchain image is attached
+        VkExtent2D extent{};
+        VkExtent2D renderArea{};
+    };
+
+    struct Resource
+    {
+        std::string name;
+        bool image = false;
+        bool imported = false;
+        ImageDesc desc{};
+        VkImageUsageFlags usage = 0;
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        // Imported images have one image per swapchain image, transient images exactly one
+        std::vector<VkImage> images;
+        std::vector<VkImageView> imageViews;
+
+        // Lifetime in live passes, used for aliasing
+        std::optional<uint32_t> firstPass;
+        uint32_t lastPass = 0;
+        std::optional<uint32_t> memoryBlock;
+    };
+
+    struct MemoryBlock
+    {
+        VkMemoryRequirements requirements{};
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        uint32_t lastPass = 0;
+        LayoutUsage lastUsage{}; // Last access in the frame, the first user in the next frame waits on it
+    };
+
+    Access& addAccess(PassHandle pass, ResourceHandle resource, VkImageLayout layout, bool read, bool write);
+    void cullPasses();
+    void computeLifetimes();
+    void allocateTransientImages();
+    void computeBarriers();
+    [[nodiscard]] bool isReadAfter(ResourceHandle resource, uint32_t passIndex) const;
+    void createRenderPass(uint32_t passIndex);
+    void createFramebuffers(Pass& pass);
+    void recordRenderPass(const Pass& pass, uint32_t passIndex, PassContext& context) const;
+    void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<Barrier>& barriers, uint32_t imageIndex) const;
+    [[nodiscard]] VkImage resolveImage(ResourceHandle resource, uint32_t imageIndex) const;
+    [[nodiscard]] VkImageView resolveImageView(ResourceHandle resource, uint32_t imageIndex) const;
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkAllocationCallbacks* m_allocator = nullptr;
+    VmaAllocator m_vmaAllocator = VK_NULL_HANDLE;
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    std::vector<MemoryBlock> m_memoryBlocks;
+    std::vector<Barrier> m_finalBarriers; // Transitions imported images into their final layout
+    VkDeviceSize m_transientImageSize = 0;
+};
+
+} // namespace Vulkan
+} // namespace RDE
@@ -2,18 +2,28 @@
 
 #include "renderer.hpp"
 
+#include "block_decoder.hpp"
 #include "core/main.hpp"
+#include "culling.hpp"
 #include "data_types/binding_ids.hpp"
+#include "data_types/draw_sort_key.hpp"
 #include "data_types/queue_families.hpp"
-#include "data_types/texture_data.hpp"
 #include "data_types/uniform_buffer_object.hpp"
 #include "ecs/components/component_list.hpp"
+#include "index_packer.hpp"
+#include "instance_packer.hpp"
+#include "meshlet_builder.hpp"
+#include "utilities/file_parser.hpp"
+#include "utilities/radix_sort.hpp"
 #include "utilities/utilities.hpp"
+#include "vertex_packer.hpp"
 
+#include <cstring>
 #include <glm/gtc/matrix_transform.hpp>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_vulkan.h>
+#include <thread>
 
 #define VMA_IMPLEMENTATION
 #include <vma/vk_mem_alloc.h>
@@ -26,7 +36,29 @@ const std::vector<const char*> k_validationLayers = {"VK_LAYER_KHRONOS_validatio
 const std::vector<const char*> k_deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
 const glm::vec4 k_clearColor = {0.0f, 0.0f, 0.0f, 1.0f};
-constexpr uint32_t k_maxFramesInFlight = 3;
+constexpr VkFormat k_offscreenFormat = VK_FORMAT_B8G8R8A8_SRGB; // Same as the preferred swapchain format
+constexpr uint32_t k_maxFramesInFlight = 4; // Per frame resources are created for this many, see setFramesInFlight()
+constexpr float k_latencySleepFraction = 0.9f; // Undershoot, oversleeping leaves the GPU idle
+constexpr float k_cpuFrameTimeSmoothing = 0.1f;
+
+const char* k_cullShaderPath = "assets/shaders/cull.spv";
+const char* k_depthShaderPath = "assets/shaders/depth.spv";
+const char* k_upscaleVertexShaderPath = "assets/shaders/upscale_vert.spv";
+const char* k_upscaleFragmentShaderPath = "assets/shaders/upscale_frag.spv";
+const char* k_pipelineCachePath = "pipeline_cache.bin";
+const char* k_frameScopeName = "Frame";
+constexpr uint32_t k_cullWorkgroupSize = 64; // Matches local_size_x in cull.comp
+constexpr size_t k_minClusterCulledMeshletCount = 16; // Every visible run of meshlets is a draw, not worth it below
+constexpr uint32_t k_cullBindingCount = 7;
+
+constexpr uint32_t k_maxBindlessTextures = 4096;
+constexpr uint32_t k_maxGpuProfileScopes = 1024; // Passes, ImGui and optionally every draw
+
+constexpr VkDeviceSize k_stagingBlockSize = 16ull * 1024 * 1024;
+constexpr VkDeviceSize k_stagingAlignment = 16; // Covers every texel and compressed block size
+constexpr VkDeviceSize k_streamingUploadBudget = 8ull * 1024 * 1024; // Per frame
+constexpr VkDeviceSize k_uniformRegionSize = 64ull * 1024;          // Per frame in flight
+constexpr VkDeviceSize k_uniformBindingRange = 256;                 // Largest uniform block read through set 0
 
 #ifdef RDE_ENABLE_VALIDATION_LAYERS
 constexpr bool k_enableValidationLayers = true;
@@ -34,10 +66,78 @@ constexpr bool k_enableValidationLayers = true;
 constexpr bool k_enableValidationLayers = false;
 #endif
 
+namespace {
+struct ShaderSource
+{
+    const char* sourcePath;
+    const char* spirvPath;
+    bool required; // Used by the main pipeline, the optional ones only disable their feature
+};
+
+// Compiled by the build or scripts/compile_shaders.bat, the SPIR-V isn't tracked
+const std::vector<ShaderSource> k_shaderSources = {
+    {"assets/shaders/shader.vert", "assets/shaders/vert.spv", true},
+    {"assets/shaders/shader.frag", "assets/shaders/frag.spv", true},
+    {"assets/shaders/cull.comp", k_cullShaderPath, false},
+    {"assets/shaders/depth.vert", k_depthShaderPath, false},
+    {"assets/shaders/upscale.vert", k_upscaleVertexShaderPath, false},
+    {"assets/shaders/upscale.frag", k_upscaleFragmentShaderPath, false},
+};
+
+// False if the SPIR-V is missing or older than its source. Stale binaries may still expect an old vertex layout or
+// push constant block and can't be used with this build
+[[nodiscard]] bool isShaderCompiled(const char* spirvPath)
+{
+    std::error_code error;
+    const auto spirvTime = std::filesystem::last_write_time(spirvPath, error);
+    if (error) {
+        return false;
+    }
+
+    for (const auto& shader : k_shaderSources) {
+        if (std::strcmp(shader.spirvPath, spirvPath) != 0) {
+            continue;
+        }
+        const auto sourceTime = std::filesystem::last_write_time(shader.sourcePath, error);
+        return error || sourceTime <= spirvTime; // Shipped without sources
+    }
+    return true;
+}
+} // namespace
+
 void Renderer::init()
 {
     RDELOG_INFO("Start");
     m_window = &g_engine->window();
+    m_headless = m_window->isHeadless();
+
+    for (const auto& shader : k_shaderSources) {
+        if (isShaderCompiled(shader.spirvPath)) {
+            continue;
+        }
+        if (shader.required) {
+            RDELOG_CRITICAL("{} is missing or older than {}, rebuild or run scripts/compile_shaders.bat",
+                            shader.spirvPath,
+                            shader.sourcePath);
+            std::exit(EXIT_FAILURE);
+        }
+        RDELOG_WARN("{} is missing or older than {}, rebuild or run scripts/compile_shaders.bat",
+                    shader.spirvPath,
+                    shader.sourcePath);
+    }
+
+    const auto& options = g_engine->launchOptions();
+    m_instanceEncoding = InstancePacker::parseEncoding(options.instanceEncoding);
+    m_validateGpuCulling = options.validateCulling;
+    m_upscaling = isUpscalingSupported();
+    m_resolutionController.setSettings(
+        {options.minRenderScale,
+         options.maxRenderScale,
+         options.dynamicResolutionTarget.value_or(m_resolutionController.settings().targetGpuTime)});
+    m_resolutionController.reset(m_resolutionController.settings().maxScale);
+
+    Clock::Timer initTimer;
+    Clock::start(initTimer);
 
     createInstance();
     setupDebugMessenger();
@@ -45,58 +145,102 @@ void Renderer::init()
     selectPhysicalDevice();
     createLogicalDevice();
     createVmaAllocator();
+    createStagingPool();
+    createPipelineCache();
     createSwapchain();
     createImageViews();
-    createRenderPass();
+    createRenderGraph();
     createDescriptorSetLayout();
-    m_pipeline.create(m_device,
-                      m_allocator,
-                      m_swapchain,
-                      m_msaaSamples,
-                      m_uboDescriptorSetLayout,
-                      m_samplerDescriptorSetLayout,
-                      m_renderPass);
+    createBindlessDescriptorSet();
+    createUpscaleResources();
+    createPipelineLayout();
+    createMaterials();
     createCommandPools();
-    createColorResources();
-    createDepthResources();
-    createFramebuffers();
+    createThreadCommandPools();
+    createTextureStreamer();
     loadTextures();
     loadModels();
     createVertexBuffers();
     createIndexBuffers();
-    createUniformBuffers();
+    createPipelines();
+    createUniformRing();
     createDescriptorPool();
     createDescriptorSets();
     initImGui();
+    createCullingResources();
     createCommandBuffers();
     createSynchronizationObjects();
+    createGpuProfiler();
+
+    m_framesInFlight = std::clamp(options.framesInFlight.value_or(m_framesInFlight), 1u, k_maxFramesInFlight);
+    m_lowLatency = options.lowLatency;
+    if (options.dynamicResolutionTarget) {
+        setDynamicResolution(true);
+    }
 
+    RDELOG_INFO("Renderer initialized in {:.2f} ms ({} bytes of pipeline cache loaded)",
+                Clock::stop(initTimer),
+                m_pipelineCache.loadedSize());
     RDELOG_INFO("End");
 }
 
-void Renderer::drawFrame()
+void Renderer::waitForFrameSlot()
 {
+    if (m_frameSlotReady) {
+        return;
+    }
+
     // Wait for fence at (previous) frame
+    Clock::Timer waitTimer;
+    Clock::start(waitTimer);
     vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+    m_framePacingStatistics.fenceWait = Clock::stop(waitTimer);
+    m_deletionQueue.collect(m_frameSlotNumbers[m_currentFrame]);
+    m_framePacingStatistics.acquireWait = 0.0f;
+    m_framePacingStatistics.latencySleep = 0.0f;
+
+    if (m_lowLatency) {
+        sleepForLatency();
+    }
+    Clock::start(m_cpuFrameTimer);
+    m_frameSlotReady = true;
+}
+
+void Renderer::drawFrame()
+{
+    waitForFrameSlot();
 
-    // Acquire image from swap chain
-    uint32_t imageIndex;
-    auto result = vkAcquireNextImageKHR(m_device,
-                                        m_swapchain.handle,
-                                        UINT64_MAX,
-                                        m_imageAvailableSemaphores[m_currentFrame],
-                                        VK_NULL_HANDLE,
-                                        &imageIndex); // UINT64_MAX disables timeout
+    // Passes were toggled since the last frame
+    if (m_renderGraphDirty) {
+        rebuildRenderGraph();
+    }
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreateSwapchain();
-        return;
+    // Acquire image from swap chain. Offscreen images are used in turn, one per frame in flight
+    uint32_t imageIndex = static_cast<uint32_t>(m_currentFrame);
+    if (!m_headless) {
+        Clock::Timer acquireTimer;
+        Clock::start(acquireTimer);
+        auto result = vkAcquireNextImageKHR(m_device,
+                                            m_swapchain.handle,
+                                            UINT64_MAX,
+                                            m_imageAvailableSemaphores[m_currentFrame],
+                                            VK_NULL_HANDLE,
+                                            &imageIndex); // UINT64_MAX disables timeout
+        m_framePacingStatistics.acquireWait = Clock::stop(acquireTimer);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapchain();
+            return;
+        }
+        RDE_ASSERT_2(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR, "Failed to acquire next swap chain image!");
     }
-    RDE_ASSERT_2(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR, "Failed to acquire next swap chain image!");
 
     // If previous frame is using this image, we need to wait for its fence
     if (m_imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
+        Clock::Timer waitTimer;
+        Clock::start(waitTimer);
         vkWaitForFences(m_device, 1, &m_imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        m_framePacingStatistics.fenceWait += Clock::stop(waitTimer);
     }
 
     // Mark image as being in use by this frame
@@ -127,9 +271,16 @@ void Renderer::drawFrame()
             ImGui::RenderPlatformWindowsDefault();
         }
     }
+    // Upload instances for GPU culling now that this frame's buffers are no longer in use
+    if (m_cullingMode == CullingMode::Gpu) {
+        prepareGpuCulling();
+    }
+
+    // Residency changes are submitted ahead of this frame, which orders them before its draws
+    updateTextureStreaming();
+
     // Update ubo and record command buffer for each model
-    m_drawCallCount = 0;
-    updateUniformBuffer(imageIndex);
+    updateUniforms();
     recordCommandBuffers(imageIndex);
 
     // Execute command buffer with image as attachment in the framebuffer
@@ -140,20 +291,34 @@ void Renderer::drawFrame()
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT}; // Each stage
                                                                                          // corresponds to each
                                                                                          // wait semaphore
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = m_headless ? 0 : 1; // Nothing to acquire or present offscreen
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &m_commandBuffers[imageIndex];
 
     VkSemaphore signalSemaphores[] = {m_renderFinishedSemaphores[m_currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = m_headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
     vkResetFences(m_device, 1, &m_inFlightFences[m_currentFrame]);
 
-    result = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_inFlightFences[m_currentFrame]);
+    auto result = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_inFlightFences[m_currentFrame]);
     RDE_ASSERT_2(result == VK_SUCCESS, "Failed to submit draw command buffer!");
+    m_frameSlotNumbers[m_currentFrame] = ++m_frameNumber;
+
+    auto& cpuFrameTime = m_framePacingStatistics.cpuFrameTime;
+    cpuFrameTime += (Clock::stop(m_cpuFrameTimer) - cpuFrameTime) * k_cpuFrameTimeSmoothing;
+    m_frameSlotReady = false;
+
+    if (m_headless) {
+        if (!m_capturePath.empty()) {
+            captureFrame(imageIndex, m_capturePath);
+            m_capturePath.clear();
+        }
+        m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+        return;
+    }
 
     // Return image to swap chain for presentation
     VkPresentInfoKHR presentInfo{};
@@ -176,33 +341,42 @@ void Renderer::drawFrame()
         RDE_ASSERT_2(result == VK_SUCCESS, "Failed to present swapchain image!");
     }
 
-    m_currentFrame = (m_currentFrame + 1) % k_maxFramesInFlight;
+    m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
 }
 
 void Renderer::cleanup()
 {
+    // Assets and per frame buffers take the same path as at runtime, the device is idle so they go right away
+    auto& assetManager = g_engine->assetManager();
+    assetManager.eachTexture([this](Texture& texture) { retireTexture(texture); });
+    assetManager.eachMesh([this](Mesh& mesh) { retireMesh(mesh); });
+    for (auto& cullingBuffers : m_cullingBuffers) {
+        retireCullingBuffers(cullingBuffers);
+    }
+    for (auto& clusterCommandBuffer : m_clusterCommandBuffers) {
+        retireBuffer(clusterCommandBuffer);
+    }
+    m_deletionQueue.flush();
+
     cleanupSwapchain();
     cleanUpImGui();
 
-    auto& assetManager = g_engine->assetManager();
-    assetManager.eachTexture([this](Texture& texture) {
-        vkDestroySampler(m_device, texture.sampler, m_allocator);
-        vkDestroyImageView(m_device, texture.imageView, m_allocator);
-        vmaDestroyImage(m_vmaAllocator, texture.vmaImage.image, texture.vmaImage.allocation);
-    });
-
-    vkDestroyDescriptorSetLayout(m_device, m_samplerDescriptorSetLayout, m_allocator);
+    vkDestroySampler(m_device, m_upscaleSampler, m_allocator);
+    vkDestroyDescriptorPool(m_device, m_bindlessDescriptorPool, m_allocator);
+    vkDestroyDescriptorSetLayout(m_device, m_bindlessDescriptorSetLayout, m_allocator);
+    m_uniformRing.destroy();
+    vkDestroyDescriptorPool(m_device, m_descriptorPool, m_allocator);
     vkDestroyDescriptorSetLayout(m_device, m_uboDescriptorSetLayout, m_allocator);
+    vkDestroyPipelineLayout(m_device, m_pipelineLayout, m_allocator);
 
-    assetManager.eachMesh([this](Mesh& mesh) {
-        for (auto& [textureID, instanceBuffer] : mesh.instanceBuffers) {
-            vmaDestroyBuffer(m_vmaAllocator, instanceBuffer.vmaBuffer.buffer, instanceBuffer.vmaBuffer.allocation);
-            vmaDestroyBuffer(
-                m_vmaAllocator, instanceBuffer.stagingBuffer.buffer, instanceBuffer.stagingBuffer.allocation);
-        }
-        vmaDestroyBuffer(m_vmaAllocator, mesh.indexBuffer.buffer, mesh.indexBuffer.allocation);
-        vmaDestroyBuffer(m_vmaAllocator, mesh.vertexBuffer.buffer, mesh.vertexBuffer.allocation);
-    });
+    m_cullPipeline.destroy(m_device, m_allocator);
+    vkDestroyDescriptorPool(m_device, m_cullDescriptorPool, m_allocator);
+    vkDestroyDescriptorSetLayout(m_device, m_cullDescriptorSetLayout, m_allocator);
+
+    vmaDestroyBuffer(m_vmaAllocator, m_defaultAttributeBuffer.buffer, m_defaultAttributeBuffer.allocation);
+
+    m_gpuProfiler.destroy();
+    m_stagingPool.destroy();
 
     for (uint32_t i = 0; i < k_maxFramesInFlight; ++i) {
         vkDestroySemaphore(m_device, m_imageAvailableSemaphores[i], m_allocator);
@@ -210,9 +384,19 @@ void Renderer::cleanup()
         vkDestroyFence(m_device, m_inFlightFences[i], m_allocator);
     }
 
+    for (uint32_t i = 0; i < k_maxFramesInFlight; ++i) {
+        for (const auto& threadCommandPool : m_threadCommandPools[i]) {
+            vkDestroyCommandPool(m_device, threadCommandPool.commandPool, m_allocator);
+        }
+        vkDestroyCommandPool(m_device, m_uiCommandPools[i].commandPool, m_allocator);
+    }
     vkDestroyCommandPool(m_device, m_commandPool, m_allocator);
     vkDestroyCommandPool(m_device, m_transientCommandPool, m_allocator);
 
+    // Everything compiled this run is picked up by the next launch
+    m_pipelineCache.save(m_device);
+    m_pipelineCache.destroy(m_device, m_allocator);
+
     vmaDestroyAllocator(m_vmaAllocator);
 
     vkDestroyDevice(m_device, m_allocator);
@@ -230,6 +414,15 @@ void Renderer::waitForOperations()
     vkDeviceWaitIdle(m_device);
 }
 
+void Renderer::requestCapture(std::string path)
+{
+    if (!m_headless) {
+        RDELOG_WARN("Frames can only be captured in headless mode!");
+        return;
+    }
+    m_capturePath = std::move(path);
+}
+
 [[nodiscard]] uint32_t Renderer::drawCallCount() const
 {
     return m_drawCallCount;
@@ -240,1869 +433,3896 @@ void Renderer::waitForOperations()
     return m_instancesString;
 }
 
-[[nodiscard]] std::vector<MeshInstance>& Renderer::getInstancesForMesh(uint32_t meshID, uint32_t textureID)
+[[nodiscard]] std::vector<MeshInstance>& Renderer::getInstancesForMesh(uint32_t meshID, uint32_t materialIndex)
 {
     RDE_ASSERT_0(meshID != k_undefinedGuid, "Mesh ID is not initialized!");
-    RDE_ASSERT_0(textureID != k_undefinedGuid, "Texture ID is not initialized!");
 
-    const auto key = std::make_pair(meshID, textureID);
-    if (m_meshInstances.find(key) == m_meshInstances.end()) {
-        m_meshInstances[key] = std::make_unique<std::vector<Vulkan::MeshInstance>>();
+    // Unknown materials are drawn with the default one
+    const auto key = std::make_pair(meshID, materialIndex < m_materials.size() ? materialIndex : 0);
+
+    auto& batch = m_meshInstances[key];
+    if (!batch) {
+        batch = std::make_unique<InstanceBatch>();
     }
-    return *m_meshInstances[key];
+    return batch->instances;
 }
 
-Texture Renderer::createTextureResources(TextureData& textureData)
+[[nodiscard]] const std::vector<Material>& Renderer::materials() const
 {
-    Texture texture;
-    createTextureImage(texture, textureData);
-    createTextureImageView(texture, textureData);
-    createTextureSampler(texture, textureData);
+    return m_materials;
+}
 
-    return texture;
+[[nodiscard]] uint32_t Renderer::pipelineCount() const
+{
+    return m_pipelineStates.pipelineCount();
 }
 
-void Renderer::clearMeshInstances()
+[[nodiscard]] uint32_t Renderer::pendingPipelineCount() const
 {
-    m_meshInstances.clear();
+    return m_pipelineStates.pendingCount();
 }
 
-void Renderer::copyInstancesIntoInstanceBuffer()
+[[nodiscard]] CullingMode Renderer::cullingMode() const
 {
-    static auto& assetManager = g_engine->assetManager();
+    return m_cullingMode;
+}
 
-    for (auto& [meshTextureID, instanceData] : m_meshInstances) {
-        if (instanceData->empty()) {
-            continue;
-        }
-        const auto [meshID, textureID] = meshTextureID;
-        auto& mesh = assetManager.getMesh(meshID);
-        auto& instanceBuffer = mesh.instanceBuffers[textureID];
+void Renderer::setCullingMode(CullingMode cullingMode)
+{
+    if (cullingMode == CullingMode::Gpu && !isGpuCullingSupported()) {
+        RDELOG_WARN("GPU culling is not supported on this device!");
+        return;
+    }
+    const bool wasGpuCulling = m_cullingMode == CullingMode::Gpu;
+    m_cullingMode = cullingMode;
 
-        instanceBuffer.instanceCount = static_cast<uint32_t>(instanceData->size());
-        const uint32_t instanceSize = instanceBuffer.instanceCount * sizeof(MeshInstance);
+    // Instance buffers were not filled this frame while GPU culling
+    if (wasGpuCulling && m_cullingMode != CullingMode::Gpu) {
+        copyInstancesIntoInstanceBuffer();
+    }
+}
 
-        // If instance count exceeds size, recreate instance buffer with
-        // sufficient size
-        if (instanceSize > instanceBuffer.size) {
-            vmaDestroyBuffer(m_vmaAllocator, instanceBuffer.vmaBuffer.buffer, instanceBuffer.vmaBuffer.allocation);
-            vmaDestroyBuffer(
-                m_vmaAllocator, instanceBuffer.stagingBuffer.buffer, instanceBuffer.stagingBuffer.allocation);
+[[nodiscard]] uint32_t Renderer::submittedInstanceCount() const
+{
+    return m_submittedInstanceCount;
+}
 
-            // Allocate staging buffer in host visible memory
-            createBuffer(instanceSize,
-                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                         0,
-                         VMA_MEMORY_USAGE_AUTO,
-                         VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
-                         instanceBuffer.stagingBuffer);
+[[nodiscard]] uint32_t Renderer::visibleInstanceCount() const
+{
+    return m_visibleInstanceCount;
+}
 
-            // Allocate instance buffer in local device memory
-            createBuffer(instanceSize,
-                         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                         0,
-                         VMA_MEMORY_USAGE_AUTO,
-                         0,
-                         instanceBuffer.vmaBuffer);
+[[nodiscard]] bool Renderer::clusterCulling() const
+{
+    return m_clusterCulling;
+}
 
-            instanceBuffer.size = instanceSize;
-        }
+void Renderer::setClusterCulling(bool clusterCulling)
+{
+    if (clusterCulling && !isClusterCullingSupported()) {
+        RDELOG_WARN("Cluster culling is not supported on this device!");
+        return;
+    }
+    m_clusterCulling = clusterCulling;
+}
 
-        // Fill in host-visible buffer
-        memcpy(instanceBuffer.stagingBuffer.allocationInfo.pMappedData,
-               instanceData->data(),
-               instanceBuffer.instanceCount * sizeof(MeshInstance));
+[[nodiscard]] bool Renderer::validateGpuCulling() const
+{
+    return m_validateGpuCulling;
+}
 
-        // Copy data from host-visible staging buffer into local device instance
-        // buffer using command queue
-        copyBuffer(instanceBuffer.stagingBuffer, instanceBuffer.vmaBuffer, instanceSize);
+void Renderer::setValidateGpuCulling(bool validateGpuCulling)
+{
+    m_validateGpuCulling = validateGpuCulling;
+}
 
-        // Set descriptors for instance buffer
-        instanceBuffer.descriptor.range = instanceBuffer.size;
-        instanceBuffer.descriptor.buffer = instanceBuffer.vmaBuffer.buffer;
-        instanceBuffer.descriptor.offset = 0;
-    }
+[[nodiscard]] uint64_t Renderer::validatedCullBatchCount() const
+{
+    return m_validatedCullBatchCount;
 }
 
-VKAPI_ATTR VkBool32 VKAPI_CALL Renderer::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-                                                       VkDebugUtilsMessageTypeFlagsEXT messageType,
-                                                       const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-                                                       void* pUserData)
+[[nodiscard]] uint64_t Renderer::cullMismatchCount() const
 {
-    switch (messageSeverity) {
-        case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT: {
-            RDELOG_CLEAN_WARN(pCallbackData->pMessage);
-            break;
-        }
-        case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT: {
-            RDELOG_CLEAN_ERROR(pCallbackData->pMessage);
-            break;
-        }
-        default: {
-            // RDELOG_CLEAN_INFO("Validation Layer:\n\t{}",
-            // pCallbackData->pMessage);
-            break;
-        }
-    }
-    return VK_FALSE;
+    return m_cullMismatchCount;
 }
 
-// Our own function wrapped around the API extension function since it needs to
-// be loaded from its address
-VkResult Renderer::createDebugUtilsMessengerEXT(VkInstance instance,
-                                                const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo,
-                                                const VkAllocationCallbacks* pAllocator,
-                                                VkDebugUtilsMessengerEXT* pDebugMessenger)
+[[nodiscard]] const ClusterCullingStatistics& Renderer::clusterCullingStatistics() const
 {
-    auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
+    return m_clusterCullingStatistics;
+}
 
-    if (func != nullptr) {
-        return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
-    } else {
-        return VK_ERROR_EXTENSION_NOT_PRESENT;
-    }
+[[nodiscard]] InstanceEncoding Renderer::instanceEncoding() const
+{
+    return m_instanceEncoding;
 }
 
-void Renderer::destroyDebugUtilsMessengerEXT(VkInstance instance,
-                                             VkDebugUtilsMessengerEXT debugMessenger,
-                                             const VkAllocationCallbacks* pAllocator)
+void Renderer::setInstanceEncoding(InstanceEncoding instanceEncoding)
 {
-    auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+    if (instanceEncoding == m_instanceEncoding) {
+        return;
+    }
+    m_instanceEncoding = instanceEncoding;
 
-    if (func != nullptr) {
-        func(instance, debugMessenger, pAllocator);
+    // Pipelines for the new encoding compile on first use. The instance buffers filled this frame are repacked, GPU
+    // culling packs its own once the frame's buffers are free
+    if (m_cullingMode != CullingMode::Gpu) {
+        copyInstancesIntoInstanceBuffer();
     }
 }
 
-[[nodiscard]] std::vector<VkExtensionProperties> Renderer::retrieveSupportedExtensionsList() const
+[[nodiscard]] uint32_t Renderer::recordingThreadCount() const
 {
-    uint32_t extensionCount = 0;
-
-    // Retrieve number of supported extensions
-    auto result = vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to retrieve instance extension count!");
+    return m_recordingThreadCount;
+}
 
-    std::vector<VkExtensionProperties> extensions(extensionCount);
+void Renderer::setRecordingThreadCount(uint32_t recordingThreadCount)
+{
+    m_recordingThreadCount = std::clamp(recordingThreadCount, 1u, maxRecordingThreadCount());
+}
 
-    // Query extension details
-    result = vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to retrieve instance extension list!");
+[[nodiscard]] uint32_t Renderer::maxRecordingThreadCount() const
+{
+    return static_cast<uint32_t>(m_threadCommandPools.front().size());
+}
 
-    // std::ostringstream ss;
-    // ss << "\nAvailable extensions: \n";
-    //
-    // for (const auto& extension : extensions) {
-    //	ss << '\t' << extension.extensionName << '\n';
-    // }
-    // RDELOG_INFO(ss.str());
+[[nodiscard]] uint32_t Renderer::maxInstancesPerDraw() const
+{
+    return m_maxInstancesPerDraw;
+}
 
-    return extensions;
+void Renderer::setMaxInstancesPerDraw(uint32_t maxInstancesPerDraw)
+{
+    m_maxInstancesPerDraw = maxInstancesPerDraw;
 }
 
-[[nodiscard]] std::vector<const char*> Renderer::retrieveRequiredExtensions() const
+[[nodiscard]] float Renderer::recordingTime() const
 {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    return m_recordingTime;
+}
 
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+[[nodiscard]] bool Renderer::reuseSceneCommands() const
+{
+    return m_reuseSceneCommands;
+}
 
-    if (k_enableValidationLayers) {
-        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-    }
-    return extensions;
+void Renderer::setReuseSceneCommands(bool reuseSceneCommands)
+{
+    m_reuseSceneCommands = reuseSceneCommands;
 }
 
-[[nodiscard]] VkFormat Renderer::retrieveDepthFormat() const
+[[nodiscard]] bool Renderer::sceneCommandsReused() const
 {
-    return selectSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
-                                 VK_IMAGE_TILING_OPTIMAL,
-                                 VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    return m_sceneCommandsReused;
 }
 
-VkSampleCountFlagBits Renderer::retrieveMaxSampleCount() const
+[[nodiscard]] bool Renderer::sortDrawItems() const
 {
-    VkPhysicalDeviceProperties properties{};
-    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+    return m_sortDrawItems;
+}
 
-    VkSampleCountFlags counts =
-        properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+void Renderer::setSortDrawItems(bool sortDrawItems)
+{
+    m_sortDrawItems = sortDrawItems;
+}
 
-    return counts & VK_SAMPLE_COUNT_64_BIT   ? VK_SAMPLE_COUNT_64_BIT
-           : counts & VK_SAMPLE_COUNT_32_BIT ? VK_SAMPLE_COUNT_32_BIT
-           : counts & VK_SAMPLE_COUNT_16_BIT ? VK_SAMPLE_COUNT_16_BIT
-           : counts & VK_SAMPLE_COUNT_8_BIT  ? VK_SAMPLE_COUNT_8_BIT
-           : counts & VK_SAMPLE_COUNT_4_BIT  ? VK_SAMPLE_COUNT_4_BIT
-           : counts & VK_SAMPLE_COUNT_2_BIT  ? VK_SAMPLE_COUNT_2_BIT
-                                             : VK_SAMPLE_COUNT_1_BIT;
+[[nodiscard]] const BindStatistics& Renderer::bindStatistics() const
+{
+    return m_bindStatistics;
 }
 
-[[nodiscard]] bool Renderer::checkGlfwExtensions(const std::vector<VkExtensionProperties>& supportedExtensions,
-                                                 const std::vector<const char*>& glfwExtensions) const
+[[nodiscard]] const RenderGraph& Renderer::renderGraph() const
 {
-    for (const auto& extension : supportedExtensions) {
-        static bool extensionFound = false;
+    return m_renderGraph;
+}
 
-        for (const char* glfwExtension : glfwExtensions) {
-            if (strcmp(extension.extensionName, glfwExtension) == 0) {
-                extensionFound = true;
-                break;
-            }
-        }
+[[nodiscard]] bool Renderer::depthPrePass() const
+{
+    return m_depthPrePass;
+}
 
-        if (!extensionFound) {
-            return false;
-        }
+void Renderer::setDepthPrePass(bool depthPrePass)
+{
+    if (depthPrePass && !isDepthPrePassSupported()) {
+        RDELOG_WARN("Depth pre-pass is not supported, {} is missing or out of date!", k_depthShaderPath);
+        return;
+    }
+    if (depthPrePass != m_depthPrePass) {
+        m_depthPrePass = depthPrePass;
+        m_renderGraphDirty = true;
     }
-    return true;
 }
 
-[[nodiscard]] bool Renderer::checkValidationLayerSupport() const
+[[nodiscard]] float Renderer::sceneGpuTime(bool depthPrePass) const
 {
-    uint32_t layerCount;
-    vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+    return m_sceneGpuTimes[depthPrePass ? 1 : 0];
+}
 
-    std::vector<VkLayerProperties> availableLayers(layerCount);
-    vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+[[nodiscard]] bool Renderer::dynamicResolution() const
+{
+    return m_dynamicResolution;
+}
 
-    for (const char* layerName : k_validationLayers) {
-        bool layerFound = false;
+void Renderer::setDynamicResolution(bool dynamicResolution)
+{
+    if (dynamicResolution && !m_upscaling) {
+        RDELOG_WARN("Dynamic resolution is not supported, {} or {} is missing or out of date!",
+                    k_upscaleVertexShaderPath,
+                    k_upscaleFragmentShaderPath);
+        return;
+    }
+    m_dynamicResolution = dynamicResolution;
 
-        for (const auto& layerProperties : availableLayers) {
-            if (strcmp(layerName, layerProperties.layerName) == 0) {
-                layerFound = true;
-                break;
-            }
-        }
-
-        if (!layerFound) {
-            return false;
-        }
-    }
-    return true;
+    // Starts over at full resolution either way
+    m_resolutionController.reset(m_resolutionController.settings().maxScale);
 }
 
-bool Renderer::checkDeviceExtensionSupport(VkPhysicalDevice device) const
+[[nodiscard]] const ResolutionController& Renderer::resolutionController() const
 {
-    uint32_t extensionCount;
-    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
-
-    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
-    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
-
-    std::unordered_set<std::string> requiredExtensions(k_deviceExtensions.begin(), k_deviceExtensions.end());
-
-    // Eliminate required extension off the checklist for all available ones
-    for (const auto& extension : availableExtensions) {
-        requiredExtensions.erase(extension.extensionName);
-    }
-
-    // If required extensions are empty, it means that available extensions
-    // checked them off
-    return requiredExtensions.empty();
+    return m_resolutionController;
 }
 
-[[nodiscard]] bool Renderer::isDeviceSuitable(VkPhysicalDevice device) const
+void Renderer::setResolutionSettings(const ResolutionController::Settings& settings)
 {
-    VkPhysicalDeviceProperties deviceProperties{};
-    VkPhysicalDeviceFeatures deviceFeatures{};
-    vkGetPhysicalDeviceProperties(device, &deviceProperties);
-    vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
-
-    bool isDiscreteGPU = deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
-    bool hasRequiredFeatures = deviceFeatures.geometryShader && deviceFeatures.samplerAnisotropy;
-    bool hasSuitableQueueFamily = queryQueueFamilies(device).isComplete();
-    bool supportsExtensions = checkDeviceExtensionSupport(device);
-    bool isSwapchainAdequate;
+    const float maxScale = m_resolutionController.settings().maxScale;
+    m_resolutionController.setSettings(settings);
 
-    if (supportsExtensions) {
-        Swapchain::SupportDetails swapchainSupport = querySwapchainSupport(device);
-        isSwapchainAdequate = swapchainSupport.isAdequate();
+    // The scene color image is sized for the max scale
+    if (m_upscaling && m_resolutionController.settings().maxScale != maxScale) {
+        m_renderGraphDirty = true;
     }
-
-    return isDiscreteGPU && hasRequiredFeatures && hasSuitableQueueFamily && supportsExtensions && isSwapchainAdequate;
 }
 
-[[nodiscard]] bool Renderer::hasStencilComponent(VkFormat format)
+[[nodiscard]] VkExtent2D Renderer::renderExtent() const
 {
-    return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
+    return m_renderExtent;
 }
 
-[[nodiscard]] bool Renderer::isMsaaEnabled() const
+[[nodiscard]] const GpuProfiler& Renderer::gpuProfiler() const
 {
-    return (m_msaaSamples & VK_SAMPLE_COUNT_1_BIT) != VK_SAMPLE_COUNT_1_BIT;
+    return m_gpuProfiler;
 }
 
-[[nodiscard]] QueueFamilyIndices Renderer::queryQueueFamilies(VkPhysicalDevice device) const
+[[nodiscard]] bool Renderer::profileDrawItems() const
 {
-    QueueFamilyIndices indices{};
-
-    uint32_t queueFamilyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+    return m_profileDrawItems;
+}
 
-    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+void Renderer::setProfileDrawItems(bool profileDrawItems)
+{
+    m_profileDrawItems = profileDrawItems;
+}
 
-    int index = 0;
-    for (const auto& queueFamily : queueFamilies) {
-        // Queue family supports graphics operations
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            indices.graphicsFamily = index;
-        }
-        // Device supports present
-        VkBool32 presentSupport = false;
+[[nodiscard]] const StagingPool& Renderer::stagingPool() const
+{
+    return m_stagingPool;
+}
 
-        auto result = vkGetPhysicalDeviceSurfaceSupportKHR(device, index, m_surface, &presentSupport);
-        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to get surface present support!");
+[[nodiscard]] const UniformRing& Renderer::uniformRing() const
+{
+    return m_uniformRing;
+}
 
-        if (presentSupport) {
-            indices.presentFamily = index;
-        }
+[[nodiscard]] uint32_t Renderer::framesInFlight() const
+{
+    return m_framesInFlight;
+}
 
-        if (indices.isComplete()) {
-            break;
-        }
-        ++index;
+void Renderer::setFramesInFlight(uint32_t framesInFlight)
+{
+    framesInFlight = std::clamp(framesInFlight, 1u, k_maxFramesInFlight);
+    if (framesInFlight == m_framesInFlight) {
+        return;
     }
 
-    return indices;
+    // Every fence is signaled once the device is idle, so the frame slots can restart from the first one
+    waitForOperations();
+    m_framesInFlight = framesInFlight;
+    m_currentFrame = 0;
+    m_frameSlotReady = false;
+    m_gpuProfiler.clearResults();
 }
 
-Swapchain::SupportDetails Renderer::querySwapchainSupport(VkPhysicalDevice device) const
+[[nodiscard]] uint32_t Renderer::maxFramesInFlight() const
 {
-    Swapchain::SupportDetails details;
-
-    // Surface Capabilites
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, m_surface, &details.capabilities);
-
-    // Surface formats
-    uint32_t formatCount;
-    vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &formatCount, nullptr);
+    return k_maxFramesInFlight;
+}
 
-    if (formatCount) {
-        details.formats.resize(formatCount);
-        vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &formatCount, details.formats.data());
-    }
+[[nodiscard]] bool Renderer::lowLatency() const
+{
+    return m_lowLatency;
+}
 
-    // Presentation modes
-    uint32_t presentModeCount;
-    vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &presentModeCount, nullptr);
+void Renderer::setLowLatency(bool lowLatency)
+{
+    m_lowLatency = lowLatency;
+}
 
-    if (formatCount) {
-        details.presentModes.resize(formatCount);
-        vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &formatCount, details.presentModes.data());
-    }
+[[nodiscard]] const FramePacingStatistics& Renderer::framePacingStatistics() const
+{
+    return m_framePacingStatistics;
+}
 
-    return details;
+[[nodiscard]] size_t Renderer::pendingDestructionCount() const
+{
+    return m_deletionQueue.pendingCount();
 }
 
-VkSurfaceFormatKHR Renderer::selectSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) const
+[[nodiscard]] bool Renderer::mipmapsEnabled() const
 {
-    for (const auto& availableFormat : availableFormats) {
-        if (availableFormat.format == VK_FORMAT_B8G8R8A8_SRGB &&
-            availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-            return availableFormat;
-        }
-    }
+    return m_enableMipmaps;
+}
 
-    // If SRGB is not available, just use the first format for simplicity
-    return availableFormats[0];
+[[nodiscard]] bool Renderer::textureStreaming() const
+{
+    return m_textureStreaming;
 }
 
-VkPresentModeKHR Renderer::selectSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) const
+[[nodiscard]] const TextureStreamer& Renderer::textureStreamer() const
 {
-    VkPresentModeKHR presentModeChoice;
+    return m_textureStreamer;
+}
 
-    switch (m_presentationMode) {
-        case PresentationMode::Immediate:
-            presentModeChoice = VK_PRESENT_MODE_IMMEDIATE_KHR;
-            break;
-        case PresentationMode::TripleBuffered:
-            presentModeChoice = VK_PRESENT_MODE_MAILBOX_KHR;
-            break;
-        case PresentationMode::AdaptiveVsync:
-            presentModeChoice = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
-            break;
-        case PresentationMode::Vsync:
-        default:
-            presentModeChoice = VK_PRESENT_MODE_FIFO_KHR;
-            break;
-    }
+void Renderer::setTextureBudget(VkDeviceSize budget)
+{
+    m_textureStreamer.setBudget(budget);
+}
 
-    for (const auto& availablePresentMode : availablePresentModes) {
-        // If choice is available, use this mode
-        if (availablePresentMode == presentModeChoice) {
-            return availablePresentMode;
+[[nodiscard]] std::optional<Texture> Renderer::createTextureResources(Ktx2Texture ktxTexture)
+{
+    if (!isTextureFormatSupported(ktxTexture.format)) {
+        if (!BlockDecoder::canDecode(ktxTexture.format)) {
+            return std::nullopt;
         }
+        RDELOG_WARN("{} textures are not supported by the device, decoding on the CPU",
+                    Ktx2Texture::formatName(ktxTexture.format));
+        return createTextureResources(BlockDecoder::decode(ktxTexture));
     }
 
-    // If choice is not available, use FIFO (V-Sync) since it's guaranteed to be available
-    return VK_PRESENT_MODE_FIFO_KHR;
+    // Textures larger than the streaming base size start with only the levels up to it resident
+    const uint32_t firstLevel = m_textureStreaming ? TextureStreamer::baseMip(ktxTexture) : 0;
+
+    Texture texture;
+    createTextureImage(texture, ktxTexture, firstLevel);
+    texture.imageView =
+        createImageView(texture.vmaImage.image, ktxTexture.format, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels);
+    createTextureSampler(texture);
+    registerBindlessTexture(texture);
+
+    if (firstLevel > 0) {
+        texture.source = std::make_shared<const Ktx2Texture>(std::move(ktxTexture));
+    }
+    return texture;
 }
 
-VkExtent2D Renderer::selectSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) const
+[[nodiscard]] bool Renderer::isTextureFormatSupported(VkFormat format) const
 {
-    if (capabilities.currentExtent.width != UINT32_MAX) {
-        return capabilities.currentExtent;
+    // Block-compressed formats may only be used with their feature enabled, whatever the format properties say
+    const bool bc = format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+    const bool etc2 = format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK;
+    if ((bc && !m_supportsTextureCompressionBC) || (etc2 && !m_supportsTextureCompressionETC2)) {
+        return false;
     }
 
-    int width, height;
-    // Retrieve width and height in pixels
-    glfwGetFramebufferSize(m_window->handle(), &width, &height);
-
-    VkExtent2D actualExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+    VkFormatProperties formatProperties{};
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
 
-    // Ensure extents are within min and max of capabilities
-    actualExtent.width =
-        std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
-    actualExtent.height =
-        std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+    constexpr VkFormatFeatureFlags requiredFeatures =
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
 
-    return actualExtent;
+void Renderer::clearMeshInstances()
+{
+    m_meshInstances.clear();
 }
 
-uint32_t Renderer::selectMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+void Renderer::copyInstancesIntoInstanceBuffer()
 {
-    VkPhysicalDeviceMemoryProperties memoryProperties;
-    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memoryProperties);
+    static auto& assetManager = g_engine->assetManager();
 
-    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
-        if (typeFilter & (1 << i) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
+    m_clusterCommands.clear();
+    m_clusterCullingStatistics = {};
+
+    // GPU culling uploads all instances itself once the frame's fence has been waited on
+    if (m_cullingMode == CullingMode::Gpu) {
+        return;
     }
-    RDE_ASSERT_0(0, "Failed to find suitable memory type!");
 
-    return 0;
-}
+    const auto camera = retrieveCameraMatrices();
+    const auto frustum = Frustum::fromViewProjection(camera.projection * camera.view);
+    const auto& sceneCamera = g_engine->currentScene().camera();
 
-[[nodiscard]] VkFormat Renderer::selectSupportedFormat(const std::vector<VkFormat>& candidates,
-                                                       VkImageTiling tiling,
-                                                       VkFormatFeatureFlags features) const
-{
-    auto hasFeature = [&](VkFormatFeatureFlags propFeature) -> bool { return (propFeature & features) == features; };
+    m_submittedInstanceCount = 0;
+    m_visibleInstanceCount = 0;
 
-    for (VkFormat format : candidates) {
-        VkFormatProperties properties;
-        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &properties);
+    // Batches are sorted by mesh, so all materials of a mesh share one contiguous instance buffer
+    for (auto it = m_meshInstances.begin(); it != m_meshInstances.end();) {
+        const auto meshID = it->first.first;
+        auto& mesh = assetManager.getMesh(meshID);
+        auto& instanceBuffer = mesh.instanceBuffer;
+
+        m_visibleInstances.clear();
+
+        for (; it != m_meshInstances.end() && it->first.first == meshID; ++it) {
+            auto& batch = *it->second;
+            batch.firstInstance = static_cast<uint32_t>(m_visibleInstances.size());
+            batch.depths.clear();
+
+            for (const auto& instance : batch.instances) {
+                if (m_cullingMode != CullingMode::Cpu ||
+                    Culling::isInstanceVisible(frustum, mesh.boundingSphere, instance.modelTransform)) {
+                    m_visibleInstances.push_back(instance);
+                    batch.depths.push_back(
+                        calculateViewDepth(sceneCamera.eye, sceneCamera.front, instance.modelTransform));
+                }
+            }
+            batch.instanceCount = static_cast<uint32_t>(m_visibleInstances.size()) - batch.firstInstance;
+            m_submittedInstanceCount += static_cast<uint32_t>(batch.instances.size());
 
-        if (tiling == VK_IMAGE_TILING_LINEAR && hasFeature(properties.linearTilingFeatures)) {
-            return format;
+            batch.clusterCulled = isClusterCulled(mesh);
+            if (batch.clusterCulled) {
+                cullClusters(mesh, batch, frustum, sceneCamera.eye);
+            }
         }
-        if (tiling == VK_IMAGE_TILING_OPTIMAL && hasFeature(properties.optimalTilingFeatures)) {
-            return format;
+        const auto* visibleInstances = &m_visibleInstances;
+        m_visibleInstanceCount += static_cast<uint32_t>(visibleInstances->size());
+
+        instanceBuffer.instanceCount = static_cast<uint32_t>(visibleInstances->size());
+        if (!instanceBuffer.instanceCount) {
+            continue;
         }
-        RDE_ASSERT_0(false, "Failed to find supported format from physical device!");
-    }
+        const uint32_t instanceSize = instanceBuffer.instanceCount * instanceStride(m_instanceEncoding);
 
-    return VkFormat{};
-}
+        // If instance count exceeds size, recreate instance buffer with
+        // sufficient size. Frames in flight may still read the old one
+        if (instanceSize > instanceBuffer.size) {
+            retireBuffer(instanceBuffer.vmaBuffer);
+            retireBuffer(instanceBuffer.stagingBuffer);
 
-void Renderer::configureDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) const
-{
-    createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-    createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
-                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-    createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-                             VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-                             VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-    createInfo.pfnUserCallback = debugCallback;
-    createInfo.pUserData = nullptr;
-}
+            // Allocate staging buffer in host visible memory
+            createBuffer(instanceSize,
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         0,
+                         VMA_MEMORY_USAGE_AUTO,
+                         VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                         instanceBuffer.stagingBuffer);
 
-void Renderer::configureInstanceCreateInfo(VkInstanceCreateInfo& createInfo,
-                                           const VkApplicationInfo& appInfo,
-                                           VkDebugUtilsMessengerCreateInfoEXT& debugMessengerCreateInfo,
-                                           const std::vector<const char*>& glfwExtensions) const
-{
-    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-    createInfo.pApplicationInfo = &appInfo;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(glfwExtensions.size());
-    createInfo.ppEnabledExtensionNames = glfwExtensions.data();
+            // Allocate instance buffer in local device memory
+            createBuffer(instanceSize,
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                         0,
+                         VMA_MEMORY_USAGE_AUTO,
+                         0,
+                         instanceBuffer.vmaBuffer);
 
-    if (k_enableValidationLayers) {
-        bool validationLayersAvailable = checkValidationLayerSupport();
-        RDE_ASSERT_0(validationLayersAvailable, "Validation layers requested but not available!");
+            instanceBuffer.size = instanceSize;
+        }
 
-        createInfo.enabledLayerCount = static_cast<uint32_t>(k_validationLayers.size());
-        createInfo.ppEnabledLayerNames = k_validationLayers.data();
+        // Fill in host-visible buffer
+        InstancePacker::pack(m_instanceEncoding,
+                             visibleInstances->data(),
+                             instanceBuffer.instanceCount,
+                             instanceBuffer.stagingBuffer.allocationInfo.pMappedData);
 
-        // Setup debug messenger for instance creation and destruction
-        configureDebugMessengerCreateInfo(debugMessengerCreateInfo);
-        createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT*)&debugMessengerCreateInfo;
-    } else {
-        createInfo.enabledLayerCount = 0;
-        createInfo.pNext = nullptr;
+        // Copy data from host-visible staging buffer into local device instance
+        // buffer using command queue
+        copyBuffer(instanceBuffer.stagingBuffer, instanceBuffer.vmaBuffer, instanceSize);
+
+        // Set descriptors for instance buffer
+        instanceBuffer.descriptor.range = instanceBuffer.size;
+        instanceBuffer.descriptor.buffer = instanceBuffer.vmaBuffer.buffer;
+        instanceBuffer.descriptor.offset = 0;
     }
 }
 
-void Renderer::createInstance()
+VKAPI_ATTR VkBool32 VKAPI_CALL Renderer::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+                                                       VkDebugUtilsMessageTypeFlagsEXT messageType,
+                                                       const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+                                                       void* pUserData)
 {
-    RDE_PROFILE_SCOPE
+    switch (messageSeverity) {
+        case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT: {
+            RDELOG_CLEAN_WARN(pCallbackData->pMessage);
+            break;
+        }
+        case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT: {
+            RDELOG_CLEAN_ERROR(pCallbackData->pMessage);
+            break;
+        }
+        default: {
+            // RDELOG_CLEAN_INFO("Validation Layer:\n\t{}",
+            // pCallbackData->pMessage);
+            break;
+        }
+    }
+    return VK_FALSE;
+}
 
-    // Create app info and instance create info
-    VkApplicationInfo appInfo{};
-    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    appInfo.pApplicationName = "RubberDuck Engine";
-    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.pEngineName = "RubberDuck Engine";
-    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = m_apiVersion;
+// Our own function wrapped around the API extension function since it needs to
+// be loaded from its address
+VkResult Renderer::createDebugUtilsMessengerEXT(VkInstance instance,
+                                                const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo,
+                                                const VkAllocationCallbacks* pAllocator,
+                                                VkDebugUtilsMessengerEXT* pDebugMessenger)
+{
+    auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
 
-    VkInstanceCreateInfo createInfo{};
-    VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
+    if (func != nullptr) {
+        return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
+    } else {
+        return VK_ERROR_EXTENSION_NOT_PRESENT;
+    }
+}
 
-    const auto glfwExtensions = retrieveRequiredExtensions();
+void Renderer::destroyDebugUtilsMessengerEXT(VkInstance instance,
+                                             VkDebugUtilsMessengerEXT debugMessenger,
+                                             const VkAllocationCallbacks* pAllocator)
+{
+    auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
 
-    // Configure create info
-    configureInstanceCreateInfo(createInfo, appInfo, debugCreateInfo, glfwExtensions);
+    if (func != nullptr) {
+        func(instance, debugMessenger, pAllocator);
+    }
+}
 
-    // Create instance
-    auto result = vkCreateInstance(&createInfo, m_allocator, &m_instance);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create Vk instance!");
+[[nodiscard]] std::vector<VkExtensionProperties> Renderer::retrieveSupportedExtensionsList() const
+{
+    uint32_t extensionCount = 0;
 
-    // Retrieve supported extensions and check against glfw extensions
-    const auto supportedExtensions = retrieveSupportedExtensionsList();
+    // Retrieve number of supported extensions
+    auto result = vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to retrieve instance extension count!");
+
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+
+    // Query extension details
+    result = vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to retrieve instance extension list!");
+
+    // std::ostringstream ss;
+    // ss << "\nAvailable extensions: \n";
+    //
+    // for (const auto& extension : extensions) {
+    //	ss << '\t' << extension.extensionName << '\n';
+    // }
+    // RDELOG_INFO(ss.str());
+
+    return extensions;
 }
 
-void Renderer::setupDebugMessenger()
+[[nodiscard]] std::vector<const char*> Renderer::retrieveRequiredExtensions() const
 {
-    RDE_PROFILE_SCOPE
+    uint32_t glfwExtensionCount = 0;
+    const char** glfwExtensions = nullptr;
 
-    if (!k_enableValidationLayers)
-        return;
+    // Surface extensions are only needed to present
+    if (!m_headless) {
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    }
+    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
 
-    VkDebugUtilsMessengerCreateInfoEXT createInfo{};
-    configureDebugMessengerCreateInfo(createInfo);
+    if (k_enableValidationLayers) {
+        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    }
+    return extensions;
+}
 
-    auto result = createDebugUtilsMessengerEXT(m_instance, &createInfo, m_allocator, &m_debugMessenger);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create debug utils messenger!");
+[[nodiscard]] VkFormat Renderer::retrieveDepthFormat() const
+{
+    return selectSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
+                                 VK_IMAGE_TILING_OPTIMAL,
+                                 VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 }
 
-void Renderer::createSurface()
+VkSampleCountFlagBits Renderer::retrieveMaxSampleCount() const
 {
-    RDE_PROFILE_SCOPE
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
 
-    auto result = glfwCreateWindowSurface(m_instance, m_window->handle(), m_allocator, &m_surface);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create window surface!");
+    VkSampleCountFlags counts =
+        properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+
+    return counts & VK_SAMPLE_COUNT_64_BIT   ? VK_SAMPLE_COUNT_64_BIT
+           : counts & VK_SAMPLE_COUNT_32_BIT ? VK_SAMPLE_COUNT_32_BIT
+           : counts & VK_SAMPLE_COUNT_16_BIT ? VK_SAMPLE_COUNT_16_BIT
+           : counts & VK_SAMPLE_COUNT_8_BIT  ? VK_SAMPLE_COUNT_8_BIT
+           : counts & VK_SAMPLE_COUNT_4_BIT  ? VK_SAMPLE_COUNT_4_BIT
+           : counts & VK_SAMPLE_COUNT_2_BIT  ? VK_SAMPLE_COUNT_2_BIT
+                                             : VK_SAMPLE_COUNT_1_BIT;
 }
 
-void Renderer::selectPhysicalDevice()
+[[nodiscard]] bool Renderer::checkGlfwExtensions(const std::vector<VkExtensionProperties>& supportedExtensions,
+                                                 const std::vector<const char*>& glfwExtensions) const
 {
-    RDE_PROFILE_SCOPE
+    for (const auto& extension : supportedExtensions) {
+        static bool extensionFound = false;
 
-    uint32_t deviceCount = 0;
-    vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr);
+        for (const char* glfwExtension : glfwExtensions) {
+            if (strcmp(extension.extensionName, glfwExtension) == 0) {
+                extensionFound = true;
+                break;
+            }
+        }
 
-    RDE_ASSERT_0(deviceCount > 0, "Failed to find GPUs with Vulkan support!");
+        if (!extensionFound) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
+[[nodiscard]] bool Renderer::checkValidationLayerSupport() const
+{
+    uint32_t layerCount;
+    vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
 
-    for (const auto& device : devices) {
-        // Select first GPU device to use
-        if (isDeviceSuitable(device)) {
-            m_physicalDevice = device;
-            m_maxMsaaSamples = retrieveMaxSampleCount();
-            RDELOG_INFO("Max MSAA Samples available: {}", m_maxMsaaSamples);
+    std::vector<VkLayerProperties> availableLayers(layerCount);
+    vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
 
-            VkPhysicalDeviceProperties properties{};
-            vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
-            RDELOG_INFO("Physical Device: {}", properties.deviceName);
+    for (const char* layerName : k_validationLayers) {
+        bool layerFound = false;
 
-            break;
+        for (const auto& layerProperties : availableLayers) {
+            if (strcmp(layerName, layerProperties.layerName) == 0) {
+                layerFound = true;
+                break;
+            }
         }
-    }
 
-    // If at the end variable is still null, no device is suitable
-    RDE_ASSERT_0(m_physicalDevice, "Failed to find a suitable GPU device!");
+        if (!layerFound) {
+            return false;
+        }
+    }
+    return true;
 }
 
-void Renderer::createLogicalDevice()
+bool Renderer::checkDeviceExtensionSupport(VkPhysicalDevice device) const
 {
-    RDE_PROFILE_SCOPE
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 
-    QueueFamilyIndices indices = queryQueueFamilies(m_physicalDevice);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::unordered_set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+    const auto deviceExtensions = retrieveDeviceExtensions();
+    std::unordered_set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
-    float queuePriority = 1.0f;
-    for (auto queueFamily : uniqueQueueFamilies) {
-        VkDeviceQueueCreateInfo queueCreateInfo{};
+    // Eliminate required extension off the checklist for all available ones
+    for (const auto& extension : availableExtensions) {
+        requiredExtensions.erase(extension.extensionName);
+    }
 
-        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queueCreateInfo.queueFamilyIndex = queueFamily;
-        queueCreateInfo.queueCount = 1; // Will only ever need 1
-        queueCreateInfo.pQueuePriorities = &queuePriority;
+    // If required extensions are empty, it means that available extensions
+    // checked them off
+    return requiredExtensions.empty();
+}
 
-        queueCreateInfos.emplace_back(std::move(queueCreateInfo));
+[[nodiscard]] std::vector<const char*> Renderer::retrieveDeviceExtensions() const
+{
+    return m_headless ? std::vector<const char*>{} : k_deviceExtensions;
+}
+
+[[nodiscard]] uint32_t Renderer::rateDevice(VkPhysicalDevice device) const
+{
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    // CPU implementations such as lavapipe are the last resort unless asked for, e.g. on machines without a GPU
+    switch (properties.deviceType) {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+        return 4;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+        return 3;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+        return 2;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+        return g_engine->launchOptions().preferSoftwareDevice ? 5 : 1;
+    default:
+        return 1;
     }
+}
 
+[[nodiscard]] bool Renderer::isDeviceSuitable(VkPhysicalDevice device) const
+{
+    VkPhysicalDeviceProperties deviceProperties{};
     VkPhysicalDeviceFeatures deviceFeatures{};
-    deviceFeatures.samplerAnisotropy = VK_TRUE;
-    deviceFeatures.sampleRateShading = VK_TRUE;
+    vkGetPhysicalDeviceProperties(device, &deviceProperties);
+    vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
 
-    VkDeviceCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
-    createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(k_deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = k_deviceExtensions.data();
+    bool hasRequiredFeatures = deviceFeatures.geometryShader && deviceFeatures.samplerAnisotropy &&
+                               checkDescriptorIndexingSupport(queryVulkan12Features(device));
+    bool hasSuitableQueueFamily = queryQueueFamilies(device).isComplete();
+    bool supportsExtensions = checkDeviceExtensionSupport(device);
+    bool isSwapchainAdequate = m_headless; // Rendering offscreen, there is no surface to present to
 
-    // No longer needed but added to be compatible with older versions
-    if (k_enableValidationLayers) {
-        createInfo.enabledLayerCount = static_cast<uint32_t>(k_validationLayers.size());
-        createInfo.ppEnabledLayerNames = k_validationLayers.data();
-    } else {
-        createInfo.enabledLayerCount = 0;
+    if (supportsExtensions && !m_headless) {
+        Swapchain::SupportDetails swapchainSupport = querySwapchainSupport(device);
+        isSwapchainAdequate = swapchainSupport.isAdequate();
     }
 
-    auto result = vkCreateDevice(m_physicalDevice, &createInfo, m_allocator, &m_device);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create logical device!");
+    return hasRequiredFeatures && hasSuitableQueueFamily && supportsExtensions && isSwapchainAdequate;
+}
 
-    // Cache device queue
-    vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
-    vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+[[nodiscard]] bool Renderer::checkDescriptorIndexingSupport(const VkPhysicalDeviceVulkan12Features& features) const
+{
+    // Everything the bindless texture array relies on
+    return features.runtimeDescriptorArray && features.shaderSampledImageArrayNonUniformIndexing &&
+           features.descriptorBindingPartiallyBound && features.descriptorBindingVariableDescriptorCount &&
+           features.descriptorBindingSampledImageUpdateAfterBind &&
+           features.descriptorBindingUpdateUnusedWhilePending;
 }
 
-void Renderer::createVmaAllocator()
+[[nodiscard]] VkPhysicalDeviceVulkan12Features Renderer::queryVulkan12Features(VkPhysicalDevice device) const
 {
-    VmaAllocatorCreateInfo allocatorInfo{};
-    allocatorInfo.physicalDevice = m_physicalDevice;
-    allocatorInfo.device = m_device;
-    allocatorInfo.instance = m_instance;
-    allocatorInfo.vulkanApiVersion = m_apiVersion;
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 
-    vmaCreateAllocator(&allocatorInfo, &m_vmaAllocator);
+    // Chaining 1.2 structures is only valid on 1.2 devices, leave everything unsupported otherwise
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2) {
+        return vulkan12Features;
+    }
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    vulkan12Features.pNext = nullptr;
+    return vulkan12Features;
 }
 
-void Renderer::createSwapchain()
+[[nodiscard]] bool Renderer::isMsaaEnabled() const
 {
-    RDE_PROFILE_SCOPE
+    return (m_msaaSamples & VK_SAMPLE_COUNT_1_BIT) != VK_SAMPLE_COUNT_1_BIT;
+}
 
-    Swapchain::SupportDetails swapchainSupport = querySwapchainSupport(m_physicalDevice);
+[[nodiscard]] bool Renderer::isGpuCullingSupported() const
+{
+    return m_supportsDrawIndirectCount && m_supportsMultiDrawIndirect && isShaderCompiled(k_cullShaderPath);
+}
 
-    VkSurfaceFormatKHR surfaceFormat = selectSwapSurfaceFormat(swapchainSupport.formats);
-    VkPresentModeKHR presentMode = selectSwapPresentMode(swapchainSupport.presentModes);
-    VkExtent2D extent = selectSwapExtent(swapchainSupport.capabilities);
-    uint32_t imageCount = swapchainSupport.capabilities.minImageCount;
+[[nodiscard]] bool Renderer::isDepthPrePassSupported() const
+{
+    return isShaderCompiled(k_depthShaderPath);
+}
 
-    if (m_presentationMode == PresentationMode::TripleBuffered) {
-        // Recommended to have at least 1 more image in the swapchain
-        ++imageCount;
-    }
-
-    // If maxImageCount is 0, that means there's no maximum number of images
-    // allowed. If there's a max, clamp imageCount to the max
-    if (swapchainSupport.capabilities.maxImageCount > 0) {
-        imageCount = std::min(imageCount, swapchainSupport.capabilities.maxImageCount);
-    }
-
-    VkSwapchainCreateInfoKHR createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-    createInfo.surface = m_surface;
-    createInfo.minImageCount = imageCount;
-    createInfo.imageFormat = surfaceFormat.format;
-    createInfo.imageColorSpace = surfaceFormat.colorSpace;
-    createInfo.imageExtent = extent;
-    createInfo.imageArrayLayers = 1;                             // Amount of layers each image consists of
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; // Directly render to swapchain
-
-    QueueFamilyIndices indices = queryQueueFamilies(m_physicalDevice);
-
-    if (indices.graphicsFamily != indices.presentFamily) {
-        uint32_t indicesArray[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
-
-        createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT; // Multiple queue families own image
-        createInfo.queueFamilyIndexCount = 2;
-        createInfo.pQueueFamilyIndices = indicesArray;
-    } else {
-        createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE; // One queue family own image exclusively
-        createInfo.queueFamilyIndexCount = 0;
-        createInfo.pQueueFamilyIndices = nullptr;
-    }
-
-    createInfo.preTransform = swapchainSupport.capabilities.currentTransform;
-    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    createInfo.presentMode = presentMode;
-    createInfo.clipped = VK_TRUE; // Clip pixels that are obscured (by another
-                                  // window for example)
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
-
-    auto result = vkCreateSwapchainKHR(m_device, &createInfo, m_allocator, &m_swapchain.handle);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create swap chain!");
-
-    // Get current image count after creating swapchain
-    vkGetSwapchainImagesKHR(m_device, m_swapchain.handle, &imageCount, nullptr);
-    RDELOG_INFO("Number of images/image views/framebuffers/command buffers: {}", imageCount);
-    m_swapchain.images.resize(imageCount);
-    vkGetSwapchainImagesKHR(m_device, m_swapchain.handle, &imageCount, m_swapchain.images.data());
-
-    m_swapchain.imageFormat = surfaceFormat.format;
-    m_swapchain.extent = extent;
+[[nodiscard]] bool Renderer::isUpscalingSupported() const
+{
+    return isShaderCompiled(k_upscaleVertexShaderPath) && isShaderCompiled(k_upscaleFragmentShaderPath);
 }
 
-void Renderer::createImageViews()
+[[nodiscard]] bool Renderer::isClusterCullingSupported() const
 {
-    RDE_PROFILE_SCOPE
-
-    m_swapchain.imageViews.resize(m_swapchain.images.size());
-
-    for (size_t i = 0; i < m_swapchain.images.size(); ++i) {
-        m_swapchain.imageViews[i] =
-            createImageView(m_swapchain.images[i], m_swapchain.imageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
-    }
+    // Each cluster command draws a single instance, picked with firstInstance
+    return m_supportsMultiDrawIndirect && m_supportsDrawIndirectFirstInstance;
 }
 
-void Renderer::createRenderPass()
+[[nodiscard]] QueueFamilyIndices Renderer::queryQueueFamilies(VkPhysicalDevice device) const
 {
-    RDE_PROFILE_SCOPE
-
-    RDELOG_INFO("MSAA enabled? {}, Samples: {}", isMsaaEnabled() ? "Yes" : "No", m_msaaSamples);
+    QueueFamilyIndices indices{};
 
-    VkAttachmentDescription colorAttachment{};
-    VkAttachmentReference colorAttachmentRef{};
-
-    // Color attachment
-    colorAttachment.format = m_swapchain.imageFormat;
-    colorAttachment.samples = m_msaaSamples;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; // Clear framebuffer to black
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout =
-        isMsaaEnabled() ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    colorAttachmentRef.attachment = 0; // Index
-    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    // Depth stencil attachment
-    VkAttachmentDescription depthAttachment{};
-    depthAttachment.format = retrieveDepthFormat();
-    depthAttachment.samples = m_msaaSamples;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;        // We won't use this attachment after
-                                                                       // drawing is finished
-    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;   // For stencil tests
-    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // For stencil tests
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentReference depthAttachmentRef{};
-    depthAttachmentRef.attachment = 1; // Index
-    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentDescription colorAttachmentResolve{};
-    VkAttachmentReference colorAttachmentResolveRef{};
-
-    // Color resolve attachment (from MSAA)
-    colorAttachmentResolve.format = m_swapchain.imageFormat;
-    colorAttachmentResolve.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachmentResolve.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachmentResolve.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    colorAttachmentResolveRef.attachment = 2; // Index
-    colorAttachmentResolveRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    // Subpass
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
-    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
 
-    if (isMsaaEnabled()) {
-        subpass.pResolveAttachments = &colorAttachmentResolveRef;
-    }
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
-    // Dependency
-    VkSubpassDependency dependency{};
-    // This refers to implicit subpass BEFORE render pass
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    // Subpass index, which is 0 since we only have 1 for now
-    dependency.dstSubpass = 0;
-    // Wait for color attachment output and early fragment tests
-    dependency.srcStageMask =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.srcAccessMask = 0;
+    int index = 0;
+    for (const auto& queueFamily : queueFamilies) {
+        // Queue family supports graphics operations
+        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            indices.graphicsFamily = index;
+        }
+        // Device supports present. Nothing is presented offscreen, so the graphics queue stands in
+        VkBool32 presentSupport = false;
 
-    // Wait for this stage to finish to allow writing operations
-    dependency.dstStageMask =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        if (m_headless) {
+            presentSupport = indices.graphicsFamily.has_value();
+        } else {
+            auto result = vkGetPhysicalDeviceSurfaceSupportKHR(device, index, m_surface, &presentSupport);
+            RDE_ASSERT_0(result == VK_SUCCESS, "Failed to get surface present support!");
+        }
 
-    std::vector<VkAttachmentDescription> attachments = {colorAttachment, depthAttachment};
+        if (presentSupport) {
+            indices.presentFamily = m_headless ? indices.graphicsFamily : index;
+        }
 
-    if (isMsaaEnabled()) {
-        attachments.emplace_back(colorAttachmentResolve);
+        if (indices.isComplete()) {
+            break;
+        }
+        ++index;
     }
 
-    VkRenderPassCreateInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-    renderPassInfo.pAttachments = attachments.data();
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
-
-    auto result = vkCreateRenderPass(m_device, &renderPassInfo, m_allocator, &m_renderPass);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create render pass!");
+    return indices;
 }
 
-void Renderer::createDescriptorSetLayout()
+Swapchain::SupportDetails Renderer::querySwapchainSupport(VkPhysicalDevice device) const
 {
-    RDE_PROFILE_SCOPE
+    Swapchain::SupportDetails details;
 
-    // Idea: Could have 4 descriptor sets instead:
-    // 0. Engine-global resources - bound once per frame
-    // 1. Per-pass resources - bound once per pass
-    // 2. Material resources - bound once per material instance
-    // 3. Per-object resources - bound once per object instance
+    // Surface Capabilites
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, m_surface, &details.capabilities);
 
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    // Surface formats
+    uint32_t formatCount;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &formatCount, nullptr);
 
-    VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 0;
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.descriptorCount = 1;
-    samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    if (formatCount) {
+        details.formats.resize(formatCount);
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &formatCount, details.formats.data());
+    }
 
-    VkDescriptorSetLayoutCreateInfo uboLayoutInfo{};
-    uboLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    uboLayoutInfo.bindingCount = 1;
-    uboLayoutInfo.pBindings = &uboLayoutBinding;
+    // Presentation modes
+    uint32_t presentModeCount;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &presentModeCount, nullptr);
 
-    VkDescriptorSetLayoutCreateInfo samplerLayoutInfo{};
-    samplerLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    samplerLayoutInfo.bindingCount = 1;
-    samplerLayoutInfo.pBindings = &samplerLayoutBinding;
+    if (formatCount) {
+        details.presentModes.resize(formatCount);
+        vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &formatCount, details.presentModes.data());
+    }
 
-    auto result = vkCreateDescriptorSetLayout(m_device, &uboLayoutInfo, m_allocator, &m_uboDescriptorSetLayout);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create UBO descriptor set layout!");
-    result = vkCreateDescriptorSetLayout(m_device, &samplerLayoutInfo, m_allocator, &m_samplerDescriptorSetLayout);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create sampler descriptor set layout!");
+    return details;
 }
 
-void Renderer::createFramebuffers()
+VkSurfaceFormatKHR Renderer::selectSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) const
 {
-    RDE_PROFILE_SCOPE
-
-    m_swapchain.framebuffers.resize(m_swapchain.imageViews.size());
+    for (const auto& availableFormat : availableFormats) {
+        if (availableFormat.format == VK_FORMAT_B8G8R8A8_SRGB &&
+            availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+            return availableFormat;
+        }
+    }
 
-    // Create framebuffer for each image view
-    for (size_t i = 0; i < m_swapchain.imageViews.size(); ++i) {
-        std::vector<VkImageView> attachments;
+    // If SRGB is not available, just use the first format for simplicity
+    return availableFormats[0];
+}
 
-        if (isMsaaEnabled()) {
-            attachments = std::vector<VkImageView>{m_colorImageView, m_depthImageView, m_swapchain.imageViews[i]};
-        } else {
-            attachments = std::vector<VkImageView>{m_swapchain.imageViews[i], m_depthImageView};
-        }
+VkPresentModeKHR Renderer::selectSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) const
+{
+    VkPresentModeKHR presentModeChoice;
 
-        VkFramebufferCreateInfo frameBufferInfo{};
-        frameBufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        frameBufferInfo.renderPass = m_renderPass;
-        frameBufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-        frameBufferInfo.pAttachments = attachments.data();
-        frameBufferInfo.width = m_swapchain.extent.width;
-        frameBufferInfo.height = m_swapchain.extent.height;
-        frameBufferInfo.layers = 1;
+    switch (m_presentationMode) {
+        case PresentationMode::Immediate:
+            presentModeChoice = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            break;
+        case PresentationMode::TripleBuffered:
+            presentModeChoice = VK_PRESENT_MODE_MAILBOX_KHR;
+            break;
+        case PresentationMode::AdaptiveVsync:
+            presentModeChoice = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+            break;
+        case PresentationMode::Vsync:
+        default:
+            presentModeChoice = VK_PRESENT_MODE_FIFO_KHR;
+            break;
+    }
 
-        auto result = vkCreateFramebuffer(m_device, &frameBufferInfo, m_allocator, &m_swapchain.framebuffers[i]);
-        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create framebuffer!");
+    for (const auto& availablePresentMode : availablePresentModes) {
+        // If choice is available, use this mode
+        if (availablePresentMode == presentModeChoice) {
+            return availablePresentMode;
+        }
     }
+
+    // If choice is not available, use FIFO (V-Sync) since it's guaranteed to be available
+    return VK_PRESENT_MODE_FIFO_KHR;
 }
 
-void Renderer::createCommandPools()
+VkExtent2D Renderer::selectSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) const
 {
-    RDE_PROFILE_SCOPE
-
-    QueueFamilyIndices queueFamilyIndices = queryQueueFamilies(m_physicalDevice);
+    if (capabilities.currentExtent.width != UINT32_MAX) {
+        return capabilities.currentExtent;
+    }
 
-    VkCommandPoolCreateInfo commandPoolInfo{};
-    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    commandPoolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    int width, height;
+    // Retrieve width and height in pixels
+    glfwGetFramebufferSize(m_window->handle(), &width, &height);
 
-    VkCommandPoolCreateInfo transientCommandPoolInfo{};
-    transientCommandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    transientCommandPoolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-    transientCommandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    VkExtent2D actualExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
 
-    auto result = vkCreateCommandPool(m_device, &commandPoolInfo, m_allocator, &m_commandPool);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create command pool!");
+    // Ensure extents are within min and max of capabilities
+    actualExtent.width =
+        std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+    actualExtent.height =
+        std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
 
-    result = vkCreateCommandPool(m_device, &transientCommandPoolInfo, m_allocator, &m_transientCommandPool);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create transient command pool!");
+    return actualExtent;
 }
 
-void Renderer::createColorResources()
+uint32_t Renderer::selectMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
 {
-    VkFormat colorFormat = m_swapchain.imageFormat;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memoryProperties);
 
-    // Note: Use VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT sparingly. We can allow this for color and depth buffers
-    // since they are considered big blocks of swapchain and we only have a few of these for the render pass.
-    createImage(m_swapchain.extent.width,
-                m_swapchain.extent.height,
-                1,
-                m_msaaSamples,
-                colorFormat,
-                VK_IMAGE_TILING_OPTIMAL,
-                VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                VMA_MEMORY_USAGE_AUTO,
-                VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
-                m_colorImage);
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+        if (typeFilter & (1 << i) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    RDE_ASSERT_0(0, "Failed to find suitable memory type!");
 
-    m_colorImageView = createImageView(m_colorImage.image, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+    return 0;
 }
 
-void Renderer::createDepthResources()
+[[nodiscard]] VkFormat Renderer::selectSupportedFormat(const std::vector<VkFormat>& candidates,
+                                                       VkImageTiling tiling,
+                                                       VkFormatFeatureFlags features) const
 {
-    VkFormat depthFormat = retrieveDepthFormat();
-    createImage(m_swapchain.extent.width,
-                m_swapchain.extent.height,
-                1,
-                m_msaaSamples,
-                depthFormat,
-                VK_IMAGE_TILING_OPTIMAL,
-                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                VMA_MEMORY_USAGE_AUTO,
-                VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
-                m_depthImage);
+    auto hasFeature = [&](VkFormatFeatureFlags propFeature) -> bool { return (propFeature & features) == features; };
 
-    m_depthImageView = createImageView(m_depthImage.image, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
-    transitionImageLayout(m_depthImage.image,
-                          depthFormat,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                          1);
-}
+    for (VkFormat format : candidates) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &properties);
 
-void Renderer::loadTextures()
-{
-    static auto& assetManager = g_engine->assetManager();
-    assetManager.loadTextures();
-}
+        if (tiling == VK_IMAGE_TILING_LINEAR && hasFeature(properties.linearTilingFeatures)) {
+            return format;
+        }
+        if (tiling == VK_IMAGE_TILING_OPTIMAL && hasFeature(properties.optimalTilingFeatures)) {
+            return format;
+        }
+        RDE_ASSERT_0(false, "Failed to find supported format from physical device!");
+    }
 
-void Renderer::loadModels()
-{
-    auto& assetManager = g_engine->assetManager();
-    assetManager.loadModels();
+    return VkFormat{};
 }
 
-void Renderer::createVertexBuffers()
+void Renderer::configureDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) const
 {
-    auto& assetManager = g_engine->assetManager();
-    assetManager.eachMesh([this](Mesh& mesh) { createVertexBuffer(mesh.vertices, mesh.vertexBuffer); });
+    createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+    createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
+                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+    createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+                             VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+                             VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+    createInfo.pfnUserCallback = debugCallback;
+    createInfo.pUserData = nullptr;
 }
 
-void Renderer::createIndexBuffers()
+void Renderer::configureInstanceCreateInfo(VkInstanceCreateInfo& createInfo,
+                                           const VkApplicationInfo& appInfo,
+                                           VkDebugUtilsMessengerCreateInfoEXT& debugMessengerCreateInfo,
+                                           const std::vector<const char*>& glfwExtensions) const
 {
-    auto& assetManager = g_engine->assetManager();
-    assetManager.eachMesh([this](Mesh& mesh) { createIndexBuffer(mesh.indices, mesh.indexBuffer); });
-
-    assetManager;
-}
-
-void Renderer::createVertexBuffer(const std::vector<Vertex>& vertices, VmaBuffer& vertexBuffer)
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.pApplicationInfo = &appInfo;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(glfwExtensions.size());
+    createInfo.ppEnabledExtensionNames = glfwExtensions.data();
+
+    if (k_enableValidationLayers) {
+        bool validationLayersAvailable = checkValidationLayerSupport();
+        RDE_ASSERT_0(validationLayersAvailable, "Validation layers requested but not available!");
+
+        createInfo.enabledLayerCount = static_cast<uint32_t>(k_validationLayers.size());
+        createInfo.ppEnabledLayerNames = k_validationLayers.data();
+
+        // Setup debug messenger for instance creation and destruction
+        configureDebugMessengerCreateInfo(debugMessengerCreateInfo);
+        createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT*)&debugMessengerCreateInfo;
+    } else {
+        createInfo.enabledLayerCount = 0;
+        createInfo.pNext = nullptr;
+    }
+}
+
+void Renderer::createInstance()
 {
     RDE_PROFILE_SCOPE
 
-    // Temporary host-visible staging buffer
-    VmaBuffer stagingBuffer;
-
-    VkDeviceSize bufferSize = Utilities::arraysizeof(vertices);
+    // Create app info and instance create info
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "RubberDuck Engine";
+    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.pEngineName = "RubberDuck Engine";
+    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.apiVersion = m_apiVersion;
 
-    createBuffer(bufferSize,
-                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 0,
-                 VMA_MEMORY_USAGE_AUTO,
-                 VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
-                 stagingBuffer);
+    VkInstanceCreateInfo createInfo{};
+    VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
 
-    // Copy data into host-visible staging buffer
-    memcpy(stagingBuffer.allocationInfo.pMappedData, vertices.data(), (size_t)bufferSize);
+    const auto glfwExtensions = retrieveRequiredExtensions();
 
-    // Allocate vertex buffer in local device memory
-    createBuffer(bufferSize,
-                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                 0,
-                 VMA_MEMORY_USAGE_AUTO,
-                 0,
-                 vertexBuffer);
+    // Configure create info
+    configureInstanceCreateInfo(createInfo, appInfo, debugCreateInfo, glfwExtensions);
 
-    // Copy data from host-visible staging buffer into local device vertex
-    // buffer using command queue
-    copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+    // Create instance
+    auto result = vkCreateInstance(&createInfo, m_allocator, &m_instance);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create Vk instance!");
 
-    // Clean up temporary staging buffer
-    vmaDestroyBuffer(m_vmaAllocator, stagingBuffer.buffer, stagingBuffer.allocation);
+    // Retrieve supported extensions and check against glfw extensions
+    const auto supportedExtensions = retrieveSupportedExtensionsList();
 }
 
-void Renderer::createIndexBuffer(const std::vector<uint32_t>& indices, VmaBuffer& indexBuffer)
+void Renderer::setupDebugMessenger()
 {
     RDE_PROFILE_SCOPE
 
-    // Temporary host-visible buffer
-    VmaBuffer stagingBuffer{};
-    VkDeviceSize bufferSize = Utilities::arraysizeof(indices);
-
-    createBuffer(bufferSize,
-                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 0,
-                 VMA_MEMORY_USAGE_AUTO,
-                 VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
-                 stagingBuffer);
-
-    // Copy data into host-visible staging buffer
-    memcpy(stagingBuffer.allocationInfo.pMappedData, indices.data(), (size_t)bufferSize);
-
-    // Allocate vertex buffer in local device memory
-    createBuffer(bufferSize,
-                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                 0,
-                 VMA_MEMORY_USAGE_AUTO,
-                 0,
-                 indexBuffer);
+    if (!k_enableValidationLayers)
+        return;
 
-    // Copy data from host-visible staging buffer into local device vertex
-    // buffer using command queue
-    copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+    VkDebugUtilsMessengerCreateInfoEXT createInfo{};
+    configureDebugMessengerCreateInfo(createInfo);
 
-    // Clean up temporary staging buffer
-    vmaDestroyBuffer(m_vmaAllocator, stagingBuffer.buffer, stagingBuffer.allocation);
+    auto result = createDebugUtilsMessengerEXT(m_instance, &createInfo, m_allocator, &m_debugMessenger);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create debug utils messenger!");
 }
 
-void Renderer::createInstanceBuffer(InstanceBuffer& instanceBuffer)
+void Renderer::createSurface()
 {
-    // Default to fit 1024 instances first
-    constexpr auto initialInstanceCount = 1024;
-    instanceBuffer.size = initialInstanceCount * sizeof(MeshInstance);
+    RDE_PROFILE_SCOPE
 
-    // Allocate staging buffer in host visible memory
-    createBuffer(instanceBuffer.size,
-                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 0,
-                 VMA_MEMORY_USAGE_AUTO,
-                 VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
-                 instanceBuffer.stagingBuffer);
+    if (m_headless) {
+        return;
+    }
 
-    // Allocate instance buffer in VRAM
-    createBuffer(instanceBuffer.size,
-                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                 0,
-                 VMA_MEMORY_USAGE_AUTO,
-                 0,
-                 instanceBuffer.vmaBuffer);
+    auto result = glfwCreateWindowSurface(m_instance, m_window->handle(), m_allocator, &m_surface);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create window surface!");
 }
 
-void Renderer::createUniformBuffers()
+void Renderer::selectPhysicalDevice()
 {
     RDE_PROFILE_SCOPE
 
-    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-    const auto swapchainDuplicates = m_swapchain.images.size();
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr);
 
-    m_uniformBuffers.resize(swapchainDuplicates);
+    RDE_ASSERT_0(deviceCount > 0, "Failed to find GPUs with Vulkan support!");
 
-    for (size_t i = 0; i < swapchainDuplicates; ++i) {
-        createBuffer(bufferSize,
-                     VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                     0,
-                     VMA_MEMORY_USAGE_AUTO,
-                     VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
-                     m_uniformBuffers[i]);
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
+
+    // Select the best suitable device, discrete GPUs first
+    uint32_t bestRating = 0;
+    for (const auto& device : devices) {
+        if (!isDeviceSuitable(device)) {
+            continue;
+        }
+        const uint32_t rating = rateDevice(device);
+        if (rating > bestRating) {
+            m_physicalDevice = device;
+            bestRating = rating;
+        }
+    }
+
+    // If at the end variable is still null, no device is suitable
+    RDE_ASSERT_0(m_physicalDevice, "Failed to find a suitable GPU device!");
+
+    m_maxMsaaSamples = retrieveMaxSampleCount();
+    RDELOG_INFO("Max MSAA Samples available: {}", m_maxMsaaSamples);
+
+    // Software implementations usually support fewer samples
+    if (m_msaaSamples > m_maxMsaaSamples) {
+        RDELOG_WARN("{} MSAA samples requested but only {} supported", m_msaaSamples, m_maxMsaaSamples);
+        m_msaaSamples = m_maxMsaaSamples;
     }
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+    RDELOG_INFO("Physical Device: {}", properties.deviceName);
+
+    // Indirect count draws are required for GPU culling
+    m_supportsDrawIndirectCount = queryVulkan12Features(m_physicalDevice).drawIndirectCount == VK_TRUE;
+    RDELOG_INFO("Draw indirect count supported: {}", m_supportsDrawIndirectCount);
+
+    VkPhysicalDeviceFeatures features{};
+    vkGetPhysicalDeviceFeatures(m_physicalDevice, &features);
+    m_supportsMultiDrawIndirect = features.multiDrawIndirect == VK_TRUE;
+    m_supportsDrawIndirectFirstInstance = features.drawIndirectFirstInstance == VK_TRUE;
+    RDELOG_INFO("Multi draw indirect supported: {}, with first instance: {}",
+                m_supportsMultiDrawIndirect,
+                m_supportsDrawIndirectFirstInstance);
+
+    m_supportsTextureCompressionBC = features.textureCompressionBC == VK_TRUE;
+    m_supportsTextureCompressionETC2 = features.textureCompressionETC2 == VK_TRUE;
+    RDELOG_INFO("Texture compression supported: BC {}, ETC2 {}",
+                m_supportsTextureCompressionBC,
+                m_supportsTextureCompressionETC2);
 }
 
-void Renderer::createDescriptorPool()
+void Renderer::createLogicalDevice()
 {
     RDE_PROFILE_SCOPE
 
-    const auto swapchainCount = static_cast<uint32_t>(m_swapchain.images.size());
-    constexpr uint32_t maxDescriptorCount = 128;
+    QueueFamilyIndices indices = queryQueueFamilies(m_physicalDevice);
 
-    VkDescriptorPoolSize uboPoolSize{};
-    uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboPoolSize.descriptorCount = maxDescriptorCount * swapchainCount;
+    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+    std::unordered_set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
 
-    VkDescriptorPoolSize samplerPoolSize{};
-    samplerPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerPoolSize.descriptorCount = maxDescriptorCount * swapchainCount;
+    float queuePriority = 1.0f;
+    for (auto queueFamily : uniqueQueueFamilies) {
+        VkDeviceQueueCreateInfo queueCreateInfo{};
 
-    std::array<VkDescriptorPoolSize, 2> poolSizes = {std::move(uboPoolSize), std::move(samplerPoolSize)};
+        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueCreateInfo.queueFamilyIndex = queueFamily;
+        queueCreateInfo.queueCount = 1; // Will only ever need 1
+        queueCreateInfo.pQueuePriorities = &queuePriority;
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = maxDescriptorCount * swapchainCount;
-    poolInfo.flags = 0;
+        queueCreateInfos.emplace_back(std::move(queueCreateInfo));
+    }
 
-    auto result = vkCreateDescriptorPool(m_device, &poolInfo, m_allocator, &m_descriptorPool);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create descriptor pool!");
-}
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.drawIndirectCount = m_supportsDrawIndirectCount ? VK_TRUE : VK_FALSE;
+
+    // Bindless textures
+    vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+    vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+    vulkan12Features.descriptorBindingVariableDescriptorCount = VK_TRUE;
+    vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+    VkPhysicalDeviceFeatures2 deviceFeatures{};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures.pNext = &vulkan12Features;
+    deviceFeatures.features.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.features.sampleRateShading = VK_TRUE;
+    deviceFeatures.features.multiDrawIndirect = m_supportsMultiDrawIndirect ? VK_TRUE : VK_FALSE;
+    deviceFeatures.features.drawIndirectFirstInstance = m_supportsDrawIndirectFirstInstance ? VK_TRUE : VK_FALSE;
+    deviceFeatures.features.textureCompressionBC = m_supportsTextureCompressionBC ? VK_TRUE : VK_FALSE;
+    deviceFeatures.features.textureCompressionETC2 = m_supportsTextureCompressionETC2 ? VK_TRUE : VK_FALSE;
 
-void Renderer::createDescriptorSets()
-{
-    RDE_PROFILE_SCOPE
+    VkDeviceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &deviceFeatures;
+    createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
+    createInfo.pQueueCreateInfos = queueCreateInfos.data();
+    createInfo.pEnabledFeatures = nullptr; // Features are chained through pNext
+    const auto deviceExtensions = retrieveDeviceExtensions();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+
+    // No longer needed but added to be compatible with older versions
+    if (k_enableValidationLayers) {
+        createInfo.enabledLayerCount = static_cast<uint32_t>(k_validationLayers.size());
+        createInfo.ppEnabledLayerNames = k_validationLayers.data();
+    } else {
+        createInfo.enabledLayerCount = 0;
+    }
 
-    const auto swapchainCount = static_cast<uint32_t>(m_swapchain.images.size());
+    auto result = vkCreateDevice(m_physicalDevice, &createInfo, m_allocator, &m_device);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create logical device!");
 
-    // Create vector of swapchain images number of same layouts
-    std::vector<VkDescriptorSetLayout> uboLayouts(swapchainCount, m_uboDescriptorSetLayout);
+    // Cache device queue
+    vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
+    vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+}
 
-    VkDescriptorSetAllocateInfo uboAllocateInfo{};
-    uboAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    uboAllocateInfo.descriptorPool = m_descriptorPool;
-    uboAllocateInfo.descriptorSetCount = swapchainCount;
-    uboAllocateInfo.pSetLayouts = uboLayouts.data();
-
-    m_uboDescriptorSets.resize(swapchainCount);
-
-    const auto result = vkAllocateDescriptorSets(m_device, &uboAllocateInfo, m_uboDescriptorSets.data());
-    RDE_ASSERT_2(result == VK_SUCCESS, "Failed to allocate UBO descriptor sets!");
-
-    for (size_t i = 0; i < swapchainCount; ++i) {
-        // For uniform buffer
-        VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = m_uniformBuffers[i].buffer;
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformBufferObject);
-
-        VkWriteDescriptorSet uboDescriptorWrite{};
-        uboDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        uboDescriptorWrite.dstSet = m_uboDescriptorSets[i];
-        uboDescriptorWrite.dstBinding = 0;
-        uboDescriptorWrite.dstArrayElement = 0;
-        uboDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uboDescriptorWrite.descriptorCount = 1;
-        uboDescriptorWrite.pBufferInfo = &bufferInfo;
-        uboDescriptorWrite.pImageInfo = nullptr;
-        uboDescriptorWrite.pTexelBufferView = nullptr;
-
-        vkUpdateDescriptorSets(m_device, 1, &uboDescriptorWrite, 0, nullptr);
-    }
-    // For texture sampler
-    static auto& assetManager = g_engine->assetManager();
+void Renderer::createVmaAllocator()
+{
+    VmaAllocatorCreateInfo allocatorInfo{};
+    allocatorInfo.physicalDevice = m_physicalDevice;
+    allocatorInfo.device = m_device;
+    allocatorInfo.instance = m_instance;
+    allocatorInfo.vulkanApiVersion = m_apiVersion;
 
-    assetManager.eachTexture([this, swapchainCount](Texture& texture, uint32_t id) {
-        texture.descriptorSets.resize(swapchainCount);
-
-        std::vector<VkDescriptorSetLayout> samplerLayouts(swapchainCount, m_samplerDescriptorSetLayout);
-        VkDescriptorSetAllocateInfo samplerAllocateInfo{};
-        samplerAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        samplerAllocateInfo.descriptorPool = m_descriptorPool;
-        samplerAllocateInfo.descriptorSetCount = swapchainCount;
-        samplerAllocateInfo.pSetLayouts = samplerLayouts.data();
-
-        const auto result = vkAllocateDescriptorSets(m_device, &samplerAllocateInfo, texture.descriptorSets.data());
-        RDE_ASSERT_2(result == VK_SUCCESS, "Failed to allocate sampler descriptor sets for texture id {}!", id);
-
-        for (size_t i = 0; i < swapchainCount; ++i) {
-            VkDescriptorImageInfo descriptor{};
-            descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            descriptor.imageView = texture.imageView;
-            descriptor.sampler = texture.sampler;
-
-            VkWriteDescriptorSet samplerDescriptorWrite{};
-            samplerDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            samplerDescriptorWrite.dstSet = texture.descriptorSets[i];
-            samplerDescriptorWrite.dstBinding = 0;
-            samplerDescriptorWrite.dstArrayElement = 0;
-            samplerDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            samplerDescriptorWrite.descriptorCount = 1;
-            samplerDescriptorWrite.pBufferInfo = nullptr;
-            samplerDescriptorWrite.pImageInfo = &descriptor;
-            samplerDescriptorWrite.pTexelBufferView = nullptr;
-
-            vkUpdateDescriptorSets(m_device, 1, &samplerDescriptorWrite, 0, nullptr);
-        }
-    });
+    vmaCreateAllocator(&allocatorInfo, &m_vmaAllocator);
 }
 
-void Renderer::createCommandBuffers()
+void Renderer::createStagingPool()
 {
-    RDE_PROFILE_SCOPE
+    const auto maxPoolSize = VkDeviceSize{g_engine->launchOptions().stagingPoolSize} * 1024 * 1024;
+    m_stagingPool.init(m_device, m_allocator, m_vmaAllocator, k_stagingBlockSize, maxPoolSize);
+}
 
-    // Create command buffers
-    m_commandBuffers.resize(m_swapchain.framebuffers.size());
+void Renderer::createTextureStreamer()
+{
+    const auto budget = VkDeviceSize{g_engine->launchOptions().textureBudget} * 1024 * 1024;
+    m_textureStreaming = budget > 0;
+    m_textureStreamer.init(m_vmaAllocator, budget, k_streamingUploadBudget);
+
+    m_streamingCommandBuffers.resize(k_maxFramesInFlight);
 
     VkCommandBufferAllocateInfo allocateInfo{};
     allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocateInfo.commandPool = m_commandPool;
     allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocateInfo.commandBufferCount = static_cast<uint32_t>(m_commandBuffers.size());
-
-    auto result = vkAllocateCommandBuffers(m_device, &allocateInfo, m_commandBuffers.data());
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to allocate command buffers!");
+    allocateInfo.commandBufferCount = k_maxFramesInFlight;
 
-    for (size_t imageIndex = 0; imageIndex < m_swapchain.images.size(); ++imageIndex) {
-        recordCommandBuffers(static_cast<uint32_t>(imageIndex));
-    }
+    const auto result = vkAllocateCommandBuffers(m_device, &allocateInfo, m_streamingCommandBuffers.data());
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to allocate texture streaming command buffers!");
 }
 
-void Renderer::createSynchronizationObjects()
+void Renderer::createPipelineCache()
 {
     RDE_PROFILE_SCOPE
 
-    m_imageAvailableSemaphores.resize(k_maxFramesInFlight);
-    m_renderFinishedSemaphores.resize(k_maxFramesInFlight);
-    m_inFlightFences.resize(k_maxFramesInFlight);
-    m_imagesInFlight.resize(m_swapchain.images.size(), VK_NULL_HANDLE);
-
-    VkSemaphoreCreateInfo semaphoreInfo{};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // Set to signaled state for initial frame
-
-    for (uint32_t i = 0; i < k_maxFramesInFlight; ++i) {
-
-        auto success =
-            vkCreateSemaphore(m_device, &semaphoreInfo, m_allocator, &m_imageAvailableSemaphores[i]) == VK_SUCCESS &&
-            vkCreateSemaphore(m_device, &semaphoreInfo, m_allocator, &m_renderFinishedSemaphores[i]) == VK_SUCCESS &&
-            vkCreateFence(m_device, &fenceInfo, m_allocator, &m_inFlightFences[i]) == VK_SUCCESS;
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
 
-        RDE_ASSERT_0(success, "Failed to create synchronization objects for frame {}!", i);
-    }
+    m_pipelineCache.create(m_device, m_allocator, properties, k_pipelineCachePath);
 }
 
-void checkVkResult(VkResult err)
+void Renderer::createSwapchain(VkSwapchainKHR oldSwapchain)
 {
-    RDE_ASSERT_0(err == VK_SUCCESS, "ImGui_ImplVulkan_ failure!");
-}
+    RDE_PROFILE_SCOPE
 
-void Renderer::initImGui()
-{
-    // Create descriptor pool for ImGui to use (Type, DescriptorCount)
-    constexpr uint32_t descriptorCount = 1000;
+    if (m_headless) {
+        createOffscreenImages();
+        return;
+    }
 
-    VkDescriptorPoolSize poolSizes[] = {{VK_DESCRIPTOR_TYPE_SAMPLER, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, descriptorCount},
-                                        {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, descriptorCount}};
+    Swapchain::SupportDetails swapchainSupport = querySwapchainSupport(m_physicalDevice);
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-    poolInfo.maxSets = descriptorCount;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(std::size(poolSizes));
-    poolInfo.pPoolSizes = poolSizes;
+    VkSurfaceFormatKHR surfaceFormat = selectSwapSurfaceFormat(swapchainSupport.formats);
+    VkPresentModeKHR presentMode = selectSwapPresentMode(swapchainSupport.presentModes);
+    VkExtent2D extent = selectSwapExtent(swapchainSupport.capabilities);
+    uint32_t imageCount = swapchainSupport.capabilities.minImageCount;
 
-    RDE_ASSERT_0(vkCreateDescriptorPool(m_device, &poolInfo, m_allocator, &m_imguiDescriptorPool) == VK_SUCCESS,
-                 "Failed to create descriptor pool for ImGui!");
+    if (m_presentationMode == PresentationMode::TripleBuffered) {
+        // Recommended to have at least 1 more image in the swapchain
+        ++imageCount;
+    }
 
-    // Initialize ImGui library
-    ImGui::CreateContext();
+    // If maxImageCount is 0, that means there's no maximum number of images
+    // allowed. If there's a max, clamp imageCount to the max
+    if (swapchainSupport.capabilities.maxImageCount > 0) {
+        imageCount = std::min(imageCount, swapchainSupport.capabilities.maxImageCount);
+    }
 
-    ImGuiIO& io = ImGui::GetIO();
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; // Enable Keyboard Controls
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;  // Enable Gamepad Controls
-    io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;     // Enable Docking
-    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;   // Enable Multi-Viewport / Platform Windows
+    VkSwapchainCreateInfoKHR createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = m_surface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = surfaceFormat.format;
+    createInfo.imageColorSpace = surfaceFormat.colorSpace;
+    createInfo.imageExtent = extent;
+    createInfo.imageArrayLayers = 1;                             // Amount of layers each image consists of
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; // Directly render to swapchain
 
-    // Setup Dear ImGui style
-    ImGui::StyleColorsDark();
+    QueueFamilyIndices indices = queryQueueFamilies(m_physicalDevice);
 
-    // When viewports are enabled we tweak WindowRounding/WindowBg so platform windows can look identical to regular
-    // ones.
-    ImGuiStyle& style = ImGui::GetStyle();
-    if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
-        style.WindowRounding = 0.0f;
-        style.Colors[ImGuiCol_WindowBg].w = 1.0f;
+    if (indices.graphicsFamily != indices.presentFamily) {
+        uint32_t indicesArray[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+
+        createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT; // Multiple queue families own image
+        createInfo.queueFamilyIndexCount = 2;
+        createInfo.pQueueFamilyIndices = indicesArray;
+    } else {
+        createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE; // One queue family own image exclusively
+        createInfo.queueFamilyIndexCount = 0;
+        createInfo.pQueueFamilyIndices = nullptr;
     }
-    ImGui_ImplGlfw_InitForVulkan(g_engine->window().handle(), true);
 
-    ImGui_ImplVulkan_InitInfo initInfo{};
-    initInfo.Instance = m_instance;
-    initInfo.PhysicalDevice = m_physicalDevice;
-    initInfo.Device = m_device;
-    initInfo.Queue = m_graphicsQueue;
-    initInfo.DescriptorPool = m_imguiDescriptorPool;
-    initInfo.MinImageCount = k_maxFramesInFlight;
-    initInfo.ImageCount = k_maxFramesInFlight;
-    initInfo.MSAASamples = m_msaaSamples;
-    initInfo.CheckVkResultFn = checkVkResult;
+    createInfo.preTransform = swapchainSupport.capabilities.currentTransform;
+    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    createInfo.presentMode = presentMode;
+    createInfo.clipped = VK_TRUE; // Clip pixels that are obscured (by another
+                                  // window for example)
+    createInfo.oldSwapchain = oldSwapchain; // Lets the presentation engine hand its resources over
 
-    ImGui_ImplVulkan_Init(&initInfo, m_renderPass);
+    auto result = vkCreateSwapchainKHR(m_device, &createInfo, m_allocator, &m_swapchain.handle);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create swap chain!");
 
-    singleTimeCommands([&](VkCommandBuffer commandBuffer) { ImGui_ImplVulkan_CreateFontsTexture(commandBuffer); });
+    // Get current image count after creating swapchain
+    vkGetSwapchainImagesKHR(m_device, m_swapchain.handle, &imageCount, nullptr);
+    RDELOG_INFO("Number of images/image views/framebuffers/command buffers: {}", imageCount);
+    m_swapchain.images.resize(imageCount);
+    vkGetSwapchainImagesKHR(m_device, m_swapchain.handle, &imageCount, m_swapchain.images.data());
 
-    ImGui_ImplVulkan_DestroyFontUploadObjects();
+    m_swapchain.imageFormat = surfaceFormat.format;
+    m_swapchain.extent = extent;
 }
 
-void Renderer::createViewportImage()
+void Renderer::createOffscreenImages()
 {
-    m_viewportImages.resize(m_swapchain.images.size());
+    // Stands in for the swapchain, one image per frame in flight. Captures are copied out of them
+    m_swapchain.imageFormat = k_offscreenFormat;
+    m_swapchain.extent = {m_window->width<uint32_t>(), m_window->height<uint32_t>()};
 
-    for (size_t i = 0; i < m_swapchain.images.size(); i++) {
-        // Create the linear tiled destination image to copy to and to read the memory from
-        // Note that vkCmdBlitImage (if supported) will also do format conversions if the swapchain color format would
-        // differ
+    m_offscreenImages.resize(k_maxFramesInFlight);
+    m_swapchain.images.resize(k_maxFramesInFlight);
+    RDELOG_INFO("Rendering offscreen into {} {}x{} images",
+                k_maxFramesInFlight,
+                m_swapchain.extent.width,
+                m_swapchain.extent.height);
+
+    for (uint32_t i = 0; i < k_maxFramesInFlight; ++i) {
         createImage(m_swapchain.extent.width,
                     m_swapchain.extent.height,
                     1,
                     VK_SAMPLE_COUNT_1_BIT,
-                    VK_FORMAT_B8G8R8A8_SRGB,
-                    VK_IMAGE_TILING_LINEAR,
-                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    m_swapchain.imageFormat,
+                    VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
                     VMA_MEMORY_USAGE_AUTO,
-                    VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
-                    m_viewportImages[i]);
+                    0,
+                    m_offscreenImages[i]);
+        m_swapchain.images[i] = m_offscreenImages[i].image;
     }
 }
 
-void Renderer::createViewportImageViews()
+void Renderer::createImageViews()
 {
-    m_viewportImageViews.resize(m_viewportImages.size());
+    RDE_PROFILE_SCOPE
 
-    for (size_t i = 0; i < m_viewportImages.size(); ++i) {
-        m_viewportImageViews[i] =
-            createImageView(m_viewportImages[i].image, VK_FORMAT_B8G8R8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+    m_swapchain.imageViews.resize(m_swapchain.images.size());
+
+    for (size_t i = 0; i < m_swapchain.images.size(); ++i) {
+        m_swapchain.imageViews[i] =
+            createImageView(m_swapchain.images[i], m_swapchain.imageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
     }
 }
 
-void Renderer::createViewportImageSampler()
+void Renderer::createRenderGraph()
 {
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
+    RDE_PROFILE_SCOPE
 
-    VkPhysicalDeviceProperties properties{};
-    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
-    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-    samplerInfo.mipLodBias = 0.0f;
-    samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    RDELOG_INFO("MSAA enabled? {}, Samples: {}", isMsaaEnabled() ? "Yes" : "No", m_msaaSamples);
 
-    RDE_ASSERT_0(vkCreateSampler(m_device, &samplerInfo, m_allocator, &m_viewportSampler) == VK_SUCCESS,
-                 "Failed to create texture sampler!");
+    m_renderGraph.init(m_device, m_allocator, m_vmaAllocator);
+
+    const RenderGraph::ImageDesc swapchainDesc{m_swapchain.imageFormat, m_swapchain.extent};
+    const auto swapchainImage = m_renderGraph.importImage(
+        "Swapchain",
+        swapchainDesc,
+        m_swapchain.images,
+        m_swapchain.imageViews,
+        m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    // With upscaling the scene is drawn into its own image, large enough for the max render scale
+    const VkExtent2D sceneExtent =
+        m_upscaling ? scaledExtent(m_resolutionController.settings().maxScale) : m_swapchain.extent;
+    m_sceneColorExtent = sceneExtent;
+
+    const RenderGraph::ImageDesc depthDesc{retrieveDepthFormat(), sceneExtent, m_msaaSamples};
+    const auto depthImage = m_renderGraph.createImage("Depth", depthDesc);
+    const auto culledDraws = m_renderGraph.createBuffer("Culled draws");
+
+    // Culling has to happen outside of the render pass
+    m_cullingPass = m_renderGraph.addComputePass("GPU culling", [this](const RenderGraph::PassContext& context) {
+        if (m_frameCullingBuffers) {
+            recordGpuCulling(context.commandBuffer, *m_frameCullingBuffers);
+        }
+    });
+    m_renderGraph.writeBuffer(
+        m_cullingPass, culledDraws, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+    // Depth only, so the scene pass shades every pixel at most once. Small enough to record inline
+    if (m_depthPrePass) {
+        m_depthPass = m_renderGraph.addGraphicsPass(
+            "Depth pre-pass", [this](const RenderGraph::PassContext& context) { recordDepthPrePass(context); });
+        m_renderGraph.readBuffer(m_depthPass,
+                                 culledDraws,
+                                 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                 VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+        m_renderGraph.writeDepth(m_depthPass, depthImage, RenderGraph::AttachmentLoad::Clear);
+    }
+
+    // Everything inside the render pass is recorded into secondary command buffers
+    m_scenePass = m_renderGraph.addGraphicsPass(
+        "Scene", [this](const RenderGraph::PassContext& context) { recordScenePass(context); }, true);
+    m_renderGraph.readBuffer(m_scenePass,
+                             culledDraws,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+
+    const VkClearColorValue clearColor = {{k_clearColor.x, k_clearColor.y, k_clearColor.z, k_clearColor.w}};
+
+    auto sceneTarget = swapchainImage;
+    if (m_upscaling) {
+        const RenderGraph::ImageDesc sceneColorDesc{m_swapchain.imageFormat, sceneExtent};
+        m_sceneColorImage = m_renderGraph.createImage("Scene color", sceneColorDesc);
+        sceneTarget = m_sceneColorImage;
+    }
+
+    // Draw into the multisampled image and resolve into the scene target
+    if (isMsaaEnabled()) {
+        const RenderGraph::ImageDesc colorDesc{m_swapchain.imageFormat, sceneExtent, m_msaaSamples};
+        const auto colorImage = m_renderGraph.createImage("MSAA color", colorDesc);
+
+        m_renderGraph.writeColor(m_scenePass, colorImage, RenderGraph::AttachmentLoad::Clear, clearColor);
+        m_renderGraph.writeResolve(m_scenePass, sceneTarget);
+    } else {
+        m_renderGraph.writeColor(m_scenePass, sceneTarget, RenderGraph::AttachmentLoad::Clear, clearColor);
+    }
+    if (m_depthPrePass) {
+        m_renderGraph.readDepth(m_scenePass, depthImage);
+    } else {
+        m_renderGraph.writeDepth(m_scenePass, depthImage, RenderGraph::AttachmentLoad::Clear);
+    }
+
+    // Stretches the scene over the swapchain, then draws the UI on top at full resolution. Small enough to record
+    // inline
+    if (m_upscaling) {
+        m_upscalePass = m_renderGraph.addGraphicsPass(
+            "Upscale", [this](const RenderGraph::PassContext& context) { recordUpscalePass(context); });
+        m_renderGraph.readTexture(m_upscalePass, m_sceneColorImage, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        m_renderGraph.writeColor(m_upscalePass, swapchainImage, RenderGraph::AttachmentLoad::DontCare);
+    }
+
+    m_renderGraph.compile();
+    m_renderExtent = sceneExtent; // Until the first frame picks a scale
 }
 
-[[nodiscard]] VkImageView Renderer::createImageView(VkImage image,
-                                                    VkFormat format,
-                                                    VkImageAspectFlags aspectFlags,
-                                                    uint32_t mipLevels) const
+void Renderer::createDescriptorSetLayout()
 {
-    VkImageViewCreateInfo viewInfo{};
-    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    viewInfo.image = image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    viewInfo.format = format;
-    viewInfo.subresourceRange.aspectMask = aspectFlags;
-    viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = mipLevels;
-    viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    RDE_PROFILE_SCOPE
 
-    VkImageView imageView;
+    // Idea: Could have 4 descriptor sets instead:
+    // 0. Engine-global resources - bound once per frame
+    // 1. Per-pass resources - bound once per pass
+    // 2. Material resources - bound once per material instance
+    // 3. Per-object resources - bound once per object instance
 
-    RDE_ASSERT_0(vkCreateImageView(m_device, &viewInfo, m_allocator, &imageView) == VK_SUCCESS,
-                 "Failed to create image view!");
+    VkDescriptorSetLayoutBinding uboLayoutBinding{};
+    uboLayoutBinding.binding = 0;
+    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    uboLayoutBinding.descriptorCount = 1;
+    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-    return imageView;
+    // Clamp the bindless array to what the device can bind after update
+    VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+    vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &vulkan12Properties;
+    vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+
+    m_maxBindlessTextures = std::min({k_maxBindlessTextures,
+                                      vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                      vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers});
+
+    VkDescriptorSetLayoutBinding bindlessLayoutBinding{};
+    bindlessLayoutBinding.binding = 0;
+    bindlessLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindlessLayoutBinding.descriptorCount = m_maxBindlessTextures;
+    bindlessLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Textures are written as they load, slots past the texture count are never read
+    const VkDescriptorBindingFlags bindlessBindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                          VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT |
+                                                          VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                                          VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindlessBindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo uboLayoutInfo{};
+    uboLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    uboLayoutInfo.bindingCount = 1;
+    uboLayoutInfo.pBindings = &uboLayoutBinding;
+
+    VkDescriptorSetLayoutCreateInfo bindlessLayoutInfo{};
+    bindlessLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    bindlessLayoutInfo.pNext = &bindingFlagsInfo;
+    bindlessLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    bindlessLayoutInfo.bindingCount = 1;
+    bindlessLayoutInfo.pBindings = &bindlessLayoutBinding;
+
+    auto result = vkCreateDescriptorSetLayout(m_device, &uboLayoutInfo, m_allocator, &m_uboDescriptorSetLayout);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create UBO descriptor set layout!");
+    result = vkCreateDescriptorSetLayout(m_device, &bindlessLayoutInfo, m_allocator, &m_bindlessDescriptorSetLayout);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create bindless descriptor set layout!");
 }
 
-void Renderer::createBuffer(VkDeviceSize size,
-                            VkBufferUsageFlags bufferUsage,
-                            VkBufferCreateFlags bufferFlags,
-                            VmaMemoryUsage allocationUsage,
-                            VmaAllocationCreateFlags allocationFlags,
-                            VmaBuffer& vmaBuffer) const
+void Renderer::createBindlessDescriptorSet()
 {
-    // Create buffer
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = bufferUsage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // Only allow one queue to use
-    bufferInfo.flags = bufferFlags;
+    RDE_PROFILE_SCOPE
 
-    VmaAllocationCreateInfo allocationInfo{};
-    allocationInfo.usage = allocationUsage;
-    allocationInfo.flags = allocationFlags;
+    // Lives outside of the swapchain descriptor pool, textures outlive swapchain recreation
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = m_maxBindlessTextures;
 
-    // vmaCreateBuffer encapsulates the following:
-    // 1. Create VkBuffer
-    // 2. Allocate VkBufferMemory
-    // 3. Bind VkBuffer to VkBufferMemory
-    const auto result = vmaCreateBuffer(m_vmaAllocator,
-                                        &bufferInfo,
-                                        &allocationInfo,
-                                        &vmaBuffer.buffer,
-                                        &vmaBuffer.allocation,
-                                        &vmaBuffer.allocationInfo);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create buffer!");
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    auto result = vkCreateDescriptorPool(m_device, &poolInfo, m_allocator, &m_bindlessDescriptorPool);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create bindless descriptor pool!");
+
+    VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo{};
+    variableCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+    variableCountInfo.descriptorSetCount = 1;
+    variableCountInfo.pDescriptorCounts = &m_maxBindlessTextures;
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.pNext = &variableCountInfo;
+    allocateInfo.descriptorPool = m_bindlessDescriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &m_bindlessDescriptorSetLayout;
+
+    result = vkAllocateDescriptorSets(m_device, &allocateInfo, &m_bindlessDescriptorSet);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to allocate bindless descriptor set!");
+
+    RDELOG_INFO("Bindless texture slots: {}", m_maxBindlessTextures);
 }
 
-void Renderer::createImage(uint32_t width,
-                           uint32_t height,
-                           uint32_t mipLevels,
-                           VkSampleCountFlagBits sampleCount,
-                           VkFormat format,
-                           VkImageTiling tiling,
-                           VkImageUsageFlags imageUsage,
-                           VmaMemoryUsage allocationUsage,
-                           VmaAllocationCreateFlags allocationFlags,
-                           VmaImage& vmaImage) const
+void Renderer::createPipelineLayout()
 {
-    VkImageCreateInfo imageInfo{};
-    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    imageInfo.imageType = VK_IMAGE_TYPE_2D;
-    imageInfo.extent.width = static_cast<uint32_t>(width);
-    imageInfo.extent.height = static_cast<uint32_t>(height);
-    imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = mipLevels;
-    imageInfo.arrayLayers = 1;
-    imageInfo.format = format;
-    imageInfo.tiling = tiling;
-    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageInfo.usage = imageUsage;
-    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    imageInfo.samples = sampleCount;
-    imageInfo.flags = 0;
+    RDE_PROFILE_SCOPE
 
-    VmaAllocationCreateInfo allocationInfo{};
-    allocationInfo.usage = allocationUsage;
-    allocationInfo.flags = allocationFlags;
+    // UBO and bindless texture descriptor set layouts, shared by every pipeline state
+    const std::array<VkDescriptorSetLayout, 2> descriptorSetLayouts{m_uboDescriptorSetLayout,
+                                                                    m_bindlessDescriptorSetLayout};
 
-    // vmaCreateImage does the following:
-    // 1. Create a VkImage
-    // 2. Allocate VkDeviceMemory
-    // 3. Bind VkImage to VkDeviceMemory
-    const auto result = vmaCreateImage(
-        m_vmaAllocator, &imageInfo, &allocationInfo, &vmaImage.image, &vmaImage.allocation, &vmaImage.allocationInfo);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create image!");
+    // Vertex dequantization, pushed per mesh
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstantObject);
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    auto result = vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, m_allocator, &m_pipelineLayout);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create pipeline layout!");
+
+    m_pipelineStates.init(m_device, m_allocator, m_pipelineLayout, m_pipelineCache.handle(), g_engine->threadPool());
+}
+
+void Renderer::createMaterials()
+{
+    RDE_PROFILE_SCOPE
+
+    Material defaultMaterial{};
+    defaultMaterial.name = "Default";
+
+    Material opaqueMaterial{};
+    opaqueMaterial.name = "Opaque";
+    opaqueMaterial.pipelineState.blendMode = BlendMode::Opaque;
+
+    Material additiveMaterial{};
+    additiveMaterial.name = "Additive";
+    additiveMaterial.pipelineState.blendMode = BlendMode::Additive;
+    additiveMaterial.pipelineState.depthWriteEnable = VK_FALSE;
+
+    Material doubleSidedMaterial{};
+    doubleSidedMaterial.name = "Double-sided";
+    doubleSidedMaterial.pipelineState.cullMode = VK_CULL_MODE_NONE;
+
+    m_materials = {defaultMaterial, opaqueMaterial, additiveMaterial, doubleSidedMaterial};
+}
+
+void Renderer::createPipelines()
+{
+    RDE_PROFILE_SCOPE
+
+    if (m_upscaling) {
+        [[maybe_unused]] const auto& upscalePipeline = m_pipelineStates.get(resolveUpscalePipelineState());
+    }
+
+    // The default material is the fallback for everything else, so it has to exist before the first frame for every
+    // vertex format in use
+    for (const auto& vertexFormat : m_vertexFormats) {
+        [[maybe_unused]] const auto& defaultPipeline = m_pipelineStates.get(resolvePipelineState(0, vertexFormat));
+
+        for (uint32_t materialIndex = 1; m_compilePipelinesInBackground && materialIndex < m_materials.size();
+             ++materialIndex) {
+            [[maybe_unused]] const auto* pipeline =
+                m_pipelineStates.tryGet(resolvePipelineState(materialIndex, vertexFormat));
+        }
+
+        if (!m_depthPrePass) {
+            continue;
+        }
+        [[maybe_unused]] const auto& defaultDepthPipeline =
+            m_pipelineStates.get(resolveDepthPipelineState(0, vertexFormat));
+
+        for (uint32_t materialIndex = 1; m_compilePipelinesInBackground && materialIndex < m_materials.size();
+             ++materialIndex) {
+            if (m_materials[materialIndex].pipelineState.depthWriteEnable) {
+                [[maybe_unused]] const auto* pipeline =
+                    m_pipelineStates.tryGet(resolveDepthPipelineState(materialIndex, vertexFormat));
+            }
+        }
+    }
+}
+
+void Renderer::createCommandPools()
+{
+    RDE_PROFILE_SCOPE
+
+    QueueFamilyIndices queueFamilyIndices = queryQueueFamilies(m_physicalDevice);
+
+    VkCommandPoolCreateInfo commandPoolInfo{};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    VkCommandPoolCreateInfo transientCommandPoolInfo{};
+    transientCommandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    transientCommandPoolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    transientCommandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    auto result = vkCreateCommandPool(m_device, &commandPoolInfo, m_allocator, &m_commandPool);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create command pool!");
+
+    result = vkCreateCommandPool(m_device, &transientCommandPoolInfo, m_allocator, &m_transientCommandPool);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create transient command pool!");
+}
+
+void Renderer::createThreadCommandPools()
+{
+    RDE_PROFILE_SCOPE
+
+    QueueFamilyIndices queueFamilyIndices = queryQueueFamilies(m_physicalDevice);
+
+    VkCommandPoolCreateInfo commandPoolInfo{};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    commandPoolInfo.flags = 0; // Reset as a whole, the scene commands may be kept for many frames
+
+    const auto createThreadCommandPool = [this, &commandPoolInfo](ThreadCommandPool& threadCommandPool) {
+        auto result = vkCreateCommandPool(m_device, &commandPoolInfo, m_allocator, &threadCommandPool.commandPool);
+        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create thread command pool!");
+
+        VkCommandBufferAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = threadCommandPool.commandPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocateInfo.commandBufferCount = 1;
+
+        result = vkAllocateCommandBuffers(m_device, &allocateInfo, &threadCommandPool.commandBuffer);
+        RDE_ASSERT_0(result == VK_SUCCESS, "Failed to allocate secondary command buffer!");
+    };
+
+    // The main thread records alongside the thread pool workers
+    const uint32_t maxRecordingThreadCount = g_engine->threadPool().threadCount() + 1;
+    m_recordingThreadCount = maxRecordingThreadCount;
+
+    m_threadCommandPools.resize(k_maxFramesInFlight);
+    m_uiCommandPools.resize(k_maxFramesInFlight);
+    m_sceneCommands.resize(k_maxFramesInFlight);
+
+    for (uint32_t i = 0; i < k_maxFramesInFlight; ++i) {
+        m_threadCommandPools[i].resize(maxRecordingThreadCount);
+
+        for (auto& threadCommandPool : m_threadCommandPools[i]) {
+            createThreadCommandPool(threadCommandPool);
+        }
+        createThreadCommandPool(m_uiCommandPools[i]);
+    }
+    RDELOG_INFO("Recording draws on up to {} threads", maxRecordingThreadCount);
+}
+
+void Renderer::loadTextures()
+{
+    static auto& assetManager = g_engine->assetManager();
+    assetManager.loadTextures();
+}
+
+void Renderer::loadModels()
+{
+    auto& assetManager = g_engine->assetManager();
+    assetManager.loadModels();
+}
+
+void Renderer::createVertexBuffers()
+{
+    RDE_PROFILE_SCOPE
+
+    // One submission for every mesh instead of one per buffer
+    auto& assetManager = g_engine->assetManager();
+    singleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        assetManager.eachMesh([&](uint32_t meshId, Mesh& mesh) {
+            auto packed = VertexPacker::pack(mesh.vertices, mesh.vertexFormat);
+            mesh.vertexDequantization = packed.dequantization;
+
+            createVertexBuffer(commandBuffer, packed.positions, mesh.positionBuffer);
+            if (!packed.attributes.empty()) {
+                createVertexBuffer(commandBuffer, packed.attributes, mesh.attributeBuffer);
+            }
+
+            if (std::find(m_vertexFormats.begin(), m_vertexFormats.end(), mesh.vertexFormat) == m_vertexFormats.end()) {
+                m_vertexFormats.push_back(mesh.vertexFormat);
+            }
+
+            const auto statistics = VertexPacker::statistics(mesh.vertexFormat, mesh.vertices.size());
+            RDELOG_INFO("{}: {} vertices in {} KB instead of {} KB, {} and {} bytes fetched per vertex by the depth "
+                        "and scene passes instead of {} and {}",
+                        assetManager.getAssetName(meshId),
+                        mesh.vertices.size(),
+                        statistics.size / 1024,
+                        statistics.unpackedSize / 1024,
+                        statistics.depthFetchSize,
+                        statistics.sceneFetchSize,
+                        k_unpackedPositionStride,
+                        k_unpackedVertexStride);
+        });
+
+        const std::array<uint8_t, k_defaultAttributeSize> zeroes{};
+        createBuffer(zeroes.size(),
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                     0,
+                     VMA_MEMORY_USAGE_AUTO,
+                     0,
+                     m_defaultAttributeBuffer);
+        uploadBuffer(commandBuffer, zeroes.data(), zeroes.size(), m_defaultAttributeBuffer);
+    });
+
+    // The default material's pipeline is the fallback for every mesh, so there is always at least one format
+    if (m_vertexFormats.empty()) {
+        m_vertexFormats.push_back({});
+    }
+}
+
+void Renderer::createIndexBuffers()
+{
+    RDE_PROFILE_SCOPE
+
+    auto& assetManager = g_engine->assetManager();
+    singleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        assetManager.eachMesh([&](uint32_t meshId, Mesh& mesh) {
+            const auto indices = IndexPacker::pack(mesh.indices, {mesh.indexType, mesh.submeshes});
+            createIndexBuffer(commandBuffer, indices, mesh.indexBuffer);
+
+            RDELOG_INFO("{}: {} {}-bit indices in {} submeshes, {} KB instead of {} KB",
+                        assetManager.getAssetName(meshId),
+                        mesh.indices.size(),
+                        IndexPacker::indexSize(mesh.indexType) * 8,
+                        mesh.submeshes.size(),
+                        indices.size() / 1024,
+                        Utilities::arraysizeof(mesh.indices) / 1024);
+        });
+    });
+}
+
+void Renderer::createVertexBuffer(VkCommandBuffer commandBuffer,
+                                  const std::vector<uint8_t>& vertexStream,
+                                  VmaBuffer& vertexBuffer)
+{
+    VkDeviceSize bufferSize = Utilities::arraysizeof(vertexStream);
+
+    // Allocate vertex buffer in local device memory
+    createBuffer(bufferSize,
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 0,
+                 vertexBuffer);
+
+    uploadBuffer(commandBuffer, vertexStream.data(), bufferSize, vertexBuffer);
+}
+
+void Renderer::createIndexBuffer(VkCommandBuffer commandBuffer,
+                                 const std::vector<uint8_t>& indices,
+                                 VmaBuffer& indexBuffer)
+{
+    VkDeviceSize bufferSize = Utilities::arraysizeof(indices);
+
+    // Allocate index buffer in local device memory
+    createBuffer(bufferSize,
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 0,
+                 indexBuffer);
+
+    uploadBuffer(commandBuffer, indices.data(), bufferSize, indexBuffer);
+}
+
+void Renderer::createInstanceBuffer(InstanceBuffer& instanceBuffer)
+{
+    // Default to fit 1024 instances first
+    constexpr auto initialInstanceCount = 1024;
+    instanceBuffer.size = initialInstanceCount * instanceStride(m_instanceEncoding);
+
+    // Allocate staging buffer in host visible memory
+    createBuffer(instanceBuffer.size,
+                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                 instanceBuffer.stagingBuffer);
+
+    // Allocate instance buffer in VRAM
+    createBuffer(instanceBuffer.size,
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 0,
+                 instanceBuffer.vmaBuffer);
+}
+
+void Renderer::createUniformRing()
+{
+    RDE_PROFILE_SCOPE
+
+    static_assert(sizeof(UniformBufferObject) <= k_uniformBindingRange, "Camera doesn't fit the uniform binding!");
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+
+    // Per frame in flight rather than per swapchain image, so recorded commands don't depend on the acquired image
+    m_uniformRing.init(m_vmaAllocator,
+                       k_uniformRegionSize,
+                       k_maxFramesInFlight,
+                       k_uniformBindingRange,
+                       properties.limits.minUniformBufferOffsetAlignment);
+}
+
+void Renderer::createDescriptorPool()
+{
+    RDE_PROFILE_SCOPE
+
+    constexpr uint32_t maxDescriptorCount = 128;
+
+    VkDescriptorPoolSize uboPoolSize{};
+    uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    uboPoolSize.descriptorCount = maxDescriptorCount;
+
+    std::array<VkDescriptorPoolSize, 1> poolSizes = {std::move(uboPoolSize)};
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = maxDescriptorCount;
+    poolInfo.flags = 0;
+
+    auto result = vkCreateDescriptorPool(m_device, &poolInfo, m_allocator, &m_descriptorPool);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create descriptor pool!");
+}
+
+void Renderer::createDescriptorSets()
+{
+    RDE_PROFILE_SCOPE
+
+    VkDescriptorSetAllocateInfo uboAllocateInfo{};
+    uboAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    uboAllocateInfo.descriptorPool = m_descriptorPool;
+    uboAllocateInfo.descriptorSetCount = 1;
+    uboAllocateInfo.pSetLayouts = &m_uboDescriptorSetLayout;
+
+    const auto result = vkAllocateDescriptorSets(m_device, &uboAllocateInfo, &m_uboDescriptorSet);
+    RDE_ASSERT_2(result == VK_SUCCESS, "Failed to allocate UBO descriptor set!");
+
+    // A single set for every view and frame, the dynamic offset picks the block in the uniform ring
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = m_uniformRing.buffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = m_uniformRing.bindingRange();
+
+    VkWriteDescriptorSet uboDescriptorWrite{};
+    uboDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    uboDescriptorWrite.dstSet = m_uboDescriptorSet;
+    uboDescriptorWrite.dstBinding = 0;
+    uboDescriptorWrite.dstArrayElement = 0;
+    uboDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    uboDescriptorWrite.descriptorCount = 1;
+    uboDescriptorWrite.pBufferInfo = &bufferInfo;
+    uboDescriptorWrite.pImageInfo = nullptr;
+    uboDescriptorWrite.pTexelBufferView = nullptr;
+
+    vkUpdateDescriptorSets(m_device, 1, &uboDescriptorWrite, 0, nullptr);
+}
+
+void Renderer::createCommandBuffers()
+{
+    RDE_PROFILE_SCOPE
+
+    // Create command buffers
+    m_commandBuffers.resize(m_swapchain.images.size());
+
+    VkCommandBufferAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocateInfo.commandPool = m_commandPool;
+    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.commandBufferCount = static_cast<uint32_t>(m_commandBuffers.size());
+
+    // Recorded by drawFrame() right before they are submitted
+    auto result = vkAllocateCommandBuffers(m_device, &allocateInfo, m_commandBuffers.data());
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to allocate command buffers!");
+}
+
+void Renderer::createSynchronizationObjects()
+{
+    RDE_PROFILE_SCOPE
+
+    m_imageAvailableSemaphores.resize(k_maxFramesInFlight);
+    m_renderFinishedSemaphores.resize(k_maxFramesInFlight);
+    m_inFlightFences.resize(k_maxFramesInFlight);
+    m_frameSlotNumbers.resize(k_maxFramesInFlight, 0);
+    m_imagesInFlight.resize(m_swapchain.images.size(), VK_NULL_HANDLE);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // Set to signaled state for initial frame
+
+    for (uint32_t i = 0; i < k_maxFramesInFlight; ++i) {
+
+        auto success =
+            vkCreateSemaphore(m_device, &semaphoreInfo, m_allocator, &m_imageAvailableSemaphores[i]) == VK_SUCCESS &&
+            vkCreateSemaphore(m_device, &semaphoreInfo, m_allocator, &m_renderFinishedSemaphores[i]) == VK_SUCCESS &&
+            vkCreateFence(m_device, &fenceInfo, m_allocator, &m_inFlightFences[i]) == VK_SUCCESS;
+
+        RDE_ASSERT_0(success, "Failed to create synchronization objects for frame {}!", i);
+    }
+}
+
+void Renderer::createGpuProfiler()
+{
+    RDE_PROFILE_SCOPE
+
+    const auto queueFamilyIndices = queryQueueFamilies(m_physicalDevice);
+    m_gpuProfiler.init(m_device,
+                       m_allocator,
+                       m_physicalDevice,
+                       queueFamilyIndices.graphicsFamily.value(),
+                       k_maxFramesInFlight,
+                       k_maxGpuProfileScopes);
+}
+
+void Renderer::createCullingResources()
+{
+    RDE_PROFILE_SCOPE
+
+    // Cluster culling runs on the CPU, its command buffers are allocated once there are commands
+    m_clusterCommandBuffers.resize(k_maxFramesInFlight, VmaBuffer{});
+    if (!isClusterCullingSupported()) {
+        m_clusterCulling = false;
+    }
+
+    if (!isGpuCullingSupported()) {
+        if (m_cullingMode == CullingMode::Gpu) {
+            RDELOG_WARN("GPU culling is not supported on this device, falling back to CPU culling");
+            m_cullingMode = CullingMode::Cpu;
+        }
+        return;
+    }
+
+    // Descriptor set layout, one storage buffer per binding in cull.comp
+    std::array<VkDescriptorSetLayoutBinding, k_cullBindingCount> bindings{};
+    for (uint32_t binding = 0; binding < k_cullBindingCount; ++binding) {
+        bindings[binding].binding = binding;
+        bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[binding].descriptorCount = 1;
+        bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[binding].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    auto result = vkCreateDescriptorSetLayout(m_device, &layoutInfo, m_allocator, &m_cullDescriptorSetLayout);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create culling descriptor set layout!");
+
+    // Descriptor pool with one set per frame in flight
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = k_cullBindingCount * k_maxFramesInFlight;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = k_maxFramesInFlight;
+
+    result = vkCreateDescriptorPool(m_device, &poolInfo, m_allocator, &m_cullDescriptorPool);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create culling descriptor pool!");
+
+    std::vector<VkDescriptorSetLayout> layouts(k_maxFramesInFlight, m_cullDescriptorSetLayout);
+    std::vector<VkDescriptorSet> descriptorSets(k_maxFramesInFlight);
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = m_cullDescriptorPool;
+    allocateInfo.descriptorSetCount = k_maxFramesInFlight;
+    allocateInfo.pSetLayouts = layouts.data();
+
+    result = vkAllocateDescriptorSets(m_device, &allocateInfo, descriptorSets.data());
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to allocate culling descriptor sets!");
+
+    // Buffers are allocated lazily once the instance count is known
+    m_cullingBuffers.resize(k_maxFramesInFlight);
+    for (uint32_t i = 0; i < k_maxFramesInFlight; ++i) {
+        m_cullingBuffers[i].descriptorSet = descriptorSets[i];
+    }
+
+    m_cullPipeline.create(m_device,
+                          m_allocator,
+                          k_cullShaderPath,
+                          m_cullDescriptorSetLayout,
+                          sizeof(CullPushConstants),
+                          m_pipelineCache.handle());
+}
+
+void checkVkResult(VkResult err)
+{
+    RDE_ASSERT_0(err == VK_SUCCESS, "ImGui_ImplVulkan_ failure!");
+}
+
+void Renderer::createUpscaleResources()
+{
+    if (!m_upscaling) {
+        return;
+    }
+
+    // Bilinear, clamped so the edges of the scene don't wrap around
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.maxLod = 0.0f;
+
+    RDE_ASSERT_0(vkCreateSampler(m_device, &samplerInfo, m_allocator, &m_upscaleSampler) == VK_SUCCESS,
+                 "Failed to create upscale sampler!");
+
+    writeSceneColorDescriptor();
+}
+
+void Renderer::initImGui()
+{
+    // The editor is disabled without a window
+    if (m_headless) {
+        return;
+    }
+
+    // Create descriptor pool for ImGui to use (Type, DescriptorCount)
+    constexpr uint32_t descriptorCount = 1000;
+
+    VkDescriptorPoolSize poolSizes[] = {{VK_DESCRIPTOR_TYPE_SAMPLER, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, descriptorCount},
+                                        {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, descriptorCount}};
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolInfo.maxSets = descriptorCount;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(std::size(poolSizes));
+    poolInfo.pPoolSizes = poolSizes;
+
+    RDE_ASSERT_0(vkCreateDescriptorPool(m_device, &poolInfo, m_allocator, &m_imguiDescriptorPool) == VK_SUCCESS,
+                 "Failed to create descriptor pool for ImGui!");
+
+    // Initialize ImGui library
+    ImGui::CreateContext();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; // Enable Keyboard Controls
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;  // Enable Gamepad Controls
+    io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;     // Enable Docking
+    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;   // Enable Multi-Viewport / Platform Windows
+
+    // Setup Dear ImGui style
+    ImGui::StyleColorsDark();
+
+    // When viewports are enabled we tweak WindowRounding/WindowBg so platform windows can look identical to regular
+    // ones.
+    ImGuiStyle& style = ImGui::GetStyle();
+    if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
+        style.WindowRounding = 0.0f;
+        style.Colors[ImGuiCol_WindowBg].w = 1.0f;
+    }
+    ImGui_ImplGlfw_InitForVulkan(g_engine->window().handle(), true);
+
+    ImGui_ImplVulkan_InitInfo initInfo{};
+    initInfo.Instance = m_instance;
+    initInfo.PhysicalDevice = m_physicalDevice;
+    initInfo.Device = m_device;
+    initInfo.Queue = m_graphicsQueue;
+    initInfo.DescriptorPool = m_imguiDescriptorPool;
+    initInfo.PipelineCache = m_pipelineCache.handle();
+    initInfo.MinImageCount = k_maxFramesInFlight;
+    initInfo.ImageCount = k_maxFramesInFlight;
+    initInfo.MSAASamples = m_upscaling ? VK_SAMPLE_COUNT_1_BIT : m_msaaSamples;
+    initInfo.CheckVkResultFn = checkVkResult;
+
+    // Drawn by the upscale pass if there is one, rebuilt graphs keep compatible render passes
+    ImGui_ImplVulkan_Init(&initInfo, m_renderGraph.renderPass(m_upscaling ? m_upscalePass : m_scenePass));
+
+    singleTimeCommands([&](VkCommandBuffer commandBuffer) { ImGui_ImplVulkan_CreateFontsTexture(commandBuffer); });
+
+    ImGui_ImplVulkan_DestroyFontUploadObjects();
+}
+
+void Renderer::createViewportImage()
+{
+    m_viewportImages.resize(m_swapchain.images.size());
+
+    for (size_t i = 0; i < m_swapchain.images.size(); i++) {
+        // Create the linear tiled destination image to copy to and to read the memory from
+        // Note that vkCmdBlitImage (if supported) will also do format conversions if the swapchain color format would
+        // differ
+        createImage(m_swapchain.extent.width,
+                    m_swapchain.extent.height,
+                    1,
+                    VK_SAMPLE_COUNT_1_BIT,
+                    VK_FORMAT_B8G8R8A8_SRGB,
+                    VK_IMAGE_TILING_LINEAR,
+                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    VMA_MEMORY_USAGE_AUTO,
+                    VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                    m_viewportImages[i]);
+    }
+}
+
+void Renderer::createViewportImageViews()
+{
+    m_viewportImageViews.resize(m_viewportImages.size());
+
+    for (size_t i = 0; i < m_viewportImages.size(); ++i) {
+        m_viewportImageViews[i] =
+            createImageView(m_viewportImages[i].image, VK_FORMAT_B8G8R8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+    }
+}
+
+void Renderer::createViewportImageSampler()
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    RDE_ASSERT_0(vkCreateSampler(m_device, &samplerInfo, m_allocator, &m_viewportSampler) == VK_SUCCESS,
+                 "Failed to create texture sampler!");
+}
+
+[[nodiscard]] VkImageView Renderer::createImageView(VkImage image,
+                                                    VkFormat format,
+                                                    VkImageAspectFlags aspectFlags,
+                                                    uint32_t mipLevels) const
+{
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspectFlags;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = mipLevels;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    VkImageView imageView;
+
+    RDE_ASSERT_0(vkCreateImageView(m_device, &viewInfo, m_allocator, &imageView) == VK_SUCCESS,
+                 "Failed to create image view!");
+
+    return imageView;
+}
+
+void Renderer::createBuffer(VkDeviceSize size,
+                            VkBufferUsageFlags bufferUsage,
+                            VkBufferCreateFlags bufferFlags,
+                            VmaMemoryUsage allocationUsage,
+                            VmaAllocationCreateFlags allocationFlags,
+                            VmaBuffer& vmaBuffer) const
+{
+    // Create buffer
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = bufferUsage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // Only allow one queue to use
+    bufferInfo.flags = bufferFlags;
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.usage = allocationUsage;
+    allocationInfo.flags = allocationFlags;
+
+    // vmaCreateBuffer encapsulates the following:
+    // 1. Create VkBuffer
+    // 2. Allocate VkBufferMemory
+    // 3. Bind VkBuffer to VkBufferMemory
+    const auto result = vmaCreateBuffer(m_vmaAllocator,
+                                        &bufferInfo,
+                                        &allocationInfo,
+                                        &vmaBuffer.buffer,
+                                        &vmaBuffer.allocation,
+                                        &vmaBuffer.allocationInfo);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create buffer!");
+}
+
+void Renderer::createImage(uint32_t width,
+                           uint32_t height,
+                           uint32_t mipLevels,
+                           VkSampleCountFlagBits sampleCount,
+                           VkFormat format,
+                           VkImageTiling tiling,
+                           VkImageUsageFlags imageUsage,
+                           VmaMemoryUsage allocationUsage,
+                           VmaAllocationCreateFlags allocationFlags,
+                           VmaImage& vmaImage) const
+{
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = static_cast<uint32_t>(width);
+    imageInfo.extent.height = static_cast<uint32_t>(height);
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = format;
+    imageInfo.tiling = tiling;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = imageUsage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.samples = sampleCount;
+    imageInfo.flags = 0;
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.usage = allocationUsage;
+    allocationInfo.flags = allocationFlags;
+
+    // vmaCreateImage does the following:
+    // 1. Create a VkImage
+    // 2. Allocate VkDeviceMemory
+    // 3. Bind VkImage to VkDeviceMemory
+    const auto result = vmaCreateImage(
+        m_vmaAllocator, &imageInfo, &allocationInfo, &vmaImage.image, &vmaImage.allocation, &vmaImage.allocationInfo);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create image!");
+}
+
+void Renderer::createTextureImage(Texture& texture, const Ktx2Texture& ktxTexture, uint32_t firstLevel)
+{
+    RDE_PROFILE_SCOPE
+
+    singleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        recordTextureUpload(commandBuffer, texture, ktxTexture, firstLevel);
+    });
+
+    RDELOG_INFO("Uploaded {}x{} {} texture with {} of {} levels ({} KB)",
+                ktxTexture.width,
+                ktxTexture.height,
+                Ktx2Texture::formatName(ktxTexture.format),
+                texture.mipLevels,
+                ktxTexture.levels.size(),
+                TextureStreamer::residentSize(ktxTexture, firstLevel) / 1024);
+}
+
+void Renderer::recordTextureUpload(VkCommandBuffer commandBuffer,
+                                   Texture& texture,
+                                   const Ktx2Texture& ktxTexture,
+                                   uint32_t firstLevel)
+{
+    // Mips are never generated on the GPU, every level comes from the file or the CPU mip generator
+    const auto& topLevel = ktxTexture.levels[firstLevel];
+    texture.residentMip = firstLevel;
+    texture.mipLevels = static_cast<uint32_t>(ktxTexture.levels.size()) - firstLevel;
+
+    createImage(topLevel.width,
+                topLevel.height,
+                texture.mipLevels,
+                VK_SAMPLE_COUNT_1_BIT,
+                ktxTexture.format,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VMA_MEMORY_USAGE_AUTO,
+                0,
+                texture.vmaImage);
+
+    // Levels are stored largest first, so the uploaded ones are one contiguous range
+    const size_t uploadSize = ktxTexture.data.size() - topLevel.offset;
+    const auto staging = m_stagingPool.allocate(uploadSize, k_stagingAlignment);
+    memcpy(staging.data, ktxTexture.data.data() + topLevel.offset, uploadSize);
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = texture.vmaImage.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = texture.mipLevels;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+
+    std::vector<VkBufferImageCopy> regions(texture.mipLevels);
+    for (uint32_t level = 0; level < texture.mipLevels; ++level) {
+        const auto& sourceLevel = ktxTexture.levels[firstLevel + level];
+        auto& region = regions[level];
+        region.bufferOffset = staging.offset + (sourceLevel.offset - topLevel.offset);
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {sourceLevel.width, sourceLevel.height, 1};
+    }
+    vkCmdCopyBufferToImage(commandBuffer,
+                           staging.buffer,
+                           texture.vmaImage.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()),
+                           regions.data());
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+}
+
+void Renderer::updateTextureStreaming()
+{
+    if (!m_textureStreaming) {
+        return;
+    }
+    RDE_PROFILE_SCOPE
+
+    m_textureStreamer.beginFrame();
+
+    auto& assetManager = g_engine->assetManager();
+
+    // Instances refer to textures by bindless index, so requests are looked up by it
+    constexpr uint32_t noRequest = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> slotRequests(m_bindlessTextureCount, noRequest);
+    std::vector<Texture*> textures;
+    std::vector<TextureStreamer::Request> requests;
+
+    assetManager.eachTexture([&](Texture& texture) {
+        if (!texture.source) {
+            return;
+        }
+        slotRequests[texture.bindlessIndex] = static_cast<uint32_t>(requests.size());
+        textures.push_back(&texture);
+
+        TextureStreamer::Request request{};
+        request.source = texture.source.get();
+        request.residentMip = texture.residentMip;
+        request.wantedMip = TextureStreamer::baseMip(*texture.source);
+        requests.push_back(request);
+    });
+    if (requests.empty()) {
+        return;
+    }
+
+    const auto camera = retrieveCameraMatrices();
+    const auto frustum = Frustum::fromViewProjection(camera.projection * camera.view);
+    const auto& sceneCamera = g_engine->currentScene().camera();
+
+    // Projected diameter in pixels of a sphere is its radius over its distance, scaled by this
+    const float pixelsPerRadius = std::abs(camera.projection[1][1]) * static_cast<float>(m_renderExtent.height);
+
+    for (const auto& [key, batch] : m_meshInstances) {
+        const auto& mesh = assetManager.getMesh(key.first);
+
+        for (const auto& instance : batch->instances) {
+            if (instance.textureIndex >= slotRequests.size() || slotRequests[instance.textureIndex] == noRequest) {
+                continue;
+            }
+            const auto sphere = Culling::transformBoundingSphere(mesh.boundingSphere, instance.modelTransform);
+            if (!frustum.intersectsSphere(glm::vec3(sphere), sphere.w)) {
+                continue;
+            }
+            const float distance = std::max(glm::distance(sceneCamera.eye, glm::vec3(sphere)), sceneCamera.nearClip);
+            const float screenSize = sphere.w / distance * pixelsPerRadius;
+
+            auto& request = requests[slotRequests[instance.textureIndex]];
+            request.wantedMip =
+                std::min(request.wantedMip, TextureStreamer::mipForScreenSize(*request.source, screenSize));
+            request.screenSize = std::max(request.screenSize, screenSize);
+        }
+    }
+
+    const auto changes = m_textureStreamer.plan(requests);
+    if (changes.empty()) {
+        return;
+    }
+
+    // This frame slot's fence was just waited on, so its previous uploads have finished
+    VkCommandBuffer commandBuffer = m_streamingCommandBuffers[m_currentFrame];
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // Each change gets a new image and bindless slot, the old ones may still be sampled by frames in flight
+    for (const auto& change : changes) {
+        auto& texture = *textures[change.request];
+        retireImage(texture.vmaImage, texture.imageView);
+        retireBindlessSlot(texture.bindlessIndex);
+
+        recordTextureUpload(commandBuffer, texture, *texture.source, change.residentMip);
+        texture.imageView = createImageView(
+            texture.vmaImage.image, texture.source->format, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels);
+        registerBindlessTexture(texture);
+    }
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    // Not waited on, unlike single time commands
+    const auto result = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_stagingPool.retire());
+    RDE_ASSERT_2(result == VK_SUCCESS, "Failed to submit texture streaming uploads!");
+}
+
+void Renderer::createTextureSampler(Texture& texture)
+{
+    RDE_PROFILE_SCOPE
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = m_enableMipmaps ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE; // The image view limits the levels, streaming changes it
+
+    RDE_ASSERT_0(vkCreateSampler(m_device, &samplerInfo, m_allocator, &texture.sampler) == VK_SUCCESS,
+                 "Failed to create texture sampler!");
+}
+
+[[nodiscard]] uint32_t Renderer::acquireBindlessSlot()
+{
+    // Slots of retired streamed textures and scene color images are reused first
+    if (!m_freeBindlessSlots.empty()) {
+        const uint32_t slot = m_freeBindlessSlots.back();
+        m_freeBindlessSlots.pop_back();
+        return slot;
+    }
+    RDE_ASSERT_0(m_bindlessTextureCount < m_maxBindlessTextures, "Out of bindless texture slots!");
+    return m_bindlessTextureCount++;
+}
+
+void Renderer::registerBindlessTexture(Texture& texture)
+{
+    texture.bindlessIndex = acquireBindlessSlot();
+    writeBindlessDescriptor(texture.bindlessIndex, texture.imageView, texture.sampler);
+}
+
+void Renderer::writeBindlessDescriptor(uint32_t index, VkImageView imageView, VkSampler sampler)
+{
+    VkDescriptorImageInfo descriptor{};
+    descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    descriptor.imageView = imageView;
+    descriptor.sampler = sampler;
+
+    VkWriteDescriptorSet samplerDescriptorWrite{};
+    samplerDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    samplerDescriptorWrite.dstSet = m_bindlessDescriptorSet;
+    samplerDescriptorWrite.dstBinding = 0;
+    samplerDescriptorWrite.dstArrayElement = index;
+    samplerDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerDescriptorWrite.descriptorCount = 1;
+    samplerDescriptorWrite.pBufferInfo = nullptr;
+    samplerDescriptorWrite.pImageInfo = &descriptor;
+    samplerDescriptorWrite.pTexelBufferView = nullptr;
+
+    // Update-after-bind and update-unused-while-pending, safe as long as pending command buffers don't use the slot
+    vkUpdateDescriptorSets(m_device, 1, &samplerDescriptorWrite, 0, nullptr);
+}
+
+void Renderer::cleanupSwapchain()
+{
+    vkFreeCommandBuffers(
+        m_device, m_commandPool, static_cast<uint32_t>(m_commandBuffers.size()), m_commandBuffers.data());
+    // Every pipeline was created for the render pass
+    m_pipelineStates.clear();
+    m_renderGraph.destroy();
+
+    for (auto imageView : m_swapchain.imageViews) {
+        vkDestroyImageView(m_device, imageView, m_allocator);
+    }
+
+    vkDestroySwapchainKHR(m_device, m_swapchain.handle, m_allocator);
+
+    for (auto& offscreenImage : m_offscreenImages) {
+        vmaDestroyImage(m_vmaAllocator, offscreenImage.image, offscreenImage.allocation);
+    }
+    m_offscreenImages.clear();
+}
+
+void Renderer::recreateSwapchain()
+{
+    RDE_PROFILE_SCOPE
+
+    // Handle minimization (framebuffer size 0)
+    int width = 0, height = 0;
+    while (!m_headless && (width == 0 || height == 0)) {
+        glfwGetFramebufferSize(m_window->handle(), &width, &height);
+        glfwWaitEvents();
+    }
+
+    Clock::Timer recreateTimer;
+    Clock::start(recreateTimer);
+
+    // Frames in flight keep presenting from and rendering into the old objects, which are destroyed once they finish
+    const auto oldFormat = m_swapchain.imageFormat;
+    const auto oldImageCount = m_swapchain.images.size();
+    const auto oldSwapchain = m_swapchain.handle;
+    retireSwapchain();
+
+    createSwapchain(oldSwapchain);
+    createImageViews();
+
+    // Pipelines stay valid with every render pass of the same formats, only a new surface format invalidates them.
+    // That is rare, e.g. when the window moves to a display with a different format
+    const bool formatChanged = m_swapchain.imageFormat != oldFormat;
+    if (formatChanged) {
+        retirePipelines();
+    }
+
+    createRenderGraph();
+    writeSceneColorDescriptor();
+    if (formatChanged) {
+        createPipelines();
+    }
+
+    // Per swapchain image, they only change with the image count
+    if (m_swapchain.images.size() != oldImageCount) {
+        retireCommandBuffers();
+        createCommandBuffers();
+        m_imagesInFlight.assign(m_swapchain.images.size(), VK_NULL_HANDLE);
+    }
+
+    // Timings from before the resize aren't comparable
+    m_gpuProfiler.clearResults();
+    m_resolutionController.reset(m_resolutionController.scale());
+
+    m_framePacingStatistics.swapchainRecreateTime = Clock::stop(recreateTimer);
+    RDELOG_INFO("Swapchain recreated in {:.2f} ms, {} objects waiting for frames in flight",
+                m_framePacingStatistics.swapchainRecreateTime,
+                m_deletionQueue.pendingCount());
+}
+
+void Renderer::retireSwapchain()
+{
+    // The graph owns the attachments, framebuffers and render passes sized for the old swapchain
+    retireRenderGraph();
+
+    retire([this, swapchain = m_swapchain, offscreenImages = m_offscreenImages]() {
+        for (auto imageView : swapchain.imageViews) {
+            vkDestroyImageView(m_device, imageView, m_allocator);
+        }
+        vkDestroySwapchainKHR(m_device, swapchain.handle, m_allocator);
+        for (const auto& offscreenImage : offscreenImages) {
+            vmaDestroyImage(m_vmaAllocator, offscreenImage.image, offscreenImage.allocation);
+        }
+    });
+    m_swapchain.imageViews.clear();
+    m_offscreenImages.clear();
+}
+
+void Renderer::retireCommandBuffers()
+{
+    retire([this, commandBuffers = m_commandBuffers]() {
+        vkFreeCommandBuffers(
+            m_device, m_commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+    });
+    m_commandBuffers.clear();
+}
+
+void Renderer::rebuildRenderGraph()
+{
+    RDE_PROFILE_SCOPE
+
+    // Every pipeline was created for a render pass of the old graph, frames in flight may still use both
+    retirePipelines();
+    retireRenderGraph();
+
+    createRenderGraph();
+    writeSceneColorDescriptor();
+    createPipelines();
+
+    m_gpuProfiler.clearResults();
+    m_resolutionController.reset(m_resolutionController.scale());
+    m_renderGraphDirty = false;
+}
+
+void Renderer::retire(DeletionQueue::Deleter deleter)
+{
+    // The frame being recorded may already reference the object, it is the next one to be submitted
+    m_deletionQueue.retire(m_frameNumber + 1, std::move(deleter));
+}
+
+void Renderer::retireBuffer(VmaBuffer& buffer)
+{
+    if (buffer.buffer == VK_NULL_HANDLE) {
+        return;
+    }
+    retire([this, buffer]() { vmaDestroyBuffer(m_vmaAllocator, buffer.buffer, buffer.allocation); });
+    buffer = {};
+
+    // A later buffer may get the same handle, recorded commands can't be told apart by it
+    invalidateSceneCommands();
+}
+
+void Renderer::retireImage(VmaImage& image, VkImageView& imageView)
+{
+    retire([this, image, imageView]() {
+        vkDestroyImageView(m_device, imageView, m_allocator);
+        vmaDestroyImage(m_vmaAllocator, image.image, image.allocation);
+    });
+    image = {};
+    imageView = VK_NULL_HANDLE;
+}
+
+void Renderer::retireBindlessSlot(uint32_t slot)
+{
+    // Reused only once no frame in flight can sample through it anymore
+    retire([this, slot]() { m_freeBindlessSlots.push_back(slot); });
+}
+
+void Renderer::retireTexture(Texture& texture)
+{
+    retire([this, sampler = texture.sampler]() { vkDestroySampler(m_device, sampler, m_allocator); });
+    texture.sampler = VK_NULL_HANDLE;
+    retireImage(texture.vmaImage, texture.imageView);
+    retireBindlessSlot(texture.bindlessIndex);
+}
+
+void Renderer::retireMesh(Mesh& mesh)
+{
+    retireBuffer(mesh.instanceBuffer.vmaBuffer);
+    retireBuffer(mesh.instanceBuffer.stagingBuffer);
+    retireBuffer(mesh.indexBuffer);
+    retireBuffer(mesh.attributeBuffer);
+    retireBuffer(mesh.positionBuffer);
+    mesh.instanceBuffer.size = 0;
+}
+
+void Renderer::retireRenderGraph()
+{
+    invalidateSceneCommands();
+
+    auto renderGraph = std::make_shared<RenderGraph>(std::move(m_renderGraph));
+    m_renderGraph = RenderGraph{};
+
+    // Pipelines that started compiling with one of its render passes are kept, the new ones are compatible
+    retire([this, renderGraph]() {
+        m_pipelineStates.waitForCompiles();
+        renderGraph->destroy();
+    });
+}
+
+void Renderer::retirePipelines()
+{
+    invalidateSceneCommands();
+    retire([this, pipelines = m_pipelineStates.release()]() mutable {
+        for (auto& pipeline : pipelines) {
+            pipeline.destroy(m_device, m_allocator);
+        }
+    });
+}
+
+void Renderer::cleanUpImGui()
+{
+    if (m_headless) {
+        return;
+    }
+    ImGui_ImplVulkan_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+    vkDestroyDescriptorPool(m_device, m_imguiDescriptorPool, m_allocator);
+}
+
+void Renderer::uploadBuffer(VkCommandBuffer commandBuffer, const void* data, VkDeviceSize size, VmaBuffer& dstBuffer)
+{
+    // Released once the submission recorded into commandBuffer has finished
+    const auto staging = m_stagingPool.allocate(size, k_stagingAlignment);
+    memcpy(staging.data, data, static_cast<size_t>(size));
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = staging.offset;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, staging.buffer, dstBuffer.buffer, 1, &copyRegion);
+}
+
+void Renderer::copyBuffer(const VmaBuffer& srcBuffer, VmaBuffer& dstBuffer, VkDeviceSize size)
+{
+    singleTimeCommands([&](VkCommandBuffer commandBuffer) {
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = 0;
+        copyRegion.dstOffset = 0;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(commandBuffer, srcBuffer.buffer, dstBuffer.buffer, 1, &copyRegion);
+    });
+}
+
+void Renderer::updateUniforms()
+{
+    // This frame's fence has been waited on, nothing reads its region anymore. Further views and passes push their
+    // blocks here too and bind set 0 at the returned offsets
+    m_uniformRing.beginFrame(static_cast<uint32_t>(m_currentFrame));
+    m_viewUniformOffset = m_uniformRing.push(retrieveCameraMatrices());
+}
+
+[[nodiscard]] UniformBufferObject Renderer::retrieveCameraMatrices() const
+{
+    UniformBufferObject ubo{};
+
+    const auto& camera = g_engine->currentScene().camera();
+
+    ubo.view = glm::lookAt(camera.eye, camera.eye + camera.front, camera.up);
+    ubo.projection = glm::perspective(glm::radians(camera.fov),
+                                      m_swapchain.extent.width / (float)m_swapchain.extent.height,
+                                      camera.nearClip,
+                                      camera.farClip);
+
+    // Flip Y
+    ubo.projection[1][1] *= -1.0f;
+
+    return ubo;
+}
+
+void Renderer::reserveCullingBuffers(CullingBuffers& buffers,
+                                     uint32_t instanceCount,
+                                     uint32_t batchCount,
+                                     uint32_t commandCount)
+{
+    const uint32_t stride = instanceStride(m_instanceEncoding);
+    if (instanceCount <= buffers.instanceCapacity && batchCount <= buffers.batchCapacity &&
+        commandCount <= buffers.commandCapacity && stride == buffers.instanceStride) {
+        return;
+    }
+
+    // Grow geometrically to avoid reallocating every time an instance is added
+    const uint32_t instanceCapacity = std::max(instanceCount, buffers.instanceCapacity * 2);
+    const uint32_t batchCapacity = std::max(batchCount, buffers.batchCapacity * 2);
+    const uint32_t commandCapacity = std::max(commandCount, buffers.commandCapacity * 2);
+
+    // This frame's fence has signalled, but the buffers take the same deferred path as everything else
+    retireCullingBuffers(buffers);
+
+    const VkDeviceSize instancesSize = static_cast<VkDeviceSize>(instanceCapacity) * stride;
+    const VkDeviceSize indicesSize = instanceCapacity * sizeof(uint32_t);
+    const VkDeviceSize batchesSize = batchCapacity * sizeof(CullBatch);
+    const VkDeviceSize commandsSize = commandCapacity * sizeof(VkDrawIndexedIndirectCommand);
+    const VkDeviceSize drawCountsSize = batchCapacity * sizeof(uint32_t);
+
+    constexpr VmaAllocationCreateFlags hostWriteFlags =
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    constexpr VmaAllocationCreateFlags hostReadFlags =
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    // Inputs written by the CPU every frame
+    createBuffer(instancesSize,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 hostWriteFlags,
+                 buffers.instances);
+    createBuffer(indicesSize,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 hostWriteFlags,
+                 buffers.instanceBatches);
+    createBuffer(
+        batchesSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, VMA_MEMORY_USAGE_AUTO, hostWriteFlags, buffers.batches);
+    createBuffer(commandsSize,
+                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 hostWriteFlags,
+                 buffers.commandTemplates);
+
+    // Outputs written by cull.comp
+    createBuffer(instancesSize,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 0,
+                 buffers.visibleInstances);
+    createBuffer(
+        indicesSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, VMA_MEMORY_USAGE_AUTO, 0, buffers.visibleIndices);
+    createBuffer(commandsSize,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 0,
+                 buffers.commands);
+    createBuffer(drawCountsSize,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 0,
+                 buffers.drawCounts);
+
+    createBuffer(
+        commandsSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, 0, VMA_MEMORY_USAGE_AUTO, hostReadFlags, buffers.readback);
+
+    buffers.instanceStride = stride;
+    buffers.instanceCapacity = instanceCapacity;
+    buffers.batchCapacity = batchCapacity;
+    buffers.commandCapacity = commandCapacity;
+
+    // Point the descriptor set at the new buffers, in cull.comp binding order
+    const std::array<VkBuffer, k_cullBindingCount> bindingBuffers = {buffers.instances.buffer,
+                                                                     buffers.instanceBatches.buffer,
+                                                                     buffers.batches.buffer,
+                                                                     buffers.visibleInstances.buffer,
+                                                                     buffers.visibleIndices.buffer,
+                                                                     buffers.commands.buffer,
+                                                                     buffers.drawCounts.buffer};
+
+    std::array<VkDescriptorBufferInfo, k_cullBindingCount> bufferInfos{};
+    std::array<VkWriteDescriptorSet, k_cullBindingCount> descriptorWrites{};
+
+    for (uint32_t binding = 0; binding < k_cullBindingCount; ++binding) {
+        bufferInfos[binding].buffer = bindingBuffers[binding];
+        bufferInfos[binding].offset = 0;
+        bufferInfos[binding].range = VK_WHOLE_SIZE;
+
+        descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[binding].dstSet = buffers.descriptorSet;
+        descriptorWrites[binding].dstBinding = binding;
+        descriptorWrites[binding].dstArrayElement = 0;
+        descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[binding].descriptorCount = 1;
+        descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+    }
+
+    vkUpdateDescriptorSets(
+        m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void Renderer::retireCullingBuffers(CullingBuffers& buffers)
+{
+    for (VmaBuffer* vmaBuffer : {&buffers.instances,
+                                 &buffers.instanceBatches,
+                                 &buffers.batches,
+                                 &buffers.commandTemplates,
+                                 &buffers.visibleInstances,
+                                 &buffers.visibleIndices,
+                                 &buffers.commands,
+                                 &buffers.drawCounts,
+                                 &buffers.readback}) {
+        retireBuffer(*vmaBuffer);
+    }
+
+    buffers.instanceStride = 0;
+    buffers.instanceCapacity = 0;
+    buffers.batchCapacity = 0;
+    buffers.commandCapacity = 0;
+}
+
+void Renderer::prepareGpuCulling()
+{
+    static auto& assetManager = g_engine->assetManager();
+    auto& buffers = m_cullingBuffers[m_currentFrame];
+
+    // Results from the last submission of this frame are ready now that its fence has signalled
+    readbackGpuCulling(buffers);
+
+    const auto camera = retrieveCameraMatrices();
+    m_cullFrustum = Frustum::fromViewProjection(camera.projection * camera.view);
+
+    // Flatten all batches into a single instance array so one dispatch culls everything
+    m_cullBatchMeshIds.clear();
+    m_cullBatchMaterialIndices.clear();
+    m_cullBatches.clear();
+    m_cullInstances.clear();
+    m_cullInstanceBatches.clear();
+    m_cullCommandCount = 0;
+
+    for (const auto& [key, instanceBatch] : m_meshInstances) {
+        const auto& [meshId, materialIndex] = key;
+        const auto* instanceData = &instanceBatch->instances;
+        const auto meshInstanceCount = static_cast<uint32_t>(instanceData->size());
+        const uint32_t maxInstancesPerDraw = m_maxInstancesPerDraw ? m_maxInstancesPerDraw : meshInstanceCount;
+        const auto& mesh = assetManager.getMesh(meshId);
+
+        // Every batch becomes one indirect draw per submesh, so large meshes may be split over several batches
+        for (uint32_t first = 0; first < meshInstanceCount; first += maxInstancesPerDraw) {
+            const auto batchIndex = static_cast<uint32_t>(m_cullBatches.size());
+
+            CullBatch batch{};
+            batch.boundingSphere = mesh.boundingSphere;
+            batch.firstInstance = static_cast<uint32_t>(m_cullInstances.size());
+            batch.instanceCount = std::min(maxInstancesPerDraw, meshInstanceCount - first);
+            batch.firstCommand = m_cullCommandCount;
+            batch.commandCount = static_cast<uint32_t>(mesh.submeshes.size());
+            m_cullCommandCount += batch.commandCount;
+
+            m_cullBatchMeshIds.push_back(meshId);
+            m_cullBatchMaterialIndices.push_back(materialIndex);
+            m_cullBatches.push_back(batch);
+            m_cullInstances.insert(m_cullInstances.end(),
+                                   instanceData->begin() + first,
+                                   instanceData->begin() + first + batch.instanceCount);
+            m_cullInstanceBatches.insert(m_cullInstanceBatches.end(), batch.instanceCount, batchIndex);
+        }
+    }
+
+    const auto instanceCount = static_cast<uint32_t>(m_cullInstances.size());
+    const auto batchCount = static_cast<uint32_t>(m_cullBatches.size());
+    m_submittedInstanceCount = instanceCount;
+
+    if (!batchCount) {
+        return;
+    }
+    reserveCullingBuffers(buffers, instanceCount, batchCount, m_cullCommandCount);
+
+    InstancePacker::pack(
+        m_instanceEncoding, m_cullInstances.data(), instanceCount, buffers.instances.allocationInfo.pMappedData);
+    memcpy(buffers.instanceBatches.allocationInfo.pMappedData,
+           m_cullInstanceBatches.data(),
+           instanceCount * sizeof(uint32_t));
+    memcpy(buffers.batches.allocationInfo.pMappedData, m_cullBatches.data(), batchCount * sizeof(CullBatch));
+
+    // Instance counts start at zero and are incremented by cull.comp. The instance buffer is bound at each
+    // batch's offset, so firstInstance stays zero and drawIndirectFirstInstance is not required
+    auto* commands = static_cast<VkDrawIndexedIndirectCommand*>(buffers.commandTemplates.allocationInfo.pMappedData);
+    buffers.submittedFirstCommands.clear();
+
+    for (uint32_t batchIndex = 0; batchIndex < batchCount; ++batchIndex) {
+        const auto& mesh = assetManager.getMesh(m_cullBatchMeshIds[batchIndex]);
+        const auto& batch = m_cullBatches[batchIndex];
+
+        for (uint32_t i = 0; i < batch.commandCount; ++i) {
+            const auto& submesh = mesh.submeshes[i];
+            auto& command = commands[batch.firstCommand + i];
+
+            command.indexCount = submesh.indexCount;
+            command.instanceCount = 0;
+            command.firstIndex = submesh.firstIndex;
+            command.vertexOffset = submesh.vertexOffset;
+            command.firstInstance = 0;
+        }
+        buffers.submittedFirstCommands.push_back(batch.firstCommand);
+    }
+
+    buffers.expectedInstanceCounts.clear();
+
+    if (m_validateGpuCulling) {
+        std::vector<uint32_t> visibleIndices;
+        Culling::cullInstances(m_cullFrustum,
+                               m_cullInstances,
+                               m_cullInstanceBatches,
+                               m_cullBatches,
+                               visibleIndices,
+                               buffers.expectedInstanceCounts);
+    }
+}
+
+void Renderer::readbackGpuCulling(CullingBuffers& buffers)
+{
+    if (buffers.submittedFirstCommands.empty()) {
+        return;
+    }
+    vmaInvalidateAllocation(m_vmaAllocator, buffers.readback.allocation, 0, VK_WHOLE_SIZE);
+
+    const auto* commands =
+        static_cast<const VkDrawIndexedIndirectCommand*>(buffers.readback.allocationInfo.pMappedData);
+
+    // Every submesh command of a batch has the same instance count, the first one stands for the batch
+    uint32_t visibleInstanceCount = 0;
+    for (uint32_t batchIndex = 0; batchIndex < buffers.submittedFirstCommands.size(); ++batchIndex) {
+        const auto& command = commands[buffers.submittedFirstCommands[batchIndex]];
+        visibleInstanceCount += command.instanceCount;
+
+        if (buffers.expectedInstanceCounts.empty()) {
+            continue;
+        }
+        ++m_validatedCullBatchCount;
+        if (command.instanceCount != buffers.expectedInstanceCounts[batchIndex]) {
+            ++m_cullMismatchCount;
+            RDELOG_WARN("GPU culling mismatch in batch {}: {} visible on GPU, {} on CPU",
+                        batchIndex,
+                        command.instanceCount,
+                        buffers.expectedInstanceCounts[batchIndex]);
+        }
+    }
+    m_visibleInstanceCount = visibleInstanceCount;
+    buffers.submittedFirstCommands.clear();
+}
+
+[[nodiscard]] bool Renderer::isClusterCulled(const Mesh& mesh) const
+{
+    return m_clusterCulling && m_cullingMode == CullingMode::Cpu &&
+           mesh.meshlets.size() >= k_minClusterCulledMeshletCount;
+}
+
+void Renderer::cullClusters(const Mesh& mesh,
+                            InstanceBatch& batch,
+                            const Frustum& frustum,
+                            const glm::vec3& cameraPosition)
+{
+    RDE_PROFILE_SCOPE
+
+    auto& statistics = m_clusterCullingStatistics;
+    batch.firstClusterCommand = static_cast<uint32_t>(m_clusterCommands.size());
+
+    const uint32_t lastInstance = batch.firstInstance + batch.instanceCount;
+    for (uint32_t instanceIndex = batch.firstInstance; instanceIndex < lastInstance; ++instanceIndex) {
+        m_visibleMeshlets.clear();
+        Culling::cullMeshlets(frustum,
+                              cameraPosition,
+                              mesh.meshlets,
+                              m_visibleInstances[instanceIndex].modelTransform,
+                              m_visibleMeshlets);
+
+        // Meshlets follow each other in the index buffer, so visible neighbours of a submesh merge into one command
+        VkDrawIndexedIndirectCommand* command = nullptr;
+        for (const uint32_t meshletIndex : m_visibleMeshlets) {
+            const auto& meshlet = mesh.meshlets[meshletIndex];
+            if (command && command->vertexOffset == meshlet.vertexOffset &&
+                command->firstIndex + command->indexCount == meshlet.firstIndex) {
+                command->indexCount += meshlet.indexCount;
+            } else {
+                command = &m_clusterCommands.emplace_back(VkDrawIndexedIndirectCommand{
+                    meshlet.indexCount, 1, meshlet.firstIndex, meshlet.vertexOffset, instanceIndex});
+            }
+            statistics.visibleTriangleCount += meshlet.indexCount / 3;
+        }
+
+        statistics.meshletCount += static_cast<uint32_t>(mesh.meshlets.size());
+        statistics.visibleMeshletCount += static_cast<uint32_t>(m_visibleMeshlets.size());
+        statistics.triangleCount += static_cast<uint32_t>(mesh.indices.size() / 3);
+    }
+    batch.clusterCommandCount = static_cast<uint32_t>(m_clusterCommands.size()) - batch.firstClusterCommand;
+}
+
+void Renderer::uploadClusterCommands()
+{
+    if (m_clusterCommands.empty()) {
+        return;
+    }
+    auto& commandBuffer = m_clusterCommandBuffers[m_currentFrame];
+    const VkDeviceSize size = Utilities::arraysizeof(m_clusterCommands);
+
+    if (commandBuffer.allocationInfo.size < size) {
+        const VkDeviceSize capacity = std::max(size, commandBuffer.allocationInfo.size * 2);
+        retireBuffer(commandBuffer);
+        createBuffer(capacity,
+                     VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                     0,
+                     VMA_MEMORY_USAGE_AUTO,
+                     VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                     commandBuffer);
+    }
+    memcpy(commandBuffer.allocationInfo.pMappedData, m_clusterCommands.data(), size);
+}
+
+void Renderer::recordGpuCulling(VkCommandBuffer commandBuffer, const CullingBuffers& buffers)
+{
+    const auto instanceCount = static_cast<uint32_t>(m_cullInstances.size());
+    const auto batchCount = static_cast<uint32_t>(m_cullBatches.size());
+
+    // Reset indirect commands and draw counts
+    VkBufferCopy commandsRegion{};
+    commandsRegion.srcOffset = 0;
+    commandsRegion.dstOffset = 0;
+    commandsRegion.size = m_cullCommandCount * sizeof(VkDrawIndexedIndirectCommand);
+
+    vkCmdCopyBuffer(commandBuffer, buffers.commandTemplates.buffer, buffers.commands.buffer, 1, &commandsRegion);
+    vkCmdFillBuffer(commandBuffer, buffers.drawCounts.buffer, 0, batchCount * sizeof(uint32_t), 0);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+
+    // Cull and compact
+    CullPushConstants pushConstants{};
+    pushConstants.frustumPlanes = m_cullFrustum.planes;
+    pushConstants.instanceCount = instanceCount;
+    pushConstants.batchCount = batchCount;
+    pushConstants.instanceEncoding = static_cast<uint32_t>(m_instanceEncoding);
+    pushConstants.instanceStride = instanceStride(m_instanceEncoding) / sizeof(uint32_t);
+
+    m_cullPipeline.bind(commandBuffer);
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            m_cullPipeline.layout(),
+                            /* firstSet */ 0,
+                            /* descriptorSetCount */ 1,
+                            &buffers.descriptorSet,
+                            /* dynamicOffsetCount */ 0,
+                            /* pDynamicOffsets */ nullptr);
+    vkCmdPushConstants(commandBuffer,
+                       m_cullPipeline.layout(),
+                       VK_SHADER_STAGE_COMPUTE_BIT,
+                       0,
+                       sizeof(CullPushConstants),
+                       &pushConstants);
+    vkCmdDispatch(commandBuffer, (instanceCount + k_cullWorkgroupSize - 1) / k_cullWorkgroupSize, 1, 1);
+
+    // The render graph makes the results visible to the scene pass, only the readback copy is synchronized here
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+
+    vkCmdCopyBuffer(commandBuffer, buffers.commands.buffer, buffers.readback.buffer, 1, &commandsRegion);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+}
+
+void Renderer::recordCommandBuffers(uint32_t imageIndex)
+{
+    VkResult result;
+
+    // Explicitly reset command buffer to initial state
+    RDE_ASSERT_2(vkResetCommandBuffer(m_commandBuffers[imageIndex], VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT) ==
+                     VK_SUCCESS,
+                 "Failed to reset command buffer!");
+
+    Clock::Timer recordingTimer;
+    Clock::start(recordingTimer);
+
+    // Record commands
+    // Begin command buffer
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = 0;
+    beginInfo.pInheritanceInfo = nullptr;
+
+    result = vkBeginCommandBuffer(m_commandBuffers[imageIndex], &beginInfo);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to begin recording command buffer!");
+    {
+        // Buffers may not have been prepared yet, e.g. when recording right after (re)creating command buffers
+        const CullingBuffers* cullingBuffers =
+            m_cullingMode == CullingMode::Gpu && !m_cullBatches.empty() ? &m_cullingBuffers[m_currentFrame] : nullptr;
+        const bool gpuCulling = cullingBuffers && cullingBuffers->batchCapacity >= m_cullBatches.size() &&
+                                cullingBuffers->instanceCapacity >= m_cullInstances.size() &&
+                                cullingBuffers->commandCapacity >= m_cullCommandCount;
+
+        m_frameCullingBuffers = gpuCulling ? cullingBuffers : nullptr;
+        gatherDrawItems(m_frameCullingBuffers);
+
+        // This frame's fence has been waited on, so the timings it recorded last time are ready
+        m_gpuProfiler.beginFrame(m_commandBuffers[imageIndex], static_cast<uint32_t>(m_currentFrame));
+        updateSceneGpuTimes();
+        updateRenderExtent();
+        {
+            GpuProfileScope frameScope(m_gpuProfiler, m_commandBuffers[imageIndex], k_frameScopeName);
+            m_renderGraph.execute(m_commandBuffers[imageIndex], imageIndex, &m_gpuProfiler);
+        }
+    }
+    result = vkEndCommandBuffer(m_commandBuffers[imageIndex]);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to record command buffer!");
+
+    m_recordingTime = Clock::stop(recordingTimer);
 }
 
-void Renderer::generateMipmaps(VkImage image,
-                               VkFormat imageFormat,
-                               int32_t texWidth,
-                               int32_t texHeight,
-                               uint32_t mipLevels)
+void Renderer::recordDepthPrePass(const RenderGraph::PassContext& context)
 {
-    // Check if image format supports linear blitting
-    VkFormatProperties formatProperties;
-    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, imageFormat, &formatProperties);
+    bindFrameState(context.commandBuffer);
 
-    RDE_ASSERT_0(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT,
-                 "Texture image format does not support linear blitting!");
+    // Same order as the scene pass, which is front to back within each pipeline
+    DrawItem bound{};
+    BindStatistics statistics{};
 
-    singleTimeCommands([&](VkCommandBuffer commandBuffer) {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.image = image;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.subresourceRange.levelCount = 1;
-
-        int32_t mipWidth = texWidth;
-        int32_t mipHeight = texHeight;
-
-        // Blit image at each mip level
-        if (m_enableMipmaps) {
-            for (uint32_t i = 1; i < mipLevels; ++i) {
-                barrier.subresourceRange.baseMipLevel = i - 1;
-                barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-                barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-                barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-                // Wait for image layout transition
-                vkCmdPipelineBarrier(commandBuffer,
-                                     VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                     VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                     0,
-                                     0,
-                                     nullptr,
-                                     0,
-                                     nullptr,
-                                     1,
-                                     &barrier);
-
-                VkImageBlit blit{};
-                blit.srcOffsets[0] = {0, 0, 0};
-                blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
-                blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                blit.srcSubresource.mipLevel = i - 1;
-                blit.srcSubresource.baseArrayLayer = 0;
-                blit.srcSubresource.layerCount = 1;
-                blit.dstOffsets[0] = {0, 0, 0};
-                blit.dstOffsets[1] = {mipWidth > 1 ? mipWidth >> 1 : 1, mipHeight > 1 ? mipHeight >> 1 : 1, 1};
-                blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                blit.dstSubresource.mipLevel = i;
-                blit.dstSubresource.baseArrayLayer = 0;
-                blit.dstSubresource.layerCount = 1;
-
-                // Blit the image
-                vkCmdBlitImage(commandBuffer,
-                               image,
-                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                               image,
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                               1,
-                               &blit,
-                               VK_FILTER_LINEAR);
-
-                barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-                barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-                // Wait for layout transition
-                vkCmdPipelineBarrier(commandBuffer,
-                                     VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                     VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                     0,
-                                     0,
-                                     nullptr,
-                                     0,
-                                     nullptr,
-                                     1,
-                                     &barrier);
-
-                if (mipWidth > 1)
-                    mipWidth /= 2;
-                if (mipHeight > 1)
-                    mipHeight /= 2;
-            }
+    for (const auto& drawItem : m_drawItems) {
+        if (drawItem.depthPipeline == VK_NULL_HANDLE) {
+            continue;
         }
-        barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        // Wait for final mip level
-        vkCmdPipelineBarrier(commandBuffer,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT,
-                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                             0,
-                             0,
-                             nullptr,
-                             0,
-                             nullptr,
-                             1,
-                             &barrier);
-    });
+        auto depthDrawItem = drawItem;
+        depthDrawItem.pipeline = drawItem.depthPipeline;
+        depthDrawItem.attributeBuffer = VK_NULL_HANDLE;
+        bindDrawItem(context.commandBuffer, depthDrawItem, bound, statistics);
+
+        if (m_frameCullingBuffers) {
+            drawIndirectCommand(context.commandBuffer, depthDrawItem, *m_frameCullingBuffers);
+        } else {
+            drawCommand(context.commandBuffer, depthDrawItem);
+        }
+    }
 }
 
-void Renderer::createTextureImage(Texture& texture, TextureData& textureData)
+void Renderer::recordScenePass(const RenderGraph::PassContext& context)
 {
-    RDE_PROFILE_SCOPE
+    // This frame's fence has been waited on, so none of its secondary command buffers are pending anymore
+    auto& threadCommandPools = m_threadCommandPools[m_currentFrame];
+    vkResetCommandPool(m_device, m_uiCommandPools[m_currentFrame].commandPool, 0);
+
+    // Split the draw list into one contiguous chunk per recording thread
+    const auto drawItemCount = static_cast<uint32_t>(m_drawItems.size());
+    const uint32_t chunkCount = std::max(1u, std::min(m_recordingThreadCount, drawItemCount));
+    const uint32_t chunkSize = (drawItemCount + chunkCount - 1) / chunkCount;
+
+    const auto recordChunk = [&](uint32_t chunkIndex) {
+        const uint32_t first = std::min(chunkIndex * chunkSize, drawItemCount);
+        const uint32_t count = std::min(chunkSize, drawItemCount - first);
+
+        return recordDrawItems(
+            threadCommandPools[chunkIndex].commandBuffer, m_drawItems.data() + first, count, m_frameCullingBuffers);
+    };
+
+    // The camera and instances are read from buffers, so the draws of a static scene record the same commands every
+    // frame. Those recorded the last time this frame was in flight are executed again
+    auto& sceneCommands = m_sceneCommands[m_currentFrame];
+    m_sceneCommandsReused = canReuseSceneCommands(sceneCommands, chunkCount);
+
+    // Chunk 0 is recorded on the main thread, the others on the thread pool
+    static auto& threadPool = g_engine->threadPool();
+    std::vector<std::future<BindStatistics>> recordingTasks;
+
+    if (m_sceneCommandsReused) {
+        m_bindStatistics = sceneCommands.bindStatistics;
+    } else {
+        for (auto& threadCommandPool : threadCommandPools) {
+            vkResetCommandPool(m_device, threadCommandPool.commandPool, 0);
+        }
+        recordingTasks.reserve(chunkCount - 1);
 
-    VkDeviceSize imageSize = textureData.texWidth * textureData.texHeight * STBI_rgb_alpha;
+        for (uint32_t chunkIndex = 1; chunkIndex < chunkCount; ++chunkIndex) {
+            recordingTasks.emplace_back(
+                threadPool.submit([&recordChunk, chunkIndex]() { return recordChunk(chunkIndex); }));
+        }
+        m_bindStatistics = recordChunk(0);
+    }
 
-    // Set miplevels
-    texture.mipLevels =
-        m_enableMipmaps
-            ? static_cast<uint32_t>(std::floor(std::log2(std::max(textureData.texWidth, textureData.texHeight)))) + 1
-            : 1;
+    // Render ImGui draw data (Need to check in case ImGui is not running). The upscale pass draws it if there is one
+    const bool recordUi = !m_upscaling && g_engine->editor().renderingEnabled() && ImGui::GetDrawData();
+    if (recordUi) {
+        recordImGui(m_uiCommandPools[m_currentFrame].commandBuffer, context.imageIndex);
+    }
 
-    VmaBuffer stagingBuffer;
+    for (auto& recordingTask : recordingTasks) {
+        m_bindStatistics += recordingTask.get();
+    }
 
-    createBuffer(imageSize,
-                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 0,
-                 VMA_MEMORY_USAGE_AUTO,
-                 VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
-                 stagingBuffer);
+    if (!m_sceneCommandsReused) {
+        sceneCommands.drawItems = m_drawItems;
+        sceneCommands.cullingBuffers = m_frameCullingBuffers;
+        sceneCommands.renderExtent = m_renderExtent;
+        sceneCommands.viewUniformOffset = m_viewUniformOffset;
+        sceneCommands.chunkCount = chunkCount;
+        sceneCommands.bindStatistics = m_bindStatistics;
+        sceneCommands.valid = true;
+    }
 
-    memcpy(stagingBuffer.allocationInfo.pMappedData, textureData.data, static_cast<size_t>(imageSize));
+    // Execute in submission order so the UI is drawn on top of the scene
+    std::vector<VkCommandBuffer> secondaryCommandBuffers;
+    secondaryCommandBuffers.reserve(chunkCount + 1);
 
-    createImage(textureData.texWidth,
-                textureData.texHeight,
-                texture.mipLevels,
-                VK_SAMPLE_COUNT_1_BIT,
-                VK_FORMAT_R8G8B8A8_SRGB,
-                VK_IMAGE_TILING_OPTIMAL,
-                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                VMA_MEMORY_USAGE_AUTO,
-                0,
-                texture.vmaImage);
+    for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+        secondaryCommandBuffers.push_back(threadCommandPools[chunkIndex].commandBuffer);
+    }
+    if (recordUi) {
+        secondaryCommandBuffers.push_back(m_uiCommandPools[m_currentFrame].commandBuffer);
+    }
 
-    transitionImageLayout(texture.vmaImage.image,
-                          VK_FORMAT_R8G8B8A8_SRGB,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                          texture.mipLevels);
-    copyBufferToImage(stagingBuffer,
-                      texture.vmaImage.image,
-                      static_cast<uint32_t>(textureData.texWidth),
-                      static_cast<uint32_t>(textureData.texHeight));
-    generateMipmaps(texture.vmaImage.image,
-                    VK_FORMAT_R8G8B8A8_SRGB,
-                    textureData.texWidth,
-                    textureData.texHeight,
-                    texture.mipLevels);
+    vkCmdExecuteCommands(context.commandBuffer,
+                         static_cast<uint32_t>(secondaryCommandBuffers.size()),
+                         secondaryCommandBuffers.data());
 
-    vmaDestroyBuffer(m_vmaAllocator, stagingBuffer.buffer, stagingBuffer.allocation);
+    m_drawCallCount = drawItemCount;
 }
 
-void Renderer::createTextureImageView(Texture& texture, TextureData& textureData)
+[[nodiscard]] PipelineState Renderer::resolveUpscalePipelineState() const
 {
-    RDE_PROFILE_SCOPE
+    PipelineState state{};
+    state.vertexShaderPath = k_upscaleVertexShaderPath;
+    state.fragmentShaderPath = k_upscaleFragmentShaderPath;
+    state.vertexLayout = VertexLayout::Fullscreen;
+    state.blendMode = BlendMode::Opaque;
+    state.depthTestEnable = VK_FALSE;
+    state.depthWriteEnable = VK_FALSE;
+    state.cullMode = VK_CULL_MODE_NONE;
+    state.renderPass = m_renderGraph.renderPass(m_upscalePass);
+
+    return state;
+}
 
-    texture.imageView =
-        createImageView(texture.vmaImage.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, texture.mipLevels);
+void Renderer::recordUpscalePass(const RenderGraph::PassContext& context)
+{
+    const auto commandBuffer = context.commandBuffer;
+    vkCmdBindPipeline(commandBuffer,
+                      VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      m_pipelineStates.get(resolveUpscalePipelineState()).pipeline());
+
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(m_swapchain.extent.width);
+    viewport.height = static_cast<float>(m_swapchain.extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor{};
+    scissor.extent = m_swapchain.extent;
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            m_pipelineLayout,
+                            /* firstSet */ 1,
+                            /* descriptorSetCount */ 1,
+                            &m_bindlessDescriptorSet,
+                            /* dynamicOffsetCount */ 0,
+                            /* pDynamicOffsets */ nullptr);
+
+    // Only the rendered area is sampled, clamped to the centers of its last texels
+    const glm::vec2 sceneColorSize(m_sceneColorExtent.width, m_sceneColorExtent.height);
+    const glm::vec2 renderSize(m_renderExtent.width, m_renderExtent.height);
+
+    UpscalePushConstants pushConstants{};
+    pushConstants.texCoordScale = renderSize / sceneColorSize;
+    pushConstants.texCoordMax = (renderSize - 0.5f) / sceneColorSize;
+    pushConstants.textureIndex = *m_sceneColorBindlessIndex;
+    vkCmdPushConstants(
+        commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+
+    if (g_engine->editor().renderingEnabled() && ImGui::GetDrawData()) {
+        GpuProfileScope scope(m_gpuProfiler, commandBuffer, "ImGui");
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+    }
 }
 
-void Renderer::createTextureSampler(Texture& texture, TextureData& textureData)
+void Renderer::writeSceneColorDescriptor()
 {
-    RDE_PROFILE_SCOPE
+    if (!m_upscaling) {
+        return;
+    }
 
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
+    // Frames in flight may still sample the previous image through its slot
+    if (m_sceneColorBindlessIndex) {
+        retireBindlessSlot(*m_sceneColorBindlessIndex);
+    }
+    m_sceneColorBindlessIndex = acquireBindlessSlot();
+    writeBindlessDescriptor(
+        *m_sceneColorBindlessIndex, m_renderGraph.imageView(m_sceneColorImage, 0), m_upscaleSampler);
+}
 
-    VkPhysicalDeviceProperties properties{};
-    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
-    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = m_enableMipmaps ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
-    samplerInfo.mipLodBias = 0.0f;
-    samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = m_enableMipmaps ? static_cast<float>(texture.mipLevels) : VK_LOD_CLAMP_NONE;
+void Renderer::updateRenderExtent()
+{
+    if (!m_upscaling) {
+        return;
+    }
 
-    RDE_ASSERT_0(vkCreateSampler(m_device, &samplerInfo, m_allocator, &texture.sampler) == VK_SUCCESS,
-                 "Failed to create texture sampler!");
+    // The controller skips timings of frames recorded before its last change
+    const float scale = m_dynamicResolution
+                            ? m_resolutionController.update(m_gpuProfiler.scopeTime(k_frameScopeName))
+                            : m_resolutionController.settings().maxScale;
+    const auto extent = scaledExtent(scale);
+    m_renderExtent = {std::min(extent.width, m_sceneColorExtent.width),
+                      std::min(extent.height, m_sceneColorExtent.height)};
+
+    m_renderGraph.setRenderArea(m_scenePass, m_renderExtent);
+    if (m_depthPrePass) {
+        m_renderGraph.setRenderArea(m_depthPass, m_renderExtent);
+    }
 }
 
-void Renderer::cleanupSwapchain()
+[[nodiscard]] VkExtent2D Renderer::scaledExtent(float scale) const
 {
-    vkDestroyImageView(m_device, m_colorImageView, m_allocator);
-    vmaDestroyImage(m_vmaAllocator, m_colorImage.image, m_colorImage.allocation);
-
-    vkDestroyImageView(m_device, m_depthImageView, m_allocator);
-    vmaDestroyImage(m_vmaAllocator, m_depthImage.image, m_depthImage.allocation);
+    return {std::max(1u, static_cast<uint32_t>(std::lround(static_cast<float>(m_swapchain.extent.width) * scale))),
+            std::max(1u, static_cast<uint32_t>(std::lround(static_cast<float>(m_swapchain.extent.height) * scale)))};
+}
 
-    for (auto framebuffer : m_swapchain.framebuffers) {
-        vkDestroyFramebuffer(m_device, framebuffer, m_allocator);
+[[nodiscard]] PipelineState Renderer::resolvePipelineState(uint32_t materialIndex,
+                                                          const VertexFormat& vertexFormat) const
+{
+    auto state = m_materials[materialIndex].pipelineState;
+    state.vertexFormat = vertexFormat;
+    state.instanceEncoding = m_instanceEncoding;
+    state.msaaSamples = m_msaaSamples;
+    state.renderPass = m_renderGraph.renderPass(m_scenePass);
+
+    // Depth is already final, only the nearest surface passes
+    if (m_depthPrePass && state.depthWriteEnable) {
+        state.depthCompareOp = VK_COMPARE_OP_EQUAL;
+        state.depthWriteEnable = VK_FALSE;
     }
+    return state;
+}
 
-    vkFreeCommandBuffers(
-        m_device, m_commandPool, static_cast<uint32_t>(m_commandBuffers.size()), m_commandBuffers.data());
-    m_pipeline.destroy(m_device, m_allocator);
-    vkDestroyRenderPass(m_device, m_renderPass, m_allocator);
+[[nodiscard]] VkPipeline Renderer::retrievePipeline(uint32_t materialIndex, const VertexFormat& vertexFormat)
+{
+    const auto state = resolvePipelineState(materialIndex, vertexFormat);
 
-    for (auto imageView : m_swapchain.imageViews) {
-        vkDestroyImageView(m_device, imageView, m_allocator);
+    if (!m_compilePipelinesInBackground) {
+        return m_pipelineStates.get(state).pipeline();
     }
 
-    vkDestroySwapchainKHR(m_device, m_swapchain.handle, m_allocator);
+    // Draw with the default material until the pipeline has finished compiling
+    const auto* pipeline = m_pipelineStates.tryGet(state);
+    return pipeline ? pipeline->pipeline() : m_pipelineStates.get(resolvePipelineState(0, vertexFormat)).pipeline();
+}
 
-    for (size_t i = 0; i < m_swapchain.images.size(); ++i) {
-        vmaDestroyBuffer(m_vmaAllocator, m_uniformBuffers[i].buffer, m_uniformBuffers[i].allocation);
+[[nodiscard]] PipelineState Renderer::resolveDepthPipelineState(uint32_t materialIndex,
+                                                               const VertexFormat& vertexFormat) const
+{
+    const auto& materialState = m_materials[materialIndex].pipelineState;
+
+    // Keep everything that affects which fragments pass, positions have to match the scene pass exactly
+    PipelineState state{};
+    state.vertexShaderPath = k_depthShaderPath;
+    state.fragmentShaderPath.clear();
+    state.vertexLayout = VertexLayout::PositionInstanced;
+    state.vertexFormat.position = vertexFormat.position; // Meshes that only differ in attributes share depth pipelines
+    state.instanceEncoding = m_instanceEncoding;
+    state.blendMode = BlendMode::Opaque;
+    state.depthTestEnable = materialState.depthTestEnable;
+    state.depthWriteEnable = VK_TRUE;
+    state.depthCompareOp = materialState.depthCompareOp;
+    state.cullMode = materialState.cullMode;
+    state.polygonMode = materialState.polygonMode;
+    state.msaaSamples = m_msaaSamples;
+    state.renderPass = m_renderGraph.renderPass(m_depthPass);
+
+    return state;
+}
+
+[[nodiscard]] VkPipeline Renderer::retrieveDepthPipeline(uint32_t materialIndex, const VertexFormat& vertexFormat)
+{
+    const auto state = resolveDepthPipelineState(materialIndex, vertexFormat);
+
+    if (!m_compilePipelinesInBackground) {
+        return m_pipelineStates.get(state).pipeline();
     }
 
-    vkDestroyDescriptorPool(m_device, m_descriptorPool, m_allocator);
+    const auto* pipeline = m_pipelineStates.tryGet(state);
+    return pipeline ? pipeline->pipeline()
+                    : m_pipelineStates.get(resolveDepthPipelineState(0, vertexFormat)).pipeline();
 }
 
-void Renderer::recreateSwapchain()
+void Renderer::gatherDrawItems(const CullingBuffers* cullingBuffers)
 {
-    RDE_PROFILE_SCOPE
+    static auto& assetManager = g_engine->assetManager();
+    const auto& camera = g_engine->currentScene().camera();
 
-    // Handle minimization (framebuffer size 0)
-    int width = 0, height = 0;
-    do {
-        glfwGetFramebufferSize(m_window->handle(), &width, &height);
-        glfwWaitEvents();
-    } while (width == 0 || height == 0);
+    m_drawItems.clear();
+    m_drawSortItems.clear();
+    m_instancesString.clear();
+
+    // Resolve pipelines once per material and vertex format rather than once per draw. Those sharing a pipeline share
+    // a sort slot
+    struct ResolvedPipeline {
+        uint32_t materialIndex = 0;
+        VertexFormat vertexFormat{};
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkPipeline depthPipeline = VK_NULL_HANDLE;
+        uint32_t slot = 0;
+    };
+    std::vector<ResolvedPipeline> resolvedPipelines;
+
+    const auto resolvePipelines = [&](uint32_t materialIndex, const VertexFormat& vertexFormat) {
+        for (const auto& resolved : resolvedPipelines) {
+            if (resolved.materialIndex == materialIndex && resolved.vertexFormat == vertexFormat) {
+                return resolved;
+            }
+        }
+        ResolvedPipeline resolved{materialIndex, vertexFormat};
+        resolved.pipeline = retrievePipeline(materialIndex, vertexFormat);
+        if (m_depthPrePass && m_materials[materialIndex].pipelineState.depthWriteEnable) {
+            resolved.depthPipeline = retrieveDepthPipeline(materialIndex, vertexFormat);
+        }
+        resolved.slot = static_cast<uint32_t>(
+            std::find_if(resolvedPipelines.begin(),
+                         resolvedPipelines.end(),
+                         [&](const ResolvedPipeline& other) { return other.pipeline == resolved.pipeline; }) -
+            resolvedPipelines.begin());
+
+        resolvedPipelines.push_back(resolved);
+        return resolved;
+    };
+
+    const auto addDrawItem = [&](DrawItem drawItem, const Mesh& mesh, uint32_t materialIndex, float depth) {
+        const auto resolved = resolvePipelines(materialIndex, mesh.vertexFormat);
+        drawItem.pipeline = resolved.pipeline;
+        drawItem.depthPipeline = resolved.depthPipeline;
+        drawItem.positionBuffer = mesh.positionBuffer.buffer;
+        drawItem.attributeBuffer = mesh.attributeBuffer.buffer;
+        drawItem.indexBuffer = mesh.indexBuffer.buffer;
+        drawItem.indexType = mesh.indexType;
+        drawItem.submeshes = mesh.submeshes.data();
+        drawItem.submeshCount = static_cast<uint32_t>(mesh.submeshes.size());
+        drawItem.vertexDequantization = mesh.vertexDequantization;
+
+        const bool translucent = !m_materials[materialIndex].pipelineState.depthWriteEnable;
+        const auto sortKey =
+            makeDrawSortKey(translucent, resolved.slot, materialIndex, drawItem.meshId, depth, camera.farClip);
+
+        m_drawSortItems.push_back({sortKey, static_cast<uint32_t>(m_drawItems.size())});
+        m_drawItems.push_back(drawItem);
+    };
+
+    // For each culled batch, draw with the instance count written by cull.comp
+    if (cullingBuffers) {
+        for (uint32_t batchIndex = 0; batchIndex < m_cullBatches.size(); ++batchIndex) {
+            const auto meshId = m_cullBatchMeshIds[batchIndex];
+            const auto materialIndex = m_cullBatchMaterialIndices[batchIndex];
+            const auto& mesh = assetManager.getMesh(meshId);
+            const auto& batch = m_cullBatches[batchIndex];
+
+            DrawItem drawItem{};
+            drawItem.meshId = meshId;
+            drawItem.instanceBuffer = cullingBuffers->visibleInstances.buffer;
+            drawItem.instanceOffset = batch.firstInstance * instanceStride(m_instanceEncoding);
+            drawItem.batchIndex = batchIndex;
+            drawItem.firstCommand = batch.firstCommand;
+
+            // Which instances survive culling is only known on the GPU, sort by the nearest submitted one
+            float depth = camera.farClip;
+            for (uint32_t i = batch.firstInstance; i < batch.firstInstance + batch.instanceCount; ++i) {
+                const auto& transform = m_cullInstances[i].modelTransform;
+                depth = std::min(depth, calculateViewDepth(camera.eye, camera.front, transform));
+            }
+            addDrawItem(drawItem, mesh, materialIndex, depth);
 
-    vkDeviceWaitIdle(m_device);
+            // For debugging and to show on ImGui
+            const auto& meshName = assetManager.getAssetName(meshId);
+            m_instancesString.emplace_back(std::make_tuple(meshName, batch.instanceCount));
+        }
+    }
 
-    cleanupSwapchain();
+    // GPU culled batches are only drawn once their buffers are ready
+    const bool drawInstanced = !cullingBuffers && m_cullingMode != CullingMode::Gpu;
+    if (drawInstanced) {
+        uploadClusterCommands();
+    }
 
-    createSwapchain();
-    createImageViews();
-    createRenderPass();
-    m_pipeline.create(m_device,
-                      m_allocator,
-                      m_swapchain,
-                      m_msaaSamples,
-                      m_uboDescriptorSetLayout,
-                      m_samplerDescriptorSetLayout,
-                      m_renderPass);
-    createColorResources();
-    createDepthResources();
-    createFramebuffers();
-    createUniformBuffers();
-    createDescriptorPool();
-    createDescriptorSets();
-    createCommandBuffers();
+    // For each mesh, draw instanced. Instances pick their texture through the bindless array
+    for (const auto& [key, batch] : m_meshInstances) {
+        if (!drawInstanced) {
+            break;
+        }
+        const auto& [meshId, materialIndex] = key;
+        const auto& mesh = assetManager.getMesh(meshId);
+        const uint32_t lastInstance = batch->firstInstance + batch->instanceCount;
+        const uint32_t maxInstancesPerDraw = m_maxInstancesPerDraw ? m_maxInstancesPerDraw : batch->instanceCount;
+
+        // Cluster culled batches are a single multi draw, nothing is left of them when every meshlet was culled
+        if (batch->clusterCulled && batch->clusterCommandCount) {
+            DrawItem drawItem{};
+            drawItem.meshId = meshId;
+            drawItem.instanceBuffer = mesh.instanceBuffer.vmaBuffer.buffer;
+            drawItem.firstClusterCommand = batch->firstClusterCommand;
+            drawItem.clusterCommandCount = batch->clusterCommandCount;
+
+            const float depth = *std::min_element(batch->depths.begin(), batch->depths.end());
+            addDrawItem(drawItem, mesh, materialIndex, depth);
+        }
+
+        // Split large batches into several draws, mostly to stress the recording threads
+        for (uint32_t firstInstance = batch->firstInstance; firstInstance < lastInstance && !batch->clusterCulled;
+             firstInstance += maxInstancesPerDraw) {
+            DrawItem drawItem{};
+            drawItem.meshId = meshId;
+            drawItem.instanceBuffer = mesh.instanceBuffer.vmaBuffer.buffer;
+            drawItem.firstInstance = firstInstance;
+            drawItem.instanceCount = std::min(maxInstancesPerDraw, lastInstance - firstInstance);
+
+            const auto firstDepth = batch->depths.begin() + (firstInstance - batch->firstInstance);
+            const float depth = *std::min_element(firstDepth, firstDepth + drawItem.instanceCount);
+            addDrawItem(drawItem, mesh, materialIndex, depth);
+        }
+
+        // For debugging and to show on ImGui
+        const auto& meshName = assetManager.getAssetName(meshId);
+        m_instancesString.emplace_back(std::make_tuple(meshName, batch->instanceCount));
+    }
+
+    if (!m_sortDrawItems) {
+        return;
+    }
+    static auto& threadPool = g_engine->threadPool();
+    RadixSort::sort(m_drawSortItems, m_drawSortScratch, &threadPool);
+
+    m_sortedDrawItems.clear();
+    for (const auto& sortItem : m_drawSortItems) {
+        m_sortedDrawItems.push_back(m_drawItems[sortItem.value]);
+    }
+    m_drawItems.swap(m_sortedDrawItems);
 }
 
-void Renderer::cleanUpImGui()
+void Renderer::beginSecondaryCommandBuffer(VkCommandBuffer commandBuffer,
+                                           VkCommandBufferUsageFlags flags,
+                                           VkFramebuffer framebuffer)
 {
-    ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
-    vkDestroyDescriptorPool(m_device, m_imguiDescriptorPool, m_allocator);
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = m_renderGraph.renderPass(m_scenePass);
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = framebuffer;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | flags;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    auto result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    RDE_ASSERT_2(result == VK_SUCCESS, "Failed to begin recording secondary command buffer!");
 }
 
-void Renderer::copyBuffer(const VmaBuffer& srcBuffer, VmaBuffer& dstBuffer, VkDeviceSize size)
+[[nodiscard]] bool Renderer::canReuseSceneCommands(const SceneCommands& sceneCommands, uint32_t chunkCount) const
 {
-    singleTimeCommands([&](VkCommandBuffer commandBuffer) {
-        VkBufferCopy copyRegion{};
-        copyRegion.srcOffset = 0;
-        copyRegion.dstOffset = 0;
-        copyRegion.size = size;
-        vkCmdCopyBuffer(commandBuffer, srcBuffer.buffer, dstBuffer.buffer, 1, &copyRegion);
-    });
+    // Per draw profiling scopes write to this frame's queries, which move every frame
+    if (!m_reuseSceneCommands || m_profileDrawItems || !sceneCommands.valid) {
+        return false;
+    }
+
+    // The viewport and the camera's offset are recorded too, the viewport follows the dynamic resolution
+    return sceneCommands.chunkCount == chunkCount && sceneCommands.cullingBuffers == m_frameCullingBuffers &&
+           sceneCommands.viewUniformOffset == m_viewUniformOffset &&
+           sceneCommands.renderExtent.width == m_renderExtent.width &&
+           sceneCommands.renderExtent.height == m_renderExtent.height && sceneCommands.drawItems == m_drawItems;
 }
 
-void Renderer::updateUniformBuffer(uint32_t imageIndex)
+void Renderer::invalidateSceneCommands()
 {
-    UniformBufferObject ubo{};
+    for (auto& sceneCommands : m_sceneCommands) {
+        sceneCommands.valid = false;
+    }
+}
 
-    const auto& camera = g_engine->currentScene().camera();
+BindStatistics Renderer::recordDrawItems(VkCommandBuffer commandBuffer,
+                                         const DrawItem* drawItems,
+                                         uint32_t drawItemCount,
+                                         const CullingBuffers* cullingBuffers)
+{
+    // Not one time submit, they may be executed again in later frames
+    beginSecondaryCommandBuffer(commandBuffer, 0);
+    {
+        // Secondary command buffers inherit no state, so each one sets its own viewport and descriptor sets
+        bindFrameState(commandBuffer);
 
-    ubo.view = glm::lookAt(camera.eye, camera.eye + camera.front, camera.up);
-    ubo.projection = glm::perspective(glm::radians(camera.fov),
-                                      m_swapchain.extent.width / (float)m_swapchain.extent.height,
-                                      camera.nearClip,
-                                      camera.farClip);
+        // Nothing is bound at the start of a secondary command buffer
+        DrawItem bound{};
+        BindStatistics statistics{};
 
-    // Flip Y
-    ubo.projection[1][1] *= -1.0f;
+        static auto& assetManager = g_engine->assetManager();
+
+        for (uint32_t i = 0; i < drawItemCount; ++i) {
+            bindDrawItem(commandBuffer, drawItems[i], bound, statistics);
+
+            // Per draw timings are only meaningful on GPUs that don't overlap consecutive draws much
+            auto scope = GpuProfiler::k_invalidScope;
+            if (m_profileDrawItems) {
+                scope = m_gpuProfiler.beginScope(commandBuffer, assetManager.getAssetName(drawItems[i].meshId));
+            }
+
+            if (cullingBuffers) {
+                drawIndirectCommand(commandBuffer, drawItems[i], *cullingBuffers);
+            } else {
+                drawCommand(commandBuffer, drawItems[i]);
+            }
+            m_gpuProfiler.endScope(commandBuffer, scope);
+        }
+        auto result = vkEndCommandBuffer(commandBuffer);
+        RDE_ASSERT_2(result == VK_SUCCESS, "Failed to record secondary command buffer!");
 
-    memcpy(m_uniformBuffers[imageIndex].allocationInfo.pMappedData, &ubo, sizeof(ubo));
+        return statistics;
+    }
 }
 
-void Renderer::recordCommandBuffers(uint32_t imageIndex)
+void Renderer::bindFrameState(VkCommandBuffer commandBuffer) const
 {
-    VkResult result;
+    // The scene may only cover part of its attachments, see updateRenderExtent()
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(m_renderExtent.width);
+    viewport.height = static_cast<float>(m_renderExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor{};
+    scissor.extent = m_renderExtent;
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    // Every pipeline shares one layout, so the sets stay bound across pipeline switches
+    const std::array<VkDescriptorSet, 2> descriptorSets = {m_uboDescriptorSet, m_bindlessDescriptorSet};
+
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            m_pipelineLayout,
+                            /* firstSet */ 0,
+                            /* descriptorSetCount */ static_cast<uint32_t>(descriptorSets.size()),
+                            descriptorSets.data(),
+                            /* dynamicOffsetCount */ 1,
+                            /* pDynamicOffsets */ &m_viewUniformOffset);
+
+    // Read with a stride of 0 in place of the attributes a vertex format doesn't have
+    const VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, DefaultAttributeBindingID, 1, &m_defaultAttributeBuffer.buffer, &offset);
+}
 
-    // Explicitly reset command buffer to initial state
-    RDE_ASSERT_2(vkResetCommandBuffer(m_commandBuffers[imageIndex], VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT) ==
-                     VK_SUCCESS,
-                 "Failed to reset command buffer!");
+void Renderer::bindDrawItem(VkCommandBuffer commandBuffer,
+                            const DrawItem& drawItem,
+                            DrawItem& bound,
+                            BindStatistics& statistics) const
+{
+    if (drawItem.pipeline != bound.pipeline) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawItem.pipeline);
+        bound.pipeline = drawItem.pipeline;
+        ++statistics.pipelineBinds;
+    } else {
+        ++statistics.pipelineBindsAvoided;
+    }
 
-    // Record commands
-    // Begin command buffer
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = 0;
-    beginInfo.pInheritanceInfo = nullptr;
+    // TODO: Batch all VBs and IBs into one and use indexing
+    if (drawItem.positionBuffer != bound.positionBuffer) {
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, PositionBufferBindingID, 1, &drawItem.positionBuffer, offsets);
+        bound.positionBuffer = drawItem.positionBuffer;
+        ++statistics.bufferBinds;
+
+        // Quantized streams are relative to their mesh, the positions identify it
+        vkCmdPushConstants(commandBuffer,
+                           m_pipelineLayout,
+                           VK_SHADER_STAGE_VERTEX_BIT,
+                           offsetof(PushConstantObject, vertexDequantization),
+                           sizeof(VertexDequantization),
+                           &drawItem.vertexDequantization);
+    } else {
+        ++statistics.bufferBindsAvoided;
+    }
 
-    result = vkBeginCommandBuffer(m_commandBuffers[imageIndex], &beginInfo);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to begin recording command buffer!");
-    {
-        VkRenderPassBeginInfo renderPassBeginInfo{};
-        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassBeginInfo.renderPass = m_renderPass;
-        renderPassBeginInfo.framebuffer = m_swapchain.framebuffers[imageIndex];
-        renderPassBeginInfo.renderArea.offset = {0, 0};
-        renderPassBeginInfo.renderArea.extent = m_swapchain.extent;
-
-        std::array<VkClearValue, 2> clearValues{};
-        clearValues[0].color = {k_clearColor.x, k_clearColor.y, k_clearColor.z, k_clearColor.w};
-        clearValues[1].depthStencil = {1.0f, 0};
-
-        renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-        renderPassBeginInfo.pClearValues = clearValues.data();
-
-        vkCmdBeginRenderPass(m_commandBuffers[imageIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-        // Bind graphics pipeline
-        m_pipeline.bind(m_commandBuffers[imageIndex]);
-
-        // Bind UBO descriptor set
-        vkCmdBindDescriptorSets(m_commandBuffers[imageIndex],
-                                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                m_pipeline.layout(),
-                                /* firstSet */ 0,
-                                /* descriptorSetCount */ 1,
-                                m_uboDescriptorSets.data(),
-                                /* dynamicOffsetCount */ 0,
-                                /* pDynamicOffsets */ nullptr);
+    if (drawItem.attributeBuffer != VK_NULL_HANDLE && drawItem.attributeBuffer != bound.attributeBuffer) {
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, AttributeBufferBindingID, 1, &drawItem.attributeBuffer, offsets);
+        bound.attributeBuffer = drawItem.attributeBuffer;
+        ++statistics.bufferBinds;
+    } else if (drawItem.attributeBuffer != VK_NULL_HANDLE) {
+        ++statistics.bufferBindsAvoided;
+    }
 
-        static auto& assetManager = g_engine->assetManager();
-        m_instancesString.clear();
+    if (drawItem.instanceBuffer != bound.instanceBuffer || drawItem.instanceOffset != bound.instanceOffset) {
+        VkDeviceSize offsets[] = {drawItem.instanceOffset};
+        vkCmdBindVertexBuffers(commandBuffer, InstanceBufferBindingID, 1, &drawItem.instanceBuffer, offsets);
+        bound.instanceBuffer = drawItem.instanceBuffer;
+        bound.instanceOffset = drawItem.instanceOffset;
+        ++statistics.bufferBinds;
+    } else {
+        ++statistics.bufferBindsAvoided;
+    }
 
-        // For each mesh and texture, bind texture sampler descriptor set and draw instanced
-        for (const auto& [meshTextureId, instance] : m_meshInstances) {
-            const auto [meshId, textureId] = meshTextureId;
-            const auto& mesh = assetManager.getMesh(meshId);
-            const auto& texture = assetManager.getTexture(textureId);
-
-            vkCmdBindDescriptorSets(m_commandBuffers[imageIndex],
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    m_pipeline.layout(),
-                                    /* firstSet */ 1,
-                                    /* descriptorSetCount */ 1,
-                                    &texture.descriptorSets[imageIndex],
-                                    /* dynamicOffsetCount */ 0,
-                                    /* pDynamicOffsets */ nullptr);
-
-            const auto& instanceBuffer = mesh.instanceBuffers.at(textureId);
-            drawCommand(m_commandBuffers[imageIndex],
-                        mesh.vertexBuffer.buffer,
-                        mesh.indexBuffer.buffer,
-                        instanceBuffer,
-                        static_cast<uint32_t>(mesh.indices.size()));
+    // Every index buffer has a single index type, so it only changes along with the buffer
+    if (drawItem.indexBuffer != bound.indexBuffer) {
+        vkCmdBindIndexBuffer(commandBuffer, drawItem.indexBuffer, 0, drawItem.indexType);
+        bound.indexBuffer = drawItem.indexBuffer;
+        ++statistics.bufferBinds;
+    } else {
+        ++statistics.bufferBindsAvoided;
+    }
+}
 
-            // For debugging and to show on ImGui
-            const auto& meshName = assetManager.getAssetName(meshId);
-            const auto& textureName = assetManager.getAssetName(textureId);
-            m_instancesString.emplace_back(std::make_tuple(meshName, textureName, instanceBuffer.instanceCount));
+void Renderer::sleepForLatency()
+{
+    // Frames queued ahead of this one keep the GPU busy for a while yet. Starting this frame earlier than needed to
+    // submit right as they finish only makes its input older
+    uint32_t queuedFrameCount = 0;
+    for (uint32_t i = 0; i < m_framesInFlight; ++i) {
+        if (i != m_currentFrame && vkGetFenceStatus(m_device, m_inFlightFences[i]) == VK_NOT_READY) {
+            ++queuedFrameCount;
         }
+    }
+    const float queuedGpuTime = m_gpuProfiler.scopeTime(k_frameScopeName) * static_cast<float>(queuedFrameCount);
+    const float sleepTime = (queuedGpuTime - m_framePacingStatistics.cpuFrameTime) * k_latencySleepFraction;
+    if (sleepTime <= 0.0f) {
+        return;
+    }
 
-        // Render ImGui draw data (Need to check in case ImGui is not running)
-        if (g_engine->editor().renderingEnabled()) {
-            auto* drawData = ImGui::GetDrawData();
-            if (drawData) {
-                ImGui_ImplVulkan_RenderDrawData(drawData, m_commandBuffers[imageIndex]);
-            }
-        }
+    Clock::Timer sleepTimer;
+    Clock::start(sleepTimer);
+    std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(sleepTime));
+    m_framePacingStatistics.latencySleep = Clock::stop(sleepTimer);
+}
+
+void Renderer::updateSceneGpuTimes()
+{
+    if (m_gpuProfiler.results().empty()) {
+        return;
+    }
 
-        vkCmdEndRenderPass(m_commandBuffers[imageIndex]);
+    // The pre-pass is part of the cost of the scene. Results are cleared when it is toggled
+    float sceneGpuTime = m_gpuProfiler.scopeTime(m_renderGraph.passName(m_scenePass));
+    if (m_depthPrePass) {
+        sceneGpuTime += m_gpuProfiler.scopeTime(m_renderGraph.passName(m_depthPass));
     }
-    result = vkEndCommandBuffer(m_commandBuffers[imageIndex]);
-    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to record command buffer!");
+    m_sceneGpuTimes[m_depthPrePass ? 1 : 0] = sceneGpuTime;
+}
+
+void Renderer::recordImGui(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    beginSecondaryCommandBuffer(
+        commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, m_renderGraph.framebuffer(m_scenePass, imageIndex));
+    {
+        GpuProfileScope scope(m_gpuProfiler, commandBuffer, "ImGui");
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+    }
+    auto result = vkEndCommandBuffer(commandBuffer);
+    RDE_ASSERT_2(result == VK_SUCCESS, "Failed to record ImGui command buffer!");
 }
 
 void Renderer::transitionImageLayout(VkImage image,
@@ -2120,71 +4340,74 @@ void Renderer::transitionImageLayout(VkImage image,
         barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         barrier.image = image;
 
-        if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-
-            if (hasStencilComponent(format)) {
-                barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-            }
-        } else {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        }
-
+        barrier.subresourceRange.aspectMask = RenderGraph::formatAspect(format);
         barrier.subresourceRange.baseMipLevel = 0;
         barrier.subresourceRange.levelCount = mipLevels;
         barrier.subresourceRange.baseArrayLayer = 0;
         barrier.subresourceRange.layerCount = 1;
 
-        VkPipelineStageFlags sourceStage{}, destinationStage{};
-
-        // Only allow destination write when layouts are correct
-        if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-                   newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
-                   newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask =
-                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        } else {
-            RDE_ASSERT_0(false, "Unsupported layout transition used!");
-        }
+        // Wait on whatever the old layout was used for before whatever the new layout is used for may start
+        const auto source = RenderGraph::layoutUsage(oldLayout);
+        const auto destination = RenderGraph::layoutUsage(newLayout);
+        barrier.srcAccessMask = source.access;
+        barrier.dstAccessMask = destination.access;
+
+        const auto sourceStage = source.stages;
+        const auto destinationStage = destination.stages;
 
         vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
     });
 }
 
-void Renderer::copyBufferToImage(const VmaBuffer& buffer, VkImage image, uint32_t width, uint32_t height)
+void Renderer::captureFrame(uint32_t imageIndex, const std::string& path)
 {
+    RDE_PROFILE_SCOPE
+
+    // Left in transfer source layout by the render graph
+    vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+
+    const uint32_t width = m_swapchain.extent.width;
+    const uint32_t height = m_swapchain.extent.height;
+    const VkDeviceSize bufferSize = static_cast<VkDeviceSize>(width) * height * 4;
+
+    VmaBuffer readbackBuffer{};
+    createBuffer(bufferSize,
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 0,
+                 VMA_MEMORY_USAGE_AUTO,
+                 VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                 readbackBuffer);
+
     singleTimeCommands([&](VkCommandBuffer commandBuffer) {
         VkBufferImageCopy region{};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-
         region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
         region.imageSubresource.layerCount = 1;
-
-        region.imageOffset = {0, 0, 0};
         region.imageExtent = {width, height, 1};
 
-        vkCmdCopyBufferToImage(commandBuffer, buffer.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        vkCmdCopyImageToBuffer(commandBuffer,
+                               m_swapchain.images[imageIndex],
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               readbackBuffer.buffer,
+                               1,
+                               &region);
     });
+    vmaInvalidateAllocation(m_vmaAllocator, readbackBuffer.allocation, 0, VK_WHOLE_SIZE);
+
+    // BGRA to RGB
+    static_assert(k_offscreenFormat == VK_FORMAT_B8G8R8A8_SRGB, "Capture expects BGRA pixels!");
+    const auto* pixels = static_cast<const uint8_t*>(readbackBuffer.allocationInfo.pMappedData);
+
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+    for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+        rgb[3 * i + 0] = pixels[4 * i + 2];
+        rgb[3 * i + 1] = pixels[4 * i + 1];
+        rgb[3 * i + 2] = pixels[4 * i + 0];
+    }
+    vmaDestroyBuffer(m_vmaAllocator, readbackBuffer.buffer, readbackBuffer.allocation);
+
+    if (FileParser::writePpm(path.c_str(), width, height, rgb)) {
+        RDELOG_INFO("Captured frame to {}", path);
+    }
 }
 
 VkCommandBuffer Renderer::beginSingleTimeCommands()
@@ -2217,46 +4440,48 @@ void Renderer::endSingleTimeCommands(VkCommandBuffer commandBuffer)
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    // Staging memory used by these commands is recycled once the fence is signaled
+    vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_stagingPool.retire());
     vkQueueWaitIdle(m_graphicsQueue);
 
     vkFreeCommandBuffers(m_device, m_transientCommandPool, 1, &commandBuffer);
 }
 
-void Renderer::drawCommand(VkCommandBuffer commandBuffer,
-                           const VkBuffer& vertexBuffer,
-                           const VkBuffer& indexBuffer,
-                           const InstanceBuffer& instanceBuffer,
-                           uint32_t indexCount)
+void Renderer::drawCommand(VkCommandBuffer commandBuffer, const DrawItem& drawItem)
 {
-    if (!instanceBuffer.instanceCount) {
+    if (drawItem.clusterCommandCount) {
+        vkCmdDrawIndexedIndirect(commandBuffer,
+                                 m_clusterCommandBuffers[m_currentFrame].buffer,
+                                 drawItem.firstClusterCommand * sizeof(VkDrawIndexedIndirectCommand),
+                                 drawItem.clusterCommandCount,
+                                 sizeof(VkDrawIndexedIndirectCommand));
         return;
     }
 
-    // TODO: Batch all VBs and IBs into one and use indexing
-    VkDeviceSize offsets[] = {0};
-
-    vkCmdBindVertexBuffers(commandBuffer, VertexBufferBindingID, 1, &vertexBuffer, offsets);
-    vkCmdBindVertexBuffers(commandBuffer, InstanceBufferBindingID, 1, &instanceBuffer.vmaBuffer.buffer, offsets);
-
-    static_assert(std::is_same_v<Mesh::IndicesValueType, uint16_t> || std::is_same_v<Mesh::IndicesValueType, uint32_t>,
-                  "Index type is not uint32_t or uint16_t!");
-
-    // Bind index buffer for this mesh
-    if constexpr (std::is_same_v<Mesh::IndicesValueType, uint16_t>) {
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
-    } else {
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    // One draw per submesh, each with its own vertex offset
+    for (uint32_t i = 0; i < drawItem.submeshCount; ++i) {
+        const auto& submesh = drawItem.submeshes[i];
+        vkCmdDrawIndexed(commandBuffer,
+                         submesh.indexCount,
+                         drawItem.instanceCount,
+                         submesh.firstIndex,
+                         submesh.vertexOffset,
+                         drawItem.firstInstance);
     }
+}
 
-    // vkCmdPushConstants(commandBuffer, m_pipelineLayout,
-    // VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4),
-    // &m_pushConstants.modelMtx);
-
-    // Draw command for this mesh
-    vkCmdDrawIndexed(commandBuffer, indexCount, instanceBuffer.instanceCount, 0, 0, 0);
-
-    ++m_drawCallCount;
+void Renderer::drawIndirectCommand(VkCommandBuffer commandBuffer,
+                                   const DrawItem& drawItem,
+                                   const CullingBuffers& cullingBuffers)
+{
+    // Draw count is zero when every instance of the batch was culled, one per submesh otherwise
+    vkCmdDrawIndexedIndirectCount(commandBuffer,
+                                  cullingBuffers.commands.buffer,
+                                  drawItem.firstCommand * sizeof(VkDrawIndexedIndirectCommand),
+                                  cullingBuffers.drawCounts.buffer,
+                                  drawItem.batchIndex * sizeof(uint32_t),
+                                  drawItem.submeshCount,
+                                  sizeof(VkDrawIndexedIndirectCommand));
 }
 } // namespace Vulkan
 } // namespace RDE
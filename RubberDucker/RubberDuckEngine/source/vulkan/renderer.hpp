@@ -1,41 +1,150 @@
 #pragma once
 
+#include "data_types/compute_pipeline.hpp"
+#include "data_types/culling_buffers.hpp"
+#include "data_types/culling_data.hpp"
+#include "data_types/culling_mode.hpp"
+#include "data_types/draw_item.hpp"
+#include "data_types/frame_pacing.hpp"
+#include "data_types/frustum.hpp"
+#include "data_types/instance_batch.hpp"
+#include "data_types/instance_encoding.hpp"
+#include "data_types/material.hpp"
+#include "data_types/mesh.hpp"
 #include "data_types/mesh_instance.hpp"
+#include "data_types/meshlet.hpp"
 #include "data_types/pipeline.hpp"
+#include "data_types/pipeline_cache.hpp"
 #include "data_types/presentation_mode.hpp"
 #include "data_types/push_constant_object.hpp"
 #include "data_types/swapchain.hpp"
+#include "data_types/thread_command_pool.hpp"
 #include "data_types/vma_buffer.hpp"
 #include "data_types/vma_image.hpp"
+#include "deletion_queue.hpp"
+#include "gpu_profiler.hpp"
+#include "ktx2.hpp"
+#include "pipeline_state_cache.hpp"
+#include "render_graph.hpp"
+#include "resolution_controller.hpp"
+#include "staging_pool.hpp"
+#include "texture_streamer.hpp"
+#include "uniform_ring.hpp"
+#include "utilities/clock.hpp"
+#include "utilities/radix_sort.hpp"
 #include "window/window.hpp"
 
 namespace RDE {
 namespace Vulkan {
 struct Texture;
-struct TextureData;
 struct QueueFamilyIndices;
 struct Vertex;
 struct Mesh;
 struct InstanceBuffer;
+struct UniformBufferObject;
 
 class Renderer
 {
 public:
-    using InstanceshowDebugInfo = std::tuple<std::string, std::string, size_t>;
+    using InstanceshowDebugInfo = std::tuple<std::string, size_t>;
 
     void init();
     void drawFrame();
+
+    // Blocks until the resources of the next frame are free. Called before input is sampled in low latency mode,
+    // drawFrame() calls it otherwise
+    void waitForFrameSlot();
     void cleanup();
 
     void waitForOperations();
 
-    Texture createTextureResources(TextureData& textureData);
+    // Headless only, writes the next frame to the given path once it has finished rendering
+    void requestCapture(std::string path);
+
+    // Whether source images get a full mip chain, which is built on the CPU before upload
+    [[nodiscard]] bool mipmapsEnabled() const;
+    // Decodes on the CPU if the device can't sample the format, null if that isn't possible either. Textures larger
+    // than the streaming base size keep their levels on the CPU and are streamed in as instances need them
+    [[nodiscard]] std::optional<Texture> createTextureResources(Ktx2Texture ktxTexture);
+    [[nodiscard]] bool isTextureFormatSupported(VkFormat format) const;
     void clearMeshInstances();
     void copyInstancesIntoInstanceBuffer();
 
     [[nodiscard]] uint32_t drawCallCount() const;
     [[nodiscard]] const std::list<InstanceshowDebugInfo>& instancesString() const;
-    [[nodiscard]] std::vector<MeshInstance>& getInstancesForMesh(uint32_t meshID, uint32_t textureID);
+    [[nodiscard]] std::vector<MeshInstance>& getInstancesForMesh(uint32_t meshID, uint32_t materialIndex = 0);
+
+    // Materials
+    [[nodiscard]] const std::vector<Material>& materials() const;
+    [[nodiscard]] uint32_t pipelineCount() const;
+    [[nodiscard]] uint32_t pendingPipelineCount() const;
+
+    // Culling
+    [[nodiscard]] CullingMode cullingMode() const;
+    void setCullingMode(CullingMode cullingMode);
+    [[nodiscard]] uint32_t submittedInstanceCount() const;
+    [[nodiscard]] uint32_t visibleInstanceCount() const;
+    [[nodiscard]] bool clusterCulling() const;
+    void setClusterCulling(bool clusterCulling); // Per meshlet culling of large meshes, with CPU culling only
+    [[nodiscard]] const ClusterCullingStatistics& clusterCullingStatistics() const;
+    [[nodiscard]] bool validateGpuCulling() const;
+    void setValidateGpuCulling(bool validateGpuCulling); // Compare GPU culling results against the CPU reference
+    [[nodiscard]] uint64_t validatedCullBatchCount() const;
+    [[nodiscard]] uint64_t cullMismatchCount() const; // Batches where the GPU and CPU disagreed
+
+    // Instance buffers
+    [[nodiscard]] InstanceEncoding instanceEncoding() const;
+    void setInstanceEncoding(InstanceEncoding instanceEncoding);
+
+    // Command recording
+    [[nodiscard]] uint32_t recordingThreadCount() const;
+    void setRecordingThreadCount(uint32_t recordingThreadCount);
+    [[nodiscard]] uint32_t maxRecordingThreadCount() const;
+    [[nodiscard]] uint32_t maxInstancesPerDraw() const;
+    void setMaxInstancesPerDraw(uint32_t maxInstancesPerDraw); // 0 draws each mesh with a single call
+    [[nodiscard]] float recordingTime() const;                  // In milliseconds
+    [[nodiscard]] bool reuseSceneCommands() const;
+    void setReuseSceneCommands(bool reuseSceneCommands); // Records the scene draws again only when they change
+    [[nodiscard]] bool sceneCommandsReused() const;      // In the latest frame
+    [[nodiscard]] bool sortDrawItems() const;
+    void setSortDrawItems(bool sortDrawItems);
+    [[nodiscard]] const BindStatistics& bindStatistics() const;
+
+    // Frame graph
+    [[nodiscard]] const RenderGraph& renderGraph() const;
+    [[nodiscard]] bool depthPrePass() const;
+    void setDepthPrePass(bool depthPrePass); // Takes effect at the start of the next frame
+    [[nodiscard]] float sceneGpuTime(bool depthPrePass) const; // In milliseconds, 0 until measured in that mode
+
+    // Dynamic resolution. When the upscale shaders are available the scene is drawn offscreen and stretched over the
+    // swapchain, at a scale the controller adjusts to the GPU frame time while enabled and at the max scale otherwise
+    [[nodiscard]] bool dynamicResolution() const;
+    void setDynamicResolution(bool dynamicResolution);
+    [[nodiscard]] const ResolutionController& resolutionController() const;
+    void setResolutionSettings(const ResolutionController::Settings& settings); // A new max scale rebuilds the graph
+    [[nodiscard]] VkExtent2D renderExtent() const; // Of the scene in the latest frame
+
+    // GPU timings, read back a few frames late
+    [[nodiscard]] const GpuProfiler& gpuProfiler() const;
+    [[nodiscard]] bool profileDrawItems() const;
+    void setProfileDrawItems(bool profileDrawItems); // Adds a scope around every draw
+
+    [[nodiscard]] const StagingPool& stagingPool() const;
+    [[nodiscard]] const UniformRing& uniformRing() const;
+
+    // Mip streaming, disabled for the whole run by a budget of 0 at launch
+    [[nodiscard]] bool textureStreaming() const;
+    [[nodiscard]] const TextureStreamer& textureStreamer() const;
+    void setTextureBudget(VkDeviceSize budget);
+
+    // Frame pacing. More frames in flight overlap CPU and GPU work better but add a frame of latency each
+    [[nodiscard]] uint32_t framesInFlight() const;
+    void setFramesInFlight(uint32_t framesInFlight); // Waits for the device to go idle
+    [[nodiscard]] uint32_t maxFramesInFlight() const;
+    [[nodiscard]] bool lowLatency() const;
+    void setLowLatency(bool lowLatency); // Sleeps before input is sampled so the frame is submitted just in time
+    [[nodiscard]] const FramePacingStatistics& framePacingStatistics() const;
+    [[nodiscard]] size_t pendingDestructionCount() const; // Retired objects waiting for the frames in flight
 
 private:
     // API-specific functions
@@ -62,9 +171,16 @@ private:
                                            const std::vector<const char*>& glfwExtensions) const;
     [[nodiscard]] bool checkValidationLayerSupport() const;
     [[nodiscard]] bool checkDeviceExtensionSupport(VkPhysicalDevice device) const;
+    [[nodiscard]] std::vector<const char*> retrieveDeviceExtensions() const;
+    [[nodiscard]] uint32_t rateDevice(VkPhysicalDevice device) const;
     [[nodiscard]] bool isDeviceSuitable(VkPhysicalDevice device) const;
-    [[nodiscard]] bool hasStencilComponent(VkFormat format);
+    [[nodiscard]] bool checkDescriptorIndexingSupport(const VkPhysicalDeviceVulkan12Features& features) const;
+    [[nodiscard]] VkPhysicalDeviceVulkan12Features queryVulkan12Features(VkPhysicalDevice device) const;
     [[nodiscard]] bool isMsaaEnabled() const;
+    [[nodiscard]] bool isGpuCullingSupported() const;
+    [[nodiscard]] bool isDepthPrePassSupported() const;
+    [[nodiscard]] bool isClusterCullingSupported() const;
+    [[nodiscard]] bool isUpscalingSupported() const;
     [[nodiscard]] QueueFamilyIndices queryQueueFamilies(VkPhysicalDevice device) const;
     [[nodiscard]] Swapchain::SupportDetails querySwapchainSupport(VkPhysicalDevice device) const;
     [[nodiscard]] VkSurfaceFormatKHR selectSwapSurfaceFormat(
@@ -91,19 +207,25 @@ private:
     void selectPhysicalDevice();
     void createLogicalDevice();
     void createVmaAllocator();
-    void createSwapchain();
+    void createStagingPool();
+    void createTextureStreamer();
+    void createPipelineCache();
+    void createSwapchain(VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+    void createOffscreenImages();
     void createImageViews();
-    void createRenderPass();
+    void createRenderGraph();
     void createDescriptorSetLayout();
-    void createFramebuffers();
+    void createBindlessDescriptorSet();
+    void createPipelineLayout();
+    void createMaterials();
+    void createPipelines();
     void createCommandPools();
-    void createColorResources();
-    void createDepthResources();
+    void createThreadCommandPools();
     void loadTextures();
     void loadModels();
     void createVertexBuffers();
     void createIndexBuffers();
-    void createUniformBuffers();
+    void createUniformRing();
     void createDescriptorPool();
     void createDescriptorSets();
     void initImGui();
@@ -112,6 +234,9 @@ private:
     void createViewportImageSampler();
     void createCommandBuffers();
     void createSynchronizationObjects();
+    void createCullingResources();
+    void createGpuProfiler();
+    void createUpscaleResources();
 
     // Resource creation
     [[nodiscard]] VkImageView createImageView(VkImage image,
@@ -134,12 +259,18 @@ private:
                      VmaMemoryUsage allocationUsage,
                      VmaAllocationCreateFlags allocationFlags,
                      VmaImage& vmaImage) const;
-    void generateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
 
     // Textures or images
-    void createTextureImage(Texture& texture, TextureData& textureData);
-    void createTextureImageView(Texture& texture, TextureData& textureData);
-    void createTextureSampler(Texture& texture, TextureData& textureData);
+    void createTextureImage(Texture& texture, const Ktx2Texture& ktxTexture, uint32_t firstLevel);
+    void recordTextureUpload(VkCommandBuffer commandBuffer,
+                             Texture& texture,
+                             const Ktx2Texture& ktxTexture,
+                             uint32_t firstLevel);
+    void updateTextureStreaming();
+    void createTextureSampler(Texture& texture);
+    [[nodiscard]] uint32_t acquireBindlessSlot();
+    void registerBindlessTexture(Texture& texture);
+    void writeBindlessDescriptor(uint32_t index, VkImageView imageView, VkSampler sampler);
     void transitionImageLayout(VkImage image,
                                VkFormat format,
                                VkImageLayout oldLayout,
@@ -149,27 +280,89 @@ private:
     // Swapchain
     void cleanupSwapchain();
     void recreateSwapchain();
+    void retireSwapchain();
+    void retireCommandBuffers(); // The primary ones, one per swapchain image
+    void rebuildRenderGraph();
+
+    // Deferred destruction, for objects frames in flight may still use. The handles are reset
+    void retire(DeletionQueue::Deleter deleter);
+    void retireBuffer(VmaBuffer& buffer);
+    void retireImage(VmaImage& image, VkImageView& imageView);
+    void retireBindlessSlot(uint32_t slot);
+    void retireTexture(Texture& texture); // With its sampler and bindless slot
+    void retireMesh(Mesh& mesh);
+    void retireRenderGraph();
+    void retirePipelines();
 
     // Clean up imgui
     void cleanUpImGui();
 
     // Buffers
+    void uploadBuffer(VkCommandBuffer commandBuffer, const void* data, VkDeviceSize size, VmaBuffer& dstBuffer);
     void copyBuffer(const VmaBuffer& srcBuffer, VmaBuffer& dstBuffer, VkDeviceSize size);
-    void copyBufferToImage(const VmaBuffer& buffer, VkImage image, uint32_t width, uint32_t height);
-    void createVertexBuffer(const std::vector<Vertex>& vertices, VmaBuffer& vertexBuffer);
-    void createIndexBuffer(const std::vector<uint32_t>& indices, VmaBuffer& indexBuffer);
+    void captureFrame(uint32_t imageIndex, const std::string& path);
+    void createVertexBuffer(VkCommandBuffer commandBuffer,
+                            const std::vector<uint8_t>& vertexStream,
+                            VmaBuffer& vertexBuffer);
+    void createIndexBuffer(VkCommandBuffer commandBuffer, const std::vector<uint8_t>& indices, VmaBuffer& indexBuffer);
     void createInstanceBuffer(InstanceBuffer& instanceBuffer);
-    void updateUniformBuffer(uint32_t imageIndex);
+    void updateUniforms(); // Starts this frame's region of the uniform ring
     void recordCommandBuffers(uint32_t imageIndex);
+    [[nodiscard]] PipelineState resolvePipelineState(uint32_t materialIndex, const VertexFormat& vertexFormat) const;
+    [[nodiscard]] VkPipeline retrievePipeline(uint32_t materialIndex, const VertexFormat& vertexFormat);
+    [[nodiscard]] PipelineState resolveDepthPipelineState(uint32_t materialIndex,
+                                                          const VertexFormat& vertexFormat) const;
+    [[nodiscard]] VkPipeline retrieveDepthPipeline(uint32_t materialIndex, const VertexFormat& vertexFormat);
+    void recordDepthPrePass(const RenderGraph::PassContext& context);
+    void recordScenePass(const RenderGraph::PassContext& context);
+    [[nodiscard]] PipelineState resolveUpscalePipelineState() const;
+    void recordUpscalePass(const RenderGraph::PassContext& context);
+    void writeSceneColorDescriptor();
+    void updateRenderExtent();
+    [[nodiscard]] VkExtent2D scaledExtent(float scale) const; // Of the swapchain
+    void updateSceneGpuTimes();
+    void sleepForLatency();
+    void gatherDrawItems(const CullingBuffers* cullingBuffers);
+    // Without a framebuffer the commands can be executed in any framebuffer of the scene pass
+    void beginSecondaryCommandBuffer(VkCommandBuffer commandBuffer,
+                                     VkCommandBufferUsageFlags flags,
+                                     VkFramebuffer framebuffer = VK_NULL_HANDLE);
+    [[nodiscard]] bool canReuseSceneCommands(const SceneCommands& sceneCommands, uint32_t chunkCount) const;
+    void invalidateSceneCommands();
+    BindStatistics recordDrawItems(VkCommandBuffer commandBuffer,
+                                   const DrawItem* drawItems,
+                                   uint32_t drawItemCount,
+                                   const CullingBuffers* cullingBuffers);
+    void bindFrameState(VkCommandBuffer commandBuffer) const;
+    void bindDrawItem(VkCommandBuffer commandBuffer,
+                      const DrawItem& drawItem,
+                      DrawItem& bound,
+                      BindStatistics& statistics) const;
+    void recordImGui(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    [[nodiscard]] UniformBufferObject retrieveCameraMatrices() const;
+
+    // GPU culling
+    void reserveCullingBuffers(CullingBuffers& buffers,
+                               uint32_t instanceCount,
+                               uint32_t batchCount,
+                               uint32_t commandCount);
+    void retireCullingBuffers(CullingBuffers& buffers);
+    void prepareGpuCulling();
+    void readbackGpuCulling(CullingBuffers& buffers);
+    void recordGpuCulling(VkCommandBuffer commandBuffer, const CullingBuffers& buffers);
+
+    // Cluster culling
+    [[nodiscard]] bool isClusterCulled(const Mesh& mesh) const;
+    void cullClusters(const Mesh& mesh, InstanceBatch& batch, const Frustum& frustum, const glm::vec3& cameraPosition);
+    void uploadClusterCommands();
 
     // Commands
     VkCommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-    void drawCommand(VkCommandBuffer commandBuffer,
-                     const VkBuffer& vertexBuffer,
-                     const VkBuffer& indexBuffer,
-                     const InstanceBuffer& instanceBuffer,
-                     uint32_t indexCount);
+    void drawCommand(VkCommandBuffer commandBuffer, const DrawItem& drawItem);
+    void drawIndirectCommand(VkCommandBuffer commandBuffer,
+                             const DrawItem& drawItem,
+                             const CullingBuffers& cullingBuffers);
 
     template<typename TCallable>
     void singleTimeCommands(TCallable&& callable)
@@ -197,27 +390,55 @@ private:
     VkQueue m_graphicsQueue = VK_NULL_HANDLE;
     VkQueue m_presentQueue = VK_NULL_HANDLE;
     Swapchain m_swapchain;
-    VkRenderPass m_renderPass = VK_NULL_HANDLE;
+    RenderGraph m_renderGraph{};
+    RenderGraph::PassHandle m_cullingPass = 0;
+    RenderGraph::PassHandle m_depthPass = 0;
+    RenderGraph::PassHandle m_scenePass = 0;
+    bool m_renderGraphDirty = false;
     VkCommandPool m_commandPool = VK_NULL_HANDLE;
     VkCommandPool m_transientCommandPool = VK_NULL_HANDLE;
-    Pipeline m_pipeline{};
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    PipelineStateCache m_pipelineStates{};
+    PipelineCache m_pipelineCache{};
 
-    // Uniform and command buffers for each swapchain image
+    // Offscreen images standing in for the swapchain when headless
+    std::vector<VmaImage> m_offscreenImages;
+    std::string m_capturePath;
+
+    // Command buffers for each swapchain image
     std::vector<VkCommandBuffer> m_commandBuffers;
-    std::vector<VmaBuffer> m_uniformBuffers;
+
+    // Secondary command buffers for each frame in flight, one per recording thread plus one for ImGui
+    std::vector<std::vector<ThreadCommandPool>> m_threadCommandPools;
+    std::vector<ThreadCommandPool> m_uiCommandPools;
+    std::vector<SceneCommands> m_sceneCommands; // What the recording threads' buffers of each frame hold
+    std::vector<DrawItem> m_drawItems;
+
+    // Draw order, sorted by 64-bit keys every frame
+    std::vector<RadixSort::Item> m_drawSortItems;
+    std::vector<RadixSort::Item> m_drawSortScratch;
+    std::vector<DrawItem> m_sortedDrawItems;
+
+    // Uniform blocks of every view and pass, bound by dynamic offset
+    UniformRing m_uniformRing{};
+    uint32_t m_viewUniformOffset = 0; // Of the camera this frame
 
     // Descriptor sets
     VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
     VkDescriptorSetLayout m_uboDescriptorSetLayout = VK_NULL_HANDLE;
-    VkDescriptorSetLayout m_samplerDescriptorSetLayout = VK_NULL_HANDLE;
-    std::vector<VkDescriptorSet> m_uboDescriptorSets;
+    VkDescriptorSetLayout m_bindlessDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSet m_uboDescriptorSet = VK_NULL_HANDLE;
 
-    // Push constants
-    PushConstantObject m_pushConstants;
+    // Bindless textures, one descriptor array shared by every draw
+    VkDescriptorPool m_bindlessDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_bindlessDescriptorSet = VK_NULL_HANDLE;
+    uint32_t m_maxBindlessTextures = 0;
+    uint32_t m_bindlessTextureCount = 0;
+    std::vector<uint32_t> m_freeBindlessSlots;
 
-    // Depth image
-    VmaImage m_depthImage{};
-    VkImageView m_depthImageView = VK_NULL_HANDLE;
+    // Vertex formats of the loaded meshes, pipelines are compiled ahead for each of them
+    std::vector<VertexFormat> m_vertexFormats;
+    VmaBuffer m_defaultAttributeBuffer{}; // Zeroes for the attributes a format doesn't have
 
     // Viewport objects
     std::vector<VmaImage> m_viewportImages;
@@ -231,13 +452,76 @@ private:
     std::vector<VkFence> m_inFlightFences;
     std::vector<VkFence> m_imagesInFlight;
 
+    // Frame pacing
+    uint32_t m_framesInFlight = 3;
+    bool m_lowLatency = false;
+    bool m_frameSlotReady = false; // The current frame's fence has been waited on
+    Clock::Timer m_cpuFrameTimer{};
+    FramePacingStatistics m_framePacingStatistics{};
+
+    // Objects replaced while frames are in flight, e.g. by a resize, are destroyed once those frames have finished
+    DeletionQueue m_deletionQueue{};
+    uint64_t m_frameNumber = 0;              // Of the last submitted frame
+    std::vector<uint64_t> m_frameSlotNumbers; // Of the last frame submitted in each slot
+
     // MSAA resources
     VkSampleCountFlagBits m_maxMsaaSamples = VK_SAMPLE_COUNT_1_BIT;
-    VmaImage m_colorImage{};
-    VkImageView m_colorImageView = VK_NULL_HANDLE;
 
-    // Mesh instances
-    std::map<std::pair<uint32_t, uint32_t>, std::unique_ptr<std::vector<Vulkan::MeshInstance>>> m_meshInstances;
+    // Materials, index 0 is the default and the fallback while other pipelines compile
+    std::vector<Material> m_materials;
+
+    // Mesh instances, batched by mesh and material
+    std::map<std::pair<uint32_t, uint32_t>, std::unique_ptr<InstanceBatch>> m_meshInstances;
+    std::vector<MeshInstance> m_visibleInstances;
+
+    // GPU culling objects
+    ComputePipeline m_cullPipeline{};
+    VkDescriptorSetLayout m_cullDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_cullDescriptorPool = VK_NULL_HANDLE;
+    std::vector<CullingBuffers> m_cullingBuffers;
+    std::vector<uint32_t> m_cullBatchMeshIds;
+    std::vector<uint32_t> m_cullBatchMaterialIndices;
+    std::vector<CullBatch> m_cullBatches;
+    uint32_t m_cullCommandCount = 0;
+    std::vector<MeshInstance> m_cullInstances;
+    std::vector<uint32_t> m_cullInstanceBatches;
+    Frustum m_cullFrustum{};
+    const CullingBuffers* m_frameCullingBuffers = nullptr; // Set while recording a frame that culls on the GPU
+    bool m_supportsDrawIndirectCount = false;
+    bool m_supportsMultiDrawIndirect = false; // Meshes split into submeshes draw several commands per batch
+    bool m_supportsDrawIndirectFirstInstance = false;
+
+    // Cluster culling, the commands are written on the CPU and copied to the frame's buffer once it is free
+    std::vector<VkDrawIndexedIndirectCommand> m_clusterCommands;
+    std::vector<VmaBuffer> m_clusterCommandBuffers; // Per frame in flight, host visible, grown on demand
+    std::vector<uint32_t> m_visibleMeshlets;
+    ClusterCullingStatistics m_clusterCullingStatistics{};
+
+    // Texture compression features, enabled when supported
+    bool m_supportsTextureCompressionBC = false;
+    bool m_supportsTextureCompressionETC2 = false;
+
+    // Upload memory
+    StagingPool m_stagingPool{};
+
+    // Mip streaming, uploads are recorded into the command buffer of the current frame slot
+    TextureStreamer m_textureStreamer{};
+    std::vector<VkCommandBuffer> m_streamingCommandBuffers;
+    bool m_textureStreaming = false;
+
+    // GPU timing
+    GpuProfiler m_gpuProfiler{};
+    std::array<float, 2> m_sceneGpuTimes{}; // Without and with the depth pre-pass
+
+    // Dynamic resolution, the scene color image is sized for the max scale and only its top left is rendered to
+    ResolutionController m_resolutionController{};
+    RenderGraph::PassHandle m_upscalePass = 0;
+    RenderGraph::ResourceHandle m_sceneColorImage = 0;
+    VkExtent2D m_sceneColorExtent{};
+    VkExtent2D m_renderExtent{};
+    VkSampler m_upscaleSampler = VK_NULL_HANDLE;
+    std::optional<uint32_t> m_sceneColorBindlessIndex; // A new slot for every graph, frames in flight use the old one
+    bool m_upscaling = false; // Decided at init, the scene is drawn straight into the swapchain otherwise
 
     // ImGui vulkan objects
     VkDescriptorPool m_imguiDescriptorPool = VK_NULL_HANDLE;
@@ -245,15 +529,35 @@ private:
 
     // Config variables
     // TODO: Create config file to store these values
+    bool m_headless = false;
     VkSampleCountFlagBits m_msaaSamples = VK_SAMPLE_COUNT_8_BIT;
-    bool m_enableMipmaps = false;
+    bool m_enableMipmaps = true;
     uint32_t m_apiVersion = VK_API_VERSION_1_3;
     PresentationMode m_presentationMode = PresentationMode::TripleBuffered;
+    CullingMode m_cullingMode = CullingMode::Gpu;
+    bool m_validateGpuCulling = false;
+    uint64_t m_validatedCullBatchCount = 0;
+    uint64_t m_cullMismatchCount = 0;
+    bool m_clusterCulling = true;
+    InstanceEncoding m_instanceEncoding = InstanceEncoding::QuaternionScale;
+    uint32_t m_recordingThreadCount = 1;
+    uint32_t m_maxInstancesPerDraw = 0;
+    bool m_reuseSceneCommands = true;
+    bool m_sceneCommandsReused = false;
+    bool m_sortDrawItems = true;
+    bool m_profileDrawItems = false;
+    bool m_depthPrePass = false; // Lay down depth first so the main pass shades each pixel once
+    bool m_dynamicResolution = false;
+    bool m_compilePipelinesInBackground = true; // Otherwise new materials compile on first use, stalling the frame
 
     // Debugging variables
     size_t m_currentFrame = 0;
     uint32_t m_drawCallCount = 0;
     std::list<InstanceshowDebugInfo> m_instancesString;
+    uint32_t m_submittedInstanceCount = 0;
+    uint32_t m_visibleInstanceCount = 0;
+    float m_recordingTime = 0.0f;
+    BindStatistics m_bindStatistics{};
 };
 } // namespace Vulkan
 } // namespace RDE
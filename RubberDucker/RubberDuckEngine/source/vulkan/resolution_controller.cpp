@@ -0,0 +1,113 @@
+#include "precompiled/pch.hpp"
+
+#include "resolution_controller.hpp"
+
+namespace RDE {
+namespace Vulkan {
+
+constexpr float k_lowestScale = 0.25f;
+constexpr float k_gpuTimeSmoothing = 0.2f;
+constexpr uint32_t k_minSampleCount = 4; // Before the first decision after a change
+constexpr uint32_t k_settleFrameCount = 6; // More than the frames in flight, whose timings still come back
+constexpr float k_raiseThreshold = 0.8f; // Of the target, the scale only goes up below it
+constexpr float k_aimFraction = 0.9f; // Of the target, changes aim here to leave room for noise
+constexpr float k_maxDecrease = 0.15f;
+constexpr float k_maxIncrease = 0.05f;
+constexpr float k_minChange = 0.01f;
+
+void ResolutionController::reset(float scale)
+{
+    m_scale = std::clamp(scale, m_settings.minScale, m_settings.maxScale);
+    m_smoothedGpuTime = 0.0f;
+    m_sampleCount = 0;
+    m_settleFrames = 0;
+    m_state = State::Holding;
+}
+
+float ResolutionController::update(float gpuTime)
+{
+    if (gpuTime <= 0.0f) {
+        return m_scale;
+    }
+    if (m_settleFrames > 0) {
+        --m_settleFrames;
+        return m_scale;
+    }
+
+    m_smoothedGpuTime =
+        m_sampleCount == 0 ? gpuTime : m_smoothedGpuTime + (gpuTime - m_smoothedGpuTime) * k_gpuTimeSmoothing;
+    if (++m_sampleCount < k_minSampleCount) {
+        return m_scale;
+    }
+
+    // The cost of the scene is roughly proportional to its pixel count, i.e. the square of the scale
+    const float target = m_settings.targetGpuTime;
+    const float aimedScale = m_scale * std::sqrt(target * k_aimFraction / m_smoothedGpuTime);
+
+    float scale = m_scale;
+    auto state = State::Holding;
+    if (m_smoothedGpuTime > target) {
+        scale = std::max(aimedScale, m_scale - k_maxDecrease);
+        state = State::Lowering;
+    } else if (m_smoothedGpuTime < target * k_raiseThreshold) {
+        scale = std::min(aimedScale, m_scale + k_maxIncrease);
+        state = State::Raising;
+    }
+    scale = std::clamp(scale, m_settings.minScale, m_settings.maxScale);
+
+    // Between the thresholds, or already at a bound
+    if (std::abs(scale - m_scale) < k_minChange) {
+        m_state = State::Holding;
+        return m_scale;
+    }
+
+    m_scale = scale;
+    m_state = state;
+    m_sampleCount = 0;
+    m_settleFrames = k_settleFrameCount;
+    return m_scale;
+}
+
+[[nodiscard]] const ResolutionController::Settings& ResolutionController::settings() const
+{
+    return m_settings;
+}
+
+void ResolutionController::setSettings(const Settings& settings)
+{
+    m_settings.maxScale = std::clamp(settings.maxScale, k_lowestScale, 1.0f);
+    m_settings.minScale = std::clamp(settings.minScale, k_lowestScale, m_settings.maxScale);
+    m_settings.targetGpuTime = std::max(settings.targetGpuTime, 0.1f);
+    m_scale = std::clamp(m_scale, m_settings.minScale, m_settings.maxScale);
+}
+
+[[nodiscard]] float ResolutionController::scale() const
+{
+    return m_scale;
+}
+
+[[nodiscard]] float ResolutionController::smoothedGpuTime() const
+{
+    return m_smoothedGpuTime;
+}
+
+[[nodiscard]] ResolutionController::State ResolutionController::state() const
+{
+    return m_state;
+}
+
+[[nodiscard]] const char* ResolutionController::stateName(State state)
+{
+    switch (state) {
+    case State::Holding:
+        return "Holding";
+    case State::Lowering:
+        return "Lowering";
+    case State::Raising:
+        return "Raising";
+    }
+    return "Unknown";
+}
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+namespace RDE {
+namespace Vulkan {
+
+// Picks the scale the scene is rendered at, per axis and relative to the swapchain, so the GPU frame time stays under
+// a target. Timings are smoothed, the scale drops quickly when the frame is over budget and creeps back up once there
+// is headroom. Timings are read back a few frames late, so after every change the frames still timed at the old
+// scale are skipped.
+class ResolutionController
+{
+public:
+    enum class State : uint8_t
+    {
+        Holding,
+        Lowering,
+        Raising
+    };
+
+    struct Settings
+    {
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        float targetGpuTime = 1000.0f / 60.0f; // In milliseconds
+    };
+
+    // Starts over at the given scale, e.g. after the timings were cleared
+    void reset(float scale);
+
+    // Once per frame with the latest GPU frame time in milliseconds, 0 if there is none. Returns the new scale
+    float update(float gpuTime);
+
+    [[nodiscard]] const Settings& settings() const;
+    void setSettings(const Settings& settings); // Clamps the bounds to (0, 1] and the scale to the bounds
+    [[nodiscard]] float scale() const;
+    [[nodiscard]] float smoothedGpuTime() const; // In milliseconds
+    [[nodiscard]] State state() const;
+    [[nodiscard]] static const char* stateName(State state);
+
+private:
+    Settings m_settings{};
+    float m_scale = 1.0f;
+    float m_smoothedGpuTime = 0.0f;
+    uint32_t m_sampleCount = 0;  // Since the last change
+    uint32_t m_settleFrames = 0; // Left to skip
+    State m_state = State::Holding;
+};
+
+} // namespace Vulkan
+} // namespace RDE
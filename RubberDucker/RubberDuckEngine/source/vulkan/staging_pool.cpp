@@ -0,0 +1,199 @@
+#include "precompiled/pch.hpp"
+
+#include "staging_pool.hpp"
+
+namespace RDE {
+namespace Vulkan {
+
+void StagingPool::init(VkDevice device,
+                       VkAllocationCallbacks* allocator,
+                       VmaAllocator vmaAllocator,
+                       VkDeviceSize blockSize,
+                       VkDeviceSize maxPoolSize)
+{
+    m_device = device;
+    m_allocator = allocator;
+    m_vmaAllocator = vmaAllocator;
+    m_blockSize = blockSize;
+    m_maxPoolSize = std::max(maxPoolSize, blockSize);
+}
+
+void StagingPool::destroy()
+{
+    if (!m_retiredFences.empty()) {
+        vkWaitForFences(
+            m_device, static_cast<uint32_t>(m_retiredFences.size()), m_retiredFences.data(), VK_TRUE, UINT64_MAX);
+    }
+    for (auto& block : m_blocks) {
+        vmaDestroyBuffer(m_vmaAllocator, block.buffer.buffer, block.buffer.allocation);
+    }
+    for (auto fence : m_retiredFences) {
+        vkDestroyFence(m_device, fence, m_allocator);
+    }
+    for (auto fence : m_freeFences) {
+        vkDestroyFence(m_device, fence, m_allocator);
+    }
+    m_blocks.clear();
+    m_retiredFences.clear();
+    m_freeFences.clear();
+}
+
+[[nodiscard]] StagingPool::Allocation StagingPool::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    ++m_allocationCount;
+    recycle();
+
+    if (size > m_blockSize) {
+        return allocateFrom(createBlock(size, true), 0, size);
+    }
+
+    while (true) {
+        // Blocks still read by a submission are skipped, the rest are either free or part of the current batch
+        for (auto& block : m_blocks) {
+            if (block.dedicated || block.fence != VK_NULL_HANDLE) {
+                continue;
+            }
+            const VkDeviceSize offset = (block.offset + alignment - 1) / alignment * alignment;
+            if (offset + size <= block.size) {
+                return allocateFrom(block, offset, size);
+            }
+        }
+
+        if (poolSize() + m_blockSize <= m_maxPoolSize) {
+            return allocateFrom(createBlock(m_blockSize, false), 0, size);
+        }
+
+        // At the cap. The current batch can't be waited on as it hasn't been submitted yet
+        if (m_retiredFences.empty()) {
+            return allocateFrom(createBlock(size, true), 0, size);
+        }
+        waitForOldestFence();
+    }
+}
+
+[[nodiscard]] VkFence StagingPool::retire()
+{
+    VkFence fence = VK_NULL_HANDLE;
+
+    for (auto& block : m_blocks) {
+        if (!block.pending) {
+            continue;
+        }
+        if (fence == VK_NULL_HANDLE) {
+            if (m_freeFences.empty()) {
+                VkFenceCreateInfo fenceInfo{};
+                fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+                auto result = vkCreateFence(m_device, &fenceInfo, m_allocator, &fence);
+                RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create staging fence!");
+            } else {
+                fence = m_freeFences.back();
+                m_freeFences.pop_back();
+            }
+            m_retiredFences.push_back(fence);
+        }
+        block.fence = fence;
+        block.pending = false;
+    }
+    return fence;
+}
+
+[[nodiscard]] uint32_t StagingPool::blockCount() const
+{
+    return static_cast<uint32_t>(
+        std::count_if(m_blocks.begin(), m_blocks.end(), [](const Block& block) { return !block.dedicated; }));
+}
+
+[[nodiscard]] VkDeviceSize StagingPool::poolSize() const
+{
+    return blockCount() * m_blockSize;
+}
+
+[[nodiscard]] uint32_t StagingPool::allocationCount() const
+{
+    return m_allocationCount;
+}
+
+[[nodiscard]] uint32_t StagingPool::dedicatedAllocationCount() const
+{
+    return m_dedicatedAllocationCount;
+}
+
+void StagingPool::recycle()
+{
+    for (auto fenceIt = m_retiredFences.begin(); fenceIt != m_retiredFences.end();) {
+        const VkFence fence = *fenceIt;
+        if (vkGetFenceStatus(m_device, fence) != VK_SUCCESS) {
+            ++fenceIt;
+            continue;
+        }
+
+        for (auto blockIt = m_blocks.begin(); blockIt != m_blocks.end();) {
+            if (blockIt->fence != fence) {
+                ++blockIt;
+            } else if (blockIt->dedicated) {
+                vmaDestroyBuffer(m_vmaAllocator, blockIt->buffer.buffer, blockIt->buffer.allocation);
+                blockIt = m_blocks.erase(blockIt);
+            } else {
+                blockIt->offset = 0;
+                blockIt->fence = VK_NULL_HANDLE;
+                ++blockIt;
+            }
+        }
+
+        vkResetFences(m_device, 1, &fence);
+        m_freeFences.push_back(fence);
+        fenceIt = m_retiredFences.erase(fenceIt);
+    }
+}
+
+void StagingPool::waitForOldestFence()
+{
+    vkWaitForFences(m_device, 1, &m_retiredFences.front(), VK_TRUE, UINT64_MAX);
+    recycle();
+}
+
+[[nodiscard]] StagingPool::Block& StagingPool::createBlock(VkDeviceSize size, bool dedicated)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    allocationInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    Block block{};
+    block.size = size;
+    block.dedicated = dedicated;
+
+    const auto result = vmaCreateBuffer(m_vmaAllocator,
+                                        &bufferInfo,
+                                        &allocationInfo,
+                                        &block.buffer.buffer,
+                                        &block.buffer.allocation,
+                                        &block.buffer.allocationInfo);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create staging buffer of {} bytes!", size);
+
+    if (dedicated) {
+        ++m_dedicatedAllocationCount;
+    }
+    return m_blocks.emplace_back(block);
+}
+
+[[nodiscard]] StagingPool::Allocation StagingPool::allocateFrom(Block& block, VkDeviceSize offset, VkDeviceSize size)
+{
+    block.offset = offset + size;
+    block.pending = true;
+
+    Allocation allocation{};
+    allocation.buffer = block.buffer.buffer;
+    allocation.offset = offset;
+    allocation.data = static_cast<uint8_t*>(block.buffer.allocationInfo.pMappedData) + offset;
+    return allocation;
+}
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "data_types/vma_buffer.hpp"
+
+#include <vma/vk_mem_alloc.h>
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+
+// Host-visible memory for uploads, suballocated linearly from large persistently mapped blocks. Everything allocated
+// between two calls to retire() is released together once the fence returned by the second call is signaled.
+// Uploads larger than a block, or made while the pool is at its size cap with nothing left to wait for, get a
+// dedicated buffer that is released the same way.
+class StagingPool
+{
+public:
+    struct Allocation
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        void* data = nullptr; // Mapped pointer to the start of the allocation
+    };
+
+    void init(VkDevice device,
+              VkAllocationCallbacks* allocator,
+              VmaAllocator vmaAllocator,
+              VkDeviceSize blockSize,
+              VkDeviceSize maxPoolSize);
+
+    // Waits for every pending upload
+    void destroy();
+
+    [[nodiscard]] Allocation allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+    // Returns the fence the submission reading this batch's allocations has to signal, or null if nothing was
+    // allocated since the last call
+    [[nodiscard]] VkFence retire();
+
+    // Statistics
+    [[nodiscard]] uint32_t blockCount() const;
+    [[nodiscard]] VkDeviceSize poolSize() const;
+    [[nodiscard]] uint32_t allocationCount() const;          // Since init
+    [[nodiscard]] uint32_t dedicatedAllocationCount() const; // Since init
+
+private:
+    struct Block
+    {
+        VmaBuffer buffer{};
+        VkDeviceSize size = 0;
+        VkDeviceSize offset = 0;        // Next free byte
+        VkFence fence = VK_NULL_HANDLE; // Set while a submission reads from the block
+        bool dedicated = false;
+        bool pending = false; // Allocated from since the last retire()
+    };
+
+    void recycle();
+    void waitForOldestFence();
+    [[nodiscard]] Block& createBlock(VkDeviceSize size, bool dedicated);
+    [[nodiscard]] Allocation allocateFrom(Block& block, VkDeviceSize offset, VkDeviceSize size);
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkAllocationCallbacks* m_allocator = nullptr;
+    VmaAllocator m_vmaAllocator = VK_NULL_HANDLE;
+    VkDeviceSize m_blockSize = 0;
+    VkDeviceSize m_maxPoolSize = 0;
+
+    std::vector<Block> m_blocks;
+    std::vector<VkFence> m_retiredFences; // Oldest first
+    std::vector<VkFence> m_freeFences;
+    uint32_t m_allocationCount = 0;
+    uint32_t m_dedicatedAllocationCount = 0;
+};
+
+} // namespace Vulkan
+} // namespace RDE
@@ -2,6 +2,7 @@
 
 #include "instance_update_system.hpp"
 
+#include "assetmanager/asset_manager.hpp"
 #include "core/main.hpp"
 #include "ecs/components/component_list.hpp"
 #include "vulkan/data_types/mesh_instance.hpp"
@@ -10,8 +11,9 @@ namespace RDE {
 
 void InstanceUpdateSystem::update(entt::registry& registry, float dt)
 {
-    // Update instance buffers for each mesh
+    // Update instance buffers for each mesh and material
     auto& renderer = g_engine->renderer();
+    auto& assetManager = g_engine->assetManager();
     auto group = registry.group<TransformComponent, MeshComponent>();
 
     // TODO: Implement dirty components/flags to prevent clearing/copying every frame
@@ -23,11 +25,13 @@ void InstanceUpdateSystem::update(entt::registry& registry, float dt)
         modelMtx = glm::translate(modelMtx, transform.translate) * glm::mat4_cast(transform.rotate) *
                    glm::scale(modelMtx, transform.scale);
 
-        Vulkan::MeshInstance instance;
-        std::vector<Vulkan::MeshInstance>& instances = renderer.getInstancesForMesh(model.modelGuid, model.textureGuid);
+        Vulkan::MeshInstance instance{};
+        std::vector<Vulkan::MeshInstance>& instances =
+            renderer.getInstancesForMesh(model.modelGuid, model.materialIndex);
         instance.modelTransform = modelMtx;
+        instance.textureIndex = assetManager.getTexture(model.textureGuid).bindlessIndex;
 
-        // Move instance into a vector mapped from mesh and texture IDs
+        // Move instance into a vector mapped from mesh ID and material, textures are indexed bindlessly
         instances.emplace_back(std::move(instance));
     });
 
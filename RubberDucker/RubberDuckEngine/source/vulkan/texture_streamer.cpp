@@ -0,0 +1,173 @@
+#include "precompiled/pch.hpp"
+
+#include "texture_streamer.hpp"
+
+#include <numeric>
+
+namespace RDE {
+namespace Vulkan {
+
+constexpr uint32_t k_baseSize = 64;      // Largest level every streamed texture keeps resident
+constexpr uint32_t k_dropHysteresis = 2; // Unneeded levels kept before dropping while in budget, avoids thrashing
+constexpr double k_heapHeadroom = 0.1;   // Share of the heap budget left for everything else to grow into
+
+void TextureStreamer::init(VmaAllocator vmaAllocator, VkDeviceSize budget, VkDeviceSize uploadBudget)
+{
+    m_vmaAllocator = vmaAllocator;
+    m_budget = budget;
+    m_uploadBudget = uploadBudget;
+}
+
+void TextureStreamer::beginFrame()
+{
+    m_statistics.uploadSize = 0;
+}
+
+[[nodiscard]] std::vector<TextureStreamer::Change> TextureStreamer::plan(const std::vector<Request>& requests)
+{
+    VkDeviceSize residentTotal = 0;
+    uint32_t pendingCount = 0;
+    for (const auto& request : requests) {
+        residentTotal += residentSize(*request.source, request.residentMip);
+        pendingCount += request.wantedMip < request.residentMip ? 1 : 0;
+    }
+    const VkDeviceSize budget = clampToHeapBudget(residentTotal);
+
+    std::vector<Change> changes;
+    VkDeviceSize uploadSize = 0;
+
+    // The first change of a frame always fits, so levels larger than the upload budget still get streamed
+    const auto fitsUploadBudget = [&](VkDeviceSize size) {
+        return changes.empty() || uploadSize + size <= m_uploadBudget;
+    };
+    const auto change = [&](uint32_t index, uint32_t residentMip) {
+        const auto& request = requests[index];
+        const VkDeviceSize size = residentSize(*request.source, residentMip);
+        residentTotal = residentTotal - residentSize(*request.source, request.residentMip) + size;
+        uploadSize += size;
+        changes.push_back({index, residentMip});
+    };
+
+    std::vector<uint32_t> order(requests.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    // Drops first, so raises can use what they free. A spare level is kept unless memory is short
+    const auto surplus = [&requests](uint32_t index) {
+        return static_cast<int64_t>(requests[index].wantedMip) - static_cast<int64_t>(requests[index].residentMip);
+    };
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return surplus(a) > surplus(b); });
+
+    for (const uint32_t index : order) {
+        if (surplus(index) <= 0) {
+            break;
+        }
+        const auto& request = requests[index];
+        const bool overBudget = residentTotal > budget;
+        if (!overBudget && surplus(index) < k_dropHysteresis) {
+            continue;
+        }
+
+        const uint32_t residentMip = overBudget ? request.wantedMip : request.wantedMip - 1;
+        if (fitsUploadBudget(residentSize(*request.source, residentMip))) {
+            change(index, residentMip);
+        }
+    }
+
+    // Raises one level at a time, the most starved and then the largest on screen first
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return surplus(a) != surplus(b) ? surplus(a) < surplus(b)
+                                        : requests[a].screenSize > requests[b].screenSize;
+    });
+
+    for (const uint32_t index : order) {
+        if (surplus(index) >= 0) {
+            break;
+        }
+        const auto& request = requests[index];
+        const uint32_t residentMip = request.residentMip - 1;
+        const VkDeviceSize size = residentSize(*request.source, residentMip);
+        const VkDeviceSize growth = size - residentSize(*request.source, request.residentMip);
+
+        if (residentTotal + growth <= budget && fitsUploadBudget(size)) {
+            change(index, residentMip);
+        }
+    }
+
+    m_statistics.textureCount = static_cast<uint32_t>(requests.size());
+    m_statistics.pendingCount = pendingCount;
+    m_statistics.residentSize = residentTotal;
+    m_statistics.budget = budget;
+    m_statistics.uploadSize = uploadSize;
+
+    return changes;
+}
+
+[[nodiscard]] VkDeviceSize TextureStreamer::budget() const
+{
+    return m_budget;
+}
+
+void TextureStreamer::setBudget(VkDeviceSize budget)
+{
+    m_budget = budget;
+}
+
+[[nodiscard]] const TextureStreamer::Statistics& TextureStreamer::statistics() const
+{
+    return m_statistics;
+}
+
+[[nodiscard]] uint32_t TextureStreamer::baseMip(const Ktx2Texture& source)
+{
+    for (uint32_t level = 0; level < source.levels.size(); ++level) {
+        if (std::max(source.levels[level].width, source.levels[level].height) <= k_baseSize) {
+            return level;
+        }
+    }
+    return static_cast<uint32_t>(source.levels.size()) - 1;
+}
+
+[[nodiscard]] uint32_t TextureStreamer::mipForScreenSize(const Ktx2Texture& source, float screenSize)
+{
+    // Assumes the texture is mapped once across the object, so one texel per pixel at the chosen level
+    const auto lastLevel = static_cast<uint32_t>(source.levels.size()) - 1;
+    if (screenSize <= 1.0f) {
+        return lastLevel;
+    }
+    const float level = std::floor(std::log2(static_cast<float>(std::max(source.width, source.height)) / screenSize));
+    return std::min(static_cast<uint32_t>(std::max(level, 0.0f)), lastLevel);
+}
+
+[[nodiscard]] VkDeviceSize TextureStreamer::residentSize(const Ktx2Texture& source, uint32_t residentMip)
+{
+    // Levels are stored largest first, so the resident ones are the tail of the data
+    return source.data.size() - source.levels[residentMip].offset;
+}
+
+[[nodiscard]] VkDeviceSize TextureStreamer::clampToHeapBudget(VkDeviceSize residentSize) const
+{
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS]{};
+    vmaGetHeapBudgets(m_vmaAllocator, budgets);
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(m_vmaAllocator, &memoryProperties);
+
+    VkDeviceSize heapBudget = 0;
+    VkDeviceSize heapUsage = 0;
+    for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; ++heap) {
+        if (memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            heapBudget += budgets[heap].budget;
+            heapUsage += budgets[heap].usage;
+        }
+    }
+
+    // Everything else keeps what it uses, textures may take the rest short of some headroom
+    const auto usable = static_cast<VkDeviceSize>(static_cast<double>(heapBudget) * (1.0 - k_heapHeadroom));
+    const VkDeviceSize otherUsage = heapUsage > residentSize ? heapUsage - residentSize : 0;
+    const VkDeviceSize available = usable > otherUsage ? usable - otherUsage : 0;
+
+    return std::min(m_budget, available);
+}
+
+} // namespace Vulkan
+} // namespace RDE
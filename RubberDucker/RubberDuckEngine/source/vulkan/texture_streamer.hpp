@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ktx2.hpp"
+
+#include <vma/vk_mem_alloc.h>
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+
+// Decides how many mip levels of each streamed texture are resident. Textures start with only the levels up to
+// k_baseSize and are raised one level at a time towards what their visible instances need, largest on screen first.
+// Resident levels stay within a memory budget, clamped to what VMA reports as free in the device local heaps, and
+// the bytes uploaded per frame stay within an upload budget.
+// Images replaced by a change are retired by the renderer, frames in flight may still sample them.
+class TextureStreamer
+{
+public:
+    // What the renderer knows about one streamed texture this frame
+    struct Request
+    {
+        const Ktx2Texture* source = nullptr;
+        uint32_t residentMip = 0; // First level in the image
+        uint32_t wantedMip = 0;   // Finest level any visible instance needs
+        float screenSize = 0.0f;  // Largest projected size in pixels
+    };
+
+    struct Change
+    {
+        uint32_t request = 0; // Index into the requests
+        uint32_t residentMip = 0;
+    };
+
+    struct Statistics
+    {
+        uint32_t textureCount = 0;
+        uint32_t pendingCount = 0; // Below the level they want
+        VkDeviceSize residentSize = 0;
+        VkDeviceSize budget = 0;     // After clamping to the heap budget
+        VkDeviceSize uploadSize = 0; // This frame
+    };
+
+    void init(VmaAllocator vmaAllocator, VkDeviceSize budget, VkDeviceSize uploadBudget);
+
+    // Call once per submitted frame, before planning
+    void beginFrame();
+
+    [[nodiscard]] std::vector<Change> plan(const std::vector<Request>& requests);
+
+    [[nodiscard]] VkDeviceSize budget() const;
+    void setBudget(VkDeviceSize budget);
+    [[nodiscard]] const Statistics& statistics() const;
+
+    // Streaming only pays off for textures with levels above the base size
+    [[nodiscard]] static uint32_t baseMip(const Ktx2Texture& source);
+    [[nodiscard]] static uint32_t mipForScreenSize(const Ktx2Texture& source, float screenSize);
+    [[nodiscard]] static VkDeviceSize residentSize(const Ktx2Texture& source, uint32_t residentMip);
+
+private:
+    [[nodiscard]] VkDeviceSize clampToHeapBudget(VkDeviceSize residentSize) const;
+
+    VmaAllocator m_vmaAllocator = VK_NULL_HANDLE;
+    VkDeviceSize m_budget = 0;
+    VkDeviceSize m_uploadBudget = 0;
+
+    Statistics m_statistics{};
+};
+
+} // namespace Vulkan
+} // namespace RDE
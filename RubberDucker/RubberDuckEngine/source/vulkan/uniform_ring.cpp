@@ -0,0 +1,100 @@
+#include "precompiled/pch.hpp"
+
+#include "uniform_ring.hpp"
+
+namespace RDE {
+namespace Vulkan {
+
+void UniformRing::init(VmaAllocator vmaAllocator,
+                       VkDeviceSize regionSize,
+                       uint32_t regionCount,
+                       VkDeviceSize bindingRange,
+                       VkDeviceSize minAlignment)
+{
+    m_vmaAllocator = vmaAllocator;
+    m_alignment = std::max(minAlignment, VkDeviceSize{1});
+    m_bindingRange = bindingRange;
+
+    // Regions start aligned, so offsets within them only need aligning relative to their start
+    m_regionSize = (std::max(regionSize, bindingRange) + m_alignment - 1) / m_alignment * m_alignment;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_regionSize * regionCount;
+    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    allocationInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    const auto result = vmaCreateBuffer(m_vmaAllocator,
+                                        &bufferInfo,
+                                        &allocationInfo,
+                                        &m_buffer.buffer,
+                                        &m_buffer.allocation,
+                                        &m_buffer.allocationInfo);
+    RDE_ASSERT_0(result == VK_SUCCESS, "Failed to create uniform ring of {} bytes!", bufferInfo.size);
+
+    beginFrame(0);
+}
+
+void UniformRing::destroy()
+{
+    vmaDestroyBuffer(m_vmaAllocator, m_buffer.buffer, m_buffer.allocation);
+    m_buffer = {};
+}
+
+void UniformRing::beginFrame(uint32_t frameIndex)
+{
+    m_regionStart = m_regionSize * frameIndex;
+    m_offset = m_regionStart;
+    m_allocationCount = 0;
+}
+
+[[nodiscard]] UniformRing::Allocation UniformRing::allocate(VkDeviceSize size)
+{
+    RDE_ASSERT_0(size <= m_bindingRange, "Uniform block of {} bytes is larger than the binding range!", size);
+
+    // The descriptor reads bindingRange bytes from the offset, which has to stay within the region
+    const VkDeviceSize offset = (m_offset + m_alignment - 1) / m_alignment * m_alignment;
+    RDE_ASSERT_0(offset + m_bindingRange <= m_regionStart + m_regionSize,
+                 "Out of uniform ring space, {} bytes used this frame!",
+                 m_offset - m_regionStart);
+
+    m_offset = offset + size;
+    ++m_allocationCount;
+
+    Allocation allocation{};
+    allocation.offset = static_cast<uint32_t>(offset);
+    allocation.data = static_cast<uint8_t*>(m_buffer.allocationInfo.pMappedData) + offset;
+    return allocation;
+}
+
+[[nodiscard]] VkBuffer UniformRing::buffer() const
+{
+    return m_buffer.buffer;
+}
+
+[[nodiscard]] VkDeviceSize UniformRing::bindingRange() const
+{
+    return m_bindingRange;
+}
+
+[[nodiscard]] VkDeviceSize UniformRing::regionSize() const
+{
+    return m_regionSize;
+}
+
+[[nodiscard]] VkDeviceSize UniformRing::usedSize() const
+{
+    return m_offset - m_regionStart;
+}
+
+[[nodiscard]] uint32_t UniformRing::allocationCount() const
+{
+    return m_allocationCount;
+}
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "data_types/vma_buffer.hpp"
+
+#include <vma/vk_mem_alloc.h>
+#include <vulkan/vulkan.hpp>
+
+#include <cstring>
+
+namespace RDE {
+namespace Vulkan {
+
+// One persistently mapped uniform buffer with a region for each frame in flight. Everything a frame's shaders read
+// through uniform blocks, the camera of every view and the constants of every pass, is suballocated linearly from
+// its region and bound by offset through a single UNIFORM_BUFFER_DYNAMIC descriptor. A region is only reused once the
+// fence of the frame that last wrote it has signalled.
+class UniformRing
+{
+public:
+    struct Allocation
+    {
+        uint32_t offset = 0;  // Dynamic offset to bind it with
+        void* data = nullptr; // Mapped pointer to the start of the allocation
+    };
+
+    // Every allocation can be bound with a descriptor of bindingRange bytes, blocks read through it must fit
+    void init(VmaAllocator vmaAllocator,
+              VkDeviceSize regionSize,
+              uint32_t regionCount,
+              VkDeviceSize bindingRange,
+              VkDeviceSize minAlignment);
+
+    // The device must be idle
+    void destroy();
+
+    // Starts suballocating from the region of the frame, whose fence must have signalled
+    void beginFrame(uint32_t frameIndex);
+
+    [[nodiscard]] Allocation allocate(VkDeviceSize size);
+
+    // Copies the block into a new allocation and returns its offset
+    template<typename T>
+    [[nodiscard]] uint32_t push(const T& block)
+    {
+        const auto allocation = allocate(sizeof(T));
+        memcpy(allocation.data, &block, sizeof(T));
+        return allocation.offset;
+    }
+
+    [[nodiscard]] VkBuffer buffer() const;
+    [[nodiscard]] VkDeviceSize bindingRange() const;
+    [[nodiscard]] VkDeviceSize regionSize() const;
+    [[nodiscard]] VkDeviceSize usedSize() const;    // In the current frame's region
+    [[nodiscard]] uint32_t allocationCount() const; // In the current frame
+
+private:
+    VmaAllocator m_vmaAllocator = VK_NULL_HANDLE;
+    VmaBuffer m_buffer{};
+    VkDeviceSize m_regionSize = 0;
+    VkDeviceSize m_bindingRange = 0;
+    VkDeviceSize m_alignment = 1;
+
+    VkDeviceSize m_regionStart = 0;
+    VkDeviceSize m_offset = 0; // Next free byte, relative to the buffer
+    uint32_t m_allocationCount = 0;
+};
+
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,217 @@
+#include "precompiled/pch.hpp"
+
+#include "vertex_packer.hpp"
+
+#include "utilities/clock.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace RDE {
+namespace Vulkan {
+namespace VertexPacker {
+
+namespace {
+// Texture coordinate range 16-bit steps can still address texels in, 16 / 65535 is a quarter texel at 1024
+constexpr float k_maxUnorm16TexCoordRange = 16.0f;
+
+template<typename TVector>
+struct Bounds
+{
+    TVector min{};
+    TVector max{};
+
+    [[nodiscard]] TVector extent() const { return max - min; }
+    [[nodiscard]] TVector center() const { return (min + max) * 0.5f; }
+};
+
+template<typename TVector, typename TGetter>
+[[nodiscard]] Bounds<TVector> calculateBounds(const std::vector<Vertex>& vertices, TGetter&& getter)
+{
+    if (vertices.empty()) {
+        return {};
+    }
+    Bounds<TVector> bounds{getter(vertices.front()), getter(vertices.front())};
+    for (const auto& vertex : vertices) {
+        bounds.min = glm::min(bounds.min, getter(vertex));
+        bounds.max = glm::max(bounds.max, getter(vertex));
+    }
+    return bounds;
+}
+
+// Flat axes quantize to 0, the dequantization scale is 0 there anyway
+template<typename TVector>
+[[nodiscard]] TVector inverseScale(const TVector& scale)
+{
+    TVector inverse{};
+    for (glm::length_t i = 0; i < TVector::length(); ++i) {
+        inverse[i] = scale[i] > 0.0f ? 1.0f / scale[i] : 0.0f;
+    }
+    return inverse;
+}
+
+[[nodiscard]] uint16_t toUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+[[nodiscard]] int16_t toSnorm16(float value)
+{
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+// Projects onto the octahedron |x| + |y| + |z| = 1 and folds the lower half over the upper one. Must match
+// decodeOctahedral in shader.vert
+[[nodiscard]] glm::vec2 encodeOctahedral(const glm::vec3& normal)
+{
+    const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length == 0.0f) {
+        return {};
+    }
+    glm::vec2 encoded = glm::vec2(normal) / length;
+    if (normal.z < 0.0f) {
+        const glm::vec2 sign(encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f);
+        encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * sign;
+    }
+    return encoded;
+}
+
+template<typename T>
+void write(uint8_t* destination, const T& value)
+{
+    std::memcpy(destination, &value, sizeof(T));
+}
+} // namespace
+
+[[nodiscard]] PositionEncoding parsePositionEncoding(std::string_view name)
+{
+    if (name == "float") {
+        return PositionEncoding::Float32;
+    }
+    if (name == "half") {
+        return PositionEncoding::Half16;
+    }
+    if (name != "unorm16") {
+        RDELOG_WARN("Unknown vertex position encoding {}, using unorm16", name);
+    }
+    return PositionEncoding::Unorm16;
+}
+
+[[nodiscard]] VertexFormat chooseFormat(const std::vector<Vertex>& vertices,
+                                        bool hasNormals,
+                                        bool hasTexCoords,
+                                        PositionEncoding positionEncoding)
+{
+    const bool fullPrecision = positionEncoding == PositionEncoding::Float32;
+
+    VertexFormat format{};
+    format.position = positionEncoding;
+
+    if (hasNormals) {
+        format.normal = fullPrecision ? NormalEncoding::Octahedral32 : NormalEncoding::Octahedral16;
+    }
+    if (hasTexCoords) {
+        const auto texCoordBounds =
+            calculateBounds<glm::vec2>(vertices, [](const Vertex& vertex) { return vertex.texCoord; });
+        const glm::vec2 extent = texCoordBounds.extent();
+        const bool fitsUnorm16 = std::max(extent.x, extent.y) <= k_maxUnorm16TexCoordRange;
+
+        format.texCoord = !fullPrecision && fitsUnorm16 ? TexCoordEncoding::Unorm16 : TexCoordEncoding::Float32;
+    }
+    return format;
+}
+
+[[nodiscard]] PackedVertices pack(const std::vector<Vertex>& vertices, const VertexFormat& format)
+{
+    RDE_PROFILE_SCOPE
+
+    PackedVertices packed{};
+    auto& dequantization = packed.dequantization;
+
+    // Half floats are most precise around 0, so they are centered. Unorm values are spread over the whole extent
+    const auto positionBounds = calculateBounds<glm::vec3>(vertices, [](const Vertex& vertex) { return vertex.pos; });
+    if (format.position == PositionEncoding::Half16) {
+        dequantization.positionOffset = glm::vec4(positionBounds.center(), 0.0f);
+        dequantization.positionScale = glm::vec4(positionBounds.extent() * 0.5f, 0.0f);
+    } else if (format.position == PositionEncoding::Unorm16) {
+        dequantization.positionOffset = glm::vec4(positionBounds.min, 0.0f);
+        dequantization.positionScale = glm::vec4(positionBounds.extent(), 0.0f);
+    }
+    const glm::vec3 positionOffset(dequantization.positionOffset);
+    const glm::vec3 positionInverseScale = inverseScale(glm::vec3(dequantization.positionScale));
+
+    if (format.texCoord == TexCoordEncoding::Unorm16) {
+        const auto texCoordBounds =
+            calculateBounds<glm::vec2>(vertices, [](const Vertex& vertex) { return vertex.texCoord; });
+        dequantization.texCoordTransform = glm::vec4(texCoordBounds.min, texCoordBounds.extent());
+    }
+    const glm::vec2 texCoordOffset(dequantization.texCoordTransform);
+    const glm::vec2 texCoordInverseScale =
+        inverseScale(glm::vec2(dequantization.texCoordTransform.z, dequantization.texCoordTransform.w));
+
+    const uint32_t positionStride = format.positionStride();
+    const uint32_t attributeStride = format.attributeStride();
+    packed.positions.resize(vertices.size() * positionStride);
+    packed.attributes.resize(vertices.size() * attributeStride);
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const auto& vertex = vertices[i];
+        uint8_t* position = packed.positions.data() + i * positionStride;
+        uint8_t* attributes = packed.attributes.data() + i * attributeStride;
+
+        const glm::vec3 quantizedPosition = (vertex.pos - positionOffset) * positionInverseScale;
+        switch (format.position) {
+        case PositionEncoding::Float32:
+            write(position, vertex.pos);
+            break;
+        case PositionEncoding::Half16:
+            write(position,
+                  std::array<uint16_t, 4>{glm::packHalf1x16(quantizedPosition.x),
+                                          glm::packHalf1x16(quantizedPosition.y),
+                                          glm::packHalf1x16(quantizedPosition.z),
+                                          0});
+            break;
+        case PositionEncoding::Unorm16:
+            write(position,
+                  std::array<uint16_t, 4>{toUnorm16(quantizedPosition.x),
+                                          toUnorm16(quantizedPosition.y),
+                                          toUnorm16(quantizedPosition.z),
+                                          0});
+            break;
+        }
+
+        const glm::vec2 octahedral = encodeOctahedral(vertex.normal);
+        if (format.normal == NormalEncoding::Octahedral32) {
+            write(attributes, octahedral);
+        } else if (format.normal == NormalEncoding::Octahedral16) {
+            write(attributes, std::array<int16_t, 2>{toSnorm16(octahedral.x), toSnorm16(octahedral.y)});
+        }
+
+        uint8_t* texCoord = attributes + format.texCoordOffset();
+        if (format.texCoord == TexCoordEncoding::Float32) {
+            write(texCoord, vertex.texCoord);
+        } else if (format.texCoord == TexCoordEncoding::Unorm16) {
+            const glm::vec2 quantizedTexCoord = (vertex.texCoord - texCoordOffset) * texCoordInverseScale;
+            write(texCoord, std::array<uint16_t, 2>{toUnorm16(quantizedTexCoord.x), toUnorm16(quantizedTexCoord.y)});
+        }
+    }
+    return packed;
+}
+
+[[nodiscard]] Statistics statistics(const VertexFormat& format, size_t vertexCount)
+{
+    Statistics statistics{};
+    statistics.depthFetchSize = format.positionStride();
+    statistics.sceneFetchSize = format.positionStride() + format.attributeStride();
+    statistics.size = VkDeviceSize{statistics.sceneFetchSize} * vertexCount;
+    statistics.unpackedSize = VkDeviceSize{k_unpackedVertexStride + k_unpackedPositionStride} * vertexCount;
+
+    return statistics;
+}
+
+} // namespace VertexPacker
+} // namespace Vulkan
+} // namespace RDE
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "data_types/vertex.hpp"
+#include "data_types/vertex_format.hpp"
+
+#include <string_view>
+#include <vector>
+
+namespace RDE {
+namespace Vulkan {
+namespace VertexPacker {
+
+struct PackedVertices
+{
+    std::vector<uint8_t> positions;
+    std::vector<uint8_t> attributes; // Empty if the format has no normals or texture coordinates
+    VertexDequantization dequantization{};
+};
+
+// What a mesh's vertices cost, next to what the unpacked layout cost
+struct Statistics
+{
+    VkDeviceSize size = 0;
+    VkDeviceSize unpackedSize = 0;
+    uint32_t depthFetchSize = 0; // Bytes read per vertex by the depth pre-pass
+    uint32_t sceneFetchSize = 0; // Bytes read per vertex by the scene pass
+};
+
+// "float", "half" or "unorm16"
+[[nodiscard]] PositionEncoding parsePositionEncoding(std::string_view name);
+
+// With float positions every stream stays at full precision. Otherwise normals and texture coordinates are 16-bit too,
+// unless the texture coordinates span too large a range for 16 bits to address single texels
+[[nodiscard]] VertexFormat chooseFormat(const std::vector<Vertex>& vertices,
+                                        bool hasNormals,
+                                        bool hasTexCoords,
+                                        PositionEncoding positionEncoding);
+
+[[nodiscard]] PackedVertices pack(const std::vector<Vertex>& vertices, const VertexFormat& format);
+[[nodiscard]] Statistics statistics(const VertexFormat& format, size_t vertexCount);
+
+} // namespace VertexPacker
+} // namespace Vulkan
+} // namespace RDE
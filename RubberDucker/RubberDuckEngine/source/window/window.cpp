@@ -1,5 +1,6 @@
 #include "precompiled/pch.hpp"
 
+#include "core/main.hpp"
 #include "input/input_handler.hpp"
 #include "window.hpp"
 
@@ -8,6 +9,15 @@ namespace RDE
 
 void Window::init()
 {
+    const auto& launchOptions = g_engine->launchOptions();
+    m_width = launchOptions.width.value_or(m_width);
+    m_height = launchOptions.height.value_or(m_height);
+
+    m_headless = launchOptions.headless;
+    if (m_headless) {
+        return;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -25,18 +35,37 @@ void Window::init()
         glfwSetInputMode(m_handle, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
 
     setCursorDisabled(false);
-    setDisplayType(DisplayType::Windowed);
+
+    // Keep the requested size rather than the default one
+    if (!launchOptions.width && !launchOptions.height) {
+        setDisplayType(DisplayType::Windowed);
+    }
 }
 
 void Window::cleanup()
 {
+    if (m_headless) {
+        return;
+    }
     glfwDestroyWindow(m_handle);
     glfwTerminate();
 }
 
+void Window::pollEvents()
+{
+    if (!m_headless) {
+        glfwPollEvents();
+    }
+}
+
+[[nodiscard]] bool Window::shouldClose() const
+{
+    return !m_headless && glfwWindowShouldClose(m_handle);
+}
+
 void Window::setCursorDisabled(bool disabled)
 {
-    if (m_cursorDisabled == disabled) {
+    if (m_cursorDisabled == disabled || m_headless) {
         return;
     }
 
@@ -55,6 +84,10 @@ void Window::framebufferResizeCallback(GLFWwindow* window, int width, int height
 
 void Window::setDisplayType(DisplayType displayType)
 {
+    if (m_headless) {
+        return;
+    }
+
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode* mode = glfwGetVideoMode(monitor);
 
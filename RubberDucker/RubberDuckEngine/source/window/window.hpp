@@ -20,8 +20,14 @@ public:
     void init();
     void cleanup();
 
+    void pollEvents();
+    [[nodiscard]] bool shouldClose() const;
+
     inline GLFWwindow* handle() const { return m_handle; }
 
+    // No window or GLFW at all, the renderer draws into offscreen images
+    inline bool isHeadless() const { return m_headless; }
+
     inline bool isResized() const { return m_resized; }
 
     inline void setResized(bool resized) { m_resized = resized; }
@@ -68,8 +74,9 @@ private:
     static constexpr uint32_t k_defaultWidth = 1440;
     static constexpr uint32_t k_defaultHeight = 810;
 
-    GLFWwindow* m_handle;
+    GLFWwindow* m_handle = nullptr;
 
+    bool m_headless = false;
     bool m_resized = false;
     bool m_cursorDisabled = false;
 
@@ -95,6 +95,25 @@ project "RubberDuckEngine"
         "MultiProcessorCompile"
     }
 
+    -- GLSL is compiled to SPIR-V next to the sources, the SPIR-V isn't tracked
+    local shaders =
+    {
+        ["cull.comp"] = "cull.spv",
+        ["depth.vert"] = "depth.spv",
+        ["shader.frag"] = "frag.spv",
+        ["shader.vert"] = "vert.spv",
+        ["upscale.frag"] = "upscale_frag.spv",
+        ["upscale.vert"] = "upscale_vert.spv"
+    }
+
+    for source, spirv in pairs(shaders) do
+        filter("files:**/assets/shaders/" .. source)
+            buildmessage("Compiling " .. source)
+            buildcommands { '"%VULKAN_SDK%\\Bin\\glslc.exe" "%{file.relpath}" -o "%{file.reldirectory}/' .. spirv .. '"' }
+            buildoutputs { "%{file.reldirectory}/" .. spirv }
+    end
+    filter {}
+
     filter "configurations:Debug"
         defines "RDE_DEBUG"
         symbols "On"
@@ -1,3 +1,9 @@
-C:/VulkanSDK/1.3.224.1/Bin/glslc.exe ../RubberDuckEngine/assets/shaders/shader.vert -o ../RubberDuckEngine/assets/shaders/vert.spv
-C:/VulkanSDK/1.3.224.1/Bin/glslc.exe ../RubberDuckEngine/assets/shaders/shader.frag -o ../RubberDuckEngine/assets/shaders/frag.spv
+rem Also run by the build, this is for recompiling shaders without rebuilding
+set SHADERS=%~dp0..\RubberDuckEngine\assets\shaders
+"%VULKAN_SDK%\Bin\glslc.exe" "%SHADERS%\shader.vert" -o "%SHADERS%\vert.spv"
+"%VULKAN_SDK%\Bin\glslc.exe" "%SHADERS%\shader.frag" -o "%SHADERS%\frag.spv"
+"%VULKAN_SDK%\Bin\glslc.exe" "%SHADERS%\cull.comp" -o "%SHADERS%\cull.spv"
+"%VULKAN_SDK%\Bin\glslc.exe" "%SHADERS%\depth.vert" -o "%SHADERS%\depth.spv"
+"%VULKAN_SDK%\Bin\glslc.exe" "%SHADERS%\upscale.vert" -o "%SHADERS%\upscale_vert.spv"
+"%VULKAN_SDK%\Bin\glslc.exe" "%SHADERS%\upscale.frag" -o "%SHADERS%\upscale_frag.spv"
 pause